@@ -22,6 +22,10 @@ namespace PK::Math
 			case PK_TYPE::UINT3: return PK_TYPE_SIZE_INT3;
 			case PK_TYPE::INT4: 
 			case PK_TYPE::UINT4: return PK_TYPE_SIZE_INT4;
+			case PK_TYPE::HALF2: return PK_TYPE_SIZE_HALF2;
+			case PK_TYPE::HALF4: return PK_TYPE_SIZE_HALF4;
+			case PK_TYPE::SHORT2: return PK_TYPE_SIZE_SHORT2;
+			case PK_TYPE::USHORT4: return PK_TYPE_SIZE_USHORT4;
 			case PK_TYPE::HANDLE: return PK_TYPE_SIZE_HANDLE;
 			case PK_TYPE::TEXTURE: return PK_TYPE_SIZE_TEXTURE;
 			case PK_TYPE::IMAGE_PARAMS: return PK_TYPE_SIZE_IMAGEPARAMS;
@@ -51,6 +55,10 @@ namespace PK::Math
 			case PK_TYPE::UINT3: return PK_TYPE_COMPONENTS_INT3;
 			case PK_TYPE::INT4: 
 			case PK_TYPE::UINT4: return PK_TYPE_COMPONENTS_INT4;
+			case PK_TYPE::HALF2: return PK_TYPE_COMPONENTS_HALF2;
+			case PK_TYPE::HALF4: return PK_TYPE_COMPONENTS_HALF4;
+			case PK_TYPE::SHORT2: return PK_TYPE_COMPONENTS_SHORT2;
+			case PK_TYPE::USHORT4: return PK_TYPE_COMPONENTS_USHORT4;
 			case PK_TYPE::HANDLE: return PK_TYPE_COMPONENTS_HANDLE;
 			case PK_TYPE::TEXTURE: return PK_TYPE_COMPONENTS_TEXTURE;
 			case PK_TYPE::IMAGE_PARAMS: return PK_TYPE_COMPONENTS_IMAGEPARAMS;
@@ -80,6 +88,10 @@ namespace PK::Math
 			case PK_TYPE::UINT2: return GL_UNSIGNED_INT;
 			case PK_TYPE::UINT3: return GL_UNSIGNED_INT;
 			case PK_TYPE::UINT4: return GL_UNSIGNED_INT;
+			case PK_TYPE::HALF2: return GL_HALF_FLOAT;
+			case PK_TYPE::HALF4: return GL_HALF_FLOAT;
+			case PK_TYPE::SHORT2: return GL_SHORT;
+			case PK_TYPE::USHORT4: return GL_UNSIGNED_SHORT;
 			case PK_TYPE::HANDLE: return GL_UNSIGNED_INT64_ARB;
 			case PK_TYPE::TEXTURE: return GL_INT;
 			case PK_TYPE::IMAGE_PARAMS: return GL_INT;
@@ -109,6 +121,10 @@ namespace PK::Math
 			case PK_TYPE::UINT2: return GL_UNSIGNED_INT_VEC2;
 			case PK_TYPE::UINT3: return GL_UNSIGNED_INT_VEC3;
 			case PK_TYPE::UINT4: return GL_UNSIGNED_INT_VEC4;
+			case PK_TYPE::HALF2: return GL_FLOAT_VEC2;
+			case PK_TYPE::HALF4: return GL_FLOAT_VEC4;
+			case PK_TYPE::SHORT2: return GL_FLOAT_VEC2;
+			case PK_TYPE::USHORT4: return GL_FLOAT_VEC4;
 			case PK_TYPE::HANDLE: return GL_UNSIGNED_INT64_ARB;
 			case PK_TYPE::TEXTURE: return GL_TEXTURE;
 			case PK_TYPE::IMAGE_PARAMS: return GL_TEXTURE;
@@ -226,6 +242,10 @@ namespace PK::Math
 			case PK_TYPE::UINT2: return "UINT2";
 			case PK_TYPE::UINT3: return "UINT3";
 			case PK_TYPE::UINT4: return "UINT4";
+			case PK_TYPE::HALF2: return "HALF2";
+			case PK_TYPE::HALF4: return "HALF4";
+			case PK_TYPE::SHORT2: return "SHORT2";
+			case PK_TYPE::USHORT4: return "USHORT4";
 			case PK_TYPE::HANDLE: return "HANDLE";
 			case PK_TYPE::TEXTURE: return "TEXTURE";
 			case PK_TYPE::IMAGE_PARAMS: return "IMAGE";
@@ -253,6 +273,10 @@ namespace PK::Math
 		if (strcmp(string, "UINT2") == 0) return PK_TYPE::UINT2;
 		if (strcmp(string, "UINT3") == 0) return PK_TYPE::UINT3;
 		if (strcmp(string, "UINT4") == 0) return PK_TYPE::UINT4;
+		if (strcmp(string, "HALF2") == 0) return PK_TYPE::HALF2;
+		if (strcmp(string, "HALF4") == 0) return PK_TYPE::HALF4;
+		if (strcmp(string, "SHORT2") == 0) return PK_TYPE::SHORT2;
+		if (strcmp(string, "USHORT4") == 0) return PK_TYPE::USHORT4;
 		if (strcmp(string, "HANDLE") == 0) return PK_TYPE::HANDLE;
 		if (strcmp(string, "TEXTURE") == 0) return PK_TYPE::TEXTURE;
 		if (strcmp(string, "IMAGE") == 0) return PK_TYPE::IMAGE_PARAMS;
@@ -685,6 +709,25 @@ namespace PK::Math
 		return true;
 	}
 
+	bool Functions::ContainsPlanesAABB(const float4* planes, int planeCount, const BoundingBox& aabb)
+	{
+		for (auto i = 0; i < planeCount; ++i)
+		{
+			auto& plane = planes[i];
+	
+			auto bx = plane.x > 0 ? aabb.min.x : aabb.max.x;
+			auto by = plane.y > 0 ? aabb.min.y : aabb.max.y;
+			auto bz = plane.z > 0 ? aabb.min.z : aabb.max.z;
+	
+			if (plane.x * bx + plane.y * by + plane.z * bz < -plane.w)
+			{
+				return false;
+			}
+		}
+	
+		return true;
+	}
+
 	bool Functions::IntersectAABB(const BoundingBox& a, const BoundingBox& b)
 	{
 		auto overlap = (!(a.min[0] > b.max[0]) && !(a.max[0] < b.min[0]));
@@ -33,6 +33,10 @@ namespace PK::Math
         CONSTANT_BUFFER = 19,
         COMPUTE_BUFFER = 20,
         VERTEX_ARRAY = 21,
+        HALF2 = 22,
+        HALF4 = 23,
+        SHORT2 = 24,
+        USHORT4 = 25,
         INVALID = 0xFFFF
     };
     
@@ -47,6 +51,10 @@ namespace PK::Math
     constexpr unsigned short PK_TYPE_SIZE_INT2 = 8;			// 4 * 2
     constexpr unsigned short PK_TYPE_SIZE_INT3 = 12;		// 4 * 3
     constexpr unsigned short PK_TYPE_SIZE_INT4 = 16;		// 4 * 4
+    constexpr unsigned short PK_TYPE_SIZE_HALF2 = 4;			// 2 * 2
+    constexpr unsigned short PK_TYPE_SIZE_HALF4 = 8;			// 2 * 4
+    constexpr unsigned short PK_TYPE_SIZE_SHORT2 = 4;		// 2 * 2
+    constexpr unsigned short PK_TYPE_SIZE_USHORT4 = 8;		// 2 * 4
     constexpr unsigned short PK_TYPE_SIZE_HANDLE = 8;
     constexpr unsigned short PK_TYPE_SIZE_TEXTURE = 4;
     constexpr unsigned short PK_TYPE_SIZE_IMAGEPARAMS = 21;
@@ -64,6 +72,10 @@ namespace PK::Math
     constexpr unsigned short PK_TYPE_COMPONENTS_INT2 = 2;
     constexpr unsigned short PK_TYPE_COMPONENTS_INT3 = 3;
     constexpr unsigned short PK_TYPE_COMPONENTS_INT4 = 4;
+    constexpr unsigned short PK_TYPE_COMPONENTS_HALF2 = 2;
+    constexpr unsigned short PK_TYPE_COMPONENTS_HALF4 = 4;
+    constexpr unsigned short PK_TYPE_COMPONENTS_SHORT2 = 2;
+    constexpr unsigned short PK_TYPE_COMPONENTS_USHORT4 = 4;
     constexpr unsigned short PK_TYPE_COMPONENTS_HANDLE = 1;
     constexpr unsigned short PK_TYPE_COMPONENTS_TEXTURE = 1;
     constexpr unsigned short PK_TYPE_COMPONENTS_IMAGEPARAMS = 1;
@@ -274,6 +286,8 @@ namespace PK::Math
         inline BoundingBox CreateBoundsCenterExtents(const float3& center, const float3& extents) { return BoundingBox(center - extents, center + extents); }
     
         bool IntersectPlanesAABB(const float4* planes, int planeCount, const BoundingBox& aabb);
+        // True when the whole box is on the positive side of every plane.
+        bool ContainsPlanesAABB(const float4* planes, int planeCount, const BoundingBox& aabb);
         bool IntersectAABB(const BoundingBox& a, const BoundingBox& b);
         bool IntersectSphere(const float3& center, float radius, const BoundingBox& b);
         void BoundsEncapsulate(BoundingBox* bounds, const BoundingBox& other);
@@ -8,10 +8,9 @@
 #multi_compile _ PK_ENABLE_INSTANCING
 
 #include includes/PKCommon.glsl
+#include includes/VertexCompression.glsl
 
 #pragma PROGRAM_VERTEX
-layout(location = 0) in float3 in_POSITION0;
-layout(location = 1) in float3 in_NORMAL;
 
 out float3 vs_NORMAL;
 
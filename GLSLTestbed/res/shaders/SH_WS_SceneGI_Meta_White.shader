@@ -10,11 +10,10 @@
 
 #include includes/Lighting.glsl
 #include includes/SceneGIShared.glsl
+#include includes/VertexCompression.glsl
 
 #pragma PROGRAM_VERTEX
 
-layout(location = 0) in float3 in_POSITION0;
-layout(location = 1) in float3 in_NORMAL;
 out float3 vs_WOLRDPOSITION;
 out float3 vs_NORMAL;
 
@@ -9,9 +9,9 @@
 
 #define DRAW_SHADOW_MAP_FRAGMENT
 #include includes/Shadowmapping.glsl
+#include includes/VertexCompression.glsl
 
 #pragma PROGRAM_VERTEX
-layout(location = 0) in float3 in_POSITION0;
 out float4 vs_DEPTH;
 
 void main()
@@ -8,13 +8,13 @@
 #multi_compile _ PK_ENABLE_INSTANCING
 
 #include includes/PKCommon.glsl
+#include includes/VertexCompression.glsl
 
 PK_BEGIN_INSTANCED_PROPERTIES
     PK_INSTANCED_PROPERTY float4 _Color;
 PK_END_INSTANCED_PROPERTIES
 
 #pragma PROGRAM_VERTEX
-layout(location = 0) in float3 in_POSITION0;
 PK_VARYING_INSTANCE_ID
 
 void main()
@@ -3,6 +3,7 @@
 #include LightingBRDF.glsl
 #include Reconstruction.glsl
 #include SceneGIShared.glsl
+#include VertexCompression.glsl
 
 // Meta pass specific parameters (gi voxelization requires some changes from reqular view projection).
 #multi_compile _ PK_META_DEPTH_NORMALS PK_META_GI_VOXELIZE
@@ -114,11 +115,6 @@ PKIndirect GetStaticSceneIndirect(float3 normal, float3 viewdir, float roughness
     // Use these to modify surface values in fragment or vertex stage
     void PK_SURFACE_FUNC_VERT(inout SurfaceFragmentVaryings surf);
 
-    layout(location = 0) in float3 in_POSITION0;
-    layout(location = 1) in float3 in_NORMAL;
-    layout(location = 2) in float4 in_TANGENT;
-    layout(location = 3) in float2 in_TEXCOORD0;
-    
     out SurfaceFragmentVaryings baseVaryings;
     PK_VARYING_INSTANCE_ID
     
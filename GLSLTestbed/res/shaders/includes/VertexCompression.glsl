@@ -0,0 +1,52 @@
+#pragma once
+#include HLSLSupport.glsl
+
+// Vertex inputs for meshes. Compressed layouts are written by MeshUtility::CompressVertices.
+#multi_compile _ PK_VERTEX_COMPRESSED
+
+#if defined(SHADER_STAGE_VERTEX)
+
+    #if defined(PK_VERTEX_COMPRESSED)
+
+        uniform float3 pk_MeshQuantizationMin;
+        uniform float3 pk_MeshQuantizationExtents;
+
+        layout(location = 0) in float4 in_POSITION_PACKED;
+        layout(location = 1) in float2 in_NORMAL_PACKED;
+        layout(location = 2) in uint in_TANGENT_PACKED;
+        layout(location = 3) in float2 in_TEXCOORD0;
+
+        // Unlike OctaDecode this expects the signed [-1, 1] range & z as the primary axis.
+        float3 OctaDecodeSigned(float2 f)
+        {
+            float3 n = float3(f.x, f.y, 1.0f - abs(f.x) - abs(f.y));
+            float t = max(-n.z, 0.0f);
+            n.x += n.x >= 0.0f ? -t : t;
+            n.y += n.y >= 0.0f ? -t : t;
+            return normalize(n);
+        }
+
+        float3 DecodeVertexPosition(float4 packed) { return pk_MeshQuantizationMin + packed.xyz * pk_MeshQuantizationExtents; }
+
+        float3 DecodeVertexNormal(float2 packed) { return OctaDecodeSigned(packed); }
+
+        float4 DecodeVertexTangent(uint packed)
+        {
+            float2 f = float2(packed & 0xFFFFu, (packed >> 16u) & 0x7FFFu) / float2(65535.0f, 32767.0f) * 2.0f - 1.0f;
+            return float4(OctaDecodeSigned(f), (packed >> 31u) != 0u ? -1.0f : 1.0f);
+        }
+
+        #define in_POSITION0 DecodeVertexPosition(in_POSITION_PACKED)
+        #define in_NORMAL DecodeVertexNormal(in_NORMAL_PACKED)
+        #define in_TANGENT DecodeVertexTangent(in_TANGENT_PACKED)
+
+    #else
+
+        layout(location = 0) in float3 in_POSITION0;
+        layout(location = 1) in float3 in_NORMAL;
+        layout(location = 2) in float4 in_TANGENT;
+        layout(location = 3) in float2 in_TEXCOORD0;
+
+    #endif
+
+#endif
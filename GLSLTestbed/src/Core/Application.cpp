@@ -8,14 +8,21 @@
 #include "Core/Application.h"
 #include "Core/ApplicationConfig.h"
 #include "Core/CommandConfig.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Core/MemoryTracker.h"
+#include "Core/FileWatcher.h"
+#include "Core/AssetCache.h"
 #include "Rendering/RenderPipeline.h"
 #include "Rendering/GizmoRenderer.h"
+#include "Rendering/ShaderVariantManifest.h"
 #include "ECS/Contextual/Engines/EngineEditorCamera.h"
 #include "ECS/Contextual/Engines/EngineDebug.h"
 #include "ECS/Contextual/Engines/EngineCommandInput.h"
 #include "ECS/Contextual/Engines/EngineScreenshot.h"
 #include "ECS/Contextual/Engines/EngineUpdateTransforms.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Rendering/MeshUtility.h"
 #include <math.h>
 
 namespace PK::Core
@@ -26,7 +33,7 @@ namespace PK::Core
 
 	Application* Application::s_Instance = nullptr;
 	
-	Application::Application(const std::string& name)
+	Application::Application(const std::string& name, const std::vector<std::string>& arguments)
 	{
 		PK_CORE_ASSERT(!s_Instance, "Application already exists!");
 		s_Instance = this;
@@ -34,6 +41,8 @@ namespace PK::Core
 		PK::Rendering::GraphicsAPI::Initialize();
 		
 		m_services = CreateScope<ServiceRegister>();
+		m_services->Create<Profiler>();
+		auto memoryTracker = m_services->Create<MemoryTracker>();
 		m_services->Create<StringHashID>();
 		m_services->Create<HashCache>();
 		auto entityDb = m_services->Create<PK::ECS::EntityDatabase>();
@@ -42,11 +51,15 @@ namespace PK::Core
 		
 		assetDatabase->LoadDirectory<ApplicationConfig>("res/configs/");
 		assetDatabase->LoadDirectory<CommandConfig>("res/configs/");
-		auto config = assetDatabase->Find<ApplicationConfig>("Active");
-		auto commandConfig = assetDatabase->Find<CommandConfig>("Active");
+		auto config = assetDatabase->Find<ApplicationConfig>("ApplicationConfig-Active");
+		auto commandConfig = assetDatabase->Find<CommandConfig>("CommandConfig-Active");
+		auto rebuildCache = std::find(arguments.begin(), arguments.end(), "--rebuild-cache") != arguments.end();
+		m_services->Create<AssetCache>("cache/", (uint64_t)config->AssetCacheMaxSize * 1024ull * 1024ull, config->EnableAssetCache, rebuildCache);
 
 		auto time = m_services->Create<Time>(sequencer, config->TimeScale);
 		auto input = m_services->Create<Input>(sequencer);
+		auto jobSystem = m_services->Create<JobSystem>(config->JobWorkerCount);
+		assetDatabase->SetJobSystem(jobSystem);
 
 		m_window = CreateScope<Window>(WindowProperties(name, config->InitialWidth, config->InitialHeight, config->EnableVsync, config->EnableCursor));
 		Window::SetConsole(config->EnableConsole);
@@ -55,7 +68,19 @@ namespace PK::Core
 		m_window->OnMouseButtonInput = PK_BIND_MEMBER_FUNCTION(input, OnMouseButtonInput);
 		m_window->OnClose = PK_BIND_FUNCTION(Application::Close);
 		
+		m_services->Create<ShaderVariantManifest>(assetDatabase, "res/shaders/ShaderVariants.yaml", config->StripShaderVariants);
 		assetDatabase->LoadDirectory<Shader>("res/shaders/");
+
+		TextureDescriptor placeholderDescriptor;
+		placeholderDescriptor.resolution = { 1, 1, 1 };
+		auto placeholderTexture = assetDatabase->CreateProcedural<TextureXD>("Placeholder_Texture", placeholderDescriptor);
+		uint placeholderTexel = 0xFFFFFFFF;
+		placeholderTexture->SetData(&placeholderTexel, sizeof(uint), 0);
+
+		assetDatabase->SetStreamingBudget((size_t)config->AssetStreamingBudget * 1024ull * 1024ull);
+		assetDatabase->SetPlaceholder<TextureXD>(placeholderTexture);
+		assetDatabase->SetPlaceholder<Mesh>(assetDatabase->RegisterProcedural<Mesh>("Placeholder_Mesh", MeshUtility::GetBox(PK_FLOAT3_ZERO, PK_FLOAT3_ONE * 0.5f)));
+		assetDatabase->SetPlaceholder<Shader>(assetDatabase->Find<Shader>("SH_WS_Unlit_Color"));
 	
 		auto renderPipeline = m_services->Create<RenderPipeline>(assetDatabase, entityDb, config);
 		auto engineEditorCamera = m_services->Create<ECS::Engines::EngineEditorCamera>(time, config);
@@ -63,16 +88,17 @@ namespace PK::Core
 		auto engineScreenshot = m_services->Create<ECS::Engines::EngineScreenshot>();
 		auto engineDebug = m_services->Create<ECS::Engines::EngineDebug>(assetDatabase, entityDb, config);
 		auto gizmoRenderer = m_services->Create<GizmoRenderer>(sequencer, assetDatabase, config->EnableGizmos);
-		auto engineCommands = m_services->Create<ECS::Engines::EngineCommandInput>(assetDatabase, sequencer, time, entityDb, commandConfig);
+		auto engineCommands = m_services->Create<ECS::Engines::EngineCommandInput>(assetDatabase, sequencer, time, jobSystem, entityDb, commandConfig);
+		auto fileWatcher = m_services->Create<FileWatcher>(assetDatabase, "res/", config->FileWatcherDebounce, config->EnableFileWatcher);
 
 		sequencer->SetSteps(
 		{
 			{
 				sequencer->GetRoot(),
 				{
-					{ (int)UpdateStep::OpenFrame,		{ PK_STEP_S(renderPipeline), time }},
+					{ (int)UpdateStep::OpenFrame,		{ memoryTracker, fileWatcher, assetDatabase, PK_STEP_S(renderPipeline), time }},
 					{ (int)UpdateStep::UpdateInput,		{ input } },
-					{ (int)UpdateStep::UpdateEngines,	{ PK_STEP_S(engineDebug), PK_STEP_S(engineUpdateTransforms) }},
+					{ (int)UpdateStep::UpdateEngines,	{ PK_STEP_S(renderPipeline), PK_STEP_S(engineDebug), PK_STEP_S(engineUpdateTransforms) }},
 					{ (int)UpdateStep::PreRender,		{ PK_STEP_S(renderPipeline) }},
 					{ (int)UpdateStep::Render,			{ PK_STEP_S(renderPipeline), PK_STEP_S(gizmoRenderer), PK_STEP_S(engineScreenshot) }},
 					{ (int)UpdateStep::PostRender,		{ PK_STEP_S(renderPipeline) }},
@@ -105,6 +131,14 @@ namespace PK::Core
 			{ gizmoRenderer, { PK_STEP_T(engineDebug, GizmoRenderer) }}
 		});
 	
+		sequencer->SetJobSystem(jobSystem);
+		sequencer->SetSerialExecution(config->EnableSerialSequencer);
+
+		// Simulation of the next frame overlaps with rendering & is joined before the frame is closed.
+		if (config->EnablePipelinedRendering)
+		{
+			sequencer->SetPipelinedStep((int)UpdateStep::UpdateEngines, (int)UpdateStep::CloseFrame);
+		}
 		sequencer->SetRootSequence(
 		{ 
 			(int)UpdateStep::OpenFrame,
@@ -122,6 +156,11 @@ namespace PK::Core
 		m_window = nullptr;
 		GetService<ECS::Sequencer>()->Release();
 		GetService<AssetDatabase>()->Unload();
+
+		#if defined(PK_ENABLE_PROFILER)
+		GetService<Profiler>()->ExportChromeTrace("ProfilerTrace.json");
+		#endif
+
 		GraphicsAPI::Terminate();
 		m_services->Clear();
 	}
@@ -13,7 +13,7 @@ namespace PK::Core
 	class Application : public NoCopy
 	{
 		public:
-			Application(const std::string& name = "Application");
+			Application(const std::string& name = "Application", const std::vector<std::string>& arguments = {});
 			virtual ~Application();
 			void Close();
 		
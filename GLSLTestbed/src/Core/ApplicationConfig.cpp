@@ -31,10 +31,21 @@ namespace PK::Core
 			&CascadeLinearity,
 			&TimeScale,
 			&RandomSeed,
+			&JobWorkerCount,
+			&EnableSerialSequencer,
+			&EnablePipelinedRendering,
+			&EnableFileWatcher,
+			&FileWatcherDebounce,
+			&EnableAssetCache,
+			&AssetCacheMaxSize,
+			&AssetStreamingBudget,
+			&StripShaderVariants,
 			&ZCullLights,
 			&LightCount,
 			&ShadowmapTileSize,
 			&ShadowmapTileCount,
+			&MeshLodPixelError,
+			&EnableStaticBatching,
 			&CameraFocalLength,
 			&CameraFNumber,
 			&CameraFilmHeight,
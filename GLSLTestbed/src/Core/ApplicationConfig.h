@@ -19,6 +19,15 @@ namespace PK::Core
 		BoxedValue<int>	InitialHeight = BoxedValue<int>("InitialHeight", 512);
 		
 		BoxedValue<uint> RandomSeed = BoxedValue<uint>("RandomSeed", 512);
+		BoxedValue<int> JobWorkerCount = BoxedValue<int>("JobWorkerCount", -1);
+		BoxedValue<bool> EnableSerialSequencer = BoxedValue<bool>("EnableSerialSequencer", false);
+		BoxedValue<bool> EnablePipelinedRendering = BoxedValue<bool>("EnablePipelinedRendering", false);
+		BoxedValue<bool> EnableFileWatcher = BoxedValue<bool>("EnableFileWatcher", true);
+		BoxedValue<float> FileWatcherDebounce = BoxedValue<float>("FileWatcherDebounce", 0.25f);
+		BoxedValue<bool> EnableAssetCache = BoxedValue<bool>("EnableAssetCache", true);
+		BoxedValue<uint> AssetCacheMaxSize = BoxedValue<uint>("AssetCacheMaxSize", 512u);
+		BoxedValue<uint> AssetStreamingBudget = BoxedValue<uint>("AssetStreamingBudget", 256u);
+		BoxedValue<bool> StripShaderVariants = BoxedValue<bool>("StripShaderVariants", false);
 
 		BoxedValue<float3> CameraStartPosition = BoxedValue<float3>("CameraStartPosition", PK_FLOAT3_ZERO);
 		BoxedValue<float3> CameraStartRotation = BoxedValue<float3>("CameraStartRotation", PK_FLOAT3_ZERO);
@@ -37,6 +46,8 @@ namespace PK::Core
 		BoxedValue<uint> LightCount = BoxedValue<uint>("LightCount", 0u);
 		BoxedValue<uint> ShadowmapTileSize = BoxedValue<uint>("ShadowmapTileSize", 512);
 		BoxedValue<uint> ShadowmapTileCount = BoxedValue<uint>("ShadowmapTileCount", 32);
+		BoxedValue<float> MeshLodPixelError = BoxedValue<float>("MeshLodPixelError", 1.0f);
+		BoxedValue<bool> EnableStaticBatching = BoxedValue<bool>("EnableStaticBatching", false);
 	
 		BoxedValue<float> CameraFocalLength	= BoxedValue<float>("CameraFocalLength", 0.05f);
 		BoxedValue<float> CameraFNumber	= BoxedValue<float>("CameraFNumber", 1.40f);
@@ -0,0 +1,389 @@
+#include "PrecompiledHeader.h"
+#include "Core/AssetCache.h"
+#include "Core/AssetDataBase.h"
+#include "Utilities/Log.h"
+#include <filesystem>
+
+namespace PK::Core
+{
+    AssetCacheReader::AssetCacheReader(HANDLE file, HANDLE mapping, const char* view, size_t offset, size_t size) : 
+        m_file(file), 
+        m_mapping(mapping), 
+        m_view(view), 
+        m_payload(view + offset), 
+        m_size(size)
+    {
+    }
+
+    AssetCacheReader::~AssetCacheReader()
+    {
+        UnmapViewOfFile(m_view);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+    }
+
+    std::string AssetCacheReader::ReadString()
+    {
+        size_t count = 0;
+        auto chars = Read<char>(count);
+        return chars != nullptr ? std::string(chars, count) : std::string();
+    }
+
+    void AssetCacheReader::SetRange(size_t offset, size_t size)
+    {
+        m_payload = m_view + offset;
+        m_size = size;
+        m_head = 0;
+        m_isValid = true;
+    }
+
+    const char* AssetCacheReader::ReadBytes(size_t size, size_t alignment)
+    {
+        auto head = (m_head + alignment - 1) & ~(alignment - 1);
+
+        if (!m_isValid || head > m_size || size > m_size - head)
+        {
+            m_isValid = false;
+            return nullptr;
+        }
+
+        m_head = head + size;
+        return m_payload + head;
+    }
+
+    AssetCache::AssetCache(const std::string& directory, uint64_t maxSizeBytes, bool enabled, bool rebuild) : 
+        m_directory(directory), 
+        m_maxSize(maxSizeBytes), 
+        m_enabled(enabled)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::error_code error;
+
+        if (rebuild)
+        {
+            PK_CORE_LOG("Rebuilding asset cache at %s", m_directory.c_str());
+            std::filesystem::remove_all(m_directory, error);
+        }
+
+        std::filesystem::create_directories(m_directory, error);
+        Evict();
+    }
+
+    Scope<AssetCacheReader> AssetCache::Open(const std::string& filepath, uint32_t importerVersion, uint64_t configHash)
+    {
+        if (!m_enabled)
+        {
+            return nullptr;
+        }
+
+        auto blobPath = GetBlobPath(filepath);
+        std::error_code error;
+
+        if (!std::filesystem::exists(blobPath, error))
+        {
+            m_misses.fetch_add(1u, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        // Eviction is least recently used by write time.
+        std::filesystem::last_write_time(blobPath, std::filesystem::file_time_type::clock::now(), error);
+
+        // Shared for delete so that a later store can rename a new blob over this one while it is mapped.
+        auto file = CreateFileA(blobPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            m_misses.fetch_add(1u, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = nullptr;
+        const char* view = nullptr;
+
+        if (GetFileSizeEx(file, &fileSize) && (uint64_t)fileSize.QuadPart >= sizeof(AssetCacheHeader))
+        {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+
+        if (mapping != nullptr)
+        {
+            view = reinterpret_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+
+        if (view == nullptr)
+        {
+            if (mapping != nullptr)
+            {
+                CloseHandle(mapping);
+            }
+
+            CloseHandle(file);
+            m_misses.fetch_add(1u, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto size = (uint64_t)fileSize.QuadPart;
+        auto header = reinterpret_cast<const AssetCacheHeader*>(view);
+        auto isValid = header->magic == AssetCacheHeader::Magic &&
+                       header->formatVersion == AssetCacheHeader::FormatVersion &&
+                       header->importerVersion == importerVersion &&
+                       header->payloadOffset <= size &&
+                       header->payloadSize <= size - header->payloadOffset;
+
+        isValid = isValid && header->payloadOffset >= sizeof(AssetCacheHeader);
+
+        // The reader owns the mapping from here on. Dependencies are stored between the header & the payload.
+        auto reader = CreateScope<AssetCacheReader>(file, mapping, view, sizeof(AssetCacheHeader), isValid ? (size_t)header->payloadOffset - sizeof(AssetCacheHeader) : 0);
+        std::vector<std::string> dependencies;
+
+        for (auto i = 0u; isValid && i < header->dependencyCount; ++i)
+        {
+            dependencies.push_back(reader->ReadString());
+            isValid = reader->IsValid();
+        }
+
+        size_t storedStampCount = 0;
+        auto storedStamps = isValid ? reader->Read<AssetCacheFileStamp>(storedStampCount) : nullptr;
+        std::vector<AssetCacheFileStamp> stamps;
+        isValid = isValid && reader->IsValid() && GetFileStamps(filepath, dependencies, stamps);
+
+        auto isUnchanged = isValid && header->configHash == configHash && storedStampCount == stamps.size() && std::equal(stamps.begin(), stamps.end(), storedStamps);
+
+        // Files that were touched without changing still match by content.
+        if (isValid && !isUnchanged)
+        {
+            uint64_t sourceHash = 0;
+            isValid = GetSourceHash(filepath, dependencies, importerVersion, configHash, sourceHash) && sourceHash == header->sourceHash;
+        }
+
+        if (!isValid)
+        {
+            m_misses.fetch_add(1u, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        for (auto& dependency : dependencies)
+        {
+            AssetDatabase::RecordDependency(dependency);
+        }
+
+        m_hits.fetch_add(1u, std::memory_order_relaxed);
+        reader->SetRange((size_t)header->payloadOffset, (size_t)header->payloadSize);
+        return reader;
+    }
+
+    bool AssetCache::Capture(const std::string& filepath, uint32_t importerVersion, uint64_t configHash, const std::vector<std::string>& dependencies, AssetCacheSource& source) const
+    {
+        source.dependencies = dependencies;
+        source.importerVersion = importerVersion;
+        source.configHash = configHash;
+
+        // Stamped before hashing, a write in between leaves an older stamp that forces a rehash on open.
+        return m_enabled && GetFileStamps(filepath, dependencies, source.stamps) && GetSourceHash(filepath, dependencies, importerVersion, configHash, source.hash);
+    }
+
+    void AssetCache::Store(const std::string& filepath, const AssetCacheSource& source, const AssetCacheWriter& payload)
+    {
+        if (!m_enabled || source.stamps.size() != source.dependencies.size() + 1)
+        {
+            return;
+        }
+
+        AssetCacheHeader header;
+        header.importerVersion = source.importerVersion;
+        header.dependencyCount = (uint32_t)source.dependencies.size();
+        header.configHash = source.configHash;
+        header.sourceHash = source.hash;
+
+        AssetCacheWriter dependencyWriter;
+
+        for (auto& dependency : source.dependencies)
+        {
+            dependencyWriter.WriteString(dependency);
+        }
+
+        dependencyWriter.Write(source.stamps.data(), source.stamps.size());
+
+        auto& dependencyData = dependencyWriter.GetData();
+        auto& payloadData = payload.GetData();
+        header.payloadOffset = (sizeof(AssetCacheHeader) + dependencyData.size() + AssetCacheWriter::ArrayAlignment - 1) & ~(AssetCacheWriter::ArrayAlignment - 1);
+        header.payloadSize = payloadData.size();
+
+        // Written to a temporary file first so that a concurrent or interrupted write never leaves a partial blob in place.
+        auto blobPath = GetBlobPath(filepath);
+        auto tempPath = blobPath + ".tmp";
+
+        {
+            std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+            if (!file)
+            {
+                return;
+            }
+
+            std::vector<char> padding((size_t)header.payloadOffset - sizeof(AssetCacheHeader) - dependencyData.size(), 0);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(AssetCacheHeader));
+            file.write(dependencyData.data(), dependencyData.size());
+            file.write(padding.data(), padding.size());
+            file.write(payloadData.data(), payloadData.size());
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, blobPath, error);
+
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+        }
+    }
+
+    uint64_t AssetCache::Hash(const void* data, size_t size, uint64_t seed)
+    {
+        // FNV-1a over 8 byte words with a final avalanche. Only used for change detection.
+        const uint64_t prime = 0x100000001B3ull;
+        auto hash = seed ^ 0xCBF29CE484222325ull;
+        auto bytes = reinterpret_cast<const unsigned char*>(data);
+        size_t i = 0;
+
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash = (hash ^ word) * prime;
+            hash ^= hash >> 29;
+        }
+
+        for (; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * prime;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    bool AssetCache::HashFile(const std::string& filepath, uint64_t& hash)
+    {
+        std::ifstream file(filepath, std::ios::in | std::ios::binary);
+
+        if (!file)
+        {
+            return false;
+        }
+
+        char buffer[1u << 16u];
+
+        while (file)
+        {
+            file.read(buffer, sizeof(buffer));
+            hash = Hash(buffer, (size_t)file.gcount(), hash);
+        }
+
+        return true;
+    }
+
+    std::string AssetCache::GetBlobPath(const std::string& filepath) const
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.pkc", (unsigned long long)Hash(filepath.data(), filepath.size(), 0ull));
+        return m_directory + name;
+    }
+
+    bool AssetCache::GetSourceHash(const std::string& filepath, const std::vector<std::string>& dependencies, uint32_t importerVersion, uint64_t configHash, uint64_t& hash) const
+    {
+        uint64_t versions[3] = { AssetCacheHeader::FormatVersion, importerVersion, configHash };
+        hash = Hash(versions, sizeof(versions), 0ull);
+
+        if (!HashFile(filepath, hash))
+        {
+            return false;
+        }
+
+        for (auto& dependency : dependencies)
+        {
+            if (!HashFile(dependency, hash))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool AssetCache::GetFileStamps(const std::string& filepath, const std::vector<std::string>& dependencies, std::vector<AssetCacheFileStamp>& stamps)
+    {
+        std::error_code error;
+        stamps.clear();
+        stamps.reserve(dependencies.size() + 1);
+
+        for (auto i = 0u; i <= dependencies.size(); ++i)
+        {
+            auto& path = i == 0 ? filepath : dependencies.at(i - 1);
+            AssetCacheFileStamp stamp;
+            stamp.size = (uint64_t)std::filesystem::file_size(path, error);
+
+            if (error)
+            {
+                return false;
+            }
+
+            stamp.writeTime = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+
+            if (error)
+            {
+                return false;
+            }
+
+            stamps.push_back(stamp);
+        }
+
+        return true;
+    }
+
+    void AssetCache::Evict()
+    {
+        struct BlobInfo
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type time;
+            uint64_t size;
+        };
+
+        std::vector<BlobInfo> blobs;
+        uint64_t totalSize = 0ull;
+        std::error_code error;
+
+        for (const auto& entry : std::filesystem::directory_iterator(m_directory, error))
+        {
+            // Left over temporary files from interrupted writes are always removed.
+            if (entry.path().extension().compare(".tmp") == 0)
+            {
+                std::filesystem::remove(entry.path(), error);
+                continue;
+            }
+
+            if (entry.is_regular_file(error) && entry.path().extension().compare(".pkc") == 0)
+            {
+                blobs.push_back({ entry.path(), entry.last_write_time(error), entry.file_size(error) });
+                totalSize += blobs.back().size;
+            }
+        }
+
+        std::sort(blobs.begin(), blobs.end(), [](const BlobInfo& a, const BlobInfo& b) { return a.time < b.time; });
+
+        for (auto i = 0u; i < blobs.size() && totalSize > m_maxSize; ++i)
+        {
+            if (std::filesystem::remove(blobs.at(i).path, error))
+            {
+                totalSize -= blobs.at(i).size;
+            }
+        }
+    }
+}
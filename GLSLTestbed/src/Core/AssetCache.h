@@ -0,0 +1,163 @@
+#pragma once
+#include "Core/IService.h"
+#include "Core/ISingleton.h"
+#include "Core/NoCopy.h"
+#include "Utilities/Ref.h"
+#include <atomic>
+
+namespace PK::Core
+{
+    using namespace PK::Utilities;
+
+    // Blob layout: header, dependency paths, file stamps of the source & its dependencies, payload. The payload starts at a 16 byte boundary & arrays in it are 16 byte aligned,
+    // so that a mapped blob can be read in place.
+    struct AssetCacheHeader
+    {
+        static constexpr uint32_t Magic = 0x43414B50; // "PKAC"
+        static constexpr uint32_t FormatVersion = 2;
+
+        uint32_t magic = Magic;
+        uint32_t formatVersion = FormatVersion;
+        uint32_t importerVersion = 0;
+        uint32_t dependencyCount = 0;
+        uint64_t sourceHash = 0;
+        uint64_t payloadOffset = 0;
+        uint64_t payloadSize = 0;
+        uint64_t configHash = 0;
+    };
+
+    // Compared before the source hash, the inputs are only read & hashed when a stamp differs.
+    struct AssetCacheFileStamp
+    {
+        uint64_t size = 0;
+        int64_t writeTime = 0;
+
+        inline bool operator==(const AssetCacheFileStamp& other) const { return size == other.size && writeTime == other.writeTime; }
+    };
+
+    // Stamps & hash of an import's inputs, captured before they are decoded.
+    // An edit made while decoding then leaves a blob whose stamps & hash no longer match, instead of one that claims the new contents.
+    struct AssetCacheSource
+    {
+        std::vector<std::string> dependencies;
+        std::vector<AssetCacheFileStamp> stamps;
+        uint32_t importerVersion = 0;
+        uint64_t configHash = 0;
+        uint64_t hash = 0;
+    };
+
+    class AssetCacheWriter
+    {
+        public:
+            static constexpr size_t ArrayAlignment = 16;
+
+            template<typename T>
+            void Write(const T* values, size_t count)
+            {
+                static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be cooked!");
+                WriteValue<uint64_t>(count);
+                Align(ArrayAlignment);
+                auto offset = m_data.size();
+                m_data.resize(offset + sizeof(T) * count);
+                memcpy(m_data.data() + offset, values, sizeof(T) * count);
+            }
+
+            template<typename T>
+            void WriteValue(const T& value)
+            {
+                static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be cooked!");
+                Align(alignof(T));
+                auto offset = m_data.size();
+                m_data.resize(offset + sizeof(T));
+                memcpy(m_data.data() + offset, &value, sizeof(T));
+            }
+
+            inline void WriteString(const std::string& value) { Write(value.data(), value.size()); }
+
+            inline const std::vector<char>& GetData() const { return m_data; }
+
+        private:
+            inline void Align(size_t alignment) { m_data.resize((m_data.size() + alignment - 1) & ~(alignment - 1)); }
+
+            std::vector<char> m_data;
+    };
+
+    // Sequential reader over a read only mapping of a blob. Mirrors AssetCacheWriter.
+    // Reads past the end of the payload return null & invalidate the reader, importers should then fall back to their source files.
+    class AssetCacheReader : public NoCopy
+    {
+        friend class AssetCache;
+
+        public:
+            AssetCacheReader(HANDLE file, HANDLE mapping, const char* view, size_t offset, size_t size);
+            ~AssetCacheReader();
+
+            // Points into the mapped file, valid for the lifetime of the reader.
+            template<typename T>
+            const T* Read(size_t& count)
+            {
+                count = (size_t)ReadValue<uint64_t>();
+                // Guards against overflow on corrupt counts.
+                auto values = count <= m_size / sizeof(T) ? reinterpret_cast<const T*>(ReadBytes(sizeof(T) * count, AssetCacheWriter::ArrayAlignment)) : nullptr;
+                m_isValid &= values != nullptr;
+                count = values != nullptr ? count : 0;
+                return values;
+            }
+
+            // Default value if the payload is exhausted.
+            template<typename T>
+            T ReadValue() 
+            { 
+                auto value = reinterpret_cast<const T*>(ReadBytes(sizeof(T), alignof(T)));
+                return value != nullptr ? *value : T();
+            }
+
+            std::string ReadString();
+
+            inline bool IsValid() const { return m_isValid; }
+
+        private:
+            const char* ReadBytes(size_t size, size_t alignment);
+            void SetRange(size_t offset, size_t size);
+
+            HANDLE m_file;
+            HANDLE m_mapping;
+            const char* m_view;
+            const char* m_payload;
+            size_t m_size;
+            size_t m_head = 0;
+            bool m_isValid = true;
+    };
+
+    // Cooked import results keyed by a hash of the source file, the files it depends on, the importer version & relevant config.
+    // Blobs are stored per source path & overwritten when their source changes. Least recently used blobs are evicted on startup once the cache exceeds its size limit.
+    class AssetCache : public IService, public ISingleton<AssetCache>
+    {
+        public:
+            AssetCache(const std::string& directory, uint64_t maxSizeBytes, bool enabled, bool rebuild);
+
+            // Null on a miss. Records the blob's dependencies for hot reload.
+            Scope<AssetCacheReader> Open(const std::string& filepath, uint32_t importerVersion, uint64_t configHash);
+            // False if an input can't be read, the import shouldn't be stored then.
+            bool Capture(const std::string& filepath, uint32_t importerVersion, uint64_t configHash, const std::vector<std::string>& dependencies, AssetCacheSource& source) const;
+            void Store(const std::string& filepath, const AssetCacheSource& source, const AssetCacheWriter& payload);
+
+            inline uint32_t GetHitCount() const { return m_hits.load(std::memory_order_relaxed); }
+            inline uint32_t GetMissCount() const { return m_misses.load(std::memory_order_relaxed); }
+
+            static uint64_t Hash(const void* data, size_t size, uint64_t seed);
+            static bool HashFile(const std::string& filepath, uint64_t& hash);
+
+        private:
+            std::string GetBlobPath(const std::string& filepath) const;
+            bool GetSourceHash(const std::string& filepath, const std::vector<std::string>& dependencies, uint32_t importerVersion, uint64_t configHash, uint64_t& hash) const;
+            static bool GetFileStamps(const std::string& filepath, const std::vector<std::string>& dependencies, std::vector<AssetCacheFileStamp>& stamps);
+            void Evict();
+
+            std::string m_directory;
+            uint64_t m_maxSize;
+            bool m_enabled;
+            std::atomic<uint32_t> m_hits = 0u;
+            std::atomic<uint32_t> m_misses = 0u;
+    };
+}
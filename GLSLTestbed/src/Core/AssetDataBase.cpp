@@ -0,0 +1,267 @@
+#include "PrecompiledHeader.h"
+#include "Core/AssetDataBase.h"
+#include "Core/UpdateStep.h"
+
+namespace PK::Core
+{
+    void AssetDatabase::Step(int condition)
+    {
+        if ((UpdateStep)condition != UpdateStep::OpenFrame)
+        {
+            return;
+        }
+
+        PK_PROFILE_FUNCTION();
+
+        ++m_streamFrame;
+
+        for (size_t i = 0; i < m_streamInFlight.size();)
+        {
+            auto request = m_streamInFlight.at(i);
+
+            if (!request->isDecoded.load(std::memory_order_acquire))
+            {
+                ++i;
+                continue;
+            }
+
+            m_streamInFlight.erase(m_streamInFlight.begin() + i);
+            CommitStreamRequest(request.get());
+        }
+
+        DispatchStreamRequests();
+        EvictStreamedAssets();
+    }
+
+    void AssetDatabase::DecodeStreamRequest(StreamRequest* request)
+    {
+        // Exceptions can't cross job threads, they are reported when the request is committed.
+        try
+        {
+            DependencyScope scope(&request->dependencies);
+            request->decode(request);
+        }
+        catch (...)
+        {
+            request->error = std::current_exception();
+        }
+
+        request->isDecoded.store(true, std::memory_order_release);
+    }
+
+    void AssetDatabase::CommitStreamRequest(StreamRequest* request)
+    {
+        auto& streamed = m_streamed.at(request->assetId);
+        streamed.request = nullptr;
+
+        // A failed decode leaves the slot empty, handles keep resolving to the placeholder.
+        if (request->error != nullptr)
+        {
+            try
+            {
+                std::rethrow_exception(request->error);
+            }
+            catch (const std::exception& exception)
+            {
+                PK_CORE_LOG_WARNING("Failed to stream asset: %s (%s)", request->filepath.c_str(), exception.what());
+            }
+            catch (...)
+            {
+                PK_CORE_LOG_WARNING("Failed to stream asset: %s", request->filepath.c_str());
+            }
+
+            return;
+        }
+
+        auto slot = streamed.slot;
+        request->commit(this, request);
+        slot->lastUseFrame = m_streamFrame;
+
+        if (!slot->isPinned)
+        {
+            m_streamedSize += slot->size;
+        }
+    }
+
+    void AssetDatabase::DispatchStreamRequests()
+    {
+        // Requests that nobody holds a handle to anymore are dropped before they are decoded.
+        for (size_t i = 0; i < m_streamQueue.size();)
+        {
+            auto& streamed = m_streamed.at(m_streamQueue.at(i)->assetId);
+
+            if (streamed.slot.use_count() > 1)
+            {
+                ++i;
+                continue;
+            }
+
+            auto assetId = streamed.slot->assetId;
+            m_streamQueue.erase(m_streamQueue.begin() + i);
+            m_streamed.erase(assetId);
+        }
+
+        auto maxInFlight = m_jobSystem != nullptr ? std::max(1u, m_jobSystem->GetWorkerCount()) : 1u;
+
+        if (m_streamQueue.empty() || m_streamInFlight.size() >= maxInFlight)
+        {
+            return;
+        }
+
+        std::sort(m_streamQueue.begin(), m_streamQueue.end(), [](const Ref<StreamRequest>& a, const Ref<StreamRequest>& b)
+        {
+            return a->priority != b->priority ? a->priority > b->priority : a->sequence < b->sequence;
+        });
+
+        auto count = std::min(maxInFlight - m_streamInFlight.size(), m_streamQueue.size());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto request = m_streamQueue.at(i);
+            m_streamInFlight.push_back(request);
+
+            // Without workers the request is decoded here & committed on the next frame.
+            if (m_jobSystem != nullptr)
+            {
+                m_jobSystem->Dispatch([request]() { DecodeStreamRequest(request.get()); }, &m_streamCounter);
+            }
+            else
+            {
+                DecodeStreamRequest(request.get());
+            }
+        }
+
+        m_streamQueue.erase(m_streamQueue.begin(), m_streamQueue.begin() + count);
+    }
+
+    void AssetDatabase::EvictStreamedAssets()
+    {
+        std::vector<AssetStreamSlot*> candidates;
+
+        for (auto element = m_streamed.begin(); element != m_streamed.end();)
+        {
+            auto& slot = element->second.slot;
+
+            if (slot->isUsed.exchange(false, std::memory_order_relaxed))
+            {
+                slot->lastUseFrame = m_streamFrame;
+            }
+
+            auto isReferenced = slot.use_count() > 1;
+
+            // Unloaded or cancelled & no longer requested by anyone.
+            if (!isReferenced && slot->asset == nullptr && element->second.request == nullptr)
+            {
+                element = m_streamed.erase(element);
+                continue;
+            }
+
+            if (!isReferenced && slot->asset != nullptr && !slot->isPinned)
+            {
+                candidates.push_back(slot.get());
+            }
+
+            ++element;
+        }
+
+        if (m_streamedSize <= m_streamBudget || candidates.empty())
+        {
+            return;
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const AssetStreamSlot* a, const AssetStreamSlot* b) { return a->lastUseFrame < b->lastUseFrame; });
+
+        for (auto i = 0u; i < candidates.size() && m_streamedSize > m_streamBudget; ++i)
+        {
+            auto assetId = candidates.at(i)->assetId;
+            auto evict = m_streamed.at(assetId).evict;
+            (this->*evict)(assetId);
+        }
+    }
+
+    void AssetDatabase::PinStreamed(AssetID assetId, Asset* asset)
+    {
+        auto streamed = m_streamed.find(assetId);
+
+        if (streamed == m_streamed.end())
+        {
+            return;
+        }
+
+        auto& slot = streamed->second.slot;
+
+        if (slot->asset != nullptr && !slot->isPinned)
+        {
+            m_streamedSize -= slot->size;
+        }
+
+        slot->asset = asset;
+        slot->isPinned = true;
+    }
+
+    void AssetDatabase::ReleaseStreamed(AssetID assetId)
+    {
+        auto streamed = m_streamed.find(assetId);
+
+        if (streamed == m_streamed.end())
+        {
+            return;
+        }
+
+        auto& slot = streamed->second.slot;
+
+        if (slot->asset != nullptr && !slot->isPinned)
+        {
+            m_streamedSize -= slot->size;
+        }
+
+        slot->asset = nullptr;
+        slot->isPinned = false;
+        slot->size = 0;
+
+        // Handles to it resolve to the placeholder until it is requested again.
+        if (slot.use_count() < 2 && streamed->second.request == nullptr)
+        {
+            m_streamed.erase(streamed);
+        }
+    }
+
+    void AssetDatabase::ReleasePlaceholder(std::type_index type)
+    {
+        auto placeholder = m_placeholders.find(type);
+
+        if (placeholder == m_placeholders.end())
+        {
+            return;
+        }
+
+        for (auto& kv : m_streamed)
+        {
+            if (kv.second.slot->placeholder == placeholder->second)
+            {
+                kv.second.slot->placeholder = nullptr;
+            }
+        }
+
+        m_placeholders.erase(placeholder);
+    }
+
+    void AssetDatabase::ClearStreaming()
+    {
+        if (m_jobSystem != nullptr)
+        {
+            m_jobSystem->Wait(&m_streamCounter);
+        }
+
+        for (auto& kv : m_streamed)
+        {
+            kv.second.slot->asset = nullptr;
+            kv.second.slot->placeholder = nullptr;
+        }
+
+        m_streamQueue.clear();
+        m_streamInFlight.clear();
+        m_streamed.clear();
+        m_streamedSize = 0;
+    }
+}
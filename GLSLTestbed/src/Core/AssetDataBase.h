@@ -6,8 +6,12 @@
 #include "Utilities/Log.h"
 #include "Core/ServiceRegister.h"
 #include "Core/NoCopy.h"
+#include "Core/Profiler.h"
+#include "Core/JobSystem.h"
+#include "Core/MemoryTracker.h"
 #include "ECS/Sequencer.h"
 #include <filesystem>
+#include <atomic>
 
 namespace PK::Core
 {
@@ -52,9 +56,69 @@ namespace PK::Core
 
         template<typename T>
         void Import(const std::string& filepath, Ref<T>& asset);
+
+        // Intermediate produced by the decode phase of an import. Types that specialize this split their import into
+        // a thread safe Decode that does file io & parsing and a main thread Commit that creates the graphics objects.
+        // Other types are imported entirely on the main thread.
+        // Specializations also provide GetSize, an estimate of the memory the committed asset occupies.
+        template<typename T>
+        struct ImportData
+        {
+            static constexpr bool IsDecodable = false;
+        };
+
+        template<typename T>
+        void Decode(const std::string& filepath, ImportData<T>& data);
+
+        template<typename T>
+        void Commit(ImportData<T>& data, Ref<T>& asset);
+    };
+
+    // Shared by the handles of a streamed asset & the database.
+    struct AssetStreamSlot : public NoCopy
+    {
+        AssetID assetId = 0;
+        // Set on the main thread when the asset is committed & cleared when it is evicted or unloaded.
+        Asset* asset = nullptr;
+        Asset* placeholder = nullptr;
+        size_t size = 0;
+        uint64_t lastUseFrame = 0;
+        std::atomic<bool> isUsed = false;
+        // Also loaded synchronously. Raw pointers to it may exist, so it is never evicted.
+        bool isPinned = false;
+    };
+
+    // Resolves to the placeholder of its type until the asset is resident. Never blocks.
+    // Can also wrap an asset that isn't streamed (procedural), in which case it is always resident.
+    template<typename T>
+    class AssetHandle
+    {
+        public:
+            AssetHandle() = default;
+            AssetHandle(T* asset) : m_asset(asset) {}
+            AssetHandle(const Ref<AssetStreamSlot>& slot) : m_slot(slot) {}
+
+            inline bool IsValid() const { return m_slot != nullptr || m_asset != nullptr; }
+            inline bool IsResident() const { return m_slot != nullptr ? m_slot->asset != nullptr : m_asset != nullptr; }
+
+            // Marks the asset as used this frame, unused assets are evicted first.
+            T* Get() const
+            {
+                if (m_slot == nullptr)
+                {
+                    return m_asset;
+                }
+
+                m_slot->isUsed.store(true, std::memory_order_relaxed);
+                return static_cast<T*>(m_slot->asset != nullptr ? m_slot->asset : m_slot->placeholder);
+            }
+
+        private:
+            Ref<AssetStreamSlot> m_slot = nullptr;
+            T* m_asset = nullptr;
     };
     
-    class AssetDatabase : public IService
+    class AssetDatabase : public IService, public ECS::ISimpleStep
     {
         private:
             template<typename T>
@@ -62,19 +126,30 @@ namespace PK::Core
             {
                 static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
                 PK_CORE_ASSERT(std::filesystem::exists(filepath), "Asset not found at path: %s", filepath.c_str());
+                RecordDependency(assetId);
     
                 auto& collection = m_assets[std::type_index(typeid(T))];
     
                 if (collection.count(assetId) > 0)
                 {
-                    return std::static_pointer_cast<T>(collection.at(assetId)).get();
+                    auto asset = collection.at(assetId).get();
+                    PinStreamed(assetId, asset);
+                    return static_cast<T*>(asset);
                 }
     
-                auto asset = CreateRef<T>();
-                collection[assetId] = asset;
-                std::static_pointer_cast<Asset>(asset)->m_assetId = assetId;
-    
-                AssetImporters::Import<T>(filepath, asset);
+                PK_PROFILE_FUNCTION();
+
+                auto asset = CreateAsset<T>(assetId);
+                std::vector<AssetID> dependencies;
+
+                {
+                    DependencyScope scope(&dependencies);
+                    MemoryScope memoryScope(typeid(T).name(), assetId);
+                    AssetImporters::Import<T>(filepath, asset);
+                }
+
+                SetDependencies<T>(assetId, dependencies);
+                PinStreamed(assetId, asset.get());
     
                 AssetImportToken<T> importToken = { this, asset.get() };
                 m_sequencer->Next(this, &importToken, (int)AssetImportType::IMPORT);
@@ -86,7 +161,10 @@ namespace PK::Core
             T* Reload(const std::string& filepath, AssetID assetId)
             {
                 static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
+                PK_PROFILE_FUNCTION();
+
                 PK_CORE_ASSERT(std::filesystem::exists(filepath), "Asset not found at path: %s", filepath.c_str());
+                RecordDependency(assetId);
                 
                 auto& collection = m_assets[std::type_index(typeid(T))];
                 Ref<T> asset = nullptr;
@@ -97,12 +175,18 @@ namespace PK::Core
                 }
                 else
                 {
-                    auto asset = CreateRef<T>();
-                    collection[assetId] = asset;
-                    std::static_pointer_cast<Asset>(asset)->m_assetId = assetId;
+                    asset = CreateAsset<T>(assetId);
                 }
-    
-                AssetImporters::Import<T>(filepath, asset);
+
+                std::vector<AssetID> dependencies;
+
+                {
+                    DependencyScope scope(&dependencies);
+                    MemoryScope memoryScope(typeid(T).name(), assetId);
+                    AssetImporters::Import<T>(filepath, asset);
+                }
+
+                SetDependencies<T>(assetId, dependencies);
     
                 AssetImportToken<T> importToken = { this, asset.get() };
                 m_sequencer->Next(this, &importToken, (int)AssetImportType::RELOAD);
@@ -113,6 +197,97 @@ namespace PK::Core
         public:
             AssetDatabase(ECS::Sequencer* sequencer) : m_sequencer(sequencer) {}
 
+            // Directory loads decode on the job system once it is available. Until then decoding happens on the calling thread.
+            inline void SetJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+            // Memory that resident streamed assets may occupy before unreferenced ones are evicted.
+            inline void SetStreamingBudget(size_t bytes) { m_streamBudget = bytes; }
+
+            // Estimated size of the resident streamed assets. Assets that are also loaded synchronously are not counted.
+            inline size_t GetStreamedSize() const { return m_streamedSize; }
+
+            // Streamed assets of the type resolve to this until they are resident.
+            template<typename T>
+            void SetPlaceholder(T* asset) 
+            { 
+                static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
+                m_placeholders[std::type_index(typeid(T))] = asset; 
+            }
+
+            // Queues the asset to be decoded in the background & committed at the start of a later frame. Higher priorities are decoded first.
+            // Requesting an asset that is still pending raises its priority. Evicted assets are requested again.
+            template<typename T>
+            AssetHandle<T> RequestLoad(const std::string& filepath, int priority = 0)
+            {
+                static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
+                static_assert(AssetImporters::ImportData<T>::IsDecodable, "Only assets with a decode phase can be streamed!");
+                PK_CORE_ASSERT(std::filesystem::exists(filepath), "Asset not found at path: %s", filepath.c_str());
+
+                auto type = std::type_index(typeid(T));
+                auto assetId = StringHashID::StringToID(filepath);
+                auto& streamed = m_streamed[assetId];
+
+                if (streamed.slot == nullptr)
+                {
+                    auto placeholder = m_placeholders.find(type);
+                    streamed.slot = CreateRef<AssetStreamSlot>();
+                    streamed.slot->assetId = assetId;
+                    streamed.slot->placeholder = placeholder != m_placeholders.end() ? placeholder->second : nullptr;
+                    streamed.evict = &AssetDatabase::EvictAsset<T>;
+                }
+
+                auto handle = AssetHandle<T>(streamed.slot);
+
+                if (streamed.slot->asset != nullptr)
+                {
+                    return handle;
+                }
+
+                if (streamed.request != nullptr)
+                {
+                    streamed.request->priority = std::max(streamed.request->priority, priority);
+                    return handle;
+                }
+
+                auto& collection = m_assets[type];
+
+                if (collection.count(assetId) > 0)
+                {
+                    PinStreamed(assetId, collection.at(assetId).get());
+                    return handle;
+                }
+
+                auto data = CreateRef<AssetImporters::ImportData<T>>();
+                auto request = CreateRef<StreamRequest>();
+                request->assetId = assetId;
+                request->filepath = filepath;
+                request->priority = priority;
+                request->sequence = m_streamSequence++;
+                request->decode = [data](StreamRequest* request) { AssetImporters::Decode<T>(request->filepath, *data); };
+                request->commit = [data](AssetDatabase* database, StreamRequest* request)
+                {
+                    auto& slot = database->m_streamed.at(request->assetId).slot;
+                    auto& collection = database->m_assets[std::type_index(typeid(T))];
+
+                    // Loaded synchronously while the request was pending.
+                    if (collection.count(request->assetId) > 0)
+                    {
+                        database->PinStreamed(request->assetId, collection.at(request->assetId).get());
+                        return;
+                    }
+
+                    slot->size = data->GetSize();
+                    slot->asset = database->CommitImport<T>(request->assetId, *data, request->dependencies, AssetImportType::IMPORT).get();
+                };
+
+                streamed.request = request;
+                m_streamQueue.push_back(request);
+                return handle;
+            }
+
+            // Commits decoded stream requests, dispatches pending ones in priority order & evicts while over budget.
+            void Step(int condition) override;
+
             template<typename T, typename ... Args>
             T* CreateProcedural(std::string name, Args&& ... args)
             {
@@ -125,6 +300,7 @@ namespace PK::Core
                 auto asset = CreateRef<T>(std::forward<Args>(args)...);
                 collection[assetId] = asset;
                 std::static_pointer_cast<Asset>(asset)->m_assetId = assetId;
+                AddNameIndex<T>(assetId);
     
                 return asset.get();
             }
@@ -141,12 +317,51 @@ namespace PK::Core
     
                 collection[assetId] = asset;
                 std::static_pointer_cast<Asset>(asset)->m_assetId = assetId;
+                AddNameIndex<T>(assetId);
     
                 return asset.get();
             }
     
+            // Exact match against the file name without directory & extension.
             template<typename T>
             T* Find(const char* name) const
+            {
+                auto asset = TryFind<T>(name);
+
+                if (asset == nullptr)
+                {
+                    PK_CORE_ERROR("Could not find asset with name %s", name);
+                }
+
+                return asset;
+            }
+
+            template<typename T>
+            T* TryFind(const char* name) const
+            {
+                static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
+
+                auto type = std::type_index(typeid(T));
+                auto names = m_names.find(type);
+
+                if (names == m_names.end())
+                {
+                    return nullptr;
+                }
+
+                auto element = names->second.find(name);
+
+                if (element == names->second.end())
+                {
+                    return nullptr;
+                }
+
+                return std::static_pointer_cast<T>(m_assets.at(type).at(element->second)).get();
+            }
+
+            // Linear search for the first asset whose file name contains the given string.
+            template<typename T>
+            T* FindContaining(const char* name) const
             {
                 static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
 
@@ -171,7 +386,7 @@ namespace PK::Core
             }
 
             template<typename T>
-            T* TryFind(const char* name) const
+            T* TryFindContaining(const char* name) const
             {
                 static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
 
@@ -224,15 +439,25 @@ namespace PK::Core
                     return;
                 }
     
+                std::vector<std::string> filepaths;
+                auto& collection = m_assets[std::type_index(typeid(T))];
+
                 for (const auto& entry : std::filesystem::directory_iterator(directory))
                 {
                     auto& path = entry.path();
     
                     if (path.has_extension() && AssetImporters::IsValidExtension<T>(path.extension()))
                     {
-                        Load<T>(entry.path().string());
+                        auto filepath = entry.path().string();
+
+                        if (collection.count(StringHashID::StringToID(filepath)) < 1)
+                        {
+                            filepaths.push_back(filepath);
+                        }
                     }
                 }
+
+                ImportBatch<T>(filepaths, AssetImportType::IMPORT);
             }
     
             template<typename T>
@@ -245,15 +470,19 @@ namespace PK::Core
                     return;
                 }
     
+                std::vector<std::string> filepaths;
+
                 for (const auto& entry : std::filesystem::directory_iterator(directory))
                 {
                     auto& path = entry.path();
     
                     if (path.has_extension() && AssetImporters::IsValidExtension<T>(path.extension()))
                     {
-                        Reload<T>(entry.path().string());
+                        filepaths.push_back(entry.path().string());
                     }
                 }
+
+                ImportBatch<T>(filepaths, AssetImportType::RELOAD);
             }
     
             template<typename T>
@@ -281,8 +510,19 @@ namespace PK::Core
             void Unload(AssetID assetId)
             {
                 static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
-                auto& collection = m_assets[std::type_index(typeid(T))];
+                auto type = std::type_index(typeid(T));
+                auto& collection = m_assets[type];
+                auto placeholder = m_placeholders.find(type);
+
+                if (placeholder != m_placeholders.end() && placeholder->second->GetAssetID() == assetId)
+                {
+                    ReleasePlaceholder(type);
+                }
+
+                ReleaseStreamed(assetId);
                 collection.erase(assetId);
+                RemoveNameIndex<T>(assetId);
+                RemoveDependencies(assetId);
             }
     
             template<typename T>
@@ -296,10 +536,161 @@ namespace PK::Core
             inline void Unload() 
             {
                 static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
-                m_assets.erase(std::type_index(typeid(T))); 
+                auto type = std::type_index(typeid(T));
+
+                for (auto& kv : m_assets[type])
+                {
+                    ReleaseStreamed(kv.first);
+                    RemoveDependencies(kv.first);
+                }
+
+                ReleasePlaceholder(type);
+
+                m_assets.erase(type); 
+                m_names.erase(type); 
             }
     
-            inline void Unload() { m_assets.clear();  };
+            inline void Unload() 
+            { 
+                ClearStreaming();
+                m_placeholders.clear();
+                m_assets.clear(); 
+                m_names.clear(); 
+                m_dependencies.clear(); 
+                m_dependents.clear(); 
+                m_reloaders.clear(); 
+            };
+
+            // Importers report the files they read besides the asset file itself (shader includes).
+            // Assets loaded during an import are recorded automatically. Safe to call from decode jobs.
+            inline static void RecordDependency(const std::string& filepath) { RecordDependency(StringHashID::StringToID(filepath)); }
+
+            // Files that loaded assets were imported from.
+            void GetDependencyFiles(std::vector<std::string>& filepaths) const
+            {
+                for (auto& kv : m_reloaders)
+                {
+                    filepaths.push_back(StringHashID::IDToString(kv.first));
+                }
+
+                for (auto& kv : m_dependents)
+                {
+                    if (m_reloaders.count(kv.first) < 1)
+                    {
+                        filepaths.push_back(StringHashID::IDToString(kv.first));
+                    }
+                }
+            }
+
+            // Reloads the assets imported from the given files & everything that depends on them.
+            // Assets are reloaded once, in topological order over the affected assets so that dependencies are reloaded before their dependents.
+            void ReloadChangedFiles(const std::vector<std::string>& filepaths)
+            {
+                std::vector<AssetID> affected;
+                std::unordered_set<AssetID> visited;
+
+                for (auto& filepath : filepaths)
+                {
+                    auto fileId = StringHashID::StringToID(filepath);
+
+                    if (visited.insert(fileId).second)
+                    {
+                        affected.push_back(fileId);
+                    }
+                }
+
+                for (size_t i = 0; i < affected.size(); ++i)
+                {
+                    auto dependents = m_dependents.find(affected.at(i));
+
+                    if (dependents == m_dependents.end())
+                    {
+                        continue;
+                    }
+
+                    for (auto dependent : dependents->second)
+                    {
+                        if (visited.insert(dependent).second)
+                        {
+                            affected.push_back(dependent);
+                        }
+                    }
+                }
+
+                // Kahn's algorithm restricted to the affected set, dependencies outside of it are already up to date.
+                std::unordered_map<AssetID, uint32_t> remaining;
+                std::vector<AssetID> order;
+
+                for (auto assetId : affected)
+                {
+                    auto& count = remaining[assetId];
+                    auto dependencies = m_dependencies.find(assetId);
+
+                    if (dependencies == m_dependencies.end())
+                    {
+                        continue;
+                    }
+
+                    std::unordered_set<AssetID> counted;
+
+                    for (auto dependency : dependencies->second)
+                    {
+                        if (dependency != assetId && visited.count(dependency) > 0 && counted.insert(dependency).second)
+                        {
+                            ++count;
+                        }
+                    }
+                }
+
+                for (auto assetId : affected)
+                {
+                    if (remaining.at(assetId) == 0)
+                    {
+                        order.push_back(assetId);
+                    }
+                }
+
+                for (size_t i = 0; i < order.size(); ++i)
+                {
+                    auto dependents = m_dependents.find(order.at(i));
+
+                    if (dependents == m_dependents.end())
+                    {
+                        continue;
+                    }
+
+                    for (auto dependent : dependents->second)
+                    {
+                        auto count = remaining.find(dependent);
+
+                        if (count != remaining.end() && count->second > 0 && --count->second == 0)
+                        {
+                            order.push_back(dependent);
+                        }
+                    }
+                }
+
+                // Assets in a dependency cycle are reloaded last, in discovery order.
+                for (auto assetId : affected)
+                {
+                    if (remaining.at(assetId) > 0)
+                    {
+                        order.push_back(assetId);
+                    }
+                }
+
+                for (auto assetId : order)
+                {
+                    auto reloader = m_reloaders.find(assetId);
+
+                    // Not an asset (include file) or unloaded since.
+                    if (reloader != m_reloaders.end())
+                    {
+                        auto reload = reloader->second;
+                        (this->*reload)(assetId);
+                    }
+                }
+            }
     
             template<typename T>
             void ListAssetsOfType()
@@ -317,6 +708,24 @@ namespace PK::Core
                 }
             }
 
+            template<typename T>
+            void GetAssetsOfType(std::vector<T*>& assets) const
+            {
+                static_assert(std::is_base_of<Asset, T>::value, "Template argument type does not derive from Asset!");
+
+                auto collection = m_assets.find(std::type_index(typeid(T)));
+
+                if (collection == m_assets.end())
+                {
+                    return;
+                }
+
+                for (auto& kv : collection->second)
+                {
+                    assets.push_back(std::static_pointer_cast<T>(kv.second).get());
+                }
+            }
+
             void ListAssets()
             {
                 for (auto& typecollection : m_assets)
@@ -331,7 +740,260 @@ namespace PK::Core
             }
 
         private:
+            typedef void (AssetDatabase::*AssetReloadFunction)(AssetID assetId);
+            typedef void (AssetDatabase::*AssetEvictFunction)(AssetID assetId);
+
+            struct StreamRequest
+            {
+                AssetID assetId = 0;
+                std::string filepath;
+                int priority = 0;
+                uint64_t sequence = 0;
+                std::vector<AssetID> dependencies;
+                std::exception_ptr error = nullptr;
+                std::atomic<bool> isDecoded = false;
+                // Decode runs on a job thread, commit on the main thread.
+                std::function<void(StreamRequest* request)> decode;
+                std::function<void(AssetDatabase* database, StreamRequest* request)> commit;
+            };
+
+            struct StreamedAsset
+            {
+                // Referenced only by the database once all handles are gone.
+                Ref<AssetStreamSlot> slot = nullptr;
+                // Queued or decoding.
+                Ref<StreamRequest> request = nullptr;
+                AssetEvictFunction evict = nullptr;
+            };
+
+            // Redirects the files recorded on the current thread for the duration of an import.
+            struct DependencyScope
+            {
+                DependencyScope(std::vector<AssetID>* dependencies) : previous(s_dependencies) { s_dependencies = dependencies; }
+                ~DependencyScope() { s_dependencies = previous; }
+                std::vector<AssetID>* previous;
+            };
+
+            inline static void RecordDependency(AssetID fileId)
+            {
+                if (s_dependencies != nullptr && std::find(s_dependencies->begin(), s_dependencies->end(), fileId) == s_dependencies->end())
+                {
+                    s_dependencies->push_back(fileId);
+                }
+            }
+
+            template<typename T>
+            void ReloadAsset(AssetID assetId) { Reload<T>(assetId); }
+
+            template<typename T>
+            void EvictAsset(AssetID assetId) { Unload<T>(assetId); }
+
+            static void DecodeStreamRequest(StreamRequest* request);
+            void CommitStreamRequest(StreamRequest* request);
+            void DispatchStreamRequests();
+            void EvictStreamedAssets();
+            void PinStreamed(AssetID assetId, Asset* asset);
+            void ReleaseStreamed(AssetID assetId);
+            // Handles that outlive the placeholder of their type resolve to null instead of the released asset.
+            void ReleasePlaceholder(std::type_index type);
+            void ClearStreaming();
+
+            template<typename T>
+            void SetDependencies(AssetID assetId, const std::vector<AssetID>& dependencies)
+            {
+                RemoveDependencies(assetId);
+
+                for (auto dependency : dependencies)
+                {
+                    if (dependency != assetId)
+                    {
+                        m_dependents[dependency].insert(assetId);
+                    }
+                }
+
+                m_dependencies[assetId] = dependencies;
+                m_reloaders[assetId] = &AssetDatabase::ReloadAsset<T>;
+            }
+
+            void RemoveDependencies(AssetID assetId)
+            {
+                m_reloaders.erase(assetId);
+
+                auto element = m_dependencies.find(assetId);
+
+                if (element == m_dependencies.end())
+                {
+                    return;
+                }
+
+                for (auto dependency : element->second)
+                {
+                    auto dependents = m_dependents.find(dependency);
+
+                    if (dependents != m_dependents.end())
+                    {
+                        dependents->second.erase(assetId);
+
+                        if (dependents->second.empty())
+                        {
+                            m_dependents.erase(dependents);
+                        }
+                    }
+                }
+
+                m_dependencies.erase(element);
+            }
+
+            template<typename T>
+            Ref<T> CreateAsset(AssetID assetId)
+            {
+                auto asset = CreateRef<T>();
+                m_assets[std::type_index(typeid(T))][assetId] = asset;
+                std::static_pointer_cast<Asset>(asset)->m_assetId = assetId;
+                AddNameIndex<T>(assetId);
+                return asset;
+            }
+
+            // Decodes all files in parallel, then commits them on the calling thread in order.
+            template<typename T>
+            void ImportBatch(const std::vector<std::string>& filepaths, AssetImportType importType)
+            {
+                if constexpr (!AssetImporters::ImportData<T>::IsDecodable)
+                {
+                    for (auto& filepath : filepaths)
+                    {
+                        if (importType == AssetImportType::IMPORT)
+                        {
+                            Load<T>(filepath);
+                        }
+                        else
+                        {
+                            Reload<T>(filepath);
+                        }
+                    }
+                }
+                else
+                {
+                    PK_PROFILE_FUNCTION();
+
+                    auto count = (uint32_t)filepaths.size();
+                    std::vector<AssetImporters::ImportData<T>> data(count);
+                    std::vector<std::vector<AssetID>> dependencies(count);
+                    std::vector<std::exception_ptr> errors(count);
+
+                    auto decode = [&](uint32_t begin, uint32_t end)
+                    {
+                        for (auto i = begin; i < end; ++i)
+                        {
+                            // Exceptions can't cross job threads, rethrow them from the calling thread.
+                            try
+                            {
+                                DependencyScope scope(&dependencies.at(i));
+                                AssetImporters::Decode<T>(filepaths.at(i), data.at(i));
+                            }
+                            catch (...)
+                            {
+                                errors.at(i) = std::current_exception();
+                            }
+                        }
+                    };
+
+                    if (m_jobSystem != nullptr)
+                    {
+                        m_jobSystem->ParallelFor(count, 1u, decode);
+                    }
+                    else
+                    {
+                        decode(0u, count);
+                    }
+
+                    for (auto i = 0u; i < count; ++i)
+                    {
+                        if (errors.at(i) != nullptr)
+                        {
+                            std::rethrow_exception(errors.at(i));
+                        }
+
+                        auto assetId = StringHashID::StringToID(filepaths.at(i));
+                        auto asset = CommitImport<T>(assetId, data.at(i), dependencies.at(i), importType);
+                        PinStreamed(assetId, asset.get());
+                    }
+                }
+            }
+
+            // Main thread half of a split import. Dependencies recorded during the decode are extended with those of the commit.
+            template<typename T>
+            Ref<T> CommitImport(AssetID assetId, AssetImporters::ImportData<T>& data, std::vector<AssetID>& dependencies, AssetImportType importType)
+            {
+                auto& collection = m_assets[std::type_index(typeid(T))];
+                auto asset = collection.count(assetId) > 0 ? std::static_pointer_cast<T>(collection.at(assetId)) : CreateAsset<T>(assetId);
+
+                {
+                    DependencyScope scope(&dependencies);
+                    MemoryScope memoryScope(typeid(T).name(), assetId);
+                    AssetImporters::Commit<T>(data, asset);
+                }
+
+                SetDependencies<T>(assetId, dependencies);
+
+                AssetImportToken<T> importToken = { this, asset.get() };
+                m_sequencer->Next(this, &importToken, (int)importType);
+                return asset;
+            }
+
+            template<typename T>
+            void AddNameIndex(AssetID assetId)
+            {
+                // On name collisions the first asset keeps the entry.
+                auto& names = m_names[std::type_index(typeid(T))];
+                names.emplace(Utilities::String::ReadFileName(StringHashID::IDToString(assetId)), assetId);
+            }
+
+            template<typename T>
+            void RemoveNameIndex(AssetID assetId)
+            {
+                auto type = std::type_index(typeid(T));
+                auto& names = m_names[type];
+                auto name = Utilities::String::ReadFileName(StringHashID::IDToString(assetId));
+                auto element = names.find(name);
+
+                if (element == names.end() || element->second != assetId)
+                {
+                    return;
+                }
+
+                names.erase(element);
+
+                // Fall back to another asset with the same name if there is one.
+                for (auto& kv : m_assets[type])
+                {
+                    if (Utilities::String::ReadFileName(StringHashID::IDToString(kv.first)) == name)
+                    {
+                        names.emplace(name, kv.first);
+                        break;
+                    }
+                }
+            }
+
             std::unordered_map<std::type_index, std::unordered_map<AssetID, Ref<Asset>>> m_assets;
+            std::unordered_map<std::type_index, std::unordered_map<std::string, AssetID>> m_names;
             ECS::Sequencer* m_sequencer;
+            JobSystem* m_jobSystem = nullptr;
+
+            // Asset -> files it was imported from & file -> assets imported from it.
+            std::unordered_map<AssetID, std::vector<AssetID>> m_dependencies;
+            std::unordered_map<AssetID, std::unordered_set<AssetID>> m_dependents;
+            std::unordered_map<AssetID, AssetReloadFunction> m_reloaders;
+            inline static thread_local std::vector<AssetID>* s_dependencies = nullptr;
+
+            std::unordered_map<std::type_index, Asset*> m_placeholders;
+            std::unordered_map<AssetID, StreamedAsset> m_streamed;
+            std::vector<Ref<StreamRequest>> m_streamQueue;
+            std::vector<Ref<StreamRequest>> m_streamInFlight;
+            JobCounter m_streamCounter;
+            uint64_t m_streamSequence = 0;
+            uint64_t m_streamFrame = 0;
+            size_t m_streamBudget = std::numeric_limits<size_t>::max();
+            size_t m_streamedSize = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "PrecompiledHeader.h"
+#include "Core/FileWatcher.h"
+#include "Core/UpdateStep.h"
+#include "Utilities/Log.h"
+
+namespace PK::Core
+{
+    FileWatcher::FileWatcher(AssetDatabase* assetDatabase, const std::string& directory, float debounceSeconds, bool enabled) : 
+        m_assetDatabase(assetDatabase), 
+        m_debounce(debounceSeconds), 
+        m_enabled(enabled)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        m_notification = FindFirstChangeNotificationA(directory.c_str(), TRUE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+
+        if (m_notification == INVALID_HANDLE_VALUE)
+        {
+            PK_CORE_LOG_WARNING("Could not watch directory %s, polling for changes instead.", directory.c_str());
+        }
+
+        // Baseline for the files loaded so far.
+        ScanFiles(std::chrono::steady_clock::now());
+        m_pending.clear();
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        if (m_notification != INVALID_HANDLE_VALUE)
+        {
+            FindCloseChangeNotification(m_notification);
+        }
+    }
+
+    void FileWatcher::Step(int condition)
+    {
+        if (!m_enabled || (UpdateStep)condition != UpdateStep::OpenFrame)
+        {
+            return;
+        }
+
+        PK_PROFILE_FUNCTION();
+
+        auto now = std::chrono::steady_clock::now();
+        auto scan = false;
+
+        if (m_notification != INVALID_HANDLE_VALUE)
+        {
+            if (WaitForSingleObject(m_notification, 0) == WAIT_OBJECT_0)
+            {
+                scan = true;
+                FindNextChangeNotification(m_notification);
+            }
+        }
+        else if (now >= m_nextPoll)
+        {
+            scan = true;
+            m_nextPoll = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(PollInterval));
+        }
+
+        // Keep scanning while there are pending changes, in case a file is still being written.
+        if (scan || !m_pending.empty())
+        {
+            ScanFiles(now);
+        }
+
+        std::vector<std::string> changed;
+
+        for (auto iter = m_pending.begin(); iter != m_pending.end();)
+        {
+            if (now - iter->second >= m_debounce)
+            {
+                changed.push_back(iter->first);
+                iter = m_pending.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+
+        if (changed.empty())
+        {
+            return;
+        }
+
+        for (auto& filepath : changed)
+        {
+            PK_CORE_LOG("Reloading changed file: %s", filepath.c_str());
+        }
+
+        m_assetDatabase->ReloadChangedFiles(changed);
+
+        // Reloads might have introduced new dependencies (includes).
+        ScanFiles(now);
+    }
+
+    void FileWatcher::ScanFiles(const TimePoint& now)
+    {
+        m_files.clear();
+        m_assetDatabase->GetDependencyFiles(m_files);
+
+        for (auto& filepath : m_files)
+        {
+            std::error_code error;
+            auto timestamp = std::filesystem::last_write_time(filepath, error);
+
+            // Files might be briefly missing while an editor replaces them.
+            if (error)
+            {
+                continue;
+            }
+
+            auto element = m_timestamps.find(filepath);
+
+            if (element == m_timestamps.end())
+            {
+                m_timestamps.emplace(filepath, timestamp);
+                continue;
+            }
+
+            if (element->second != timestamp)
+            {
+                element->second = timestamp;
+                m_pending[filepath] = now;
+            }
+        }
+    }
+}
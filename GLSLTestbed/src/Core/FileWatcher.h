@@ -0,0 +1,36 @@
+#pragma once
+#include "Core/IService.h"
+#include "Core/AssetDataBase.h"
+#include "ECS/Sequencer.h"
+#include <chrono>
+
+namespace PK::Core
+{
+    // Reloads assets when the files they were imported from change.
+    // Waits on a directory change notification & falls back to polling if one can't be created.
+    // Changes are debounced so that a file is reloaded once it hasn't been written to for a while & all changes in a frame are reloaded together.
+    class FileWatcher : public IService, public ECS::ISimpleStep
+    {
+        typedef std::chrono::steady_clock::time_point TimePoint;
+
+        public:
+            FileWatcher(AssetDatabase* assetDatabase, const std::string& directory, float debounceSeconds, bool enabled);
+            ~FileWatcher();
+
+            void Step(int condition) override;
+
+        private:
+            void ScanFiles(const TimePoint& now);
+
+            static constexpr float PollInterval = 1.0f;
+
+            AssetDatabase* m_assetDatabase = nullptr;
+            HANDLE m_notification = INVALID_HANDLE_VALUE;
+            std::chrono::duration<float> m_debounce;
+            TimePoint m_nextPoll;
+            std::unordered_map<std::string, std::filesystem::file_time_type> m_timestamps;
+            std::unordered_map<std::string, TimePoint> m_pending;
+            std::vector<std::string> m_files;
+            bool m_enabled = true;
+    };
+}
@@ -16,7 +16,7 @@ namespace PK::Core
 
                 s_Instance = static_cast<T*>(this); 
             }
-            virtual ~ISingleton() = default;
+            virtual ~ISingleton() { s_Instance = nullptr; }
             inline static T* Get() { return s_Instance; }
     
         private: inline static T* s_Instance = nullptr;
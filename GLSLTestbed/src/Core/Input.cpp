@@ -8,6 +8,7 @@ namespace PK::Core
 {
 	Input::Input(PK::ECS::Sequencer* sequencer) : m_sequencer(sequencer)
 	{
+		m_stepHandle = sequencer->GetHandle<Input>(this, 0);
 	}
 	
 	void Input::OnKeyInput(int key, int scancode, int action, int mods)
@@ -106,7 +107,7 @@ namespace PK::Core
 				m_mouseScroll = m_mouseScrollRaw;
 				m_mouseScrollRaw = { 0, 0 };
 
-				m_sequencer->Next(this, this, 0);
+				m_sequencer->Next(m_stepHandle, this);
 			}
 			break;
 		}
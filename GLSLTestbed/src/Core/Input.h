@@ -182,6 +182,7 @@ namespace PK::Core
     
     	private:
             PK::ECS::Sequencer* m_sequencer;
+            PK::ECS::StepHandle m_stepHandle = nullptr;
             
     		std::unordered_map<KeyCode, InputState> m_inputStateCurrent;
     		std::unordered_map<KeyCode, InputState> m_inputStatePrevious;
@@ -0,0 +1,259 @@
+#include "PrecompiledHeader.h"
+#include "Core/JobSystem.h"
+
+namespace PK::Core
+{
+    static thread_local uint32_t s_threadIndex = 0u;
+    static thread_local const JobSystem* s_threadOwner = nullptr;
+
+    void JobQueue::Push(Job&& job)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_jobs.push_back(std::move(job));
+    }
+
+    bool JobQueue::Pop(Job& job)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        if (m_jobs.empty())
+        {
+            return false;
+        }
+
+        job = std::move(m_jobs.back());
+        m_jobs.pop_back();
+        return true;
+    }
+
+    bool JobQueue::Steal(Job& job)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        if (m_jobs.empty())
+        {
+            return false;
+        }
+
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        return true;
+    }
+
+    JobSystem::JobSystem(int workerCount)
+    {
+        if (workerCount < 0)
+        {
+            auto concurrency = (int)std::thread::hardware_concurrency();
+            workerCount = concurrency > 1 ? concurrency - 1 : 0;
+        }
+
+        for (auto i = 0; i <= workerCount; ++i)
+        {
+            m_queues.push_back(CreateScope<JobQueue>());
+        }
+
+        for (auto i = 0; i < workerCount; ++i)
+        {
+            m_workers.emplace_back(&JobSystem::WorkerLoop, this, (uint32_t)(i + 1));
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeLock);
+            m_isRunning = false;
+        }
+
+        m_wakeCondition.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    uint32_t JobSystem::GetThreadIndex() { return s_threadIndex; }
+
+    void JobSystem::Dispatch(const std::function<void()>& function, JobCounter* counter, const JobCounter* dependency)
+    {
+        if (counter != nullptr)
+        {
+            counter->value.fetch_add(1u, std::memory_order_acq_rel);
+        }
+
+        Enqueue({ function, counter, dependency });
+        m_wakeCondition.notify_one();
+    }
+
+    void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function, JobCounter* counter, const JobCounter* dependency)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (grainSize == 0)
+        {
+            grainSize = std::max(1u, count / (GetThreadCount() * 4u));
+        }
+
+        auto jobCount = (count + grainSize - 1) / grainSize;
+
+        if (counter != nullptr)
+        {
+            counter->value.fetch_add(jobCount, std::memory_order_acq_rel);
+        }
+
+        // Jobs might outlive the caller's function object.
+        auto shared = CreateRef<std::function<void(uint32_t, uint32_t)>>(function);
+
+        for (auto i = 0u; i < jobCount; ++i)
+        {
+            auto begin = i * grainSize;
+            auto end = std::min(begin + grainSize, count);
+            Enqueue({ [shared, begin, end]() { (*shared)(begin, end); }, counter, dependency });
+        }
+
+        m_wakeCondition.notify_all();
+    }
+
+    void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function)
+    {
+        JobCounter counter;
+        ParallelFor(count, grainSize, function, &counter);
+        Wait(&counter);
+    }
+
+    void JobSystem::Wait(const JobCounter* counter)
+    {
+        auto threadIndex = s_threadOwner == this ? s_threadIndex : 0u;
+
+        while (!counter->IsDone())
+        {
+            if (TryExecuteJob(threadIndex))
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeLock);
+            m_wakeCondition.wait(lock, [this, counter] { return counter->IsDone() || m_pendingJobs.load(std::memory_order_acquire) > 0u; });
+        }
+    }
+
+    void JobSystem::Signal(JobCounter* counter)
+    {
+        if (counter->value.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+        {
+            Release(counter);
+        }
+    }
+
+    void JobSystem::Enqueue(Job&& job)
+    {
+        // Non worker threads share the first queue.
+        auto threadIndex = s_threadOwner == this ? s_threadIndex : 0u;
+
+        {
+            std::lock_guard<std::mutex> lock(m_wakeLock);
+            m_pendingJobs.fetch_add(1u, std::memory_order_acq_rel);
+        }
+
+        m_queues.at(threadIndex)->Push(std::move(job));
+    }
+
+    bool JobSystem::TryExecuteJob(uint32_t threadIndex)
+    {
+        Job job;
+        auto queueCount = (uint32_t)m_queues.size();
+        auto found = m_queues.at(threadIndex)->Pop(job);
+
+        for (auto i = 1u; !found && i < queueCount; ++i)
+        {
+            found = m_queues.at((threadIndex + i) % queueCount)->Steal(job);
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+
+        if (job.dependency != nullptr && !job.dependency->IsDone() && Park(job))
+        {
+            return false;
+        }
+
+        m_pendingJobs.fetch_sub(1u, std::memory_order_acq_rel);
+        job.function();
+
+        if (job.counter != nullptr)
+        {
+            Signal(job.counter);
+        }
+
+        return true;
+    }
+
+    bool JobSystem::Park(Job& job)
+    {
+        std::lock_guard<std::mutex> lock(m_parkLock);
+
+        // Checked again under the lock that Release takes, so that a dependency finishing in between can't strand the job.
+        if (job.dependency->IsDone())
+        {
+            return false;
+        }
+
+        m_pendingJobs.fetch_sub(1u, std::memory_order_acq_rel);
+        auto dependency = job.dependency;
+        m_parkedJobs.emplace(dependency, std::move(job));
+        return true;
+    }
+
+    void JobSystem::Release(const JobCounter* counter)
+    {
+        std::vector<Job> released;
+
+        {
+            std::lock_guard<std::mutex> lock(m_parkLock);
+            auto range = m_parkedJobs.equal_range(counter);
+
+            for (auto element = range.first; element != range.second; ++element)
+            {
+                released.push_back(std::move(element->second));
+            }
+
+            m_parkedJobs.erase(range.first, range.second);
+        }
+
+        for (auto& job : released)
+        {
+            Enqueue(std::move(job));
+        }
+
+        // Taken so that a thread that just found the counter pending in Wait is already waiting when notified.
+        {
+            std::lock_guard<std::mutex> lock(m_wakeLock);
+        }
+
+        m_wakeCondition.notify_all();
+    }
+
+    void JobSystem::WorkerLoop(uint32_t threadIndex)
+    {
+        s_threadIndex = threadIndex;
+        s_threadOwner = this;
+
+        while (m_isRunning)
+        {
+            if (TryExecuteJob(threadIndex))
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wakeLock);
+            m_wakeCondition.wait(lock, [this] { return m_pendingJobs.load(std::memory_order_acquire) > 0u || !m_isRunning; });
+        }
+    }
+}
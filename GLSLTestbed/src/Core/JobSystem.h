@@ -0,0 +1,82 @@
+#pragma once
+#include "Core/IService.h"
+#include "Utilities/Ref.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+
+namespace PK::Core
+{
+    using namespace PK::Utilities;
+
+    // Number of jobs still in flight. Incremented on dispatch & decremented when a job finishes.
+    // Jobs can depend on a counter, in which case they are parked until it reaches zero.
+    struct JobCounter
+    {
+        std::atomic<uint32_t> value = 0u;
+        inline bool IsDone() const { return value.load(std::memory_order_acquire) == 0u; }
+    };
+
+    struct Job
+    {
+        std::function<void()> function;
+        JobCounter* counter = nullptr;
+        const JobCounter* dependency = nullptr;
+    };
+
+    // Owner pushes & pops from the back, other threads steal from the front.
+    class JobQueue : public NoCopy
+    {
+        public:
+            void Push(Job&& job);
+            bool Pop(Job& job);
+            bool Steal(Job& job);
+
+        private:
+            std::deque<Job> m_jobs;
+            std::mutex m_lock;
+    };
+
+    class JobSystem : public IService
+    {
+        public:
+            // A negative worker count resolves to hardware concurrency - 1 (the main thread participates through Wait).
+            JobSystem(int workerCount);
+            ~JobSystem();
+
+            void Dispatch(const std::function<void()>& function, JobCounter* counter, const JobCounter* dependency = nullptr);
+            void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function, JobCounter* counter, const JobCounter* dependency = nullptr);
+            void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function);
+
+            // Executes pending jobs on the calling thread until the counter reaches zero, sleeps while there are none.
+            void Wait(const JobCounter* counter);
+            // Decrements a counter that is incremented manually instead of by a dispatch, releasing the jobs & waits on it at zero.
+            void Signal(JobCounter* counter);
+
+            inline uint32_t GetWorkerCount() const { return (uint32_t)m_workers.size(); }
+            inline uint32_t GetThreadCount() const { return (uint32_t)m_workers.size() + 1u; }
+
+            // 0 for non worker threads, 1..n for workers.
+            static uint32_t GetThreadIndex();
+
+        private:
+            bool TryExecuteJob(uint32_t threadIndex);
+            void WorkerLoop(uint32_t threadIndex);
+            void Enqueue(Job&& job);
+            // Returns false if the dependency finished in the meantime, in which case the job can run.
+            bool Park(Job& job);
+            void Release(const JobCounter* counter);
+
+            std::vector<std::thread> m_workers;
+            std::vector<Scope<JobQueue>> m_queues;
+            // Runnable jobs, parked jobs aren't counted so that idle workers sleep while only those remain.
+            std::atomic<uint32_t> m_pendingJobs = 0u;
+            std::unordered_multimap<const JobCounter*, Job> m_parkedJobs;
+            std::mutex m_parkLock;
+            std::atomic<bool> m_isRunning = true;
+            std::mutex m_wakeLock;
+            std::condition_variable m_wakeCondition;
+    };
+}
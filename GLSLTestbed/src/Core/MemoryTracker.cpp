@@ -0,0 +1,223 @@
+#include "PrecompiledHeader.h"
+#include "Core/MemoryTracker.h"
+#include "Core/UpdateStep.h"
+#include "Utilities/StringHashID.h"
+#include "Utilities/Log.h"
+
+namespace PK::Core
+{
+    using namespace PK::Utilities;
+
+    static void WriteEscaped(std::ofstream& file, const char* value)
+    {
+        for (auto* c = value; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                file << '\\';
+            }
+
+            file << *c;
+        }
+    }
+
+    static void WriteUsage(std::ofstream& file, const MemoryUsage& usage)
+    {
+        file << "\"cpu\":" << usage.cpuBytes << ",\"gpu\":" << usage.gpuBytes;
+        file << ",\"peakCpu\":" << usage.peakCpuBytes << ",\"peakGpu\":" << usage.peakGpuBytes << ",\"count\":" << usage.count;
+    }
+
+    static float ToKB(size_t bytes) { return bytes / 1024.0f; }
+
+    void MemoryUsage::Apply(int64_t cpuDelta, int64_t gpuDelta, int64_t countDelta)
+    {
+        cpuBytes = (size_t)((int64_t)cpuBytes + cpuDelta);
+        gpuBytes = (size_t)((int64_t)gpuBytes + gpuDelta);
+        count = (size_t)((int64_t)count + countDelta);
+        peakCpuBytes = std::max(peakCpuBytes, cpuBytes);
+        peakGpuBytes = std::max(peakGpuBytes, gpuBytes);
+    }
+
+    MemoryAllocation::MemoryAllocation(MemoryResource resource) : m_owner(MemoryScope::GetOwner()), m_resource(resource)
+    {
+        m_isTracked = MemoryTracker::Get() != nullptr;
+    }
+
+    MemoryAllocation::~MemoryAllocation()
+    {
+        auto tracker = MemoryTracker::Get();
+
+        if (m_isTracked && m_isCounted && tracker != nullptr)
+        {
+            tracker->Record(m_owner, m_resource, -(int64_t)m_cpuBytes, -(int64_t)m_gpuBytes, -1);
+        }
+    }
+
+    void MemoryAllocation::Set(size_t cpuBytes, size_t gpuBytes)
+    {
+        auto tracker = MemoryTracker::Get();
+
+        if (m_isTracked && tracker != nullptr)
+        {
+            tracker->Record(m_owner, m_resource, (int64_t)cpuBytes - (int64_t)m_cpuBytes, (int64_t)gpuBytes - (int64_t)m_gpuBytes, m_isCounted ? 0 : 1);
+            m_isCounted = true;
+        }
+
+        m_cpuBytes = cpuBytes;
+        m_gpuBytes = gpuBytes;
+    }
+
+    void MemoryTracker::Record(const MemoryOwner& owner, MemoryResource resource, int64_t cpuDelta, int64_t gpuDelta, int64_t countDelta)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_assets[owner.group][owner.assetId].Apply(cpuDelta, gpuDelta, countDelta);
+        m_groups[owner.group].Apply(cpuDelta, gpuDelta, countDelta);
+        m_resources[(int)resource].Apply(cpuDelta, gpuDelta, countDelta);
+        m_total.Apply(cpuDelta, gpuDelta, countDelta);
+
+        auto grown = std::max<int64_t>(cpuDelta, 0) + std::max<int64_t>(gpuDelta, 0);
+
+        if (grown > 0)
+        {
+            m_frame.allocatedBytes += (size_t)grown;
+            m_frame.allocationCount++;
+        }
+    }
+
+    void MemoryTracker::Step(int condition)
+    {
+        if ((UpdateStep)condition != UpdateStep::OpenFrame)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_lastFrame = m_frame;
+        m_frame = MemoryFrameUsage();
+
+        if (m_lastFrame.allocatedBytes > m_peakFrame.allocatedBytes)
+        {
+            m_peakFrame = m_lastFrame;
+        }
+    }
+
+    MemoryUsage MemoryTracker::GetTotal() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_total;
+    }
+
+    void MemoryTracker::LogReport() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        PK_CORE_LOG_HEADER("Memory usage in kb (cpu / gpu, peak cpu / peak gpu)");
+        PK_CORE_LOG("Total: %.1f / %.1f, %.1f / %.1f, objects: %i", ToKB(m_total.cpuBytes), ToKB(m_total.gpuBytes), ToKB(m_total.peakCpuBytes), ToKB(m_total.peakGpuBytes), (int)m_total.count);
+        PK_CORE_LOG("Allocated last frame: %.1f in %i allocations, peak frame: %.1f in %i allocations", ToKB(m_lastFrame.allocatedBytes), (int)m_lastFrame.allocationCount, ToKB(m_peakFrame.allocatedBytes), (int)m_peakFrame.allocationCount);
+
+        PK_CORE_LOG_HEADER("By resource");
+
+        for (auto i = 0; i < (int)MemoryResource::Count; ++i)
+        {
+            auto& usage = m_resources[i];
+            PK_CORE_LOG("%s: %.1f / %.1f, %.1f / %.1f, objects: %i", GetResourceName((MemoryResource)i), ToKB(usage.cpuBytes), ToKB(usage.gpuBytes), ToKB(usage.peakCpuBytes), ToKB(usage.peakGpuBytes), (int)usage.count);
+        }
+
+        PK_CORE_LOG_HEADER("By asset type & subsystem");
+
+        for (auto& kv : m_groups)
+        {
+            PK_CORE_LOG("%s: %.1f / %.1f, %.1f / %.1f, objects: %i", kv.first.c_str(), ToKB(kv.second.cpuBytes), ToKB(kv.second.gpuBytes), ToKB(kv.second.peakCpuBytes), ToKB(kv.second.peakGpuBytes), (int)kv.second.count);
+        }
+
+        PK_CORE_LOG_HEADER("By asset");
+
+        for (auto& group : m_assets)
+        {
+            for (auto& kv : group.second)
+            {
+                if (kv.first != 0 && kv.second.count > 0)
+                {
+                    PK_CORE_LOG("%s: %.1f / %.1f", StringHashID::IDToString(kv.first).c_str(), ToKB(kv.second.cpuBytes), ToKB(kv.second.gpuBytes));
+                }
+            }
+        }
+    }
+
+    void MemoryTracker::ExportJson(const std::string& filepath) const
+    {
+        std::ofstream file(filepath);
+
+        if (!file.is_open())
+        {
+            PK_CORE_LOG_WARNING("Failed to open file for memory usage export: %s", filepath.c_str());
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        file << "{\n\"total\": {";
+        WriteUsage(file, m_total);
+        file << "},\n\"lastFrame\": {\"allocated\":" << m_lastFrame.allocatedBytes << ",\"allocations\":" << m_lastFrame.allocationCount << "}";
+        file << ",\n\"peakFrame\": {\"allocated\":" << m_peakFrame.allocatedBytes << ",\"allocations\":" << m_peakFrame.allocationCount << "}";
+        file << ",\n\"resources\": {\n";
+
+        for (auto i = 0; i < (int)MemoryResource::Count; ++i)
+        {
+            file << (i > 0 ? ",\n" : "") << "\"" << GetResourceName((MemoryResource)i) << "\": {";
+            WriteUsage(file, m_resources[i]);
+            file << "}";
+        }
+
+        file << "\n},\n\"groups\": [\n";
+        auto separator = "";
+
+        for (auto& group : m_assets)
+        {
+            file << separator << "{\"name\":\"";
+            WriteEscaped(file, group.first.c_str());
+            file << "\",";
+            WriteUsage(file, m_groups.at(group.first));
+            file << ",\"assets\":[";
+
+            auto assetSeparator = "";
+
+            for (auto& kv : group.second)
+            {
+                if (kv.first == 0 || kv.second.count == 0)
+                {
+                    continue;
+                }
+
+                file << assetSeparator << "{\"name\":\"";
+                WriteEscaped(file, StringHashID::IDToString(kv.first).c_str());
+                file << "\",";
+                WriteUsage(file, kv.second);
+                file << "}";
+                assetSeparator = ",";
+            }
+
+            file << "]}";
+            separator = ",\n";
+        }
+
+        file << "\n]\n}\n";
+
+        PK_CORE_LOG("Exported memory usage to %s", filepath.c_str());
+    }
+
+    const char* MemoryTracker::GetResourceName(MemoryResource resource)
+    {
+        switch (resource)
+        {
+            case MemoryResource::VertexBuffer: return "VertexBuffer";
+            case MemoryResource::IndexBuffer: return "IndexBuffer";
+            case MemoryResource::ConstantBuffer: return "ConstantBuffer";
+            case MemoryResource::ComputeBuffer: return "ComputeBuffer";
+            case MemoryResource::Texture: return "Texture";
+            case MemoryResource::ShaderVariant: return "ShaderVariant";
+            default: return "Unknown";
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "Core/IService.h"
+#include "Core/ISingleton.h"
+#include "ECS/Sequencer.h"
+#include <mutex>
+
+namespace PK::Core
+{
+    enum class MemoryResource
+    {
+        VertexBuffer,
+        IndexBuffer,
+        ConstantBuffer,
+        ComputeBuffer,
+        Texture,
+        ShaderVariant,
+        Count
+    };
+
+    // Asset or subsystem that graphics objects created on the current thread are attributed to.
+    // Groups are not copied, they must outlive the tracker (string literals, typeid names).
+    struct MemoryOwner
+    {
+        const char* group = "Unscoped";
+        uint32_t assetId = 0;
+    };
+
+    struct MemoryUsage
+    {
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+        size_t peakCpuBytes = 0;
+        size_t peakGpuBytes = 0;
+        size_t count = 0;
+
+        void Apply(int64_t cpuDelta, int64_t gpuDelta, int64_t countDelta);
+    };
+
+    // Bytes allocated (grown) during a frame, released memory is not subtracted.
+    struct MemoryFrameUsage
+    {
+        size_t allocatedBytes = 0;
+        size_t allocationCount = 0;
+    };
+
+    class MemoryScope
+    {
+        public:
+            MemoryScope(const char* group, uint32_t assetId = 0) : m_previous(s_owner) { s_owner = { group, assetId }; }
+            ~MemoryScope() { s_owner = m_previous; }
+            inline static const MemoryOwner& GetOwner() { return s_owner; }
+
+        private:
+            inline static thread_local MemoryOwner s_owner;
+            MemoryOwner m_previous;
+    };
+
+    // Member of the objects that own graphics memory. Captures the owner at construction & reports size changes to the tracker.
+    class MemoryAllocation : public NoCopy
+    {
+        public:
+            MemoryAllocation(MemoryResource resource);
+            ~MemoryAllocation();
+
+            void Set(size_t cpuBytes, size_t gpuBytes);
+            inline size_t GetCpuBytes() const { return m_cpuBytes; }
+            inline size_t GetGpuBytes() const { return m_gpuBytes; }
+
+        private:
+            MemoryOwner m_owner;
+            MemoryResource m_resource;
+            size_t m_cpuBytes = 0;
+            size_t m_gpuBytes = 0;
+            // Objects created before the tracker are never reported.
+            bool m_isTracked = false;
+            bool m_isCounted = false;
+    };
+
+    // Aggregates graphics memory by owning asset, by group (asset type or subsystem) & by resource type.
+    class MemoryTracker : public IService, public ISingleton<MemoryTracker>, public ECS::ISimpleStep
+    {
+        public:
+            void Record(const MemoryOwner& owner, MemoryResource resource, int64_t cpuDelta, int64_t gpuDelta, int64_t countDelta);
+
+            // Closes the frame's transient totals.
+            void Step(int condition) override;
+
+            MemoryUsage GetTotal() const;
+            void LogReport() const;
+            void ExportJson(const std::string& filepath) const;
+
+            static const char* GetResourceName(MemoryResource resource);
+
+        private:
+            mutable std::mutex m_lock;
+            std::map<std::string, std::map<uint32_t, MemoryUsage>> m_assets;
+            std::map<std::string, MemoryUsage> m_groups;
+            MemoryUsage m_resources[(int)MemoryResource::Count];
+            MemoryUsage m_total;
+            MemoryFrameUsage m_frame;
+            MemoryFrameUsage m_lastFrame;
+            MemoryFrameUsage m_peakFrame;
+    };
+}
@@ -0,0 +1,160 @@
+#include "PrecompiledHeader.h"
+#include "Core/Profiler.h"
+#include "Utilities/Log.h"
+
+namespace PK::Core
+{
+    static void WriteEscaped(std::ofstream& file, const char* value)
+    {
+        for (auto* c = value; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                file << '\\';
+            }
+
+            file << *c;
+        }
+    }
+
+    void ProfilerThreadBuffer::CopyEvents(std::vector<ProfilerEvent>& events) const
+    {
+        auto head = m_head.load(std::memory_order_acquire);
+        auto first = head > Capacity ? head - Capacity : 0ull;
+
+        for (auto i = first; i < head; ++i)
+        {
+            auto& slot = m_slots[i & (Capacity - 1u)];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+            // Overwritten by a later event or being written.
+            if (sequence != i * 2u + 2u)
+            {
+                continue;
+            }
+
+            ProfilerEvent event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.begin = slot.begin.load(std::memory_order_relaxed);
+            event.end = slot.end.load(std::memory_order_relaxed);
+            event.depth = slot.depth.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                events.push_back(event);
+            }
+        }
+    }
+
+    // Destroyed when the registered thread exits.
+    struct ProfilerThreadRelease
+    {
+        ProfilerThreadBuffer* buffer = nullptr;
+
+        ~ProfilerThreadRelease()
+        {
+            auto* profiler = Profiler::Get();
+
+            if (profiler != nullptr && buffer != nullptr)
+            {
+                profiler->ReleaseThread(buffer);
+            }
+        }
+    };
+
+    static int64_t GetPerformanceCounter()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    Profiler::Profiler()
+    {
+        m_startCounter = GetPerformanceCounter();
+        m_startTimestamp = GetTimestamp();
+    }
+
+    ProfilerThreadBuffer* Profiler::RegisterThread()
+    {
+        auto* profiler = Get();
+
+        if (profiler == nullptr)
+        {
+            return nullptr;
+        }
+
+        static thread_local ProfilerThreadRelease release;
+
+        std::lock_guard<std::mutex> lock(profiler->m_lock);
+        profiler->m_buffers.push_back(CreateScope<ProfilerThreadBuffer>(profiler->m_nextThreadId++));
+        s_threadBuffer = profiler->m_buffers.back().get();
+        release.buffer = s_threadBuffer;
+        return s_threadBuffer;
+    }
+
+    void Profiler::ReleaseThread(ProfilerThreadBuffer* buffer)
+    {
+        // Exports hold the lock while copying, the buffer isn't freed while it is being read.
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(), [buffer](const Scope<ProfilerThreadBuffer>& b) { return b.get() == buffer; }), m_buffers.end());
+
+        if (s_threadBuffer == buffer)
+        {
+            s_threadBuffer = nullptr;
+        }
+    }
+
+    void Profiler::ExportChromeTrace(const std::string& filepath) const
+    {
+        std::ofstream file(filepath);
+
+        if (!file.is_open())
+        {
+            PK_CORE_LOG_WARNING("Failed to open file for profiler trace export: %s", filepath.c_str());
+            return;
+        }
+
+        // Calibrate the cycle counter against the performance counter over the profiler's lifetime.
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        auto elapsedSeconds = (GetPerformanceCounter() - m_startCounter) / (double)frequency.QuadPart;
+        auto elapsedTicks = GetTimestamp() - m_startTimestamp;
+        auto microsecondsPerTick = elapsedTicks > 0 ? elapsedSeconds * 1e6 / (double)elapsedTicks : 0.0;
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        std::vector<ProfilerEvent> events;
+        auto eventCount = 0ull;
+        auto separator = "";
+
+        file << "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n";
+
+        for (auto& buffer : m_buffers)
+        {
+            auto threadId = buffer->GetThreadId();
+
+            file << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadId << ",\"args\":{\"name\":\"Thread " << threadId << "\"}}";
+            separator = ",\n";
+
+            events.clear();
+            buffer->CopyEvents(events);
+            eventCount += events.size();
+
+            for (auto& event : events)
+            {
+                file << separator << "{\"name\":\"";
+                WriteEscaped(file, event.name);
+                file << "\",\"cat\":\"PK\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadId;
+                file << ",\"ts\":" << (event.begin - m_startTimestamp) * microsecondsPerTick;
+                file << ",\"dur\":" << (event.end - event.begin) * microsecondsPerTick;
+                file << ",\"args\":{\"depth\":" << event.depth << "}}";
+            }
+        }
+
+        file << "\n]\n}\n";
+        file.close();
+
+        PK_CORE_LOG("Exported %llu profiler events from %llu threads to: %s", eventCount, (uint64_t)m_buffers.size(), filepath.c_str());
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "Core/IService.h"
+#include "Core/ISingleton.h"
+#include "Utilities/Ref.h"
+#include <atomic>
+#include <mutex>
+#include <intrin.h>
+
+namespace PK::Core
+{
+    using namespace PK::Utilities;
+
+    struct ProfilerEvent
+    {
+        // Names are not copied, they must outlive the profiler (string literals, typeid names).
+        const char* name = nullptr;
+        int64_t begin = 0;
+        int64_t end = 0;
+        uint32_t depth = 0;
+    };
+
+    // Single producer ring buffer. Only the owning thread writes, readers copy the events that haven't been overwritten yet.
+    class ProfilerThreadBuffer : public NoCopy
+    {
+        public:
+            static constexpr uint32_t Capacity = 1u << 16u;
+
+            ProfilerThreadBuffer(uint32_t threadId) : m_threadId(threadId) {}
+
+            inline void Push(const char* name, int64_t begin, int64_t end, uint32_t depth)
+            {
+                auto head = m_head.load(std::memory_order_relaxed);
+                auto& slot = m_slots[head & (Capacity - 1u)];
+                slot.sequence.store(head * 2u + 1u, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.name.store(name, std::memory_order_relaxed);
+                slot.begin.store(begin, std::memory_order_relaxed);
+                slot.end.store(end, std::memory_order_relaxed);
+                slot.depth.store(depth, std::memory_order_relaxed);
+                slot.sequence.store(head * 2u + 2u, std::memory_order_release);
+                m_head.store(head + 1u, std::memory_order_release);
+            }
+
+            // Events that the owner is overwriting while they are copied are skipped.
+            void CopyEvents(std::vector<ProfilerEvent>& events) const;
+            inline uint32_t GetThreadId() const { return m_threadId; }
+
+        private:
+            // Seqlock per event. Odd while the owner writes it, (index + 1) * 2 once the event of that index is complete.
+            struct Slot
+            {
+                std::atomic<uint64_t> sequence = 0u;
+                std::atomic<const char*> name = nullptr;
+                std::atomic<int64_t> begin = 0;
+                std::atomic<int64_t> end = 0;
+                std::atomic<uint32_t> depth = 0u;
+            };
+
+            Slot m_slots[Capacity];
+            std::atomic<uint64_t> m_head = 0u;
+            uint32_t m_threadId;
+    };
+
+    class Profiler : public IService, public ISingleton<Profiler>
+    {
+        friend struct ProfilerThreadRelease;
+
+        public:
+            Profiler();
+
+            // Raw cycle counter, a lot cheaper than QueryPerformanceCounter. Converted to time on export.
+            inline static int64_t GetTimestamp() { return (int64_t)__rdtsc(); }
+
+            // Registers the calling thread on first use. Null if there is no profiler instance.
+            inline static ProfilerThreadBuffer* GetThreadBuffer() { return s_threadBuffer != nullptr ? s_threadBuffer : RegisterThread(); }
+
+            // Chrome trace event format, viewable in chrome://tracing or ui.perfetto.dev.
+            void ExportChromeTrace(const std::string& filepath) const;
+
+        private:
+            static ProfilerThreadBuffer* RegisterThread();
+            // Frees the buffer of a thread that exits, its events are dropped from later exports.
+            void ReleaseThread(ProfilerThreadBuffer* buffer);
+
+            inline static thread_local ProfilerThreadBuffer* s_threadBuffer = nullptr;
+
+            mutable std::mutex m_lock;
+            std::vector<Scope<ProfilerThreadBuffer>> m_buffers;
+            uint32_t m_nextThreadId = 0u;
+            int64_t m_startTimestamp = 0;
+            int64_t m_startCounter = 0;
+    };
+
+    class ProfilerScope
+    {
+        public:
+            inline ProfilerScope(const char* name) : m_name(name), m_depth(s_depth++), m_begin(Profiler::GetTimestamp()) {}
+
+            inline ~ProfilerScope()
+            {
+                auto end = Profiler::GetTimestamp();
+                --s_depth;
+                auto* buffer = Profiler::GetThreadBuffer();
+
+                if (buffer != nullptr)
+                {
+                    buffer->Push(m_name, m_begin, end, m_depth);
+                }
+            }
+
+        private:
+            inline static thread_local uint32_t s_depth = 0u;
+            const char* m_name;
+            uint32_t m_depth;
+            int64_t m_begin;
+    };
+}
+
+#define PK_PROFILE_CONCAT_INNER(a, b) a##b
+#define PK_PROFILE_CONCAT(a, b) PK_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(PK_ENABLE_PROFILER)
+    #define PK_PROFILE_SCOPE(name) PK::Core::ProfilerScope PK_PROFILE_CONCAT(pk_profilerScope, __LINE__)(name)
+    #define PK_PROFILE_FUNCTION() PK_PROFILE_SCOPE(__FUNCTION__)
+#else
+    #define PK_PROFILE_SCOPE(name)
+    #define PK_PROFILE_FUNCTION()
+#endif
+
+// Token steps are invoked per event & command, they are only recorded when PK_ENABLE_STEP_PROFILER is defined as well.
+#if defined(PK_ENABLE_PROFILER) && defined(PK_ENABLE_STEP_PROFILER)
+    #define PK_PROFILE_STEP(name) PK_PROFILE_SCOPE(name)
+#else
+    #define PK_PROFILE_STEP(name)
+#endif
@@ -19,6 +19,7 @@ namespace PK::Core
     
     Time::Time(ECS::Sequencer* sequencer, float timeScale) : m_sequencer(sequencer), m_timeScale(timeScale)
     {
+        m_stepHandle = sequencer->GetHandle<Time>(this, 0);
     }
     
     
@@ -51,7 +52,7 @@ namespace PK::Core
             case PK::Core::UpdateStep::OpenFrame: 
             {
                 m_frameStart = std::chrono::steady_clock::now(); 
-                m_sequencer->Next<Time>(this, this, 0);
+                m_sequencer->Next(m_stepHandle, this);
             }
             break;
             case PK::Core::UpdateStep::CloseFrame:
@@ -36,6 +36,7 @@ namespace PK::Core
     
         private:
             ECS::Sequencer* m_sequencer = nullptr;
+            ECS::StepHandle m_stepHandle = nullptr;
     
             std::chrono::time_point<std::chrono::steady_clock, std::chrono::duration<double>> m_frameStart;
             uint64_t m_frameIndex = 0;
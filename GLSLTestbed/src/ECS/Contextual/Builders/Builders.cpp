@@ -28,7 +28,6 @@ void PK::ECS::Builders::InitializeLightValues(LightImplementer* implementer, con
 			break;
 	}
 
-	implementer->isVisible = false;
 	implementer->color = lightColor;
 	implementer->radius = autoRadius;
 	implementer->castShadows = castShadows;
@@ -26,6 +26,9 @@ namespace PK::ECS::Components
     {
         BoundingBox localAABB;
         BoundingBox worldAABB;
+        // Per submesh of the mesh, empty for procedural meshes. Lets partially visible renderables with several submeshes cull them individually.
+        std::vector<BoundingBox> submeshLocalAABBs;
+        std::vector<BoundingBox> submeshWorldAABBs;
         virtual ~Bounds() = default;
     };
     
@@ -44,7 +47,6 @@ namespace PK::ECS::Components
 
     struct RenderableHandle
     {
-        bool isVisible = false;
         bool isCullable = true;
         RenderHandleFlags flags = RenderHandleFlags::Renderer;
         virtual ~RenderableHandle() = default;
@@ -52,7 +54,8 @@ namespace PK::ECS::Components
     
     struct MeshReference
     {
-        Mesh* sharedMesh = nullptr;
+        // Resolves to the placeholder mesh while the mesh is streamed in.
+        Core::AssetHandle<Mesh> sharedMesh;
         virtual ~MeshReference() = default;
     };
     
@@ -68,9 +71,6 @@ namespace PK::ECS::Components
         float radius = 1.0f;
         float angle = 45.0f;
         bool castShadows = true;
-        uint linearIndex = 0;
-        uint shadowmapIndex = 0;
-        uint projectionIndex = 0;
         LightCookie cookie = LightCookie::NoCookie;
         LightType lightType = LightType::Point;
         virtual ~Light() = default;
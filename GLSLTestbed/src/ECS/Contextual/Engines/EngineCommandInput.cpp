@@ -2,9 +2,15 @@
 #include "EngineCommandInput.h"
 #include "Core/Application.h"
 #include "Core/ApplicationConfig.h"
+#include "Core/Profiler.h"
+#include "Core/MemoryTracker.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Rendering/RenderPipeline.h"
 #include "Utilities/StringUtilities.h"
 #include "Rendering/Objects/TextureXD.h"
+#include "Rendering/ShaderVariantManifest.h"
+#include "EngineCommandTests.h"
+#include <sstream>
 
 namespace PK::ECS::Engines
 {
@@ -12,20 +18,32 @@ namespace PK::ECS::Engines
     {
         {std::string("query"),      CommandArgument::Query},
         {std::string("reload"),     CommandArgument::Reload},
+        {std::string("test"),       CommandArgument::Test},
+        {std::string("benchmark"),  CommandArgument::Benchmark},
         {std::string("exit"),       CommandArgument::Exit},
         {std::string("application"),CommandArgument::Application},
         {std::string("contextual"), CommandArgument::Contextual},
         {std::string("vsync"),      CommandArgument::VSync},
+        {std::string("sequencer"),  CommandArgument::Sequencer},
         {std::string("assets"),     CommandArgument::Assets},
         {std::string("variants"),   CommandArgument::Variants},
         {std::string("uniforms"),   CommandArgument::Uniforms},
         {std::string("gpu_memory"), CommandArgument::GPUMemory},
+        {std::string("memory"),     CommandArgument::Memory},
+        {std::string("culling"),    CommandArgument::Culling},
+        {std::string("save"),       CommandArgument::Save},
         {std::string("shader"),     CommandArgument::TypeShader},
         {std::string("mesh"),       CommandArgument::TypeMesh},
         {std::string("texture"),    CommandArgument::TypeTexture},
         {std::string("material"),   CommandArgument::TypeMaterial},
         {std::string("time"),       CommandArgument::TypeTime},
         {std::string("appconfig"),       CommandArgument::TypeAppConfig},
+        {std::string("jobs"),       CommandArgument::TypeJobs},
+        {std::string("lods"),       CommandArgument::TypeLods},
+        {std::string("tangents"),   CommandArgument::TypeTangents},
+        {std::string("obj"),        CommandArgument::TypeObj},
+        {std::string("pool"),       CommandArgument::TypePool},
+        {std::string("profiler"),   CommandArgument::TypeProfiler},
     };
 
     void EngineCommandInput::ApplicationExit(const ConsoleCommand& arguments) { Application::Get().Close(); }
@@ -45,9 +63,28 @@ namespace PK::ECS::Engines
         PK_CORE_LOG("VSync: %s", (Application::GetWindow()->IsVSync() ? "Enabled" : "Disabled"));
     }
 
+    void EngineCommandInput::ApplicationSetSequencerMode(const ConsoleCommand& arguments)
+    {
+        const auto& str = arguments.at(2);
+        if (str == "serial") m_sequencer->SetSerialExecution(true);
+        if (str == "parallel") m_sequencer->SetSerialExecution(false);
+        if (str == "toggle") m_sequencer->SetSerialExecution(!m_sequencer->IsSerialExecution());
+        PK_CORE_LOG("Sequencer: %s", (m_sequencer->IsSerialExecution() ? "Serial" : "Parallel"));
+    }
+
+    void EngineCommandInput::ApplicationSetSubmeshCulling(const ConsoleCommand& arguments)
+    {
+        auto pipeline = Application::GetService<Rendering::RenderPipeline>();
+        const auto& str = arguments.at(2);
+        if (str == "true") pipeline->SetSubmeshCulling(true);
+        if (str == "false") pipeline->SetSubmeshCulling(false);
+        if (str == "toggle") pipeline->SetSubmeshCulling(!pipeline->IsSubmeshCulling());
+        PK_CORE_LOG("Submesh culling: %s", (pipeline->IsSubmeshCulling() ? "Enabled" : "Disabled"));
+    }
+
     void EngineCommandInput::QueryShaderVariants(const ConsoleCommand& arguments)
     {
-        auto shader = m_assetDatabase->TryFind<Shader>(arguments[2].c_str());
+        auto shader = m_assetDatabase->TryFindContaining<Shader>(arguments[2].c_str());
 
         if (shader != nullptr)
         {
@@ -63,7 +100,7 @@ namespace PK::ECS::Engines
 
     void EngineCommandInput::QueryShaderUniforms(const ConsoleCommand& arguments)
     {
-        auto shader = m_assetDatabase->TryFind<Shader>(arguments[2].c_str());
+        auto shader = m_assetDatabase->TryFindContaining<Shader>(arguments[2].c_str());
 
         if (shader != nullptr)
         {
@@ -82,6 +119,68 @@ namespace PK::ECS::Engines
         PK_CORE_LOG("GPU Memory usage in kb: %i", Rendering::GraphicsAPI::GetMemoryUsageKB());
     }
 
+    void EngineCommandInput::QueryMemory(const ConsoleCommand& arguments)
+    {
+        auto tracker = MemoryTracker::Get();
+        tracker->LogReport();
+        tracker->ExportJson("MemoryUsage.json");
+    }
+
+    void EngineCommandInput::QuerySequencerGraph(const ConsoleCommand& arguments)
+    {
+        m_sequencer->ExportGraph("SequencerGraph.dot");
+    }
+
+    void EngineCommandInput::QueryProfilerTrace(const ConsoleCommand& arguments)
+    {
+        #if defined(PK_ENABLE_PROFILER)
+        Application::GetService<Profiler>()->ExportChromeTrace("ProfilerTrace.json");
+        #else
+        PK_CORE_LOG_WARNING("Profiler is disabled at compile time (PK_ENABLE_PROFILER).");
+        #endif
+    }
+
+    void EngineCommandInput::QuerySubmeshCulling(const ConsoleCommand& arguments)
+    {
+        auto pipeline = Application::GetService<Rendering::RenderPipeline>();
+        auto statistics = pipeline->GetSubmeshCullingStatistics();
+        auto culledPercentage = statistics.submeshes > 0 ? 100.0f * statistics.culledSubmeshes / statistics.submeshes : 0.0f;
+        double frameTimes[2];
+
+        for (auto i = 0u; i < 2u; ++i)
+        {
+            auto& frameTime = pipeline->GetSubmeshCullingFrameTime(i == 1);
+            frameTimes[i] = frameTime.frames > 0 ? frameTime.seconds * 1000.0 / frameTime.frames : 0.0;
+        }
+
+        PK_CORE_LOG_HEADER("Submesh culling: %s (last frame)", pipeline->IsSubmeshCulling() ? "Enabled" : "Disabled");
+        PK_CORE_LOG("Visible renderables: %i, partially visible: %i", statistics.visibleRenderables, statistics.partialRenderables);
+        PK_CORE_LOG("Submeshes: %i, tested: %i, culled: %i (%4.1f%%)", statistics.submeshes, statistics.testedSubmeshes, statistics.culledSubmeshes, culledPercentage);
+        PK_CORE_LOG("Average frame time enabled: %6.3f ms, disabled: %6.3f ms, delta: %6.3f ms", frameTimes[1], frameTimes[0], frameTimes[1] - frameTimes[0]);
+    }
+
+    void EngineCommandInput::QueryVariantManifest(const ConsoleCommand& arguments)
+    {
+        auto manifest = Rendering::ShaderVariantManifest::Get();
+        std::vector<Shader*> shaders;
+        m_assetDatabase->GetAssetsOfType<Shader>(shaders);
+
+        auto compiledCount = 0u;
+        auto declaredCount = 0u;
+
+        for (auto shader : shaders)
+        {
+            compiledCount += shader->GetCompiledVariantCount();
+            declaredCount += shader->GetDeclaredVariantCount();
+        }
+
+        PK_CORE_LOG_HEADER("Shader variants (%s)", manifest->IsStripping() ? "stripped by manifest" : "compiled on demand");
+        PK_CORE_LOG("Shaders: %i, declared variants: %i, compiled: %i", (uint32_t)shaders.size(), declaredCount, compiledCount);
+        PK_CORE_LOG("Variants resolved: %i, manifest misses: %i", manifest->GetRecordedCount(), manifest->GetMissCount());
+    }
+
+    void EngineCommandInput::SaveVariantManifest(const ConsoleCommand& arguments) { Rendering::ShaderVariantManifest::Get()->Save("res/materials/"); }
+
     void EngineCommandInput::ReloadTime(const ConsoleCommand& arguments)
     {
         Application::GetService<Time>()->Reset();
@@ -163,11 +262,12 @@ namespace PK::ECS::Engines
         }
     }
 
-    EngineCommandInput::EngineCommandInput(AssetDatabase* assetDatabase, Sequencer* sequencer, Time* time, EntityDatabase* entityDb, CommandConfig* commandBindings)
+    EngineCommandInput::EngineCommandInput(AssetDatabase* assetDatabase, Sequencer* sequencer, Time* time, JobSystem* jobSystem, EntityDatabase* entityDb, CommandConfig* commandBindings)
     {
         m_entityDb = entityDb;
         m_assetDatabase = assetDatabase;
         m_time = time;
+        m_jobSystem = jobSystem;
         m_sequencer = sequencer;
         m_commandBindings = commandBindings;
 
@@ -176,7 +276,15 @@ namespace PK::ECS::Engines
         m_commands[{CommandArgument::Application, CommandArgument::VSync, CommandArgument::StringParameter }] = PK_BIND_FUNCTION(ApplicationSetVSync);
         m_commands[{CommandArgument::Query, CommandArgument::TypeShader, CommandArgument::StringParameter, CommandArgument::Variants}] = PK_BIND_FUNCTION(QueryShaderVariants);
         m_commands[{CommandArgument::Query, CommandArgument::TypeShader, CommandArgument::StringParameter, CommandArgument::Uniforms}] = PK_BIND_FUNCTION(QueryShaderUniforms);
+        m_commands[{CommandArgument::Application, CommandArgument::Sequencer, CommandArgument::StringParameter }] = PK_BIND_FUNCTION(ApplicationSetSequencerMode);
+        m_commands[{CommandArgument::Application, CommandArgument::Culling, CommandArgument::StringParameter }] = PK_BIND_FUNCTION(ApplicationSetSubmeshCulling);
         m_commands[{CommandArgument::Query, CommandArgument::GPUMemory}] = PK_BIND_FUNCTION(QueryGPUMemory);
+        m_commands[{CommandArgument::Query, CommandArgument::Memory}] = PK_BIND_FUNCTION(QueryMemory);
+        m_commands[{CommandArgument::Query, CommandArgument::Sequencer}] = PK_BIND_FUNCTION(QuerySequencerGraph);
+        m_commands[{CommandArgument::Query, CommandArgument::TypeProfiler}] = PK_BIND_FUNCTION(QueryProfilerTrace);
+        m_commands[{CommandArgument::Query, CommandArgument::Culling}] = PK_BIND_FUNCTION(QuerySubmeshCulling);
+        m_commands[{CommandArgument::Query, CommandArgument::Variants}] = PK_BIND_FUNCTION(QueryVariantManifest);
+        m_commands[{CommandArgument::Save, CommandArgument::Variants}] = PK_BIND_FUNCTION(SaveVariantManifest);
         m_commands[{CommandArgument::Query, CommandArgument::Assets, CommandArgument::TypeShader}] = PK_BIND_FUNCTION(QueryLoadedShaders);
         m_commands[{CommandArgument::Query, CommandArgument::Assets, CommandArgument::TypeMaterial}] = PK_BIND_FUNCTION(QueryLoadedMaterials);
         m_commands[{CommandArgument::Query, CommandArgument::Assets, CommandArgument::TypeMesh}] = PK_BIND_FUNCTION(QueryLoadedMeshes);
@@ -188,6 +296,19 @@ namespace PK::ECS::Engines
         m_commands[{CommandArgument::Reload, CommandArgument::TypeTexture, CommandArgument::StringParameter}] = PK_BIND_FUNCTION(ReloadTextures);
         m_commands[{CommandArgument::Reload, CommandArgument::TypeAppConfig, CommandArgument::StringParameter}] = PK_BIND_FUNCTION(ReloadAppConfig);
         m_commands[{CommandArgument::Reload, CommandArgument::TypeTime}] = PK_BIND_FUNCTION(ReloadTime);
+        m_commands[{CommandArgument::Test, CommandArgument::TypeJobs}] = [this](const ConsoleCommand& arguments) { CommandTests::TestJobSystem(m_jobSystem); };
+        m_commands[{CommandArgument::Test, CommandArgument::TypeMesh}] = [](const ConsoleCommand& arguments) { CommandTests::TestMeshCompression(); };
+        m_commands[{CommandArgument::Test, CommandArgument::TypeLods}] = [](const ConsoleCommand& arguments) { CommandTests::TestMeshLods(); };
+        m_commands[{CommandArgument::Test, CommandArgument::TypeObj}] = [this](const ConsoleCommand& arguments) { CommandTests::TestObjReader(m_jobSystem); };
+        m_commands[{CommandArgument::Test, CommandArgument::TypePool}] = [](const ConsoleCommand& arguments) { CommandTests::TestRangeAllocator(); };
+        m_commands[{CommandArgument::Test, CommandArgument::TypeShader}] = [](const ConsoleCommand& arguments) { CommandTests::TestShaderDirectives(); };
+        m_commands[{CommandArgument::Benchmark, CommandArgument::TypeJobs}] = [](const ConsoleCommand& arguments) { CommandTests::BenchmarkJobSystem(); };
+        m_commands[{CommandArgument::Benchmark, CommandArgument::TypeTangents}] = [](const ConsoleCommand& arguments) { CommandTests::BenchmarkTangents(); };
+        m_commands[{CommandArgument::Benchmark, CommandArgument::TypeObj}] = [this](const ConsoleCommand& arguments) { CommandTests::BenchmarkObjReader(m_jobSystem); };
+        m_commands[{CommandArgument::Benchmark, CommandArgument::Sequencer}] = [](const ConsoleCommand& arguments) { CommandTests::BenchmarkSequencer(); };
+        m_commands[{CommandArgument::Benchmark, CommandArgument::TypeProfiler}] = [](const ConsoleCommand& arguments) { CommandTests::BenchmarkProfiler(); };
+        m_commands[{CommandArgument::Benchmark, CommandArgument::Assets}] = [this](const ConsoleCommand& arguments) { CommandTests::BenchmarkAssetFind(m_assetDatabase); };
+        m_commands[{CommandArgument::Benchmark, CommandArgument::TypeShader}] = [](const ConsoleCommand& arguments) { CommandTests::BenchmarkShaderPreprocess(); };
     }
     
     void EngineCommandInput::Step(Input* input)
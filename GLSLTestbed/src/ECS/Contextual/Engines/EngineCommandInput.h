@@ -3,6 +3,7 @@
 #include "Utilities/Ref.h"
 #include "Core/CommandConfig.h"
 #include "Core/Time.h"
+#include "Core/JobSystem.h"
 #include "Core/Input.h"
 #include "Core/UpdateStep.h"
 #include "Core/AssetDataBase.h"
@@ -17,21 +18,33 @@ namespace PK::ECS::Engines
 	{
 		Query,
 		Reload,
+		Test,
+		Benchmark,
 		Exit,
 		Application,
 		Contextual,
 		VSync,
+		Sequencer,
 		Assets,
 		StringParameter,
 		Variants,
 		Uniforms,
 		GPUMemory,
+		Memory,
+		Culling,
+		Save,
 		TypeShader,
 		TypeMesh,
 		TypeTexture,
 		TypeMaterial,
 		TypeTime,
-		TypeAppConfig
+		TypeAppConfig,
+		TypeJobs,
+		TypeLods,
+		TypeTangents,
+		TypeObj,
+		TypePool,
+		TypeProfiler
 	};
 
 	class ConsoleCommand : public std::vector<std::string>
@@ -43,16 +56,24 @@ namespace PK::ECS::Engines
 		public:
 			const static std::unordered_map<std::string, CommandArgument> ArgumentMap;
 
-			EngineCommandInput(AssetDatabase* assetDatabase, Sequencer* sequencer, Time* time, EntityDatabase* entityDb, CommandConfig* commandBindings);
+			EngineCommandInput(AssetDatabase* assetDatabase, Sequencer* sequencer, Time* time, JobSystem* jobSystem, EntityDatabase* entityDb, CommandConfig* commandBindings);
 			void Step(Input* input) override;
 
 		private:
 			void ApplicationExit(const ConsoleCommand& arguments);
 			void ApplicationContextual(const ConsoleCommand& arguments);
 			void ApplicationSetVSync(const ConsoleCommand& arguments);
+			void ApplicationSetSequencerMode(const ConsoleCommand& arguments);
+			void ApplicationSetSubmeshCulling(const ConsoleCommand& arguments);
 			void QueryShaderVariants(const ConsoleCommand& arguments);
 			void QueryShaderUniforms(const ConsoleCommand& arguments);
 			void QueryGPUMemory(const ConsoleCommand& arguments);
+			void QueryMemory(const ConsoleCommand& arguments);
+			void QuerySequencerGraph(const ConsoleCommand& arguments);
+			void QueryProfilerTrace(const ConsoleCommand& arguments);
+			void QuerySubmeshCulling(const ConsoleCommand& arguments);
+			void QueryVariantManifest(const ConsoleCommand& arguments);
+			void SaveVariantManifest(const ConsoleCommand& arguments);
 			void ReloadTime(const ConsoleCommand& arguments);
 			void ReloadAppConfig(const ConsoleCommand& arguments);
 			void ReloadShaders(const ConsoleCommand& arguments);
@@ -72,5 +93,6 @@ namespace PK::ECS::Engines
 			AssetDatabase* m_assetDatabase = nullptr;
 			Sequencer* m_sequencer = nullptr;
 			Time* m_time = nullptr;
+			JobSystem* m_jobSystem = nullptr;
 	};
 }
\ No newline at end of file
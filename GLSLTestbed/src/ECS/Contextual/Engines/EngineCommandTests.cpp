@@ -0,0 +1,927 @@
+#include "PrecompiledHeader.h"
+#include "EngineCommandTests.h"
+#include "Core/Profiler.h"
+#include "ECS/Sequencer.h"
+#include "Utilities/StringUtilities.h"
+#include "Rendering/Objects/Shader.h"
+#include "Rendering/Objects/Material.h"
+#include "Rendering/Objects/Mesh.h"
+#include "Rendering/Objects/TextureXD.h"
+#include "Rendering/MeshUtility.h"
+#include "Rendering/ObjReader.h"
+#include "Rendering/ShaderDirectives.h"
+#include "Rendering/Structs/RangeAllocator.h"
+#include <tinyobjloader/tiny_obj_loader.h>
+#include <random>
+#include <sstream>
+
+namespace PK::ECS::Engines::CommandTests
+{
+    using namespace PK::Utilities;
+    using namespace PK::Rendering::Objects;
+
+    struct SequencerBenchmarkToken
+    {
+        uint64_t count = 0ull;
+    };
+
+    class SequencerBenchmarkStep : public IStep<SequencerBenchmarkToken>
+    {
+        public: void Step(SequencerBenchmarkToken* token) override { ++token->count; }
+    };
+
+    // Random but valid obj text: mixed number formats, relative indices, polygons, groups, ignored statements & line endings.
+    static std::string GenerateObj(std::mt19937& random)
+    {
+        auto number = [&random]()
+        {
+            char buffer[32];
+            auto value = ((int)(random() % 2000000u) - 1000000) * 1e-4;
+
+            switch (random() % 5u)
+            {
+                case 0: snprintf(buffer, sizeof(buffer), "%i", (int)value); break;
+                case 1: snprintf(buffer, sizeof(buffer), "%.3e", value); break;
+                case 2: snprintf(buffer, sizeof(buffer), "%.9g", value * 1.2345e-3); break;
+                case 3: snprintf(buffer, sizeof(buffer), "+%.4f", glm::abs(value)); break;
+                default: snprintf(buffer, sizeof(buffer), "%.6f", value); break;
+            }
+
+            return std::string(buffer);
+        };
+
+        auto hasTexcoords = random() % 4u != 0;
+        auto hasNormals = random() % 4u != 0;
+        auto isRelative = random() % 2u == 0;
+        auto newline = random() % 4u == 0 ? "\r\n" : "\n";
+        auto counts = int3(0);
+        std::string text;
+
+        for (auto block = random() % 6u; block < 6u; ++block)
+        {
+            text += random() % 2u ? std::string(random() % 2u ? "g" : "o") + " group" + std::to_string(block) + newline : "";
+            text += random() % 3u ? "" : std::string("# v 1 2 3") + newline;
+
+            for (auto vertexCount = 3u + random() % 20u; vertexCount > 0; --vertexCount)
+            {
+                text += (random() % 6u ? "v " : "  v\t") + number() + " " + number() + " " + number() + (random() % 8u ? "" : " 1.0") + newline;
+                text += hasTexcoords ? "vt " + number() + " " + number() + newline : "";
+                text += hasNormals ? "vn " + number() + " " + number() + " " + number() + newline : "";
+                counts += int3(1, hasTexcoords ? 1 : 0, hasNormals ? 1 : 0);
+            }
+
+            text += random() % 3u ? "" : std::string("usemtl material") + newline + "s 1" + newline + newline;
+
+            for (auto faceCount = random() % 30u; faceCount > 0; --faceCount)
+            {
+                auto index = [&](int count) { auto i = (int)(random() % (uint)count); return std::to_string(isRelative && random() % 2u ? i - count : i + 1); };
+                text += "f";
+
+                for (auto cornerCount = 3u + (random() % 5u ? 0u : random() % 4u); cornerCount > 0; --cornerCount)
+                {
+                    text += " " + index(counts.x);
+                    text += hasTexcoords ? "/" + index(counts.y) : (hasNormals ? "/" : "");
+                    text += hasNormals ? "/" + index(counts.z) : "";
+                }
+
+                text += newline;
+            }
+        }
+
+        return text;
+    }
+
+    // Corner attributes per submesh, corners without a texcoord or normal are zero like in ObjReader.
+    static void FlattenObj(const std::string& text, std::vector<float>& corners, std::vector<uint>& submeshCounts)
+    {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string error;
+        std::istringstream stream(text);
+        tinyobj::LoadObj(&attrib, &shapes, &materials, &error, &stream, nullptr, true);
+
+        for (auto& shape : shapes)
+        {
+            submeshCounts.push_back((uint)shape.mesh.indices.size());
+
+            for (auto& index : shape.mesh.indices)
+            {
+                corners.insert(corners.end(), attrib.vertices.begin() + index.vertex_index * 3, attrib.vertices.begin() + index.vertex_index * 3 + 3);
+                corners.push_back(index.texcoord_index >= 0 ? attrib.texcoords.at(index.texcoord_index * 2 + 0) : 0.0f);
+                corners.push_back(index.texcoord_index >= 0 ? attrib.texcoords.at(index.texcoord_index * 2 + 1) : 0.0f);
+                corners.push_back(index.normal_index >= 0 ? attrib.normals.at(index.normal_index * 3 + 0) : 0.0f);
+                corners.push_back(index.normal_index >= 0 ? attrib.normals.at(index.normal_index * 3 + 1) : 0.0f);
+                corners.push_back(index.normal_index >= 0 ? attrib.normals.at(index.normal_index * 3 + 2) : 0.0f);
+            }
+        }
+    }
+
+    static void FlattenObj(const Rendering::ObjReader::ObjData& data, std::vector<float>& corners, std::vector<uint>& submeshCounts)
+    {
+        for (auto& submesh : data.submeshes)
+        {
+            submeshCounts.push_back(submesh.count);
+        }
+
+        for (auto index : data.indices)
+        {
+            auto& vertex = data.vertices.at(index);
+            corners.insert(corners.end(), { vertex.position.x, vertex.position.y, vertex.position.z, vertex.texcoord.x, vertex.texcoord.y, vertex.normal.x, vertex.normal.y, vertex.normal.z });
+        }
+    }
+
+    // Directives extracted by the sequential token passes that the shader importer made before the directive lexer.
+    struct ShaderDirectivesReference
+    {
+        std::vector<std::vector<std::string>> multiCompiles;
+        std::vector<std::string> states;
+        std::vector<std::pair<std::string, std::string>> instancedProperties;
+        // Type, version & text of each program.
+        std::vector<std::tuple<std::string, std::string, std::string>> programs;
+    };
+
+    static void ExtractShaderDirectives(std::string source, ShaderDirectivesReference& reference)
+    {
+        auto typeToken = "#pragma PROGRAM_";
+        auto typeTokenLength = strlen(typeToken);
+        std::vector<std::string> properties;
+        std::string output;
+        size_t pos = 0;
+
+        while ((pos = Utilities::String::ExtractToken(pos, "#multi_compile ", source, output, false)) != std::string::npos)
+        {
+            reference.multiCompiles.push_back(Utilities::String::Split(output, " "));
+        }
+
+        for (auto token : { "#ZWrite ", "#ZTest ", "#Blend ", "#ColorMask ", "#Cull " })
+        {
+            reference.states.push_back(Utilities::String::ExtractToken(token, source, false));
+        }
+
+        Utilities::String::FindTokens("PK_INSTANCED_PROPERTY", source, properties, true);
+
+        for (auto& property : properties)
+        {
+            auto values = Utilities::String::Split(property, " ;\n\r");
+
+            if (values.size() == 3)
+            {
+                reference.instancedProperties.push_back({ values.at(1), values.at(2) });
+            }
+        }
+
+        pos = source.find(typeToken);
+        auto sharedInclude = pos != std::string::npos ? source.substr(0, pos) : std::string();
+
+        while (pos != std::string::npos)
+        {
+            auto eol = source.find_first_of("\r\n", pos);
+            auto nextLinePos = source.find_first_not_of("\r\n", eol);
+            auto type = source.substr(pos + typeTokenLength, eol - pos - typeTokenLength);
+            pos = source.find(typeToken, nextLinePos);
+            auto text = sharedInclude + (pos == std::string::npos ? source.substr(nextLinePos) : source.substr(nextLinePos, pos - nextLinePos));
+            auto version = Utilities::String::ExtractToken("#version ", text, true);
+            reference.programs.push_back({ type, version, text });
+        }
+    }
+
+    void TestJobSystem(JobSystem* jobSystem)
+    {
+        const uint32_t iterations = 256;
+        const uint32_t elementCount = 65537;
+        std::vector<std::atomic<uint32_t>> visits(elementCount);
+        std::atomic<uint32_t> failures = 0u;
+
+        PK_CORE_LOG_HEADER("Job system stress test (%i threads)", jobSystem->GetThreadCount());
+
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            for (auto& visit : visits)
+            {
+                visit.store(0u, std::memory_order_relaxed);
+            }
+
+            // Odd grain sizes & a nested dispatch per range to exercise stealing & help while waiting.
+            jobSystem->ParallelFor(elementCount, 1u + (i % 97) * 13u, [&](uint32_t begin, uint32_t end)
+            {
+                JobCounter nested;
+                jobSystem->Dispatch([&visits, begin]() { visits[begin].fetch_add(1u, std::memory_order_relaxed); }, &nested);
+
+                for (auto j = begin + 1; j < end; ++j)
+                {
+                    visits[j].fetch_add(1u, std::memory_order_relaxed);
+                }
+
+                jobSystem->Wait(&nested);
+            });
+
+            for (auto& visit : visits)
+            {
+                failures += visit.load(std::memory_order_relaxed) != 1u ? 1u : 0u;
+            }
+
+            // Dependency chain: each stage must observe the full completion of the previous one.
+            std::atomic<uint32_t> completed = 0u;
+            JobCounter stages[4];
+
+            for (auto stage = 0u; stage < 4u; ++stage)
+            {
+                jobSystem->ParallelFor(64u, 1u, [&completed, &failures, stage](uint32_t begin, uint32_t end)
+                {
+                    if (completed.load(std::memory_order_acquire) < stage * 64u)
+                    {
+                        failures.fetch_add(1u, std::memory_order_relaxed);
+                    }
+
+                    completed.fetch_add(1u, std::memory_order_acq_rel);
+                }, &stages[stage], stage > 0 ? &stages[stage - 1] : nullptr);
+            }
+
+            jobSystem->Wait(&stages[3]);
+        }
+
+        if (failures > 0)
+        {
+            PK_CORE_LOG_WARNING("Job system stress test failed with %i errors", failures.load());
+        }
+        else
+        {
+            PK_CORE_LOG("Job system stress test passed %i iterations", iterations);
+        }
+    }
+
+    void TestMeshCompression()
+    {
+        const auto& budget = Rendering::MeshUtility::VertexCompressionBudget;
+
+        PK_CORE_LOG_HEADER("Vertex compression round trip error (budget: position %f, normal %f deg, tangent %f deg, texcoord %f)", budget.position, budget.normal, budget.tangent, budget.texcoord);
+
+        for (const auto& entry : std::filesystem::directory_iterator("res/models"))
+        {
+            if (!AssetImporters::IsValidExtension<Mesh>(entry.path().extension()))
+            {
+                continue;
+            }
+
+            AssetImporters::ImportData<Mesh> data;
+            AssetImporters::Decode(entry.path().generic_string(), data);
+            auto error = Rendering::MeshUtility::GetCompressionError(data.vertexData, (uint)data.vertexCount, data.localBounds);
+
+            auto name = entry.path().filename().string();
+            auto layout = data.isCompressed ? "compressed" : "full precision";
+            PK_CORE_LOG("%s: %i vertices, position %f, normal %f deg, tangent %f deg, texcoord %f -> %s", name.c_str(), (uint)data.vertexCount, error.position, error.normal, error.tangent, error.texcoord, layout);
+        }
+    }
+
+    void TestMeshLods()
+    {
+        using namespace Rendering;
+
+        PK_CORE_LOG_HEADER("Mesh lod chains (a lod must meet its triangle budget or stop within its error bound without adding non manifold edges)");
+
+        for (const auto& entry : std::filesystem::directory_iterator("res/models"))
+        {
+            if (!AssetImporters::IsValidExtension<Mesh>(entry.path().extension()))
+            {
+                continue;
+            }
+
+            AssetImporters::ImportData<Mesh> data;
+            AssetImporters::Decode(entry.path().generic_string(), data);
+
+            const uint stride = sizeof(Structs::Vertex_Full) / 4;
+            auto vertices = reinterpret_cast<const float*>(data.vertexData);
+            auto vcount = (uint)data.vertexCount;
+            auto submeshCount = (uint)data.submeshes.size() / data.lodCount;
+            auto size = data.localBounds.GetExtents() * 2.0f;
+            auto maxSize = glm::max(size.x, glm::max(size.y, size.z));
+            auto name = entry.path().filename().string();
+
+            PK_CORE_LOG("%s: %i lods", name.c_str(), data.lodCount);
+
+            for (auto lod = 1u; lod < data.lodCount; ++lod)
+            {
+                auto baseTriangles = 0u;
+                auto triangles = 0u;
+                auto targetTriangles = 0u;
+                auto maxError = 0.0f;
+                auto isValid = true;
+
+                for (auto i = 0u; i < submeshCount; ++i)
+                {
+                    auto& base = data.submeshes.at(i);
+                    auto& range = data.submeshes.at(lod * submeshCount + i);
+                    auto error = data.lodErrors.at(lod * submeshCount + i);
+                    auto target = (uint)((base.count / 3) * MeshUtility::LodTriangleRatios[lod - 1]);
+                    auto baseTopology = MeshUtility::AnalyzeTopology(vertices, stride, 0, data.indexData + base.offset, base.count, vcount);
+                    auto topology = MeshUtility::AnalyzeTopology(vertices, stride, 0, data.indexData + range.offset, range.count, vcount);
+
+                    isValid &= range.count / 3 <= target || error <= maxSize * MeshUtility::LodErrorRatios[lod - 1];
+                    isValid &= topology.nonManifoldEdges <= baseTopology.nonManifoldEdges;
+                    isValid &= topology.degenerateTriangles == 0;
+
+                    for (auto j = 0u; j < range.count; ++j)
+                    {
+                        isValid &= data.indexData[range.offset + j] < vcount;
+                    }
+
+                    baseTriangles += base.count / 3;
+                    triangles += range.count / 3;
+                    targetTriangles += target;
+                    maxError = glm::max(maxError, error);
+                }
+
+                PK_CORE_LOG("    lod %i: %i / %i triangles (budget %i), error %f -> %s", lod, triangles, baseTriangles, targetTriangles, maxError, isValid ? "passed" : "failed");
+            }
+        }
+    }
+
+    void TestObjReader(JobSystem* jobSystem)
+    {
+        const uint corpusSize = 2000u;
+        const uint mutationCount = 20000u;
+        std::mt19937 random(42u);
+        std::string concatenated;
+        auto mismatches = 0u;
+        auto failures = 0u;
+
+        PK_CORE_LOG_HEADER("Obj reader test (%i generated files compared to tinyobjloader, %i mutated files)", corpusSize, mutationCount);
+
+        for (auto i = 0u; i < corpusSize; ++i)
+        {
+            auto text = GenerateObj(random);
+            concatenated += text + "\n";
+
+            Rendering::ObjReader::ObjData data;
+            std::string error;
+            std::vector<float> expected, corners;
+            std::vector<uint> expectedCounts, counts;
+
+            if (!Rendering::ObjReader::Parse(text.data(), text.size(), nullptr, data, error))
+            {
+                failures++;
+                continue;
+            }
+
+            FlattenObj(text, expected, expectedCounts);
+            FlattenObj(data, corners, counts);
+            mismatches += expected != corners || expectedCounts != counts ? 1u : 0u;
+        }
+
+        // Absolute indices stay in range when files are concatenated, the result spans many chunks & must not depend on the thread count.
+        Rendering::ObjReader::ObjData serial, parallel;
+        std::string error;
+        std::vector<float> expected, serialCorners, parallelCorners;
+        std::vector<uint> expectedCounts, serialCounts, parallelCounts;
+        failures += Rendering::ObjReader::Parse(concatenated.data(), concatenated.size(), nullptr, serial, error) ? 0u : 1u;
+        failures += Rendering::ObjReader::Parse(concatenated.data(), concatenated.size(), jobSystem, parallel, error) ? 0u : 1u;
+        FlattenObj(concatenated, expected, expectedCounts);
+        FlattenObj(serial, serialCorners, serialCounts);
+        FlattenObj(parallel, parallelCorners, parallelCounts);
+        mismatches += expected != serialCorners || expectedCounts != serialCounts ? 1u : 0u;
+        mismatches += serialCorners != parallelCorners || serial.indices != parallel.indices ? 1u : 0u;
+
+        // Mutated files must either be rejected or produce in range indices & contiguous submeshes.
+        auto rejected = 0u;
+        auto invalid = 0u;
+
+        for (auto i = 0u; i < mutationCount; ++i)
+        {
+            auto text = GenerateObj(random);
+
+            for (auto mutation = random() % 4u; mutation < 4u && !text.empty(); ++mutation)
+            {
+                auto position = random() % text.size();
+
+                switch (random() % 4u)
+                {
+                    case 0: text[position] = "0123456789/-+.eE \t\n\rvfgo#"[random() % 26u]; break;
+                    case 1: text.erase(position, 1u + random() % 8u); break;
+                    case 2: text.insert(position, 1u + random() % 3u, "/-9 \n"[random() % 5u]); break;
+                    default: text.resize(position); break;
+                }
+            }
+
+            Rendering::ObjReader::ObjData data;
+
+            if (!Rendering::ObjReader::Parse(text.data(), text.size(), nullptr, data, error))
+            {
+                rejected++;
+                continue;
+            }
+
+            auto offset = 0u;
+
+            for (auto& submesh : data.submeshes)
+            {
+                invalid += submesh.offset != offset || submesh.count == 0 || submesh.count % 3 != 0 ? 1u : 0u;
+                offset += submesh.count;
+            }
+
+            for (auto index : data.indices)
+            {
+                invalid += index >= data.vertices.size() ? 1u : 0u;
+            }
+
+            invalid += offset != data.indices.size() ? 1u : 0u;
+        }
+
+        if (mismatches > 0 || failures > 0 || invalid > 0)
+        {
+            PK_CORE_LOG_WARNING("Obj reader test failed: %i mismatches, %i valid files rejected, %i invalid results", mismatches, failures, invalid);
+        }
+        else
+        {
+            PK_CORE_LOG("Obj reader test passed, %i of %i mutated files rejected", rejected, mutationCount);
+        }
+    }
+
+    void TestRangeAllocator()
+    {
+        const uint iterations = 200000u;
+        std::mt19937 random(7u);
+        Rendering::Structs::RangeAllocator allocator(4096u);
+        // Stands in for the pool buffers, every element holds the handle of the range it belongs to.
+        std::vector<uint> storage(allocator.GetCapacity(), ~0u);
+        std::vector<Rendering::Structs::RangeAllocator::Move> moves;
+        std::vector<uint> handles;
+        auto failures = 0u;
+        auto compactions = 0u;
+        auto maxFreeRanges = 0u;
+
+        PK_CORE_LOG_HEADER("Range allocator test (%i random allocations & releases)", iterations);
+
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            if (random() % 2u == 0u)
+            {
+                auto count = 1u + random() % 256u;
+                auto handle = allocator.Allocate(count);
+
+                // Same policy as the geometry pool, compact when the free ranges are fragmented & double the capacity otherwise.
+                if (handle == Rendering::Structs::RangeAllocator::InvalidHandle)
+                {
+                    auto capacity = allocator.GetFreeCount() >= count ? allocator.GetCapacity() : allocator.GetCapacity() * 2u;
+                    allocator.Compact(moves);
+                    allocator.Grow(capacity);
+
+                    std::vector<uint> compacted(allocator.GetCapacity(), ~0u);
+
+                    for (auto& move : moves)
+                    {
+                        std::copy(storage.begin() + move.source, storage.begin() + move.source + move.count, compacted.begin() + move.destination);
+                    }
+
+                    storage.swap(compacted);
+                    handle = allocator.Allocate(count);
+                    compactions++;
+                }
+
+                if (handle == Rendering::Structs::RangeAllocator::InvalidHandle)
+                {
+                    failures++;
+                    continue;
+                }
+
+                auto range = allocator.GetRange(handle);
+
+                for (auto j = range.offset; j < range.offset + range.count; ++j)
+                {
+                    failures += storage.at(j) != ~0u ? 1u : 0u;
+                    storage.at(j) = handle;
+                }
+
+                handles.push_back(handle);
+            }
+            else if (!handles.empty())
+            {
+                auto index = random() % (uint)handles.size();
+                auto handle = handles.at(index);
+                auto range = allocator.GetRange(handle);
+
+                for (auto j = range.offset; j < range.offset + range.count; ++j)
+                {
+                    failures += storage.at(j) != handle ? 1u : 0u;
+                    storage.at(j) = ~0u;
+                }
+
+                allocator.Free(handle);
+                handles.at(index) = handles.back();
+                handles.pop_back();
+            }
+
+            maxFreeRanges = glm::max(maxFreeRanges, allocator.GetFreeRangeCount());
+            failures += i % 64u == 0 && !allocator.Validate() ? 1u : 0u;
+        }
+
+        for (auto handle : handles)
+        {
+            auto range = allocator.GetRange(handle);
+            failures += (uint)std::count_if(storage.begin() + range.offset, storage.begin() + range.offset + range.count, [handle](uint value) { return value != handle; });
+        }
+
+        failures += allocator.Validate() && allocator.GetAllocationCount() == handles.size() ? 0u : 1u;
+
+        if (failures > 0)
+        {
+            PK_CORE_LOG_WARNING("Range allocator test failed with %i errors", failures);
+        }
+        else
+        {
+            PK_CORE_LOG("Range allocator test passed: capacity %i, %i live ranges, %i compactions, at most %i free ranges", allocator.GetCapacity(), (uint)handles.size(), compactions, maxFreeRanges);
+        }
+    }
+
+    void TestShaderDirectives()
+    {
+        auto fileCount = 0u;
+        auto mismatches = 0u;
+
+        PK_CORE_LOG_HEADER("Shader directive lexer test (res/shaders compared to sequential token extraction)");
+
+        for (const auto& entry : std::filesystem::directory_iterator("res/shaders"))
+        {
+            if (!AssetImporters::IsValidExtension<Shader>(entry.path().extension()))
+            {
+                continue;
+            }
+
+            auto source = Utilities::String::ReadFileRecursiveInclude(entry.path().generic_string());
+            Rendering::ShaderDirectives::Header header;
+            Rendering::ShaderDirectives::Lex(source, header);
+
+            ShaderDirectivesReference reference;
+            ExtractShaderDirectives(source, reference);
+
+            std::vector<std::string> states = { header.zwrite, header.ztest, header.blend, header.colorMask, header.cull };
+            std::vector<std::tuple<std::string, std::string, std::string>> programs;
+
+            for (auto& program : header.programs)
+            {
+                std::string text;
+                Rendering::ShaderDirectives::GetProgramText(source, header, program, text);
+                programs.push_back({ program.type, source.substr(program.version.offset, program.version.count), text });
+            }
+
+            fileCount++;
+
+            if (reference.multiCompiles != header.multiCompiles || reference.states != states || reference.instancedProperties != header.instancedProperties || reference.programs != programs)
+            {
+                PK_CORE_LOG_WARNING("Directive mismatch in %s", entry.path().filename().string().c_str());
+                mismatches++;
+            }
+        }
+
+        if (mismatches > 0)
+        {
+            PK_CORE_LOG_WARNING("Shader directive lexer test failed: %i of %i files differ", mismatches, fileCount);
+        }
+        else
+        {
+            PK_CORE_LOG("Shader directive lexer test passed, %i files", fileCount);
+        }
+    }
+
+    void BenchmarkJobSystem()
+    {
+        const uint32_t elementCount = 1u << 22u;
+        const uint32_t iterations = 16u;
+        std::vector<float> values(elementCount);
+        auto maxWorkers = std::max(1u, std::thread::hardware_concurrency()) - 1u;
+        auto baseline = 0.0;
+
+        PK_CORE_LOG_HEADER("Job system scaling benchmark (%i elements, %i iterations)", elementCount, iterations);
+
+        for (auto workers = 0u; workers <= maxWorkers; workers = workers == 0 ? 1u : workers * 2u)
+        {
+            JobSystem jobSystem((int)workers);
+            auto start = std::chrono::steady_clock::now();
+
+            for (auto i = 0u; i < iterations; ++i)
+            {
+                jobSystem.ParallelFor(elementCount, 4096u, [&values, i](uint32_t begin, uint32_t end)
+                {
+                    for (auto j = begin; j < end; ++j)
+                    {
+                        values[j] = sqrtf((float)(j ^ i)) * sinf((float)j);
+                    }
+                });
+            }
+
+            auto milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+            baseline = workers == 0 ? milliseconds : baseline;
+            PK_CORE_LOG("Threads: %2i, %8.3f ms, speedup: %4.2fx", workers + 1, milliseconds, baseline / milliseconds);
+        }
+    }
+
+    void BenchmarkTangents()
+    {
+        using namespace Rendering;
+
+        const uint iterations = 4u;
+        const uint stride = sizeof(Structs::Vertex_Full) / 4;
+        auto maxWorkers = std::max(1u, std::thread::hardware_concurrency()) - 1u;
+
+        PK_CORE_LOG_HEADER("Tangent generation benchmark (%i iterations, results must be bitwise identical to the single threaded mikktspace pass)", iterations);
+
+        for (const auto& entry : std::filesystem::directory_iterator("res/models"))
+        {
+            if (!AssetImporters::IsValidExtension<Mesh>(entry.path().extension()))
+            {
+                continue;
+            }
+
+            AssetImporters::ImportData<Mesh> data;
+            AssetImporters::Decode(entry.path().generic_string(), data);
+
+            // Same input as the importer, imported vertices are split by tangent. Lods are skipped, they follow the full detail submeshes.
+            auto& lastSubmesh = data.submeshes.at(data.submeshes.size() / data.lodCount - 1);
+            auto icount = lastSubmesh.offset + lastSubmesh.count;
+            std::vector<Structs::Vertex_Full> vertices(data.vertexData, data.vertexData + data.vertexCount);
+            std::vector<uint> indices(data.indexData, data.indexData + icount);
+
+            for (auto& vertex : vertices)
+            {
+                vertex.tangent = PK_FLOAT4_ZERO;
+            }
+
+            auto vcount = MeshUtility::WeldVertices(reinterpret_cast<float*>(vertices.data()), stride, indices.data(), (uint)vertices.size(), icount);
+            std::vector<float4> reference(icount);
+            std::vector<float4> tangents(icount);
+
+            auto start = std::chrono::steady_clock::now();
+
+            for (auto i = 0u; i < iterations; ++i)
+            {
+                MeshUtility::CalculateTangents(vertices.data(), stride, 0, 3, 10, indices.data(), reference.data(), vcount, icount);
+            }
+
+            auto baseline = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+            auto name = entry.path().filename().string();
+            PK_CORE_LOG("%s: %i triangles, mikktspace: %8.3f ms", name.c_str(), icount / 3, baseline);
+
+            for (auto workers = 0u; workers <= maxWorkers; workers = workers == 0 ? 1u : workers * 2u)
+            {
+                JobSystem jobSystem((int)workers);
+                start = std::chrono::steady_clock::now();
+
+                for (auto i = 0u; i < iterations; ++i)
+                {
+                    MeshUtility::CalculateTangents(&jobSystem, vertices.data(), stride, 0, 3, 10, indices.data(), tangents.data(), vcount, icount);
+                }
+
+                auto milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+                auto isIdentical = memcmp(reference.data(), tangents.data(), sizeof(float4) * icount) == 0;
+                PK_CORE_LOG("    Threads: %2i, %8.3f ms, speedup: %4.2fx -> %s", workers + 1, milliseconds, baseline / milliseconds, isIdentical ? "identical" : "mismatch");
+            }
+        }
+    }
+
+    void BenchmarkObjReader(JobSystem* jobSystem)
+    {
+        const uint iterations = 4u;
+
+        PK_CORE_LOG_HEADER("Obj reader benchmark (%i iterations, %i threads)", iterations, jobSystem->GetThreadCount());
+
+        for (const auto& entry : std::filesystem::directory_iterator("res/models"))
+        {
+            if (!AssetImporters::IsValidExtension<Mesh>(entry.path().extension()))
+            {
+                continue;
+            }
+
+            auto filepath = entry.path().generic_string();
+            auto start = std::chrono::steady_clock::now();
+
+            for (auto i = 0u; i < iterations; ++i)
+            {
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                std::vector<tinyobj::material_t> materials;
+                std::string error;
+                tinyobj::LoadObj(&attrib, &shapes, &materials, &error, filepath.c_str(), nullptr, true);
+            }
+
+            auto baseline = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+            double milliseconds[2];
+
+            for (auto j = 0u; j < 2u; ++j)
+            {
+                start = std::chrono::steady_clock::now();
+
+                for (auto i = 0u; i < iterations; ++i)
+                {
+                    Rendering::ObjReader::ObjData data;
+                    std::string error;
+                    Rendering::ObjReader::Read(filepath, j == 0 ? nullptr : jobSystem, data, error);
+                }
+
+                milliseconds[j] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+            }
+
+            auto name = entry.path().filename().string();
+            PK_CORE_LOG("%s: tinyobjloader %8.3f ms, reader %8.3f ms (%4.2fx), parallel %8.3f ms (%4.2fx)", name.c_str(), baseline, milliseconds[0], baseline / milliseconds[0], milliseconds[1], baseline / milliseconds[1]);
+        }
+    }
+
+    void BenchmarkShaderPreprocess()
+    {
+        const uint iterations = 4u;
+        std::vector<std::string> filepaths;
+
+        for (const auto& entry : std::filesystem::directory_iterator("res/shaders"))
+        {
+            if (AssetImporters::IsValidExtension<Shader>(entry.path().extension()))
+            {
+                filepaths.push_back(entry.path().generic_string());
+            }
+        }
+
+        PK_CORE_LOG_HEADER("Shader preprocess benchmark (%i shaders, %i iterations)", (uint)filepaths.size(), iterations);
+
+        // Cold reads refill the include cache from disk, warm reads only check the file timestamps.
+        double readMilliseconds[2];
+
+        for (auto j = 0u; j < 2u; ++j)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (auto i = 0u; i < iterations; ++i)
+            {
+                if (j == 0)
+                {
+                    Utilities::String::ClearIncludeCache();
+                }
+
+                for (auto& filepath : filepaths)
+                {
+                    Utilities::String::ReadFileRecursiveInclude(filepath);
+                }
+            }
+
+            readMilliseconds[j] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+        }
+
+        std::unordered_set<size_t> stageHashes;
+        std::unordered_set<size_t> programHashes;
+        std::unordered_map<GLenum, std::string> sources;
+        auto variantCount = 0u;
+        auto stageCount = 0u;
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto& filepath : filepaths)
+        {
+            AssetImporters::ImportData<Shader> data;
+            AssetImporters::Decode(filepath, data);
+
+            for (auto i = 0u; i < data.variantMap.variantcount; ++i)
+            {
+                data.source->GetVariantSources(i, sources);
+                programHashes.insert(ShaderSource::GetProgramHash(sources));
+                variantCount++;
+
+                for (auto& kv : sources)
+                {
+                    stageHashes.insert(ShaderSource::GetStageHash(kv.first, kv.second));
+                    stageCount++;
+                }
+            }
+        }
+
+        auto preprocessMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        PK_CORE_LOG("Read (cold cache): %8.3f ms", readMilliseconds[0]);
+        PK_CORE_LOG("Read (warm cache): %8.3f ms", readMilliseconds[1]);
+        PK_CORE_LOG("Decode & preprocess all variants: %8.3f ms", preprocessMilliseconds);
+        PK_CORE_LOG("%i variants, %i programs, %i stage sources of which %i unique", variantCount, (uint)programHashes.size(), stageCount, (uint)stageHashes.size());
+    }
+
+    void BenchmarkSequencer()
+    {
+        const uint32_t iterations = 1000000u;
+        Sequencer sequencer;
+        SequencerBenchmarkStep steps[4];
+        SequencerBenchmarkToken token;
+        auto engine = 0;
+
+        sequencer.SetSteps({ { &engine, { &steps[0], &steps[1], &steps[2], &steps[3] } } });
+
+        PK_CORE_LOG_HEADER("Sequencer benchmark (%i Next calls, %i steps)", iterations, 4);
+
+        auto handle = sequencer.GetHandle<SequencerBenchmarkToken>(&engine, 0);
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            sequencer.Next(handle, &token);
+        }
+
+        auto handleMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            sequencer.Next(&engine, &token, 0);
+        }
+
+        auto lookupMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        PK_CORE_LOG("Pre-resolved handle: %8.3f ms, %6.2f ns per call", handleMilliseconds, handleMilliseconds * 1e6 / iterations);
+        PK_CORE_LOG("Engine lookup:       %8.3f ms, %6.2f ns per call", lookupMilliseconds, lookupMilliseconds * 1e6 / iterations);
+        PK_CORE_LOG("Steps invoked: %llu", token.count);
+    }
+
+    void BenchmarkProfiler()
+    {
+        const uint32_t iterations = 1000000u;
+        volatile uint32_t counter = 0u;
+
+        PK_CORE_LOG_HEADER("Profiler benchmark (%i scopes)", iterations);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            counter = counter + 1u;
+        }
+
+        auto baselineMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            PK_PROFILE_SCOPE("ProfilerBenchmark");
+            counter = counter + 1u;
+        }
+
+        auto scopeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        auto overhead = (scopeMilliseconds - baselineMilliseconds) * 1e6 / iterations;
+
+        PK_CORE_LOG("Baseline: %8.3f ms", baselineMilliseconds);
+        PK_CORE_LOG("Scoped:   %8.3f ms, %6.2f ns overhead per scope", scopeMilliseconds, overhead);
+
+        if (overhead > 50.0)
+        {
+            PK_CORE_LOG_WARNING("Scope overhead exceeds the 50 ns budget!");
+        }
+    }
+
+    // Times exact & substring lookups against the names of the already loaded assets of one type.
+    // Registering synthetic assets would grow the global string id table for the rest of the session.
+    template<typename T>
+    static void BenchmarkAssetFindOfType(const AssetDatabase* assetDatabase, const char* typeName, uint32_t lookupCount)
+    {
+        std::vector<T*> assets;
+        std::vector<std::string> names;
+        assetDatabase->GetAssetsOfType<T>(assets);
+
+        for (auto asset : assets)
+        {
+            names.push_back(Utilities::String::ReadFileName(asset->GetFileName()));
+        }
+
+        if (names.empty())
+        {
+            PK_CORE_LOG("%-10s no loaded assets", typeName);
+            return;
+        }
+
+        auto found = 0u;
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < lookupCount; ++i)
+        {
+            found += assetDatabase->TryFind<T>(names.at((i * 7919u) % names.size()).c_str()) != nullptr;
+        }
+
+        auto indexedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < lookupCount; ++i)
+        {
+            found += assetDatabase->TryFindContaining<T>(names.at((i * 7919u) % names.size()).c_str()) != nullptr;
+        }
+
+        auto linearMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        PK_CORE_LOG("%-10s %6i assets, indexed %10.2f ns, substring %10.2f ns per lookup, found %i / %i",
+            typeName,
+            (int)names.size(),
+            indexedMilliseconds * 1e6 / lookupCount,
+            linearMilliseconds * 1e6 / lookupCount,
+            found,
+            lookupCount * 2);
+    }
+
+    void BenchmarkAssetFind(const AssetDatabase* assetDatabase)
+    {
+        const uint32_t lookupCount = 10000u;
+
+        PK_CORE_LOG_HEADER("Asset find benchmark (%i lookups per type)", lookupCount);
+        BenchmarkAssetFindOfType<Shader>(assetDatabase, "Shader", lookupCount);
+        BenchmarkAssetFindOfType<Material>(assetDatabase, "Material", lookupCount);
+        BenchmarkAssetFindOfType<Mesh>(assetDatabase, "Mesh", lookupCount);
+        BenchmarkAssetFindOfType<TextureXD>(assetDatabase, "Texture", lookupCount);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "PrecompiledHeader.h"
+#include "Core/JobSystem.h"
+#include "Core/AssetDataBase.h"
+
+// Self checks & benchmarks for engine subsystems. Run from the console through EngineCommandInput ("test ..." & "benchmark ...").
+namespace PK::ECS::Engines::CommandTests
+{
+	using namespace PK::Core;
+
+	void TestJobSystem(JobSystem* jobSystem);
+	void TestMeshCompression();
+	void TestMeshLods();
+	void TestObjReader(JobSystem* jobSystem);
+	void TestRangeAllocator();
+	void TestShaderDirectives();
+	void BenchmarkJobSystem();
+	void BenchmarkTangents();
+	void BenchmarkObjReader(JobSystem* jobSystem);
+	void BenchmarkShaderPreprocess();
+	void BenchmarkSequencer();
+	void BenchmarkProfiler();
+	void BenchmarkAssetFind(const AssetDatabase* assetDatabase);
+}
@@ -14,7 +14,7 @@ namespace PK::ECS::Engines
 	using namespace PK::Rendering::Structs;
 	using namespace PK::Math;
 
-	static EGID CreateMeshRenderable(EntityDatabase* entityDb, const float3& position, const float3& rotation, float size, Mesh* mesh, Material* material, bool castShadows = true)
+	static EGID CreateMeshRenderable(EntityDatabase* entityDb, const float3& position, const float3& rotation, float size, const AssetHandle<Mesh>& mesh, Material* material, bool castShadows = true, bool isStatic = false)
 	{
 		auto egid = EGID(entityDb->ReserveEntityId(), (uint)ENTITY_GROUPS::ACTIVE);
 		auto implementer = entityDb->ResereveImplementer<Implementers::MeshRenderableImplementer>();
@@ -30,9 +30,9 @@ namespace PK::ECS::Engines
 		meshView->mesh = static_cast<Components::MeshReference*>(implementer);
 		meshView->transform = static_cast<Components::Transform*>(implementer);
 	
-		implementer->localAABB = mesh->GetLocalBounds();
+		implementer->localAABB = mesh.Get()->GetLocalBounds();
+		implementer->submeshLocalAABBs = mesh.Get()->GetSubmeshBounds();
 		implementer->isCullable = true;
-		implementer->isVisible = false;
 		implementer->position = position;
 		implementer->rotation = glm::quat(rotation * PK_FLOAT_DEG2RAD);
 		implementer->scale = PK_FLOAT3_ONE * size;
@@ -48,6 +48,11 @@ namespace PK::ECS::Engines
 			implementer->flags = Components::RenderHandleFlags::Renderer;
 		}
 
+		if (isStatic)
+		{
+			implementer->flags = implementer->flags | Components::RenderHandleFlags::Static;
+		}
+
 		return egid;
 	}
 	
@@ -115,15 +120,17 @@ namespace PK::ECS::Engines
 		m_assetDatabase = assetDatabase;
 	
 		//meshCube = MeshUtilities::GetBox(PK_FLOAT3_ZERO, { 10.0f, 0.5f, 10.0f });
-		auto buildingsMesh = assetDatabase->Load<Mesh>("res/models/Buildings.mdl");
-		auto spiralMesh = assetDatabase->Load<Mesh>("res/models/Spiral.mdl");
-		auto clothMesh = assetDatabase->Load<Mesh>("res/models/Cloth.mdl");
-		//auto treeMesh = assetDatabase->Load<Mesh>("res/models/Tree.mdl");
-		auto columnMesh = assetDatabase->Load<Mesh>("res/models/Columns.mdl");
+		// Streamed in the background, renderables use the placeholder mesh until then. Requests without handles are dropped.
+		auto buildingsMesh = assetDatabase->RequestLoad<Mesh>("res/models/Buildings.mdl");
+		auto spiralMesh = assetDatabase->RequestLoad<Mesh>("res/models/Spiral.mdl");
+		auto clothMesh = assetDatabase->RequestLoad<Mesh>("res/models/Cloth.mdl");
+		//auto treeMesh = assetDatabase->RequestLoad<Mesh>("res/models/Tree.mdl");
+		auto columnMesh = assetDatabase->RequestLoad<Mesh>("res/models/Columns.mdl", 1);
 
 		auto sphereMesh = assetDatabase->RegisterProcedural<Mesh>("Primitive_Sphere", Rendering::MeshUtility::GetSphere(PK_FLOAT3_ZERO, 1.0f));
 		auto planeMesh = assetDatabase->RegisterProcedural<Mesh>("Primitive_Plane16x16", Rendering::MeshUtility::GetPlane(PK_FLOAT2_ZERO, PK_FLOAT2_ONE, { 16, 16 }));
 		auto oceanMesh = assetDatabase->RegisterProcedural<Mesh>("Primitive_Plane128x128", Rendering::MeshUtility::GetPlane(PK_FLOAT2_ZERO, PK_FLOAT2_ONE * 5.0f, { 128, 128 }));
+		auto sphereGridMesh = assetDatabase->RegisterProcedural<Mesh>("Primitive_SphereGrid8x8", Rendering::MeshUtility::GetSphereGrid(PK_FLOAT3_ZERO, 1.0f, 4.0f, { 8, 8 }));
 	
 		auto materialMetal = assetDatabase->Load<Material>("res/materials/M_Metal_Panel.material");
 		auto materialCloth = assetDatabase->Load<Material>("res/materials/M_Cloth.material");
@@ -140,11 +147,11 @@ namespace PK::ECS::Engines
 
 		srand(config->RandomSeed);
 
-		CreateMeshRenderable(entityDb, float3(0,-5,0), { 90, 0, 0 }, 80.0f, planeMesh, materialSand);
+		CreateMeshRenderable(entityDb, float3(0,-5,0), { 90, 0, 0 }, 80.0f, planeMesh, materialSand, true, true);
 
 		//CreateMeshRenderable(entityDb, float3(0, -5, 0), { 0, 0, 0 }, 1.0f, buildingsMesh, materialAsphalt);
 
-		CreateMeshRenderable(entityDb, float3(-20, 5, -20), { 0, 0, 0 }, 3.0f, columnMesh, materialAsphalt);
+		m_pendingBounds.push_back(CreateMeshRenderable(entityDb, float3(-20, 5, -20), { 0, 0, 0 }, 3.0f, columnMesh, materialAsphalt, true, true));
 
 		//CreateMeshRenderable(entityDb, float3(-25, -7.5f, 0), { 0, 90, 0 }, 1.0f, spiralMesh, materialAsphalt);
 
@@ -153,15 +160,27 @@ namespace PK::ECS::Engines
 		//CreateMeshRenderable(entityDb, float3( 55, 7, -15), { 90, 0, 0 }, 3.0f, oceanMesh, materialWater, false);
 
 		//CreateMeshRenderable(entityDb, float3( -35, -5, -30), { 0, 0, 0 }, 2.0f, treeMesh, materialAsphalt, true);
+
+		// Multi material props for submesh culling ("query culling"). Dynamic, as static batches are culled per batch.
+		for (auto i = 0; i < 4; ++i)
+		{
+			auto egid = CreateMeshRenderable(entityDb, float3(i % 2 ? 40 : -40, -3, i / 2 ? 40 : -40), { 0, 0, 0 }, 1.0f, sphereGridMesh, materialMetal);
+			auto materials = entityDb->Query<EntityViews::MeshRenderable>(egid)->materials;
+
+			for (auto j = 1u; j < sphereGridMesh->GetSubmeshCount(); ++j)
+			{
+				materials->sharedMaterials.push_back(j % 2 ? materialGravel : materialMetal);
+			}
+		}
 		
 		for (auto i = 0; i < 320; ++i)
 		{
-			CreateMeshRenderable(entityDb, Functions::RandomRangeFloat3(minpos, maxpos), Functions::RandomEuler(), 1.0f, sphereMesh, materialMetal);
+			CreateMeshRenderable(entityDb, Functions::RandomRangeFloat3(minpos, maxpos), Functions::RandomEuler(), 1.0f, sphereMesh, materialMetal, true, true);
 		}
 	
 		for (auto i = 0; i < 320; ++i)
 		{
-			CreateMeshRenderable(entityDb, Functions::RandomRangeFloat3(minpos, maxpos), Functions::RandomEuler(), 1.0f, sphereMesh, materialGravel);
+			CreateMeshRenderable(entityDb, Functions::RandomRangeFloat3(minpos, maxpos), Functions::RandomEuler(), 1.0f, sphereMesh, materialGravel, true, true);
 		}
 	
 		bool flipperinotyperino = false;
@@ -180,6 +199,21 @@ namespace PK::ECS::Engines
 	
 	void EngineDebug::Step(int condition)
 	{
+		// Bounds of streamed meshes are known once they are resident.
+		for (auto i = 0; i < (int)m_pendingBounds.size(); ++i)
+		{
+			auto egid = m_pendingBounds.at(i);
+			auto mesh = m_entityDb->Query<EntityViews::MeshRenderable>(egid)->mesh;
+
+			if (mesh->sharedMesh.IsResident())
+			{
+				auto bounds = m_entityDb->Query<EntityViews::BaseRenderable>(egid)->bounds;
+				bounds->localAABB = mesh->sharedMesh.Get()->GetLocalBounds();
+				bounds->submeshLocalAABBs = mesh->sharedMesh.Get()->GetSubmeshBounds();
+				m_pendingBounds.erase(m_pendingBounds.begin() + i--);
+			}
+		}
+
 		auto lights = m_entityDb->Query<EntityViews::LightSphere>((int)ENTITY_GROUPS::ACTIVE);
 		auto time = Application::GetService<Time>()->GetTime();
 	
@@ -203,6 +237,12 @@ namespace PK::ECS::Engines
 		}
 	}
 	
+	void EngineDebug::GetStepAccess(int condition, StepAccess* access) const
+	{
+		// Resolves streamed mesh handles, the asset database & entity database are modified by main thread steps outside of this graph. Kept on the main thread.
+		access->Read<Time>().Read<AssetDatabase>().Read<EntityDatabase>().Write<Components::Transform>().Write<Components::Bounds>();
+	}
+
 	void EngineDebug::Step(Rendering::GizmoRenderer* gizmos)
 	{
 		auto time = Application::GetService<Time>()->GetTime();
@@ -14,15 +14,17 @@ namespace PK::ECS::Engines
 	using namespace PK::Utilities;
 	using namespace PK::Rendering::Objects;
 
-	class EngineDebug : public IService, public ISimpleStep, public IStep<Rendering::GizmoRenderer>
+	class EngineDebug : public IService, public ISimpleStep, public IStepAccess, public IStep<Rendering::GizmoRenderer>
 	{
 		public:
 			EngineDebug(AssetDatabase* assetDatabase, EntityDatabase* entityDb, const ApplicationConfig* config);
 			void Step(int condition) override;
 			void Step(Rendering::GizmoRenderer* gizmos) override;
+			void GetStepAccess(int condition, StepAccess* access) const override;
 	
 		private:
 			EntityDatabase* m_entityDb;
 			AssetDatabase* m_assetDatabase;
+			std::vector<EGID> m_pendingBounds;
 	};
 }
\ No newline at end of file
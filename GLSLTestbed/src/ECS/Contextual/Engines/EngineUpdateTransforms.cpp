@@ -11,6 +11,11 @@ namespace PK::ECS::Engines
         m_entityDb = entityDb;
     }
     
+    void EngineUpdateTransforms::GetStepAccess(int condition, StepAccess* access) const
+    {
+        access->Read<Components::Transform>().Write<Components::Transform>().Write<Components::Bounds>().ThreadSafe();
+    }
+
     void EngineUpdateTransforms::Step(int condition)
     {
         auto views = m_entityDb->Query<EntityViews::TransformView>((int)ENTITY_GROUPS::ACTIVE);
@@ -21,6 +26,12 @@ namespace PK::ECS::Engines
             view->transform->localToWorld = view->transform->GetLocalToWorld();
             view->transform->worldToLocal = glm::inverse(view->transform->localToWorld);
             view->bounds->worldAABB = Functions::BoundsTransform(view->transform->localToWorld, view->bounds->localAABB);
+            view->bounds->submeshWorldAABBs.resize(view->bounds->submeshLocalAABBs.size());
+
+            for (auto j = 0u; j < view->bounds->submeshLocalAABBs.size(); ++j)
+            {
+                view->bounds->submeshWorldAABBs.at(j) = Functions::BoundsTransform(view->transform->localToWorld, view->bounds->submeshLocalAABBs.at(j));
+            }
         }
     }
 }
\ No newline at end of file
@@ -5,11 +5,12 @@
 
 namespace PK::ECS::Engines
 {
-	class EngineUpdateTransforms : public IService, public ISimpleStep
+	class EngineUpdateTransforms : public IService, public ISimpleStep, public IStepAccess
 	{
 		public:
 			EngineUpdateTransforms(EntityDatabase* entityDb);
 			void Step(int condition) override;
+			void GetStepAccess(int condition, StepAccess* access) const override;
 		
 		private:
 			EntityDatabase* m_entityDb = nullptr;
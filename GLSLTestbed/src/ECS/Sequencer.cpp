@@ -1,5 +1,6 @@
 #include "PrecompiledHeader.h"
 #include "ECS/Sequencer.h"
+#include "Utilities/Log.h"
 
 namespace PK::ECS
 {
@@ -17,21 +18,383 @@ namespace PK::ECS
         return &m_branchSteps.at(condition);
     }
 
+    const std::type_index* StepAccess::GetConflict(const StepAccess& other) const
+    {
+        for (auto& write : writes)
+        {
+            for (auto& read : other.reads)
+            {
+                if (write == read)
+                {
+                    return &write;
+                }
+            }
+
+            for (auto& otherWrite : other.writes)
+            {
+                if (write == otherWrite)
+                {
+                    return &write;
+                }
+            }
+        }
+
+        for (auto& otherWrite : other.writes)
+        {
+            for (auto& read : reads)
+            {
+                if (otherWrite == read)
+                {
+                    return &otherWrite;
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
     void Sequencer::SetSteps(std::initializer_list<Steps::value_type> steps)
     {
+        JoinPipelinedStep();
         m_steps = Steps(steps);
+
+        {
+            std::lock_guard<std::mutex> lock(m_dispatchLock);
+
+            for (auto& kv : m_dispatches)
+            {
+                BuildDispatch(kv.second.get());
+            }
+        }
+
+        BuildRootGraphs();
     }
 
     void Sequencer::SetRootSequence(std::initializer_list<int> sequence)
     {
+        JoinPipelinedStep();
         m_rootSequence = std::vector<int>(sequence);
+        m_rootHandles.clear();
+
+        for (auto condition : m_rootSequence)
+        {
+            m_rootHandles.push_back(GetHandle<void>(this, condition));
+        }
+
+        BuildRootGraphs();
+    }
+
+    void Sequencer::SetPipelinedStep(int condition, int joinCondition)
+    {
+        JoinPipelinedStep();
+        m_pipelinedCondition = condition;
+        m_pipelineJoinCondition = joinCondition;
     }
 
     void Sequencer::ExecuteRootSequence()
     {
-        for (auto i : m_rootSequence)
+        for (auto i = 0u; i < m_rootSequence.size(); ++i)
         {
-            Next<void>(this, nullptr, i);
+            auto condition = m_rootSequence.at(i);
+
+            if (condition == m_pipelineJoinCondition || condition == m_pipelinedCondition)
+            {
+                JoinPipelinedStep();
+            }
+
+            // Root steps are profiled in both modes, token steps only when step profiling is enabled.
+            if (m_serialExecution || m_jobSystem == nullptr)
+            {
+                for (auto& step : m_rootHandles.at(i)->steps)
+                {
+                    PK_PROFILE_SCOPE(step.name);
+                    step.function(step.instance, nullptr, condition);
+                }
+
+                continue;
+            }
+
+            auto isPipelined = condition == m_pipelinedCondition;
+            ExecuteRootGraph(condition, !isPipelined);
+            m_isPipelinePending |= isPipelined;
         }
     }
+
+    void Sequencer::Release()
+    {
+        JoinPipelinedStep();
+        m_steps.clear();
+        m_rootGraphs.clear();
+        m_rootCounters.clear();
+        m_rootDependencyCounters.clear();
+
+        // Keep the dispatches alive as handles might still be referenced.
+        std::lock_guard<std::mutex> lock(m_dispatchLock);
+
+        for (auto& kv : m_dispatches)
+        {
+            kv.second->steps.clear();
+        }
+    }
+
+    StepHandle Sequencer::ResolveHandle(const void* engine, std::type_index tokenType, int condition)
+    {
+        std::lock_guard<std::mutex> lock(m_dispatchLock);
+
+        auto& dispatch = m_dispatches[{ engine, tokenType, condition }];
+
+        if (dispatch == nullptr)
+        {
+            dispatch = Utilities::CreateScope<StepDispatch>();
+            dispatch->engine = engine;
+            dispatch->tokenType = tokenType;
+            dispatch->condition = condition;
+            BuildDispatch(dispatch.get());
+        }
+
+        return dispatch.get();
+    }
+
+    void Sequencer::BuildDispatch(StepDispatch* dispatch)
+    {
+        dispatch->steps.clear();
+
+        if (m_steps.count(dispatch->engine) < 1)
+        {
+            return;
+        }
+
+        auto& target = m_steps.at(dispatch->engine);
+        const auto* branchSteps = target.GetSteps(dispatch->condition);
+
+        if (branchSteps != nullptr)
+        {
+            for (auto& step : *branchSteps)
+            {
+                if (step.tokenType == dispatch->tokenType)
+                {
+                    dispatch->steps.push_back(step);
+                }
+            }
+        }
+
+        for (auto& step : *target.GetCommonSteps())
+        {
+            if (step.tokenType == dispatch->tokenType)
+            {
+                dispatch->steps.push_back(step);
+            }
+        }
+    }
+
+    void Sequencer::ExportGraph(const std::string& filepath) const
+    {
+        std::ofstream file(filepath);
+
+        if (!file.is_open())
+        {
+            PK_CORE_LOG_WARNING("Failed to open file for sequencer graph export: %s", filepath.c_str());
+            return;
+        }
+
+        file << "digraph Sequencer\n{\n    rankdir=LR;\n    node [shape=box, style=filled];\n";
+
+        for (auto condition : m_rootSequence)
+        {
+            if (m_rootGraphs.count(condition) < 1)
+            {
+                continue;
+            }
+
+            auto& graph = m_rootGraphs.at(condition);
+
+            file << "    subgraph cluster_" << condition << "\n    {\n";
+            file << "        label=\"Root Step " << condition << "\";\n";
+
+            for (auto i = 0u; i < graph.size(); ++i)
+            {
+                auto& node = graph.at(i);
+                auto color = !node.isDeclared ? "lightcoral" : node.access.isThreadSafe ? "palegreen" : "lightgray";
+                file << "        n" << condition << "_" << i << " [label=\"" << typeid(*node.step.base).name() << "\", fillcolor=" << color << "];\n";
+            }
+
+            for (auto i = 0u; i < graph.size(); ++i)
+            {
+                auto& node = graph.at(i);
+
+                for (auto dependency : node.dependencies)
+                {
+                    auto& other = graph.at(dependency);
+                    auto conflict = node.isDeclared && other.isDeclared ? node.access.GetConflict(other.access) : nullptr;
+                    auto label = conflict != nullptr ? conflict->name() : "undeclared";
+                    file << "        n" << condition << "_" << dependency << " -> n" << condition << "_" << i << " [label=\"" << label << "\"];\n";
+                }
+            }
+
+            file << "    }\n";
+        }
+
+        file << "}\n";
+        file.close();
+
+        PK_CORE_LOG("Exported sequencer graph to: %s", filepath.c_str());
+    }
+
+    void Sequencer::BuildRootGraphs()
+    {
+        m_rootGraphs.clear();
+        m_rootCounters.clear();
+        m_rootDependencyCounters.clear();
+
+        if (m_steps.count(this) < 1)
+        {
+            return;
+        }
+
+        auto& target = m_steps.at(this);
+
+        for (auto condition : m_rootSequence)
+        {
+            // Preserve the serial order: branch steps first, common steps after.
+            auto& graph = m_rootGraphs[condition];
+            const auto* branchSteps = target.GetSteps(condition);
+            std::vector<StepPtr> steps;
+
+            if (branchSteps != nullptr)
+            {
+                steps.insert(steps.end(), branchSteps->begin(), branchSteps->end());
+            }
+
+            steps.insert(steps.end(), target.GetCommonSteps()->begin(), target.GetCommonSteps()->end());
+            steps.erase(std::remove_if(steps.begin(), steps.end(), [](const StepPtr& step) { return step.tokenType != std::type_index(typeid(void)); }), steps.end());
+
+            for (auto i = 0u; i < steps.size(); ++i)
+            {
+                StepNode node;
+                node.step = steps.at(i);
+
+                auto* declaring = dynamic_cast<IStepAccess*>(node.step.base);
+
+                if (declaring != nullptr)
+                {
+                    node.isDeclared = true;
+                    declaring->GetStepAccess(condition, &node.access);
+                }
+
+                for (auto j = 0u; j < i; ++j)
+                {
+                    auto& other = graph.at(j);
+
+                    if (node.isDeclared && other.isDeclared && node.access.GetConflict(other.access) == nullptr)
+                    {
+                        continue;
+                    }
+
+                    node.dependencies.push_back(j);
+                    other.dependents.push_back(i);
+                }
+
+                graph.push_back(node);
+            }
+
+            // Separate counters per condition as a pipelined graph can be in flight while others execute.
+            m_rootCounters[condition] = std::vector<Core::JobCounter>(graph.size());
+            m_rootDependencyCounters[condition] = std::vector<Core::JobCounter>(graph.size());
+        }
+    }
+
+    void Sequencer::ExecuteRootGraph(int condition, bool join)
+    {
+        if (m_rootGraphs.count(condition) < 1)
+        {
+            return;
+        }
+
+        auto& graph = m_rootGraphs.at(condition);
+        auto* counters = m_rootCounters.at(condition).data();
+        auto* dependencyCounters = m_rootDependencyCounters.at(condition).data();
+
+        for (auto i = 0u; i < graph.size(); ++i)
+        {
+            counters[i].value.store(1u, std::memory_order_release);
+            dependencyCounters[i].value.store((uint32_t)graph.at(i).dependencies.size(), std::memory_order_release);
+        }
+
+        // Worker nodes are parked on their dependency counter until every node they depend on has executed, nothing blocks inside a job.
+        // A job waiting for another could otherwise pick up a node that depends on it & deadlock the thread.
+        for (auto i = 0u; i < graph.size(); ++i)
+        {
+            auto& node = graph.at(i);
+
+            if (!node.access.isThreadSafe)
+            {
+                continue;
+            }
+
+            m_jobSystem->Dispatch([this, &node, counters, dependencyCounters, condition, i]()
+            {
+                InvokeRootStep(node, condition);
+                CompleteRootStep(node, counters, dependencyCounters, i);
+            }, nullptr, &dependencyCounters[i]);
+        }
+
+        for (auto i = 0u; i < graph.size(); ++i)
+        {
+            auto& node = graph.at(i);
+
+            if (node.access.isThreadSafe)
+            {
+                continue;
+            }
+
+            m_jobSystem->Wait(&dependencyCounters[i]);
+            InvokeRootStep(node, condition);
+            CompleteRootStep(node, counters, dependencyCounters, i);
+        }
+
+        if (join)
+        {
+            JoinRootGraph(condition);
+        }
+    }
+
+    void Sequencer::JoinRootGraph(int condition)
+    {
+        if (m_rootCounters.count(condition) < 1)
+        {
+            return;
+        }
+
+        for (auto& counter : m_rootCounters.at(condition))
+        {
+            m_jobSystem->Wait(&counter);
+        }
+    }
+
+    void Sequencer::JoinPipelinedStep()
+    {
+        if (m_isPipelinePending)
+        {
+            m_isPipelinePending = false;
+            JoinRootGraph(m_pipelinedCondition);
+        }
+    }
+
+    void Sequencer::InvokeRootStep(const StepNode& node, int condition)
+    {
+        PK_PROFILE_SCOPE(node.step.name);
+
+        node.step.function(node.step.instance, nullptr, condition);
+    }
+
+    void Sequencer::CompleteRootStep(const StepNode& node, Core::JobCounter* counters, Core::JobCounter* dependencyCounters, uint32_t index)
+    {
+        // Dependents are released first, the graph can be executed again once every node counter has been joined.
+        for (auto dependent : node.dependents)
+        {
+            m_jobSystem->Signal(&dependencyCounters[dependent]);
+        }
+
+        m_jobSystem->Signal(&counters[index]);
+    }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "PrecompiledHeader.h"
 #include "Core/IService.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
 #include "Utilities/Ref.h"
 
 // @TODO Replace this nastyness with templates or smth.
@@ -38,7 +40,63 @@ namespace PK::ECS
             void Step(void* token, int condition) { Step(condition); }
     };
 
-    typedef IBaseStep* StepPtr;
+    // Resources (services, components) a step reads or writes when invoked for a root update step.
+    // Steps that do not declare their access are treated as main thread bound & conflicting with every other step.
+    struct StepAccess
+    {
+        std::vector<std::type_index> reads;
+        std::vector<std::type_index> writes;
+        bool isThreadSafe = false;
+
+        template<typename T>
+        StepAccess& Read() { reads.push_back(std::type_index(typeid(T))); return *this; }
+
+        template<typename T>
+        StepAccess& Write() { writes.push_back(std::type_index(typeid(T))); return *this; }
+
+        // Step doesn't touch the graphics context or window & can be executed on a worker thread.
+        StepAccess& ThreadSafe() { isThreadSafe = true; return *this; }
+
+        const std::type_index* GetConflict(const StepAccess& other) const;
+    };
+
+    class IStepAccess
+    {
+        protected: virtual ~IStepAccess() = default;
+        public: virtual void GetStepAccess(int condition, StepAccess* access) const = 0;
+    };
+
+    // Step bound to the interface it was registered through. Resolved once when steps are set instead of per invocation.
+    struct StepPtr
+    {
+        typedef void (*StepFunction)(void* instance, void* token, int condition);
+
+        IBaseStep* base = nullptr;
+        void* instance = nullptr;
+        StepFunction function = nullptr;
+        std::type_index tokenType = std::type_index(typeid(void));
+        // Engine type name, used as the profiler scope name.
+        const char* name = nullptr;
+
+        StepPtr() = default;
+
+        template<typename T>
+        StepPtr(IStep<T>* step) : base(step), instance(step), function(&InvokeStep<T>), tokenType(typeid(T)), name(typeid(*step).name()) {}
+
+        template<typename T>
+        StepPtr(IConditionalStep<T>* step) : base(step), instance(step), function(&InvokeConditionalStep<T>), tokenType(typeid(T)), name(typeid(*step).name()) {}
+
+        StepPtr(ISimpleStep* step) : base(step), instance(step), function(&InvokeSimpleStep), tokenType(typeid(void)), name(typeid(*step).name()) {}
+
+        template<typename T>
+        static void InvokeStep(void* instance, void* token, int condition) { static_cast<IStep<T>*>(instance)->Step(static_cast<T*>(token)); }
+
+        template<typename T>
+        static void InvokeConditionalStep(void* instance, void* token, int condition) { static_cast<IConditionalStep<T>*>(instance)->Step(static_cast<T*>(token), condition); }
+
+        static void InvokeSimpleStep(void* instance, void* token, int condition) { static_cast<ISimpleStep*>(instance)->Step(condition); }
+    };
+
     typedef std::unordered_map<int, std::vector<StepPtr>> BranchSteps;
 
     class To
@@ -59,57 +117,110 @@ namespace PK::ECS
 
     typedef std::unordered_map<const void*, To> Steps;
 
+    struct StepNode
+    {
+        StepPtr step;
+        StepAccess access;
+        bool isDeclared = false;
+        // Earlier nodes in the serial order that this node conflicts with.
+        std::vector<uint32_t> dependencies;
+        // Later nodes that conflict with this node, their dependency counters are signalled once it has executed.
+        std::vector<uint32_t> dependents;
+    };
+
+    typedef std::vector<StepNode> StepGraph;
+
+    // Flattened branch & common steps of an engine for a token type & condition.
+    struct StepDispatch
+    {
+        const void* engine = nullptr;
+        std::type_index tokenType = std::type_index(typeid(void));
+        int condition = 0;
+        std::vector<StepPtr> steps;
+    };
+
+    typedef const StepDispatch* StepHandle;
+
     class Sequencer : public Core::IService
     {
         public:
             void SetSteps(std::initializer_list<Steps::value_type> steps);
             void SetRootSequence(std::initializer_list<int> sequence);
             void ExecuteRootSequence();
+            void ExportGraph(const std::string& filepath) const;
+
+            inline void SetJobSystem(Core::JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+            inline void SetSerialExecution(bool value) { m_serialExecution = value; }
+            inline bool IsSerialExecution() const { return m_serialExecution; }
+
+            // The pipelined root step is left running on workers once its main thread steps have executed & is joined at the start of joinCondition.
+            // Root steps in between overlap with it & must not touch what its worker steps write. Requires parallel execution.
+            void SetPipelinedStep(int condition, int joinCondition);
 
             inline const void* GetRoot() { return this; }
 
+            // Handles stay valid for the lifetime of the sequencer & are rebound when steps are set.
             template<typename T>
-            void Next(const void* engine, T* token, int condition)
-            {
-                if (m_steps.count(engine) < 1)
-                {
-                    return;
-                }
+            StepHandle GetHandle(const void* engine, int condition) { return ResolveHandle(engine, std::type_index(typeid(T)), condition); }
 
-                auto& target = m_steps.at(engine);
-                const auto* branchSteps = target.GetSteps(condition);
-
-                if (branchSteps != nullptr)
+            template<typename T>
+            void Next(StepHandle handle, T* token)
+            {
+                for (auto& step : handle->steps)
                 {
-                    InvokeSteps(branchSteps, token, condition);
+                    PK_PROFILE_STEP(step.name);
+                    step.function(step.instance, token, handle->condition);
                 }
-
-                InvokeSteps(target.GetCommonSteps(), token, condition);
             }
 
-            inline void Release() { m_steps.clear(); }
+            template<typename T>
+            void Next(const void* engine, T* token, int condition) { Next(GetHandle<T>(engine, condition), token); }
+
+            void Release();
 
         private:
-            template<typename T>
-            void InvokeSteps(const std::vector<StepPtr>* branchSteps, T* token, int condition)
+            struct DispatchKey
             {
-                auto& steps = *branchSteps;
+                const void* engine;
+                std::type_index tokenType;
+                int condition;
+
+                inline bool operator == (const DispatchKey& other) const { return engine == other.engine && tokenType == other.tokenType && condition == other.condition; }
+            };
 
-                for (auto& i : steps)
+            struct DispatchKeyHash
+            {
+                size_t operator()(const DispatchKey& key) const noexcept
                 {
-                    if (auto* conditionalStep = dynamic_cast<IConditionalStep<T>*>(i))
-                    {
-                        conditionalStep->Step(token, condition);
-                    }
-
-                    if (auto* step = dynamic_cast<IStep<T>*>(i))
-                    {
-                        step->Step(token);
-                    }
+                    auto hash = std::hash<const void*>()(key.engine);
+                    hash ^= key.tokenType.hash_code() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                    hash ^= std::hash<int>()(key.condition) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                    return hash;
                 }
-            }
+            };
+
+            StepHandle ResolveHandle(const void* engine, std::type_index tokenType, int condition);
+            void BuildDispatch(StepDispatch* dispatch);
+            void BuildRootGraphs();
+            void ExecuteRootGraph(int condition, bool join);
+            void JoinRootGraph(int condition);
+            void JoinPipelinedStep();
+            void InvokeRootStep(const StepNode& node, int condition);
+            void CompleteRootStep(const StepNode& node, Core::JobCounter* counters, Core::JobCounter* dependencyCounters, uint32_t index);
 
             Steps m_steps;
+            std::unordered_map<DispatchKey, Utilities::Scope<StepDispatch>, DispatchKeyHash> m_dispatches;
+            std::mutex m_dispatchLock;
             std::vector<int> m_rootSequence;
+            std::vector<StepHandle> m_rootHandles;
+            std::unordered_map<int, StepGraph> m_rootGraphs;
+            std::unordered_map<int, std::vector<Core::JobCounter>> m_rootCounters;
+            // Dependencies of each node that haven't executed yet, worker nodes are parked on theirs.
+            std::unordered_map<int, std::vector<Core::JobCounter>> m_rootDependencyCounters;
+            Core::JobSystem* m_jobSystem = nullptr;
+            bool m_serialExecution = true;
+            int m_pipelinedCondition = -1;
+            int m_pipelineJoinCondition = -1;
+            bool m_isPipelinePending = false;
     };
 }
\ No newline at end of file
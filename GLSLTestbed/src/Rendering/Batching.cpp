@@ -3,6 +3,10 @@
 #include "Utilities/HashCache.h"
 #include "Rendering/Batching.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Rendering/Culling.h"
+#include "Rendering/MeshUtility.h"
+#include "Core/Profiler.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering::Batching
 {
@@ -28,9 +32,92 @@ namespace PK::Rendering::Batching
         }
     }
 
+    // Instances that draw the whole submesh extend the previous command of the same batch when it draws the same range.
+    // Ranges are relative to the mesh, pooled meshes are offset by their position in the pool.
+    static void AppendIndirectCommands(DrawIndirectArguments* commands, uint* commandCount, uint batchFirstCommand, const IndexRange* visibleRanges, const Mesh* mesh, int submesh, uint rangeOffset, uint rangeCount, uint instance)
+    {
+        auto baseIndex = mesh->GetBaseIndex();
+        auto baseVertex = mesh->GetBaseVertex();
+
+        if (rangeCount != ~0u)
+        {
+            for (auto i = 0u; i < rangeCount; ++i)
+            {
+                auto& range = visibleRanges[rangeOffset + i];
+                commands[(*commandCount)++] = { range.count, 1u, baseIndex + range.offset, baseVertex, instance };
+            }
+
+            return;
+        }
+
+        auto range = mesh->GetSubmeshIndexRange(submesh);
+
+        if (*commandCount > batchFirstCommand)
+        {
+            auto& previous = commands[*commandCount - 1];
+
+            if (previous.firstIndex == baseIndex + range.offset && previous.count == range.count && previous.baseInstance + previous.instanceCount == instance)
+            {
+                previous.instanceCount++;
+                return;
+            }
+        }
+
+        commands[(*commandCount)++] = { range.count, 1u, baseIndex + range.offset, baseVertex, instance };
+    }
+
+    static DrawIndirectArguments* BeginMapIndirectArguments(Ref<ComputeBuffer>& arguments, uint maxCommandCount)
+    {
+        if (arguments == nullptr)
+        {
+            arguments = CreateRef<ComputeBuffer>(BufferLayout(
+            {
+                { PK_TYPE::UINT, "COUNT" },
+                { PK_TYPE::UINT, "INSTANCE_COUNT" },
+                { PK_TYPE::UINT, "FIRST_INDEX" },
+                { PK_TYPE::INT, "BASE_VERTEX" },
+                { PK_TYPE::UINT, "BASE_INSTANCE" }
+            }), maxCommandCount, false, GL_STREAM_DRAW);
+        }
+        else
+        {
+            arguments->ValidateSize(maxCommandCount);
+        }
+
+        return arguments->BeginMapBufferRange<DrawIndirectArguments>(0, maxCommandCount).data;
+    }
+
+    // Draws the commands of the instances in [offset, offset + count).
+    template<typename T, typename ... Args>
+    static void DrawInstancesIndirect(const T* collection, const Mesh* mesh, uint offset, uint count, Args&& ... args)
+    {
+        auto firstCommand = collection->CommandOffsets.at(offset);
+        auto commandCount = collection->CommandOffsets.at(offset + count) - firstCommand;
+
+        if (commandCount > 0)
+        {
+            GraphicsAPI::DrawMeshIndirect(mesh, collection->IndirectArguments->GetGraphicsID(), firstCommand, commandCount, std::forward<Args>(args)...);
+        }
+    }
+
+    // Passes that can't use meshlet culling draw the whole submesh of every instance.
+    template<typename ... Args>
+    static void DrawInstances(const DynamicBatchCollection* collection, bool cullMeshlets, const Mesh* mesh, int submesh, uint offset, uint count, Args&& ... args)
+    {
+        if (cullMeshlets)
+        {
+            DrawInstancesIndirect(collection, mesh, offset, count, std::forward<Args>(args)...);
+        }
+        else
+        {
+            GraphicsAPI::DrawMeshInstanced(mesh, submesh, offset, count, std::forward<Args>(args)...);
+        }
+    }
+
     void ResetCollection(DynamicBatchCollection* collection)
     {
         collection->TotalDrawCallCount = 0;
+        collection->VisibleRangeCount = 0;
 
         for (auto& batch : collection->MeshBatches)
         {
@@ -67,6 +154,7 @@ namespace PK::Rendering::Batching
     void ResetCollection(IndexedMeshBatchCollection* collection)
     {
         collection->TotalDrawCallCount = 0;
+        collection->VisibleRangeCount = 0;
 
         for (auto& batch : collection->MeshBatches)
         {
@@ -78,7 +166,7 @@ namespace PK::Rendering::Batching
   
     void QueueDraw(DynamicBatchCollection* collection, const Mesh* mesh, int submesh, const Material* material, const Drawcall& drawcall)
     {
-        auto meshId = (ulong)mesh->GetGraphicsID();
+        auto meshId = (ulong)mesh->GetMeshID();
         auto materialId = (ulong)material->GetAssetID();
         auto shaderId = (ulong)material->GetShaderAssetID();
 
@@ -104,6 +192,7 @@ namespace PK::Rendering::Batching
 
             if (instancingInfo.hasInstancedProperties)
             {
+                Core::MemoryScope memoryScope("Batching");
                 shaderBatch->instancedData = CreateRef<ComputeBuffer>(instancingInfo.propertyLayout, 1, false, GL_STREAM_DRAW);
             }
         }
@@ -130,7 +219,7 @@ namespace PK::Rendering::Batching
 
     void QueueDraw(MeshBatchCollection* collection, const Mesh* mesh, const Drawcall& drawcall)
     {
-        auto meshId = (ulong)mesh->GetGraphicsID();
+        auto meshId = (ulong)mesh->GetMeshID();
         
         uint meshBatchIndex = 0;
         MeshOnlyBatch* meshBatch = nullptr;
@@ -143,24 +232,229 @@ namespace PK::Rendering::Batching
         ++collection->TotalDrawCallCount;
     }
 
-    void QueueDraw(IndexedMeshBatchCollection* collection, const Mesh* mesh, const DrawcallIndexed& drawcall)
+    void QueueDraw(IndexedMeshBatchCollection* collection, const Mesh* mesh, int submesh, const DrawcallIndexed& drawcall)
     {
-        auto meshId = (ulong)mesh->GetGraphicsID();
+        auto meshId = (ulong)mesh->GetMeshID();
+        auto submeshKey = (ulong)(((ulong)(uint)submesh << 32ul) | meshId);
 
         uint meshBatchIndex = 0;
         IndexedMeshBatch* meshBatch = nullptr;
 
-        GetBatch(collection->BatchMap, collection->MeshBatches, meshId, &meshBatch, &meshBatchIndex);
+        GetBatch(collection->BatchMap, collection->MeshBatches, submeshKey, &meshBatch, &meshBatchIndex);
         meshBatch->mesh = mesh;
+        meshBatch->submesh = submesh;
 
         Utilities::ValidateVectorSize(meshBatch->drawcalls, meshBatch->drawCallCount + 1);
         meshBatch->drawcalls[meshBatch->drawCallCount++] = drawcall;
         ++collection->TotalDrawCallCount;
     }
 
+    void QueueDraw(DynamicBatchCollection* collection, const Mesh* mesh, int submesh, const Material* material, const Drawcall& drawcall, const float4x4& worldToClip, bool cullBackfaces)
+    {
+        auto meshlets = mesh->GetMeshletRange(submesh);
+        auto culled = drawcall;
+
+        if (meshlets.count > 0)
+        {
+            culled.rangeOffset = collection->VisibleRangeCount;
+            culled.rangeCount = Culling::CullMeshlets(mesh->GetMeshlets() + meshlets.offset, meshlets.count, worldToClip * *drawcall.localToWorld, cullBackfaces, collection->VisibleRanges, &collection->VisibleRangeCount);
+        }
+
+        // Fully culled drawcalls are still queued, passes that can't use meshlet culling draw them whole.
+        QueueDraw(collection, mesh, submesh, material, culled);
+    }
+
+    void QueueDraw(IndexedMeshBatchCollection* collection, const Mesh* mesh, int submesh, const DrawcallIndexed& drawcall, const float4x4& worldToClip, bool cullBackfaces)
+    {
+        auto meshlets = mesh->GetMeshletRange(submesh);
+        auto culled = drawcall;
+
+        if (meshlets.count > 0)
+        {
+            culled.rangeOffset = collection->VisibleRangeCount;
+            culled.rangeCount = Culling::CullMeshlets(mesh->GetMeshlets() + meshlets.offset, meshlets.count, worldToClip * *drawcall.localToWorld, cullBackfaces, collection->VisibleRanges, &collection->VisibleRangeCount);
+
+            if (culled.rangeCount == 0)
+            {
+                return;
+            }
+        }
+
+        QueueDraw(collection, mesh, submesh, culled);
+    }
+
+
+    // Interleaves the bits of a position quantized to 10 bits per axis within bounds.
+    static uint GetMortonCode(const float3& position, const BoundingBox& bounds)
+    {
+        auto normalized = glm::clamp((position - bounds.min) / glm::max(bounds.max - bounds.min, float3(1e-6f)), 0.0f, 1.0f);
+        auto code = 0u;
+
+        for (auto axis = 0; axis < 3; ++axis)
+        {
+            auto value = (uint)(normalized[axis] * 1023.0f);
+
+            for (auto bit = 0u; bit < 10u; ++bit)
+            {
+                code |= ((value >> bit) & 1u) << (bit * 3u + axis);
+            }
+        }
+
+        return code;
+    }
+
+    static void FlushStaticBatch(StaticBatchCollection* collection, const Material* material, std::vector<Vertex_Full>& vertices, std::vector<uint>& indices, const float3& minpos, const float3& maxpos)
+    {
+        if (indices.empty())
+        {
+            return;
+        }
+
+        const uint stride = sizeof(Vertex_Full) / 4;
+        std::vector<Meshlet> meshlets;
+        auto meshletCount = MeshUtility::BuildMeshlets(reinterpret_cast<const float*>(vertices.data()), stride, 0, indices.data(), (uint)indices.size(), (uint)vertices.size(), meshlets);
+
+        StaticBatch batch;
+        batch.material = material;
+        batch.bounds = Functions::CreateBoundsMinMax(minpos, maxpos);
+        batch.mesh = CreateRef<Mesh>(Mesh::GetVertexLayout(false), vertices.data(), (uint)vertices.size(), indices.data(), (uint)indices.size());
+        batch.mesh->SetLocalBounds(batch.bounds);
+        batch.mesh->SetMeshlets(meshlets, { { 0u, meshletCount } });
+        collection->Batches.push_back(batch);
+
+        vertices.clear();
+        indices.clear();
+    }
+
+    void BakeStaticBatches(StaticBatchCollection* collection, const StaticDrawcall* drawcalls, uint count, bool* isBaked)
+    {
+        PK_PROFILE_FUNCTION();
+        Core::MemoryScope memoryScope("Batching");
+
+        struct Geometry
+        {
+            std::vector<Vertex_Full> vertices;
+            std::vector<uint> indices;
+            bool isValid = false;
+        };
+
+        std::unordered_map<const Mesh*, Geometry> geometries;
+        std::vector<uint> order;
+        std::vector<uint> mortonCodes(count);
+        BoundingBox sceneBounds(PK_FLOAT3_ONE * std::numeric_limits<float>().max(), -PK_FLOAT3_ONE * std::numeric_limits<float>().max());
+
+        collection->Batches.clear();
+
+        for (auto i = 0u; i < count; ++i)
+        {
+            auto& drawcall = drawcalls[i];
+            auto geometry = geometries.find(drawcall.mesh);
+
+            if (geometry == geometries.end())
+            {
+                geometry = geometries.emplace(drawcall.mesh, Geometry()).first;
+                geometry->second.isValid = drawcall.mesh->ReadGeometry(geometry->second.vertices, geometry->second.indices);
+            }
+
+            isBaked[i] = geometry->second.isValid;
+
+            if (isBaked[i])
+            {
+                order.push_back(i);
+                Functions::BoundsEncapsulate(&sceneBounds, Functions::BoundsTransform(drawcall.localToWorld, drawcall.mesh->GetLocalBounds()));
+            }
+        }
+
+        for (auto i : order)
+        {
+            mortonCodes.at(i) = GetMortonCode(Functions::BoundsTransform(drawcalls[i].localToWorld, drawcalls[i].mesh->GetLocalBounds()).GetCenter(), sceneBounds);
+        }
+
+        // Grouped by material, then along a z-order curve so that merged drawcalls are close to each other.
+        std::sort(order.begin(), order.end(), [drawcalls, &mortonCodes](uint a, uint b)
+        {
+            auto materialA = drawcalls[a].material;
+            auto materialB = drawcalls[b].material;
+
+            if (materialA != materialB)
+            {
+                return materialA->GetAssetID() != materialB->GetAssetID() ? materialA->GetAssetID() < materialB->GetAssetID() : materialA < materialB;
+            }
+
+            return mortonCodes.at(a) < mortonCodes.at(b);
+        });
+
+        std::vector<Vertex_Full> vertices;
+        std::vector<uint> indices;
+        std::vector<uint> remap;
+        std::vector<uint> used;
+        const Material* material = nullptr;
+        float3 minpos = PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+        float3 maxpos = -PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+
+        for (auto i : order)
+        {
+            auto& drawcall = drawcalls[i];
+            auto& geometry = geometries.at(drawcall.mesh);
+            auto range = drawcall.mesh->GetSubmeshIndexRange(drawcall.submesh);
+
+            // Only the vertices referenced by the submesh are copied.
+            remap.assign(geometry.vertices.size(), ~0u);
+            used.clear();
+
+            for (auto j = range.offset; j < range.offset + range.count; ++j)
+            {
+                auto vertex = geometry.indices.at(j);
+
+                if (remap.at(vertex) == ~0u)
+                {
+                    remap.at(vertex) = (uint)used.size();
+                    used.push_back(vertex);
+                }
+            }
+
+            if (drawcall.material != material || vertices.size() + used.size() > MaxStaticBatchVertexCount)
+            {
+                FlushStaticBatch(collection, material, vertices, indices, minpos, maxpos);
+                material = drawcall.material;
+                minpos = PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+                maxpos = -PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+            }
+
+            auto matrix = float3x3(drawcall.localToWorld);
+            auto normalMatrix = glm::transpose(glm::inverse(matrix));
+            // Mirroring transforms flip the winding & the bitangent.
+            auto isMirrored = glm::determinant(matrix) < 0.0f;
+            auto baseVertex = (uint)vertices.size();
+
+            for (auto vertex : used)
+            {
+                auto output = geometry.vertices.at(vertex);
+                output.position = float3(drawcall.localToWorld * float4(output.position, 1.0f));
+                output.normal = glm::normalize(normalMatrix * output.normal);
+                output.tangent = float4(glm::normalize(matrix * float3(output.tangent)), isMirrored ? -output.tangent.w : output.tangent.w);
+                minpos = glm::min(minpos, output.position);
+                maxpos = glm::max(maxpos, output.position);
+                vertices.push_back(output);
+            }
+
+            for (auto j = range.offset; j + 2 < range.offset + range.count; j += 3)
+            {
+                indices.push_back(baseVertex + remap.at(geometry.indices.at(j)));
+                indices.push_back(baseVertex + remap.at(geometry.indices.at(isMirrored ? j + 2 : j + 1)));
+                indices.push_back(baseVertex + remap.at(geometry.indices.at(isMirrored ? j + 1 : j + 2)));
+            }
+        }
+
+        FlushStaticBatch(collection, material, vertices, indices, minpos, maxpos);
+        collection->IsBaked = true;
+    }
    
     void UpdateBuffers(DynamicBatchCollection* collection)
     {
+        PK_PROFILE_FUNCTION();
+        Core::MemoryScope memoryScope("Batching");
+
         if (collection->TotalDrawCallCount < 1)
         {
             return;
@@ -186,12 +480,18 @@ namespace PK::Rendering::Batching
 
         auto indexBuffer = collection->PropertyIndices->BeginMapBufferRange<uint>(0, collection->TotalDrawCallCount);
         auto matrixBuffer = collection->MatrixBuffer->BeginMapBufferRange<float4x4>(0, collection->TotalDrawCallCount);
+        // Each drawcall has either one whole submesh command or one per visible range.
+        auto commands = BeginMapIndirectArguments(collection->IndirectArguments, collection->TotalDrawCallCount + collection->VisibleRangeCount);
+        auto visibleRanges = collection->VisibleRanges.data();
         auto shaderBatches = collection->ShaderBatches.data();
         auto materialBatches = collection->MaterialBatches.data();
         char* instancedDataBuffer = nullptr;
         const BufferLayout* instancingLayout = nullptr;
         size_t stride = 0;
         size_t offset = 0;
+        uint commandCount = 0;
+
+        Utilities::ValidateVectorSize(collection->CommandOffsets, collection->TotalDrawCallCount + 1);
 
         for (auto& meshBatch : collection->MeshBatches)
         {
@@ -229,11 +529,14 @@ namespace PK::Rendering::Batching
                     }
 
                     Drawcall* drawcalls = materialBatch->drawcalls.data();
+                    auto batchFirstCommand = commandCount;
 
                     for (uint k = 0; k < materialBatch->drawCallCount; ++k)
                     {
                         indexBuffer[offset + k] = j;
                         matrixBuffer[offset + k] = *drawcalls[k].localToWorld;
+                        collection->CommandOffsets[offset + k] = commandCount;
+                        AppendIndirectCommands(commands, &commandCount, batchFirstCommand, visibleRanges, meshBatch.mesh, shaderBatch->submesh, drawcalls[k].rangeOffset, drawcalls[k].rangeCount, (uint)(offset + k));
                     }
 
                     offset += materialBatch->drawCallCount;
@@ -246,12 +549,17 @@ namespace PK::Rendering::Batching
             }
         }
 
+        collection->CommandOffsets[offset] = commandCount;
         collection->PropertyIndices->EndMapBuffer();
         collection->MatrixBuffer->EndMapBuffer();
+        collection->IndirectArguments->EndMapBuffer();
     }
 
     void UpdateBuffers(MeshBatchCollection* collection)
     {
+        PK_PROFILE_FUNCTION();
+        Core::MemoryScope memoryScope("Batching");
+
         if (collection->TotalDrawCallCount < 1)
         {
             return;
@@ -292,6 +600,9 @@ namespace PK::Rendering::Batching
 
     void UpdateBuffers(IndexedMeshBatchCollection* collection)
     {
+        PK_PROFILE_FUNCTION();
+        Core::MemoryScope memoryScope("Batching");
+
         if (collection->TotalDrawCallCount < 1)
         {
             return;
@@ -318,7 +629,12 @@ namespace PK::Rendering::Batching
 
         auto matrixBuffer = collection->MatrixBuffer->BeginMapBufferRange<float4x4>(0, collection->TotalDrawCallCount);
         auto indexBuffer = collection->IndexBuffer->BeginMapBufferRange<uint>(0, collection->TotalDrawCallCount);
+        auto commands = BeginMapIndirectArguments(collection->IndirectArguments, collection->TotalDrawCallCount + collection->VisibleRangeCount);
+        auto visibleRanges = collection->VisibleRanges.data();
         size_t offset = 0;
+        uint commandCount = 0;
+
+        Utilities::ValidateVectorSize(collection->CommandOffsets, collection->TotalDrawCallCount + 1);
 
         for (auto& meshBatch : collection->MeshBatches)
         {
@@ -328,24 +644,31 @@ namespace PK::Rendering::Batching
             }
 
             auto* drawcalls = meshBatch.drawcalls.data();
+            auto batchFirstCommand = commandCount;
             meshBatch.instancingOffset = (uint)offset;
 
             for (uint i = 0; i < meshBatch.drawCallCount; ++i)
             {
                 indexBuffer[offset + i] = drawcalls[i].index;
                 matrixBuffer[offset + i] = *drawcalls[i].localToWorld;
+                collection->CommandOffsets[offset + i] = commandCount;
+                AppendIndirectCommands(commands, &commandCount, batchFirstCommand, visibleRanges, meshBatch.mesh, meshBatch.submesh, drawcalls[i].rangeOffset, drawcalls[i].rangeCount, (uint)(offset + i));
             }
 
             offset += meshBatch.drawCallCount;
         }
 
+        collection->CommandOffsets[offset] = commandCount;
         collection->MatrixBuffer->EndMapBuffer();
         collection->IndexBuffer->EndMapBuffer();
+        collection->IndirectArguments->EndMapBuffer();
     }
 
 
     void DrawBatches(DynamicBatchCollection* collection)
     {
+        PK_PROFILE_FUNCTION();
+
         if (collection->TotalDrawCallCount < 1)
         {
             return;
@@ -374,7 +697,7 @@ namespace PK::Rendering::Batching
                 {
                     auto* firstMaterial = &collection->MaterialBatches.at(shaderBatch->materialBatches.at(0));
                     GraphicsAPI::SetGlobalComputeBuffer(hashes->pk_InstancedProperties, instancedData->GetGraphicsID());
-                    GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, shaderBatch->submesh, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, firstMaterial->material);
+                    DrawInstancesIndirect(collection, meshBatch.mesh, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, firstMaterial->material);
                 }
                 else
                 {
@@ -383,7 +706,7 @@ namespace PK::Rendering::Batching
                     for (uint j = 0; j < shaderBatch->materialBatchCount; ++j)
                     {
                         auto* materialBatch = &collection->MaterialBatches.at(materialBatchIndices[j]);
-                        GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, shaderBatch->submesh, materialBatch->instancingOffset, (uint)materialBatch->drawCallCount, materialBatch->material);
+                        DrawInstancesIndirect(collection, meshBatch.mesh, materialBatch->instancingOffset, (uint)materialBatch->drawCallCount, materialBatch->material);
                     }
                 }
             }
@@ -466,12 +789,15 @@ namespace PK::Rendering::Batching
 
     void DrawBatchesPredicated(DynamicBatchCollection* collection, const uint32_t keyword, Shader* fallbackShader, const FixedStateAttributes& attributes)
     {
+        PK_PROFILE_FUNCTION();
+
         if (collection->TotalDrawCallCount < 1)
         {
             return;
         }
 
         auto hashes = HashCache::Get();
+        auto cullMeshlets = attributes.CullEnabled && attributes.CullMode == GL_BACK;
         GraphicsAPI::SetGlobalComputeBuffer(hashes->pk_InstancingMatrices, collection->MatrixBuffer->GetGraphicsID());
         GraphicsAPI::SetGlobalComputeBuffer(hashes->pk_InstancingPropertyIndices, collection->PropertyIndices->GetGraphicsID());
         GraphicsAPI::SetGlobalKeyword(hashes->PK_ENABLE_INSTANCING, true);
@@ -494,14 +820,14 @@ namespace PK::Rendering::Batching
 
                 if (!firstMaterial->material->SupportsKeyword(keyword))
                 {
-                    GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, -1, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, fallbackShader, attributes);
+                    DrawInstances(collection, cullMeshlets, meshBatch.mesh, -1, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, fallbackShader, attributes);
                     continue;
                 }
 
                 if (instancedData != nullptr)
                 {
                     GraphicsAPI::SetGlobalComputeBuffer(hashes->pk_InstancedProperties, instancedData->GetGraphicsID());
-                    GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, shaderBatch->submesh, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, firstMaterial->material, attributes);
+                    DrawInstances(collection, cullMeshlets, meshBatch.mesh, shaderBatch->submesh, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, firstMaterial->material, attributes);
                 }
                 else
                 {
@@ -510,7 +836,7 @@ namespace PK::Rendering::Batching
                     for (uint j = 0; j < shaderBatch->materialBatchCount; ++j)
                     {
                         auto* materialBatch = &collection->MaterialBatches.at(materialBatchIndices[j]);
-                        GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, shaderBatch->submesh, materialBatch->instancingOffset, (uint)materialBatch->drawCallCount, materialBatch->material, attributes);
+                        DrawInstances(collection, cullMeshlets, meshBatch.mesh, shaderBatch->submesh, materialBatch->instancingOffset, (uint)materialBatch->drawCallCount, materialBatch->material, attributes);
                     }
                 }
             }
@@ -522,12 +848,15 @@ namespace PK::Rendering::Batching
 
     void DrawBatchesPredicated(DynamicBatchCollection* collection, const uint32_t keyword, Shader* fallbackShader, const ShaderPropertyBlock& propertyBlock, const FixedStateAttributes& attributes)
     {
+        PK_PROFILE_FUNCTION();
+
         if (collection->TotalDrawCallCount < 1)
         {
             return;
         }
 
         auto hashes = HashCache::Get();
+        auto cullMeshlets = attributes.CullEnabled && attributes.CullMode == GL_BACK;
         GraphicsAPI::SetGlobalComputeBuffer(hashes->pk_InstancingMatrices, collection->MatrixBuffer->GetGraphicsID());
         GraphicsAPI::SetGlobalComputeBuffer(hashes->pk_InstancingPropertyIndices, collection->PropertyIndices->GetGraphicsID());
         GraphicsAPI::SetGlobalKeyword(hashes->PK_ENABLE_INSTANCING, true);
@@ -550,14 +879,14 @@ namespace PK::Rendering::Batching
 
                 if (!firstMaterial->material->SupportsKeyword(keyword))
                 {
-                    GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, -1, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, fallbackShader, propertyBlock, attributes);
+                    DrawInstances(collection, cullMeshlets, meshBatch.mesh, -1, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, fallbackShader, propertyBlock, attributes);
                     continue;
                 }
 
                 if (instancedData != nullptr)
                 {
                     GraphicsAPI::SetGlobalComputeBuffer(hashes->pk_InstancedProperties, instancedData->GetGraphicsID());
-                    GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, shaderBatch->submesh, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, firstMaterial->material, propertyBlock, attributes);
+                    DrawInstances(collection, cullMeshlets, meshBatch.mesh, shaderBatch->submesh, shaderBatch->instancingOffset, (uint)shaderBatch->drawCallCount, firstMaterial->material, propertyBlock, attributes);
                 }
                 else
                 {
@@ -566,7 +895,7 @@ namespace PK::Rendering::Batching
                     for (uint j = 0; j < shaderBatch->materialBatchCount; ++j)
                     {
                         auto* materialBatch = &collection->MaterialBatches.at(materialBatchIndices[j]);
-                        GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, shaderBatch->submesh, materialBatch->instancingOffset, (uint)materialBatch->drawCallCount, materialBatch->material, propertyBlock, attributes);
+                        DrawInstances(collection, cullMeshlets, meshBatch.mesh, shaderBatch->submesh, materialBatch->instancingOffset, (uint)materialBatch->drawCallCount, materialBatch->material, propertyBlock, attributes);
                     }
                 }
             }
@@ -668,7 +997,7 @@ namespace PK::Rendering::Batching
                 continue;
             }
 
-            GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, -1, meshBatch.instancingOffset, (uint)meshBatch.drawCallCount, overrideMaterial);
+            DrawInstancesIndirect(collection, meshBatch.mesh, meshBatch.instancingOffset, (uint)meshBatch.drawCallCount, overrideMaterial);
         }
 
         GraphicsAPI::SetGlobalKeyword(hashes->PK_ENABLE_INSTANCING, false);
@@ -693,7 +1022,7 @@ namespace PK::Rendering::Batching
                 continue;
             }
 
-            GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, -1, meshBatch.instancingOffset, (uint)meshBatch.drawCallCount, overrideShader, propertyBlock);
+            DrawInstancesIndirect(collection, meshBatch.mesh, meshBatch.instancingOffset, (uint)meshBatch.drawCallCount, overrideShader, propertyBlock);
         }
 
         GraphicsAPI::SetGlobalKeyword(hashes->PK_ENABLE_INSTANCING, false);
@@ -718,7 +1047,7 @@ namespace PK::Rendering::Batching
                 continue;
             }
 
-            GraphicsAPI::DrawMeshInstanced(meshBatch.mesh, -1, meshBatch.instancingOffset, (uint)meshBatch.drawCallCount, overrideShader);
+            DrawInstancesIndirect(collection, meshBatch.mesh, meshBatch.instancingOffset, (uint)meshBatch.drawCallCount, overrideShader);
         }
 
         GraphicsAPI::SetGlobalKeyword(hashes->PK_ENABLE_INSTANCING, false);
@@ -9,17 +9,24 @@ namespace PK::Rendering::Batching
     using namespace PK::Rendering::Objects;
     using namespace PK::Math;
     
+    const uint MaxStaticBatchVertexCount = 1u << 16u;
+
     struct Drawcall
     {
-        float4x4* localToWorld = nullptr;
+        const float4x4* localToWorld = nullptr;
         float depth = 0.0f;
+        // Visible meshlet ranges in the collection's VisibleRanges, ~0u draws the whole submesh.
+        uint rangeOffset = 0;
+        uint rangeCount = ~0u;
     };
 
     struct DrawcallIndexed
     {
-        float4x4* localToWorld = nullptr;
+        const float4x4* localToWorld = nullptr;
         float depth = 0.0f;
         uint index = 0;
+        uint rangeOffset = 0;
+        uint rangeCount = ~0u;
     };
 
     struct BatchBase
@@ -58,6 +65,7 @@ namespace PK::Rendering::Batching
     struct IndexedMeshBatch : BatchBase
     {
         const Mesh* mesh = nullptr;
+        int submesh = -1;
         std::vector<DrawcallIndexed> drawcalls;
     };
 
@@ -72,6 +80,12 @@ namespace PK::Rendering::Batching
         Ref<ComputeBuffer> MatrixBuffer;
         Ref<ComputeBuffer> PropertyIndices;
         uint TotalDrawCallCount = 0;
+
+        // Indirect commands are ordered by instance, CommandOffsets holds the first command of each instance.
+        std::vector<IndexRange> VisibleRanges;
+        uint VisibleRangeCount = 0;
+        std::vector<uint> CommandOffsets;
+        Ref<ComputeBuffer> IndirectArguments;
     };
 
     struct MeshBatchCollection
@@ -82,6 +96,29 @@ namespace PK::Rendering::Batching
         uint TotalDrawCallCount = 0;
     };
 
+    struct StaticDrawcall
+    {
+        const Mesh* mesh = nullptr;
+        int submesh = 0;
+        const Material* material = nullptr;
+        float4x4 localToWorld = PK_FLOAT4X4_IDENTITY;
+    };
+
+    struct StaticBatch
+    {
+        const Material* material = nullptr;
+        Ref<Mesh> mesh;
+        BoundingBox bounds;
+    };
+
+    // Static drawcalls baked into world space meshes that are drawn with LocalToWorld.
+    struct StaticBatchCollection
+    {
+        std::vector<StaticBatch> Batches;
+        float4x4 LocalToWorld = PK_FLOAT4X4_IDENTITY;
+        bool IsBaked = false;
+    };
+
     struct IndexedMeshBatchCollection
     {
         std::vector<IndexedMeshBatch> MeshBatches;
@@ -89,6 +126,11 @@ namespace PK::Rendering::Batching
         Ref<ComputeBuffer> MatrixBuffer;
         Ref<ComputeBuffer> IndexBuffer;
         uint TotalDrawCallCount = 0;
+
+        std::vector<IndexRange> VisibleRanges;
+        uint VisibleRangeCount = 0;
+        std::vector<uint> CommandOffsets;
+        Ref<ComputeBuffer> IndirectArguments;
     };
 
     void ResetCollection(DynamicBatchCollection* collection);
@@ -97,7 +139,15 @@ namespace PK::Rendering::Batching
     
     void QueueDraw(DynamicBatchCollection* collection, const Mesh* mesh, int submesh, const Material* material, const Drawcall& drawcall);
     void QueueDraw(MeshBatchCollection* collection, const Mesh* mesh, const Drawcall& drawcall);
-    void QueueDraw(IndexedMeshBatchCollection* collection, const Mesh* mesh, const DrawcallIndexed& drawcall);
+    void QueueDraw(IndexedMeshBatchCollection* collection, const Mesh* mesh, int submesh, const DrawcallIndexed& drawcall);
+
+    // Only the meshlets that are visible to worldToClip are drawn by passes that use the indirect commands, see Culling::CullMeshlets.
+    void QueueDraw(DynamicBatchCollection* collection, const Mesh* mesh, int submesh, const Material* material, const Drawcall& drawcall, const float4x4& worldToClip, bool cullBackfaces);
+    void QueueDraw(IndexedMeshBatchCollection* collection, const Mesh* mesh, int submesh, const DrawcallIndexed& drawcall, const float4x4& worldToClip, bool cullBackfaces);
+
+    // Merges the drawcalls of a material into pooled meshes of about MaxStaticBatchVertexCount vertices, spatially close drawcalls end up in the same mesh.
+    // isBaked is set for every drawcall, drawcalls whose mesh geometry can't be read (see Mesh::ReadGeometry) are skipped & have to be drawn dynamically.
+    void BakeStaticBatches(StaticBatchCollection* collection, const StaticDrawcall* drawcalls, uint count, bool* isBaked);
 
     void UpdateBuffers(DynamicBatchCollection* collection);
     void UpdateBuffers(MeshBatchCollection* collection);
@@ -108,6 +158,7 @@ namespace PK::Rendering::Batching
     void DrawBatches(DynamicBatchCollection* collection, Shader* overrideShader, const ShaderPropertyBlock& propertyBlock);
     void DrawBatches(DynamicBatchCollection* collection, Shader* overrideShader);
 
+    // Meshlet culling is skipped when the attributes don't cull back faces.
     void DrawBatchesPredicated(DynamicBatchCollection* collection, const uint32_t keyword, Shader* fallbackShader, const FixedStateAttributes& attributes);
     void DrawBatchesPredicated(DynamicBatchCollection* collection, const uint32_t keyword, Shader* fallbackShader, const ShaderPropertyBlock& propertyBlock, const FixedStateAttributes& attributes);
     
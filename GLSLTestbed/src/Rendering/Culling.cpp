@@ -2,6 +2,7 @@
 #include "Culling.h"
 #include "ECS/Contextual/EntityViews/EntityViews.h"
 #include "Utilities/Utilities.h"
+#include "Core/Profiler.h"
 
 namespace PK::Rendering::Culling
 {
@@ -20,11 +21,40 @@ namespace PK::Rendering::Culling
 		}
 	}
 
-	void Culling::ExecuteOnVisibleItemsCubeFaces(PK::ECS::EntityDatabase* entityDb, const BoundingBox& aabb, ushort typeMask, OnVisibleItemMulti onvisible, void* context)
+	static void GetCubeFaceVisibility(const float3& aabbcenter, const BoundingBox& bounds, bool* vis)
 	{
 		const float3 planeNormals[] = { {-1,1,0}, {1,1,0}, {1,0,1}, {1,0,-1}, {0,1,1}, {0,-1,1} };
 		const float3 absPlaneNormals[] = { {1,1,0}, {1,1,0}, {1,0,1}, {1,0,1}, {0,1,1}, {0,1,1} };
 
+		auto center = bounds.GetCenter() - aabbcenter;
+		auto extents = bounds.GetExtents();
+
+		bool rp[6];
+		bool rn[6];
+
+		// Source: https://newq.net/dl/pub/s2015_shadows.pdf
+		for (uint j = 0; j < 6; ++j)
+		{
+			auto dist = glm::dot(center, planeNormals[j]);
+			auto radius = glm::dot(extents, absPlaneNormals[j]);
+			rp[j] = dist > -radius;
+			rn[j] = dist < radius;
+		}
+
+		vis[0] = rn[0] && rp[1] && rp[2] && rp[3] && bounds.max.x > aabbcenter.x;
+		vis[1] = rp[0] && rn[1] && rn[2] && rn[3] && bounds.min.x < aabbcenter.x;
+
+		vis[2] = rp[0] && rp[1] && rp[4] && rn[5] && bounds.max.y > aabbcenter.y;
+		vis[3] = rn[0] && rn[1] && rn[4] && rp[5] && bounds.min.y < aabbcenter.y;
+
+		vis[4] = rp[2] && rn[3] && rp[4] && rp[5] && bounds.max.z > aabbcenter.z;
+		vis[5] = rn[2] && rp[3] && rn[4] && rn[5] && bounds.min.z < aabbcenter.z;
+	}
+
+	void Culling::ExecuteOnVisibleItemsCubeFaces(PK::ECS::EntityDatabase* entityDb, const BoundingBox& aabb, ushort typeMask, OnVisibleItemMulti onvisible, void* context)
+	{
+		PK_PROFILE_FUNCTION();
+
 		auto aabbcenter = aabb.GetCenter();
 
 		auto cullables = entityDb->Query<ECS::EntityViews::BaseRenderable>((int)ECS::ENTITY_GROUPS::ACTIVE);
@@ -38,35 +68,12 @@ namespace PK::Rendering::Culling
 				continue;
 			}
 
-			auto center = cullable->bounds->worldAABB.GetCenter() - aabbcenter;
-			auto extents = cullable->bounds->worldAABB.GetExtents();
-
-			bool rp[6];
-			bool rn[6];
 			bool vis[6];
-
-			// Source: https://newq.net/dl/pub/s2015_shadows.pdf
-			for (uint j = 0; j < 6; ++j)
-			{
-				auto dist = glm::dot(center, planeNormals[j]);
-				auto radius = glm::dot(extents, absPlaneNormals[j]);
-				rp[j] = dist > -radius;
-				rn[j] = dist < radius;
-			}
-
-			vis[0] = rn[0] && rp[1] && rp[2] && rp[3] && cullable->bounds->worldAABB.max.x > aabbcenter.x;
-			vis[1] = rp[0] && rn[1] && rn[2] && rn[3] && cullable->bounds->worldAABB.min.x < aabbcenter.x;
-
-			vis[2] = rp[0] && rp[1] && rp[4] && rn[5] && cullable->bounds->worldAABB.max.y > aabbcenter.y;
-			vis[3] = rn[0] && rn[1] && rn[4] && rp[5] && cullable->bounds->worldAABB.min.y < aabbcenter.y;
-
-			vis[4] = rp[2] && rn[3] && rp[4] && rp[5] && cullable->bounds->worldAABB.max.z > aabbcenter.z;
-			vis[5] = rn[2] && rp[3] && rn[4] && rn[5] && cullable->bounds->worldAABB.min.z < aabbcenter.z;
+			GetCubeFaceVisibility(aabbcenter, cullable->bounds->worldAABB, vis);
 
 			for (uint j = 0; j < 6; ++j)
 			{
 				auto isVisible = !cullable->handle->isCullable || vis[j];
-				cullable->handle->isVisible |= isVisible;
 
 				if (isVisible)
 				{
@@ -78,6 +85,8 @@ namespace PK::Rendering::Culling
 
 	void Culling::ExecuteOnVisibleItemsFrustum(PK::ECS::EntityDatabase* entityDb, const float4x4& matrix, ushort typeMask, OnVisibleItemMulti onvisible, void* context)
 	{
+		PK_PROFILE_FUNCTION();
+
 		FrustumPlanes frustum;
 		Functions::ExtractFrustrumPlanes(matrix, &frustum, true);
 
@@ -93,7 +102,6 @@ namespace PK::Rendering::Culling
 			}
 
 			auto isVisible = !cullable->handle->isCullable || Functions::IntersectPlanesAABB(frustum.planes, 6, cullable->bounds->worldAABB);
-			cullable->handle->isVisible |= isVisible;
 
 			if (isVisible)
 			{
@@ -104,6 +112,8 @@ namespace PK::Rendering::Culling
 
 	void Culling::ExecuteOnVisibleItemsCascades(PK::ECS::EntityDatabase* entityDb, const float4x4* cascades, uint count, ushort typeMask, OnVisibleItemMulti onvisible, void* context)
 	{
+		PK_PROFILE_FUNCTION();
+
 		FrustumPlanes* frustums = PK_STACK_ALLOC(FrustumPlanes, count);
 
 		for (auto i = 0u; i < count; ++i)
@@ -125,7 +135,6 @@ namespace PK::Rendering::Culling
 			for (auto j = 0u; j < count; ++j)
 			{
 				auto isVisible = !cullable->handle->isCullable || Functions::IntersectPlanesAABB(frustums[j].planes, 6, cullable->bounds->worldAABB);
-				cullable->handle->isVisible |= isVisible;
 
 				if (isVisible)
 				{
@@ -137,6 +146,8 @@ namespace PK::Rendering::Culling
 
 	void Culling::ExecuteOnVisibleItemsAABB(PK::ECS::EntityDatabase* entityDb, const BoundingBox& aabb, ushort typeMask, OnVisibleItem onvisible, void* context)
 	{
+		PK_PROFILE_FUNCTION();
+
 		auto cullables = entityDb->Query<ECS::EntityViews::BaseRenderable>((int)ECS::ENTITY_GROUPS::ACTIVE);
 
 		for (auto i = 0; i < cullables.count; ++i)
@@ -149,7 +160,6 @@ namespace PK::Rendering::Culling
 			}
 
 			auto isVisible = !cullable->handle->isCullable || Functions::IntersectAABB(aabb, cullable->bounds->worldAABB);
-			cullable->handle->isVisible |= isVisible;
 
 			if (isVisible)
 			{
@@ -160,6 +170,8 @@ namespace PK::Rendering::Culling
 
 	void Culling::ExecuteOnVisibleItemsSphere(PK::ECS::EntityDatabase* entityDb, const float3& center, float radius, ushort typeMask, OnVisibleItem onvisible, void* context)
 	{
+		PK_PROFILE_FUNCTION();
+
 		auto cullables = entityDb->Query<ECS::EntityViews::BaseRenderable>((int)ECS::ENTITY_GROUPS::ACTIVE);
 
 		for (auto i = 0; i < cullables.count; ++i)
@@ -172,7 +184,6 @@ namespace PK::Rendering::Culling
 			}
 
 			auto isVisible = !cullable->handle->isCullable || Functions::IntersectSphere(center, radius, cullable->bounds->worldAABB);
-			cullable->handle->isVisible |= isVisible;
 
 			if (isVisible)
 			{
@@ -183,6 +194,8 @@ namespace PK::Rendering::Culling
 
 	void Culling::BuildVisibilityCacheFrustum(PK::ECS::EntityDatabase* entityDb, VisibilityCache* cache, const float4x4& matrix, CullingGroup group, ushort typeMask)
 	{
+		PK_PROFILE_FUNCTION();
+
 		FrustumPlanes frustrum;
 		Functions::ExtractFrustrumPlanes(matrix, &frustrum, true);
 
@@ -199,7 +212,6 @@ namespace PK::Rendering::Culling
 			}
 
 			auto isVisible = !cullable->handle->isCullable || Functions::IntersectPlanesAABB(frustrum.planes, 6, cullable->bounds->worldAABB);
-			cullable->handle->isVisible |= isVisible;
 
 			if (isVisible)
 			{
@@ -210,6 +222,8 @@ namespace PK::Rendering::Culling
 
 	void Culling::BuildVisibilityCacheAABB(PK::ECS::EntityDatabase* entityDb, VisibilityCache* cache, const BoundingBox& aabb, CullingGroup group, ushort typeMask)
 	{
+		PK_PROFILE_FUNCTION();
+
 		auto cullables = entityDb->Query<ECS::EntityViews::BaseRenderable>((int)ECS::ENTITY_GROUPS::ACTIVE);
 
 		for (auto i = 0; i < cullables.count; ++i)
@@ -222,7 +236,6 @@ namespace PK::Rendering::Culling
 			}
 
 			auto isVisible = !cullable->handle->isCullable || Functions::IntersectAABB(aabb, cullable->bounds->worldAABB);
-			cullable->handle->isVisible |= isVisible;
 
 			if (isVisible)
 			{
@@ -231,13 +244,218 @@ namespace PK::Rendering::Culling
 		}
 	}
 
-	void Culling::ResetEntityVisibilities(PK::ECS::EntityDatabase* entityDb)
+	void Culling::ExecuteOnVisibleItemsCubeFaces(const RenderSnapshot* snapshot, const BoundingBox& aabb, ushort typeMask, OnVisibleSnapshotItemMulti onvisible, void* context)
 	{
-		auto cullables = entityDb->Query<ECS::EntityViews::BaseRenderable>((int)ECS::ENTITY_GROUPS::ACTIVE);
+		PK_PROFILE_FUNCTION();
 
-		for (auto i = 0; i < cullables.count; ++i)
+		auto aabbcenter = aabb.GetCenter();
+
+		for (auto i = 0u; i < snapshot->renderables.size(); ++i)
 		{
-			cullables[i].handle->isVisible = false;
+			auto& cullable = snapshot->renderables[i];
+
+			if (((ushort)cullable.flags & typeMask) != typeMask || !Functions::IntersectAABB(aabb, cullable.worldAABB))
+			{
+				continue;
+			}
+
+			bool vis[6];
+			GetCubeFaceVisibility(aabbcenter, cullable.worldAABB, vis);
+
+			for (uint j = 0; j < 6; ++j)
+			{
+				if (!cullable.isCullable || vis[j])
+				{
+					onvisible(snapshot, i, j, 0.0f, context);
+				}
+			}
 		}
 	}
+
+	void Culling::ExecuteOnVisibleItemsFrustum(const RenderSnapshot* snapshot, const float4x4& matrix, ushort typeMask, OnVisibleSnapshotItemMulti onvisible, void* context)
+	{
+		PK_PROFILE_FUNCTION();
+
+		FrustumPlanes frustum;
+		Functions::ExtractFrustrumPlanes(matrix, &frustum, true);
+
+		for (auto i = 0u; i < snapshot->renderables.size(); ++i)
+		{
+			auto& cullable = snapshot->renderables[i];
+
+			if (((ushort)cullable.flags & typeMask) != typeMask)
+			{
+				continue;
+			}
+
+			if (!cullable.isCullable || Functions::IntersectPlanesAABB(frustum.planes, 6, cullable.worldAABB))
+			{
+				onvisible(snapshot, i, 0u, Functions::PlaneDistanceToAABB(frustum.planes[4], cullable.worldAABB), context);
+			}
+		}
+	}
+
+	void Culling::ExecuteOnVisibleItemsCascades(const RenderSnapshot* snapshot, const float4x4* cascades, uint count, ushort typeMask, OnVisibleSnapshotItemMulti onvisible, void* context)
+	{
+		PK_PROFILE_FUNCTION();
+
+		FrustumPlanes* frustums = PK_STACK_ALLOC(FrustumPlanes, count);
+
+		for (auto i = 0u; i < count; ++i)
+		{
+			Functions::ExtractFrustrumPlanes(cascades[i], frustums + i, true);
+		}
+
+		for (auto i = 0u; i < snapshot->renderables.size(); ++i)
+		{
+			auto& cullable = snapshot->renderables[i];
+
+			if (((ushort)cullable.flags & typeMask) != typeMask)
+			{
+				continue;
+			}
+
+			for (auto j = 0u; j < count; ++j)
+			{
+				if (!cullable.isCullable || Functions::IntersectPlanesAABB(frustums[j].planes, 6, cullable.worldAABB))
+				{
+					onvisible(snapshot, i, j, Functions::PlaneDistanceToAABB(frustums[j].planes[4], cullable.worldAABB), context);
+				}
+			}
+		}
+	}
+
+	void Culling::ExecuteOnVisibleItemsAABB(const RenderSnapshot* snapshot, const BoundingBox& aabb, ushort typeMask, OnVisibleSnapshotItem onvisible, void* context)
+	{
+		PK_PROFILE_FUNCTION();
+
+		for (auto i = 0u; i < snapshot->renderables.size(); ++i)
+		{
+			auto& cullable = snapshot->renderables[i];
+
+			if (!((ushort)cullable.flags & typeMask))
+			{
+				continue;
+			}
+
+			if (!cullable.isCullable || Functions::IntersectAABB(aabb, cullable.worldAABB))
+			{
+				onvisible(snapshot, i, 0.0f, context);
+			}
+		}
+	}
+
+	void Culling::ExecuteOnVisibleItemsSphere(const RenderSnapshot* snapshot, const float3& center, float radius, ushort typeMask, OnVisibleSnapshotItem onvisible, void* context)
+	{
+		PK_PROFILE_FUNCTION();
+
+		for (auto i = 0u; i < snapshot->renderables.size(); ++i)
+		{
+			auto& cullable = snapshot->renderables[i];
+
+			if (!((ushort)cullable.flags & typeMask))
+			{
+				continue;
+			}
+
+			if (!cullable.isCullable || Functions::IntersectSphere(center, radius, cullable.worldAABB))
+			{
+				onvisible(snapshot, i, 0.0f, context);
+			}
+		}
+	}
+
+	void Culling::BuildVisibilityCacheFrustum(const RenderSnapshot* snapshot, VisibilityCache* cache, const float4x4& matrix, CullingGroup group, ushort typeMask)
+	{
+		PK_PROFILE_FUNCTION();
+
+		FrustumPlanes frustrum;
+		Functions::ExtractFrustrumPlanes(matrix, &frustrum, true);
+
+		for (auto i = 0u; i < snapshot->renderables.size(); ++i)
+		{
+			auto& cullable = snapshot->renderables[i];
+			auto maskedFlags = (ushort)cullable.flags & typeMask;
+
+			if (!maskedFlags)
+			{
+				continue;
+			}
+
+			if (!cullable.isCullable || Functions::IntersectPlanesAABB(frustrum.planes, 6, cullable.worldAABB))
+			{
+				cache->AddItem(group, maskedFlags, i);
+			}
+		}
+	}
+
+	void Culling::BuildVisibilityCacheAABB(const RenderSnapshot* snapshot, VisibilityCache* cache, const BoundingBox& aabb, CullingGroup group, ushort typeMask)
+	{
+		PK_PROFILE_FUNCTION();
+
+		for (auto i = 0u; i < snapshot->renderables.size(); ++i)
+		{
+			auto& cullable = snapshot->renderables[i];
+
+			if (!((ushort)cullable.flags & typeMask))
+			{
+				continue;
+			}
+
+			if (!cullable.isCullable || Functions::IntersectAABB(aabb, cullable.worldAABB))
+			{
+				cache->AddItem(group, (ushort)cullable.flags, i);
+			}
+		}
+	}
+
+	uint Culling::CullMeshlets(const Structs::Meshlet* meshlets, uint count, const float4x4& localToClip, bool cullBackfaces, std::vector<Structs::IndexRange>& ranges, uint* rangeCount)
+	{
+		FrustumPlanes frustum;
+		Functions::ExtractFrustrumPlanes(localToClip, &frustum, true);
+
+		// Projection center in object space. Orthographic projections have it at infinity, the result is then the view direction.
+		auto view = glm::inverse(localToClip) * float4(0.0f, 0.0f, 1.0f, 0.0f);
+		auto isPerspective = glm::abs(view.w) > 1e-6f * glm::length(float3(view));
+		auto viewPosition = isPerspective ? float3(view) / view.w : PK_FLOAT3_ZERO;
+		auto viewDirection = isPerspective ? PK_FLOAT3_ZERO : glm::normalize(float3(view));
+		auto firstRange = *rangeCount;
+
+		for (auto i = 0u; i < count; ++i)
+		{
+			auto& meshlet = meshlets[i];
+			auto isVisible = true;
+
+			for (auto j = 0; j < 6 && isVisible; ++j)
+			{
+				isVisible = glm::dot(float3(frustum.planes[j]), meshlet.center) + frustum.planes[j].w >= -meshlet.radius;
+			}
+
+			if (isVisible && cullBackfaces)
+			{
+				auto direction = isPerspective ? glm::normalize(meshlet.coneApex - viewPosition) : viewDirection;
+				isVisible = glm::dot(direction, meshlet.coneAxis) < meshlet.coneCutoff;
+			}
+
+			if (!isVisible)
+			{
+				continue;
+			}
+
+			if (*rangeCount > firstRange)
+			{
+				auto& previous = ranges.at(*rangeCount - 1);
+
+				if (previous.offset + previous.count == meshlet.indexOffset)
+				{
+					previous.count += meshlet.indexCount;
+					continue;
+				}
+			}
+
+			Utilities::PushVectorElement(ranges, rangeCount, Structs::IndexRange { meshlet.indexOffset, meshlet.indexCount });
+		}
+
+		return *rangeCount - firstRange;
+	}
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "Core/BufferView.h"
 #include "ECS/EntityDatabase.h"
+#include "Rendering/RenderSnapshot.h"
+#include "Rendering/Structs/StructsCommon.h"
 #include <vector>
 #include <hlslmath.h>
 
@@ -18,6 +20,30 @@ namespace PK::Rendering::Culling
 
     typedef void (*OnVisibleItemMulti)(ECS::EntityDatabase*, ECS::EGID, uint clipIndex, float depth, void*);
 
+    // Snapshot variants receive an index into RenderSnapshot::renderables instead of an entity id.
+    typedef void (*OnVisibleSnapshotItem)(const RenderSnapshot*, uint index, float depth, void*);
+
+    typedef void (*OnVisibleSnapshotItemMulti)(const RenderSnapshot*, uint index, uint clipIndex, float depth, void*);
+
+    // Camera pass submesh culling of a frame.
+    struct SubmeshCullingStatistics
+    {
+        uint visibleRenderables = 0;
+        // Submeshes of the visible renderables, drawn or culled.
+        uint submeshes = 0;
+        // Visible renderables with several submeshes that cross the frustum, their submeshes are tested individually.
+        uint partialRenderables = 0;
+        uint testedSubmeshes = 0;
+        uint culledSubmeshes = 0;
+    };
+
+    // Unscaled frame time accumulated while submesh culling is enabled or disabled.
+    struct SubmeshCullingFrameTime
+    {
+        double seconds = 0.0;
+        uint64_t frames = 0ull;
+    };
+
     class VisibilityCache
     {
         private:
@@ -63,5 +89,23 @@ namespace PK::Rendering::Culling
     
     void BuildVisibilityCacheAABB(PK::ECS::EntityDatabase* entityDb, VisibilityCache* cache, const BoundingBox& aabb, CullingGroup group, ushort typeMask);
 
-    void ResetEntityVisibilities(PK::ECS::EntityDatabase* entityDb);
+    void ExecuteOnVisibleItemsCubeFaces(const RenderSnapshot* snapshot, const BoundingBox& aabb, ushort typeMask, OnVisibleSnapshotItemMulti onvisible, void* context);
+
+    void ExecuteOnVisibleItemsFrustum(const RenderSnapshot* snapshot, const float4x4& matrix, ushort typeMask, OnVisibleSnapshotItemMulti onvisible, void* context);
+    
+    void ExecuteOnVisibleItemsCascades(const RenderSnapshot* snapshot, const float4x4* cascades, uint count, ushort typeMask, OnVisibleSnapshotItemMulti onvisible, void* context);
+
+    void ExecuteOnVisibleItemsAABB(const RenderSnapshot* snapshot, const BoundingBox& aabb, ushort typeMask, OnVisibleSnapshotItem onvisible, void* context);
+
+    void ExecuteOnVisibleItemsSphere(const RenderSnapshot* snapshot, const float3& center, float radius, ushort typeMask, OnVisibleSnapshotItem onvisible, void* context);
+
+    // Cached items are indices into RenderSnapshot::renderables.
+    void BuildVisibilityCacheFrustum(const RenderSnapshot* snapshot, VisibilityCache* cache, const float4x4& matrix, CullingGroup group, ushort typeMask);
+    
+    void BuildVisibilityCacheAABB(const RenderSnapshot* snapshot, VisibilityCache* cache, const BoundingBox& aabb, CullingGroup group, ushort typeMask);
+
+    // Appends the index ranges of the meshlets that intersect the frustum of localToClip, adjacent ranges are merged.
+    // Meshlets that face away from the view are culled only with cullBackfaces, passes that draw back faces must not set it.
+    // Returns the number of ranges appended.
+    uint CullMeshlets(const Structs::Meshlet* meshlets, uint count, const float4x4& localToClip, bool cullBackfaces, std::vector<Structs::IndexRange>& ranges, uint* rangeCount);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Utilities/Utilities.h"
 #include "Rendering/GizmoRenderer.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering
 {
@@ -13,7 +14,10 @@ namespace PK::Rendering
 
     GizmoRenderer::GizmoRenderer(ECS::Sequencer* sequencer, AssetDatabase* assetDatabase, bool enabled)
     {
+        Core::MemoryScope memoryScope("GizmoRenderer");
+
         m_sequencer = sequencer;
+        m_stepHandle = sequencer->GetHandle<GizmoRenderer>(this, 0);
         m_gizmoShader = assetDatabase->Find<Shader>("SH_WS_Gizmos");
         m_vertexBuffer = CreateRef<ComputeBuffer>(BufferLayout({ { PK_TYPE::FLOAT4, "POSITION" }, { PK_TYPE::FLOAT4, "COLOR" } }), 32, false, GL_STREAM_DRAW);
         m_enabled = enabled;
@@ -143,7 +147,7 @@ namespace PK::Rendering
         auto matrix = GraphicsAPI::GetActiveViewProjectionMatrix();
         Functions::ExtractFrustrumPlanes(matrix, &m_frustrumPlanes, true);
     
-        m_sequencer->Next<GizmoRenderer>(this, this, 0);
+        m_sequencer->Next(m_stepHandle, this);
     
         if (m_vertexCount <= 0)
         {
@@ -38,6 +38,7 @@ namespace PK::Rendering
             GizmoVertex* ReserveVertices(uint count);
     
             ECS::Sequencer* m_sequencer = nullptr;
+            ECS::StepHandle m_stepHandle = nullptr;
             FrustumPlanes m_frustrumPlanes;
             Ref<ComputeBuffer> m_vertexBuffer;
             Shader* m_gizmoShader = nullptr;
@@ -142,6 +142,13 @@ namespace PK::Rendering::GraphicsAPI
 
 		return total_mem_kb - cur_avail_mem_kb;
 	}
+
+	// Shader compiles & links can be polled for completion instead of blocking on the first status query.
+	bool GraphicsAPI::SupportsParallelShaderCompile()
+	{
+		static const bool isSupported = glfwExtensionSupported("GL_KHR_parallel_shader_compile") == GLFW_TRUE || glfwExtensionSupported("GL_ARB_parallel_shader_compile") == GLFW_TRUE;
+		return isSupported;
+	}
 	
 	void GraphicsAPI::ResetResourceBindings() { RESOURCE_BINDINGS.ResetBindStates(); }
 
@@ -422,6 +429,20 @@ namespace PK::Rendering::GraphicsAPI
 			}
 		}
 
+		if (descriptor.mesh != nullptr)
+		{
+			auto* hashCache = HashCache::Get();
+			auto isCompressed = descriptor.mesh->HasCompressedVertices();
+			SetGlobalKeyword(hashCache->PK_VERTEX_COMPRESSED, isCompressed);
+
+			if (isCompressed)
+			{
+				const auto& bounds = descriptor.mesh->GetQuantizationBounds();
+				SetGlobalFloat3(hashCache->pk_MeshQuantizationMin, bounds.min);
+				SetGlobalFloat3(hashCache->pk_MeshQuantizationExtents, bounds.max - bounds.min);
+			}
+		}
+
 		if (descriptor.shader != nullptr)
 		{
 			descriptor.shader->ResetKeywords();
@@ -467,12 +488,12 @@ namespace PK::Rendering::GraphicsAPI
 
 		if (descriptor.mesh != nullptr)
 		{
-			RESOURCE_BINDINGS.BindMesh(descriptor.mesh->GetGraphicsID());
+			RESOURCE_BINDINGS.BindMesh(descriptor.mesh->GetVertexArrayID());
 		}
 
 		if (descriptor.argumentsBufferId != 0)
 		{
-			glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, descriptor.argumentsBufferId);
+			glBindBuffer(descriptor.command == DrawCommand::MeshIndirect ? GL_DRAW_INDIRECT_BUFFER : GL_DISPATCH_INDIRECT_BUFFER, descriptor.argumentsBufferId);
 		}
 
 		switch (descriptor.command)
@@ -480,13 +501,20 @@ namespace PK::Rendering::GraphicsAPI
 			case DrawCommand::Mesh:
 			{
 				auto indexRange = descriptor.mesh->GetSubmeshIndexRange(descriptor.submesh);
-				glDrawElements(GL_TRIANGLES, indexRange.count, GL_UNSIGNED_INT, (GLvoid*)(size_t)(indexRange.offset * sizeof(GLuint)));
+				auto firstIndex = (size_t)(descriptor.mesh->GetBaseIndex() + indexRange.offset);
+				glDrawElementsBaseVertex(GL_TRIANGLES, indexRange.count, GL_UNSIGNED_INT, (GLvoid*)(firstIndex * sizeof(GLuint)), descriptor.mesh->GetBaseVertex());
 				break;
 			}
 			case DrawCommand::MeshInstanced:
 			{
 				auto indexRange = descriptor.mesh->GetSubmeshIndexRange(descriptor.submesh);
-				glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indexRange.count, GL_UNSIGNED_INT, (GLvoid*)(size_t)(indexRange.offset * sizeof(GLuint)), (GLsizei)descriptor.count, (GLuint)descriptor.offset);
+				auto firstIndex = (size_t)(descriptor.mesh->GetBaseIndex() + indexRange.offset);
+				glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, indexRange.count, GL_UNSIGNED_INT, (GLvoid*)(firstIndex * sizeof(GLuint)), (GLsizei)descriptor.count, descriptor.mesh->GetBaseVertex(), (GLuint)descriptor.offset);
+				break;
+			}
+			case DrawCommand::MeshIndirect:
+			{
+				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (GLvoid*)(descriptor.offset * sizeof(DrawIndirectArguments)), (GLsizei)descriptor.count, 0);
 				break;
 			}
 			case DrawCommand::Procedural:
@@ -1036,6 +1064,100 @@ namespace PK::Rendering::GraphicsAPI
 		ExecuteDrawCall(descriptor);
 	}
 
+	void GraphicsAPI::DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader)
+	{
+		DrawCallDescriptor descriptor;
+		descriptor.shader = shader;
+		descriptor.mesh = mesh;
+		descriptor.offset = offset;
+		descriptor.count = count;
+		descriptor.argumentsBufferId = argumentsBuffer;
+		descriptor.command = DrawCommand::MeshIndirect;
+		ExecuteDrawCall(descriptor);
+	}
+
+	void GraphicsAPI::DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader, const FixedStateAttributes& attributes)
+	{
+		DrawCallDescriptor descriptor;
+		descriptor.shader = shader;
+		descriptor.mesh = mesh;
+		descriptor.attributes = &attributes;
+		descriptor.offset = offset;
+		descriptor.count = count;
+		descriptor.argumentsBufferId = argumentsBuffer;
+		descriptor.command = DrawCommand::MeshIndirect;
+		ExecuteDrawCall(descriptor);
+	}
+
+	void GraphicsAPI::DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader, const ShaderPropertyBlock& propertyBlock)
+	{
+		DrawCallDescriptor descriptor;
+		descriptor.shader = shader;
+		descriptor.mesh = mesh;
+		descriptor.propertyBlock1 = &propertyBlock;
+		descriptor.offset = offset;
+		descriptor.count = count;
+		descriptor.argumentsBufferId = argumentsBuffer;
+		descriptor.command = DrawCommand::MeshIndirect;
+		ExecuteDrawCall(descriptor);
+	}
+
+	void GraphicsAPI::DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader, const ShaderPropertyBlock& propertyBlock, const FixedStateAttributes& attributes)
+	{
+		DrawCallDescriptor descriptor;
+		descriptor.shader = shader;
+		descriptor.mesh = mesh;
+		descriptor.propertyBlock1 = &propertyBlock;
+		descriptor.attributes = &attributes;
+		descriptor.offset = offset;
+		descriptor.count = count;
+		descriptor.argumentsBufferId = argumentsBuffer;
+		descriptor.command = DrawCommand::MeshIndirect;
+		ExecuteDrawCall(descriptor);
+	}
+
+	void GraphicsAPI::DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, const Material* material)
+	{
+		DrawCallDescriptor descriptor;
+		descriptor.shader = material->GetShader();
+		descriptor.mesh = mesh;
+		descriptor.propertyBlock0 = material;
+		descriptor.offset = offset;
+		descriptor.count = count;
+		descriptor.argumentsBufferId = argumentsBuffer;
+		descriptor.command = DrawCommand::MeshIndirect;
+		ExecuteDrawCall(descriptor);
+	}
+
+	void GraphicsAPI::DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, const Material* material, const FixedStateAttributes& attributes)
+	{
+		DrawCallDescriptor descriptor;
+		descriptor.shader = material->GetShader();
+		descriptor.mesh = mesh;
+		descriptor.propertyBlock0 = material;
+		descriptor.attributes = &attributes;
+		descriptor.offset = offset;
+		descriptor.count = count;
+		descriptor.argumentsBufferId = argumentsBuffer;
+		descriptor.command = DrawCommand::MeshIndirect;
+		ExecuteDrawCall(descriptor);
+	}
+
+	void GraphicsAPI::DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, const Material* material, const ShaderPropertyBlock& propertyBlock, const FixedStateAttributes& attributes)
+	{
+		DrawCallDescriptor descriptor;
+		descriptor.shader = material->GetShader();
+		descriptor.mesh = mesh;
+		descriptor.propertyBlock0 = material;
+		descriptor.propertyBlock1 = &propertyBlock;
+		descriptor.attributes = &attributes;
+		descriptor.offset = offset;
+		descriptor.count = count;
+		descriptor.argumentsBufferId = argumentsBuffer;
+		descriptor.command = DrawCommand::MeshIndirect;
+		ExecuteDrawCall(descriptor);
+	}
+
 	void GraphicsAPI::DrawProcedural(Shader* shader, GLenum topology, size_t offset, size_t count)
 	{
 		DrawCallDescriptor descriptor;
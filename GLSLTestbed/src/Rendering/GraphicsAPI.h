@@ -30,6 +30,7 @@ namespace PK::Rendering::GraphicsAPI
 	const RenderTexture* GetBackBuffer();
 	int GetActiveShaderProgramId();
 	int GetMemoryUsageKB();
+	bool SupportsParallelShaderCompile();
 
 	void ResetResourceBindings();
 	void ClearGlobalProperties();
@@ -146,6 +147,15 @@ namespace PK::Rendering::GraphicsAPI
 	void DrawMeshInstanced(const Mesh* mesh, int submesh, uint offset, uint count, const Material* material, const ShaderPropertyBlock& propertyBlock);
 	void DrawMeshInstanced(const Mesh* mesh, int submesh, uint offset, uint count, const Material* material, const ShaderPropertyBlock& propertyBlock, const FixedStateAttributes& attributes);
 
+	// Executes count commands of type DrawIndirectArguments starting at command offset in argumentsBuffer.
+	void DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader);
+	void DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader, const FixedStateAttributes& attributes);
+	void DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader, const ShaderPropertyBlock& propertyBlock);
+	void DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, Shader* shader, const ShaderPropertyBlock& propertyBlock, const FixedStateAttributes& attributes);
+	void DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, const Material* material);
+	void DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, const Material* material, const FixedStateAttributes& attributes);
+	void DrawMeshIndirect(const Mesh* mesh, const GraphicsID& argumentsBuffer, uint offset, uint count, const Material* material, const ShaderPropertyBlock& propertyBlock, const FixedStateAttributes& attributes);
+
 	void DrawProcedural(Shader* shader, GLenum topology, size_t offset, size_t count);
 	void DrawProcedural(Shader* shader, GLenum topology, size_t offset, size_t count, const ShaderPropertyBlock& propertyBlock);
 	void DrawProcedural(const Material* material, GLenum topology, size_t offset, size_t count, const ShaderPropertyBlock& propertyBlock);
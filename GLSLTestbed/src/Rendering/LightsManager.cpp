@@ -1,7 +1,9 @@
 #include "PrecompiledHeader.h"
 #include "Utilities/Utilities.h"
 #include "Utilities/HashCache.h"
+#include "Core/Profiler.h"
 #include "LightsManager.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering
 {
@@ -9,26 +11,46 @@ namespace PK::Rendering
 	{
 		ShadowmapData* data;
 		uint index;
+		// World to clip matrix of each clip index, used to cull meshlets.
+		const float4x4* clipMatrices;
+		bool cullBackfaces;
 	};
 
-	static int LightViewCompare(PK::ECS::EntityViews::LightRenderable* a, PK::ECS::EntityViews::LightRenderable* b)
+	// Same projection as GetCubeClipPos in Shadowmapping.glsl.
+	static float4x4 GetCubeFaceMatrix(const float3& position, float radius, uint faceIndex)
 	{
-		if (a->light->castShadows < b->light->castShadows)
+		const float3 faceSigns[6] = { {-1,-1,1}, {1,-1,-1}, {1,1,1}, {1,-1,-1}, {1,-1,1}, {-1,-1,-1} };
+		const uint3 swizzles[6] = { {2,1,0}, {2,1,0}, {0,2,1}, {0,2,1}, {0,1,2}, {0,1,2} };
+
+		auto& signs = faceSigns[faceIndex];
+		auto& swizzle = swizzles[faceIndex];
+		float4x4 matrix(0.0f);
+		matrix[swizzle.x][0] = signs.x;
+		matrix[swizzle.y][1] = signs.y;
+		matrix[swizzle.z][2] = signs.z * 1.020202f;
+		matrix[swizzle.z][3] = signs.z;
+		matrix[3] = matrix * float4(-position, 0.0f) + float4(0.0f, 0.0f, -radius * 0.020202f, 0.0f);
+		return matrix;
+	}
+
+	static int LightViewCompare(const VisibleLight& a, const VisibleLight& b)
+	{
+		if (a.light->castShadows < b.light->castShadows)
 		{
 			return -1;
 		}
 
-		if (a->light->castShadows > b->light->castShadows)
+		if (a.light->castShadows > b.light->castShadows)
 		{
 			return 1;
 		}
 
-		if (a->light->lightType < b->light->lightType)
+		if (a.light->lightType < b.light->lightType)
 		{
 			return -1;
 		}
 
-		if (a->light->lightType > b->light->lightType)
+		if (a.light->lightType > b.light->lightType)
 		{
 			return 1;
 		}
@@ -36,7 +58,7 @@ namespace PK::Rendering
 		return 0;
 	}
 
-	static void QuickSortVisibleLights(PK::ECS::EntityViews::LightRenderable** arr, int low, int high)
+	static void QuickSortVisibleLights(VisibleLight* arr, int low, int high)
 	{
 		int i = low;
 		int j = high;
@@ -75,16 +97,19 @@ namespace PK::Rendering
 		}
 	}
 
-	static void OnCullVisibleShadowmap(ECS::EntityDatabase* entityDb, ECS::EGID egid, uint clipIndex, float depth, void* context)
+	static void OnCullVisibleShadowmap(const RenderSnapshot* snapshot, uint renderableIndex, uint clipIndex, float depth, void* context)
 	{
 		auto ctx = reinterpret_cast<ShadowmapContext*>(context);
-		auto renderable = entityDb->Query<ECS::EntityViews::MeshRenderable>(egid);
+		auto& renderable = snapshot->renderables.at(renderableIndex);
 		auto index = (clipIndex << 24u) | ctx->index;
-		Batching::QueueDraw(&ctx->data->Batches, renderable->mesh->sharedMesh, { &renderable->transform->localToWorld, depth, index });
+		auto lod = renderable.mesh->SelectLod(-1, snapshot->GetPixelsPerUnit(renderable), snapshot->lodPixelError);
+		Batching::QueueDraw(&ctx->data->Batches, renderable.mesh, renderable.mesh->GetLodSubmesh(-1, lod), { &renderable.localToWorld, depth, index }, ctx->clipMatrices[clipIndex], ctx->cullBackfaces);
 	}
 
 	LightsManager::LightsManager(AssetDatabase* assetDatabase, const ApplicationConfig* config) : m_cascadeLinearity(config->CascadeLinearity), m_zcullLights(config->ZCullLights)
 	{
+		Core::MemoryScope memoryScope("LightsManager");
+
 		m_computeLightAssignment = assetDatabase->Find<Shader>("CS_ClusteredLightAssignment");
 		m_computeDepthTiles = assetDatabase->Find<Shader>("CS_ClusteredDepthMax");
 		m_debugVisualize = assetDatabase->Find<Shader>("SH_VS_ClusterDebug");
@@ -176,8 +201,10 @@ namespace PK::Rendering
 		return cascadeSplits;
 	}
 
-	void LightsManager::UpdateShadowmaps(ECS::EntityDatabase* entityDb, const float4x4& inverseViewProjection, float zNear, float zFar)
+	void LightsManager::UpdateShadowmaps(const RenderSnapshot* snapshot, const float4x4& inverseViewProjection, float zNear, float zFar)
 	{
+		PK_PROFILE_FUNCTION();
+
 		m_properties.SetTexture(HashCache::Get()->_ShadowmapBatchCube, m_shadowmapData.LightIndices[(int)LightType::Point].SceneRenderTarget->GetColorBuffer(0)->GetGraphicsID());
 		m_properties.SetTexture(HashCache::Get()->_ShadowmapBatch0, m_shadowmapData.LightIndices[(int)LightType::Spot].SceneRenderTarget->GetColorBuffer(0)->GetGraphicsID());
 		m_properties.SetTexture(HashCache::Get()->_ShadowmapBatch1, m_shadowmapData.ShadowmapAtlas->GetColorBuffer(0)->GetGraphicsID());
@@ -196,6 +223,8 @@ namespace PK::Rendering
 		for (auto typeIdx = 0; typeIdx < (int)LightType::TypeCount; ++typeIdx)
 		{
 			auto& typedata = m_shadowmapData.LightIndices[typeIdx];
+			auto& attributes = typedata.ShaderRenderShadows->GetFixedStateAttributes();
+			auto cullBackfaces = attributes.CullEnabled && attributes.CullMode == GL_BACK;
 			auto batchCount = (uint)std::ceil(typedata.viewCount / (float)typedata.maxBatchSize);
 
 			for (auto batch = 0u; batch < batchCount; ++batch)
@@ -203,47 +232,57 @@ namespace PK::Rendering
 				auto batchSize = std::min(typedata.viewCount - batch * typedata.maxBatchSize, typedata.maxBatchSize);
 				auto tileCount = (batchSize * ShadowmapData::BatchSize) / typedata.maxBatchSize;
 				auto baseLightIndex = typedata.viewFirst + batch * typedata.maxBatchSize;
-				auto atlasIndex = m_visibleLights[baseLightIndex]->light->shadowmapIndex;
+				auto atlasIndex = m_visibleLights[baseLightIndex].shadowmapIndex;
 				auto maxDistance = 0.0f;
 
 				Batching::ResetCollection(&m_shadowmapData.Batches);
 
 				for (uint i = 0; i < batchSize; ++i)
 				{
-					auto* lightview = m_visibleLights[baseLightIndex + i];
-					auto radius = lightview->light->radius;
-					auto baseKey = ((uint)i << 16u) | (lightview->light->linearIndex & 0xFFFF);
+					auto& visibleLight = m_visibleLights[baseLightIndex + i];
+					auto* light = visibleLight.light;
+					auto radius = light->radius;
+					auto baseKey = ((uint)i << 16u) | (visibleLight.linearIndex & 0xFFFF);
 
-					ShadowmapContext ctx = { &m_shadowmapData, baseKey };
+					ShadowmapContext ctx = { &m_shadowmapData, baseKey, nullptr, cullBackfaces };
 
 					switch ((LightType)typeIdx)
 					{
 						case LightType::Point:
 						{
 							maxDistance = glm::max(maxDistance, radius);
-							auto bounds = entityDb->Query<ECS::EntityViews::BaseRenderable>(lightview->GID)->bounds->worldAABB;
-							Culling::ExecuteOnVisibleItemsCubeFaces(entityDb, bounds, cullingMask, OnCullVisibleShadowmap, &ctx);
+							float4x4 faces[6];
+
+							for (auto j = 0u; j < 6u; ++j)
+							{
+								faces[j] = GetCubeFaceMatrix(light->position, radius, j);
+							}
+
+							ctx.clipMatrices = faces;
+							Culling::ExecuteOnVisibleItemsCubeFaces(snapshot, light->worldAABB, cullingMask, OnCullVisibleShadowmap, &ctx);
 							break;
 						}
 						case LightType::Spot:
 						{
 							maxDistance = glm::max(maxDistance, radius);
-							auto projection = Functions::GetPerspective(lightview->light->angle, 1.0f, 0.1f, lightview->light->radius) * lightview->transform->worldToLocal;
-							Culling::ExecuteOnVisibleItemsFrustum(entityDb, projection, cullingMask, OnCullVisibleShadowmap, &ctx);
+							auto projection = Functions::GetPerspective(light->angle, 1.0f, 0.1f, light->radius) * light->worldToLocal;
+							ctx.clipMatrices = &projection;
+							Culling::ExecuteOnVisibleItemsFrustum(snapshot, projection, cullingMask, OnCullVisibleShadowmap, &ctx);
 							break;
 						}
 						case LightType::Directional:
 						{
 							float4x4 cascades[ShadowmapData::BatchSize];
 							auto lightRange = Functions::GetShadowCascadeMatrices(
-								lightview->transform->worldToLocal, 
+								light->worldToLocal, 
 								inverseViewProjection, 
 								cascadeSplits.planes,
-								-lightview->light->radius, 
+								-light->radius, 
 								ShadowmapData::BatchSize, 
 								cascades);
 
-							Culling::ExecuteOnVisibleItemsCascades(entityDb, cascades, ShadowmapData::BatchSize, cullingMask, OnCullVisibleShadowmap, &ctx);
+							ctx.clipMatrices = cascades;
+							Culling::ExecuteOnVisibleItemsCascades(snapshot, cascades, ShadowmapData::BatchSize, cullingMask, OnCullVisibleShadowmap, &ctx);
 							maxDistance = glm::max(maxDistance, lightRange);
 							break;
 						}
@@ -266,13 +305,17 @@ namespace PK::Rendering
 		}
 	}
 
-	void LightsManager::UpdateLightBuffers(PK::ECS::EntityDatabase* entityDb, Core::BufferView<uint> visibleLights, const float4x4& inverseViewProjection, float zNear, float zFar)
+	void LightsManager::UpdateLightBuffers(const RenderSnapshot* snapshot, Core::BufferView<uint> visibleLights, const float4x4& inverseViewProjection, float zNear, float zFar)
 	{
+		PK_PROFILE_FUNCTION();
+
 		m_visibleLightCount = 0;
 
 		for (size_t i = 0; i < visibleLights.count; ++i)
 		{
-			Utilities::PushVectorElement(m_visibleLights, &m_visibleLightCount, entityDb->Query<ECS::EntityViews::LightRenderable>(ECS::EGID(visibleLights[i], (uint)ECS::ENTITY_GROUPS::ACTIVE)));
+			VisibleLight visibleLight;
+			visibleLight.light = &snapshot->lights.at(snapshot->renderables.at(visibleLights[i]).light);
+			Utilities::PushVectorElement(m_visibleLights, &m_visibleLightCount, visibleLight);
 		}
 
 		if (m_visibleLightCount > 1)
@@ -293,40 +336,40 @@ namespace PK::Rendering
 		// Get visible shadowmap tiles per light type so that tile indexing can be ordered by light type
 		for (size_t i = 0; i < m_visibleLightCount; ++i)
 		{
-			auto* view = m_visibleLights.at(i);
-			view->light->linearIndex = (uint)i;
+			auto& view = m_visibleLights.at(i);
+			view.linearIndex = (uint)i;
 
-			switch (view->light->lightType)
+			switch (view.light->lightType)
 			{
 				case LightType::Directional:
-					view->light->projectionIndex = lightProjectionCount;
+					view.projectionIndex = lightProjectionCount;
 					lightProjectionCount += ShadowmapData::BatchSize;
 					break;
 				case LightType::Point: 
-					view->light->projectionIndex = 0; 
+					view.projectionIndex = 0; 
 					break;
 				case LightType::Spot: 
-					view->light->projectionIndex = lightProjectionCount++;
+					view.projectionIndex = lightProjectionCount++;
 					break;
 			}
 
-			view->light->shadowmapIndex = 0xFFFFFFFF;
+			view.shadowmapIndex = 0xFFFFFFFF;
 
-			if (!view->light->castShadows || shadowMapCount >= m_shadowmapTileCount)
+			if (!view.light->castShadows || shadowMapCount >= m_shadowmapTileCount)
 			{
 				continue;
 			}
 
-			switch (view->light->lightType)
+			switch (view.light->lightType)
 			{
 				case LightType::Point:
 				case LightType::Spot:
-					view->light->shadowmapIndex = shadowMapCount++;
+					view.shadowmapIndex = shadowMapCount++;
 					break;
 				case LightType::Directional:
 					if (m_shadowmapTileCount - shadowMapCount >= ShadowmapData::BatchSize)
 					{
-						view->light->shadowmapIndex = shadowMapCount;
+						view.shadowmapIndex = shadowMapCount;
 						shadowMapCount += ShadowmapData::BatchSize;
 						break;
 					}
@@ -335,7 +378,7 @@ namespace PK::Rendering
 					continue;
 			}
 			
-			auto& indicesView = m_shadowmapData.LightIndices[(uint)view->light->lightType];
+			auto& indicesView = m_shadowmapData.LightIndices[(uint)view.light->lightType];
 			indicesView.viewFirst = std::min(indicesView.viewFirst, (uint)i);
 			++indicesView.viewCount;
 		}
@@ -350,41 +393,41 @@ namespace PK::Rendering
 
 		for (size_t i = 0; i < m_visibleLightCount; ++i)
 		{
-			auto* view = m_visibleLights.at(i);
+			auto& view = m_visibleLights.at(i);
 			auto position = PK_FLOAT4_ZERO;
 
-			switch (view->light->lightType)
+			switch (view.light->lightType)
 			{
 				case LightType::Directional:
-					position = float4(view->transform->rotation * PK_FLOAT3_FORWARD, 0.0f);
+					position = float4(view.light->rotation * PK_FLOAT3_FORWARD, 0.0f);
 					position.w = Functions::GetShadowCascadeMatrices(
-						view->transform->worldToLocal, 
+						view.light->worldToLocal, 
 						inverseViewProjection, 
 						cascades.planes, 
-						-view->light->radius, 
+						-view.light->radius, 
 						ShadowmapData::BatchSize, 
-						bufferMatrices.data + view->light->projectionIndex);
+						bufferMatrices.data + view.projectionIndex);
 					break;
 
 				case LightType::Point:
-					position = float4(view->transform->position, view->light->radius);
+					position = float4(view.light->position, view.light->radius);
 					break;
 
 				case LightType::Spot:
-					position = float4(view->transform->position, view->light->radius);
-					bufferMatrices[view->light->projectionIndex] = Functions::GetPerspective(view->light->angle, 1.0f, 0.1f, view->light->radius) * view->transform->worldToLocal;
-					bufferDirections[view->light->projectionIndex] = float4(view->transform->rotation * PK_FLOAT3_FORWARD, view->light->angle * PK_FLOAT_DEG2RAD);
+					position = float4(view.light->position, view.light->radius);
+					bufferMatrices[view.projectionIndex] = Functions::GetPerspective(view.light->angle, 1.0f, 0.1f, view.light->radius) * view.light->worldToLocal;
+					bufferDirections[view.projectionIndex] = float4(view.light->rotation * PK_FLOAT3_FORWARD, view.light->angle * PK_FLOAT_DEG2RAD);
 					break;
 			}
 
 			bufferLights[i] = 
 			{ 
-				view->light->color,
+				view.light->color,
 				position,
-				view->light->shadowmapIndex, 
-				view->light->projectionIndex, 
-				(uint)view->light->cookie, 
-				(uint)view->light->lightType 
+				view.shadowmapIndex, 
+				view.projectionIndex, 
+				(uint)view.light->cookie, 
+				(uint)view.light->lightType 
 			};
 		}
 
@@ -398,9 +441,11 @@ namespace PK::Rendering
 		}
 	}
 	
-	void LightsManager::Preprocess(PK::ECS::EntityDatabase* entityDb, Core::BufferView<uint> visibleLights, const uint2& resolution, const float4x4& inverseViewProjection, float zNear, float zFar)
+	void LightsManager::Preprocess(const RenderSnapshot* snapshot, Core::BufferView<uint> visibleLights, const uint2& resolution, const float4x4& inverseViewProjection, float zNear, float zFar)
 	{
-		UpdateLightBuffers(entityDb, visibleLights, inverseViewProjection, zNear, zFar);
+		PK_PROFILE_FUNCTION();
+
+		UpdateLightBuffers(snapshot, visibleLights, inverseViewProjection, zNear, zFar);
 
 		auto hashCache = HashCache::Get();
 		m_globalLightIndex->Clear();
@@ -410,11 +455,13 @@ namespace PK::Rendering
 		GraphicsAPI::SetGlobalComputeBuffer(hashCache->pk_LightMatrices, m_lightMatricesBuffer->GetGraphicsID());
 		GraphicsAPI::SetGlobalComputeBuffer(hashCache->pk_GlobalLightsList, m_globalLightsList->GetGraphicsID());
 		GraphicsAPI::SetGlobalImage(hashCache->pk_LightTiles, m_lightTiles->GetImageBindDescriptor(GL_READ_WRITE, 0, 0, true));
-		UpdateShadowmaps(entityDb, inverseViewProjection, zNear, zFar);
+		UpdateShadowmaps(snapshot, inverseViewProjection, zNear, zFar);
 	}
 	
 	void LightsManager::UpdateLightTiles(const uint2& resolution)
 	{	
+		PK_PROFILE_FUNCTION();
+
 		if (m_zcullLights)
 		{
 			auto depthCountX = (uint)std::ceilf(resolution.x / DepthGroupSize);
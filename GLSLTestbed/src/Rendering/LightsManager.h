@@ -6,6 +6,7 @@
 #include "ECS/Contextual/EntityViews/EntityViews.h"
 #include "Rendering/Batching.h"
 #include "Rendering/Culling.h"
+#include "Rendering/RenderSnapshot.h"
 #include "Rendering/Objects/Buffer.h"
 #include "Rendering/Objects/RenderTexture.h"
 #include "Rendering/Objects/TextureXD.h"
@@ -38,12 +39,22 @@ namespace PK::Rendering
 
     typedef struct ShadowCascades { float planes[5]; } ShadowCascades;
 
+    // Per frame light buffer indices. Kept here instead of the light component so that preprocessing doesn't write to the scene.
+    struct VisibleLight
+    {
+        const SnapshotLight* light = nullptr;
+        uint linearIndex = 0;
+        uint shadowmapIndex = 0;
+        uint projectionIndex = 0;
+    };
+
     class LightsManager : public PK::Core::NoCopy
     {
         public:
             LightsManager(AssetDatabase* assetDatabase, const ApplicationConfig* config);
 
-            void Preprocess(PK::ECS::EntityDatabase* entityDb, Core::BufferView<uint> visibleLights, const uint2& resolution, const float4x4& inverseViewProjection, float zNear, float zFar);
+            // Visible lights are indices into the snapshot renderables.
+            void Preprocess(const RenderSnapshot* snapshot, Core::BufferView<uint> visibleLights, const uint2& resolution, const float4x4& inverseViewProjection, float zNear, float zFar);
 
             void UpdateLightTiles(const uint2& resolution);
 
@@ -54,8 +65,8 @@ namespace PK::Rendering
             ShadowCascades GetCascadeZSplits(float znear, float zfar) const;
 
         private:
-            void UpdateShadowmaps(PK::ECS::EntityDatabase* entityDb, const float4x4& inverseViewProjection, float znear, float zfar);
-            void UpdateLightBuffers(PK::ECS::EntityDatabase* entityDb, Core::BufferView<uint> visibleLights, const float4x4& inverseViewProjection, float znear, float zfar);
+            void UpdateShadowmaps(const RenderSnapshot* snapshot, const float4x4& inverseViewProjection, float znear, float zfar);
+            void UpdateLightBuffers(const RenderSnapshot* snapshot, Core::BufferView<uint> visibleLights, const float4x4& inverseViewProjection, float znear, float zfar);
 
             const uint MaxLightsPerTile = 64;
             const uint GridSizeX = 16;
@@ -66,7 +77,7 @@ namespace PK::Rendering
 
             const bool m_zcullLights;
             const float m_cascadeLinearity;
-            std::vector<PK::ECS::EntityViews::LightRenderable*> m_visibleLights;
+            std::vector<VisibleLight> m_visibleLights;
             uint m_visibleLightCount;
             uint m_shadowmapCubeFaceSize;
             uint m_shadowmapTileSize;
@@ -1,7 +1,9 @@
 #include "PrecompiledHeader.h"
 #include "Rendering/MeshUtility.h"
 #include "Rendering/Structs/StructsCommon.h"
+#include "Core/Profiler.h"
 #include <mikktspace/mikktspace.h>
+#include <xmmintrin.h>
 
 namespace PK::Rendering::MeshUtility
 {
@@ -94,6 +96,7 @@ namespace PK::Rendering::MeshUtility
             unsigned int tangentOffset = 0;
             unsigned int texcoordOffset = 0;
             const unsigned int* indices = nullptr;
+            float* cornerTangents = nullptr;
             unsigned int vcount = 0;
             unsigned int icount = 0;
         };
@@ -162,89 +165,1724 @@ namespace PK::Rendering::MeshUtility
             tangent[2] = fvTangent[2];
             tangent[3] = fSign;
         }
+
+        // Results are returned unindexed, one tangent per face corner.
+        void SetTSpaceCorner(const SMikkTSpaceContext* pContext, const float fvTangent[], const float fSign, const int iFace, const int iVert)
+        {
+            auto meshData = reinterpret_cast<PKMeshData*>(pContext->m_pUserData);
+            auto tangent = meshData->cornerTangents + (iFace * 3 + iVert) * 4;
+            tangent[0] = fvTangent[0];
+            tangent[1] = fvTangent[1];
+            tangent[2] = fvTangent[2];
+            tangent[3] = fSign;
+        }
+    }
+
+    namespace WeldUtility
+    {
+        struct VertexHash
+        {
+            const uint32_t* words;
+            uint stride;
+
+            size_t operator()(uint index) const
+            {
+                auto vertex = words + (size_t)index * stride;
+                size_t hash = 2166136261u;
+
+                for (uint i = 0; i < stride; ++i)
+                {
+                    hash = (hash ^ vertex[i]) * 16777619u;
+                }
+
+                return hash;
+            }
+        };
+
+        struct VertexEquals
+        {
+            const uint32_t* words;
+            uint stride;
+
+            bool operator()(uint a, uint b) const
+            {
+                return memcmp(words + (size_t)a * stride, words + (size_t)b * stride, stride * sizeof(uint32_t)) == 0;
+            }
+        };
+    }
+
+    namespace CompressionUtility
+    {
+        inline float2 SignNotZero(const float2& v) { return float2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f); }
+
+        // Signed octahedral mapping, matches OctaEncodeSigned & OctaDecodeSigned in VertexCompression.glsl.
+        float2 OctaEncode(const float3& n)
+        {
+            auto length = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+
+            if (length <= 0.0f)
+            {
+                return PK_FLOAT2_ZERO;
+            }
+
+            auto p = float2(n.x, n.y) / length;
+            return n.z >= 0.0f ? p : (1.0f - glm::abs(float2(p.y, p.x))) * SignNotZero(p);
+        }
+
+        float3 OctaDecode(const float2& f)
+        {
+            auto n = float3(f.x, f.y, 1.0f - glm::abs(f.x) - glm::abs(f.y));
+            auto t = glm::max(-n.z, 0.0f);
+            n.x += n.x >= 0.0f ? -t : t;
+            n.y += n.y >= 0.0f ? -t : t;
+            return glm::normalize(n);
+        }
+
+        inline uint QuantizeUnorm(float value, uint bits) { return (uint)glm::round(glm::clamp(value, 0.0f, 1.0f) * (float)((1u << bits) - 1u)); }
+        inline float DequantizeUnorm(uint value, uint bits) { return (float)value / (float)((1u << bits) - 1u); }
+        inline short QuantizeSnorm16(float value) { return (short)glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f); }
+        inline float DequantizeSnorm16(short value) { return glm::max((float)value / 32767.0f, -1.0f); }
+        // acos loses too much precision for small angles.
+        inline float AngleDegrees(const float3& a, const float3& b) { return glm::degrees(glm::atan(glm::length(glm::cross(a, b)), glm::dot(a, b))); }
+    }
+
+    namespace TipsifyUtility
+    {
+        struct Adjacency
+        {
+            std::vector<uint> counts;
+            std::vector<uint> offsets;
+            std::vector<uint> triangles;
+        };
+
+        void BuildAdjacency(Adjacency& adjacency, const uint* indices, uint icount, uint vcount)
+        {
+            adjacency.counts.assign(vcount, 0u);
+            adjacency.offsets.assign(vcount, 0u);
+            adjacency.triangles.resize(icount);
+
+            for (uint i = 0; i < icount; ++i)
+            {
+                adjacency.counts[indices[i]]++;
+            }
+
+            for (uint i = 0, offset = 0; i < vcount; ++i)
+            {
+                adjacency.offsets[i] = offset;
+                offset += adjacency.counts[i];
+            }
+
+            std::vector<uint> heads = adjacency.offsets;
+
+            for (uint i = 0; i < icount; ++i)
+            {
+                adjacency.triangles[heads[indices[i]]++] = i / 3;
+            }
+        }
+
+        // Returns the most recently used vertex that still has live triangles or the next one in input order.
+        uint SkipDeadEnd(std::vector<uint>& deadEnds, const std::vector<uint>& liveCounts, uint& cursor, uint vcount)
+        {
+            while (!deadEnds.empty())
+            {
+                auto vertex = deadEnds.back();
+                deadEnds.pop_back();
+
+                if (liveCounts[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+
+            for (; cursor < vcount; ++cursor)
+            {
+                if (liveCounts[cursor] > 0)
+                {
+                    return cursor;
+                }
+            }
+
+            return ~0u;
+        }
+    }
+
+    namespace SimplifyUtility
+    {
+        enum class VertexKind : uint8_t
+        {
+            // Single attribute vertex inside a closed fan, can collapse into any neighbour.
+            Manifold,
+            // Single attribute vertex on one open edge loop, can only slide along it.
+            Border,
+            // Two attribute vertices split by a uv or normal seam, both slide along the seam together.
+            Seam,
+            // Seam junctions, corners & non manifold vertices. Only other vertices are collapsed into these.
+            Locked
+        };
+
+        // Sum of squared distances to weighted planes, stored as a symmetric 4x4 matrix.
+        struct Quadric
+        {
+            float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+            float a10 = 0.0f, a20 = 0.0f, a21 = 0.0f;
+            float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+            float c = 0.0f;
+            float w = 0.0f;
+
+            void AddPlane(const float3& n, float d, float weight)
+            {
+                a00 += weight * n.x * n.x;
+                a11 += weight * n.y * n.y;
+                a22 += weight * n.z * n.z;
+                a10 += weight * n.y * n.x;
+                a20 += weight * n.z * n.x;
+                a21 += weight * n.z * n.y;
+                b0 += weight * n.x * d;
+                b1 += weight * n.y * d;
+                b2 += weight * n.z * d;
+                c += weight * d * d;
+                w += weight;
+            }
+
+            void Add(const Quadric& q)
+            {
+                a00 += q.a00;
+                a11 += q.a11;
+                a22 += q.a22;
+                a10 += q.a10;
+                a20 += q.a20;
+                a21 += q.a21;
+                b0 += q.b0;
+                b1 += q.b1;
+                b2 += q.b2;
+                c += q.c;
+                w += q.w;
+            }
+
+            // Weighted mean of the squared plane distances.
+            float Evaluate(const float3& p) const
+            {
+                auto rx = a00 * p.x + a10 * p.y + a20 * p.z;
+                auto ry = a10 * p.x + a11 * p.y + a21 * p.z;
+                auto rz = a20 * p.x + a21 * p.y + a22 * p.z;
+                auto r = rx * p.x + ry * p.y + rz * p.z + 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+                return w > 0.0f ? glm::abs(r) / w : 0.0f;
+            }
+        };
+
+        struct Collapse
+        {
+            uint source;
+            uint target;
+            float error;
+        };
+
+        struct PositionHash
+        {
+            const uint32_t* words;
+            uint stride;
+
+            size_t operator()(uint index) const
+            {
+                auto position = words + (size_t)index * stride;
+                size_t hash = 2166136261u;
+
+                for (uint i = 0; i < 3; ++i)
+                {
+                    hash = (hash ^ position[i]) * 16777619u;
+                }
+
+                return hash;
+            }
+        };
+
+        struct PositionEquals
+        {
+            const uint32_t* words;
+            uint stride;
+
+            bool operator()(uint a, uint b) const
+            {
+                return memcmp(words + (size_t)a * stride, words + (size_t)b * stride, 3 * sizeof(uint32_t)) == 0;
+            }
+        };
+
+        // Open edges have a triangle on one side only.
+        inline ulong EdgeKey(uint a, uint b) { return ((ulong)a << 32ull) | (ulong)b; }
+
+        // Edges are weighted by length, triangles by area. Keeps borders from shrinking much faster than surfaces.
+        const float BorderWeight = 10.0f;
+        // Collapses that rotate a triangle normal by more than ~75 degrees are rejected.
+        const float FlipThreshold = 0.25f;
+    }
+
+    namespace MeshletUtility
+    {
+        // Bounding sphere around the triangle bounds & a normal cone that contains every triangle normal.
+        // Source: https://github.com/zeux/meshoptimizer/blob/master/src/clusterizer.cpp
+        void ComputeBounds(const float* vertices, uint stride, uint vertexOffset, const uint* indices, uint icount, Structs::Meshlet& meshlet)
+        {
+            // Normal cones wider than ~85 degrees cull too little to be worth testing.
+            const float minConeDot = 0.1f;
+
+            auto tcount = icount / 3;
+            auto bmin = PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+            auto bmax = -PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+            auto axis = PK_FLOAT3_ZERO;
+            std::vector<float3> normals(tcount);
+            std::vector<float3> corners(tcount);
+
+            for (uint i = 0; i < tcount; ++i)
+            {
+                auto p0 = *reinterpret_cast<const float3*>(vertices + (size_t)indices[i * 3 + 0] * stride + vertexOffset);
+                auto p1 = *reinterpret_cast<const float3*>(vertices + (size_t)indices[i * 3 + 1] * stride + vertexOffset);
+                auto p2 = *reinterpret_cast<const float3*>(vertices + (size_t)indices[i * 3 + 2] * stride + vertexOffset);
+                auto normal = glm::cross(p1 - p0, p2 - p0);
+                auto length = glm::length(normal);
+
+                bmin = glm::min(bmin, glm::min(p0, glm::min(p1, p2)));
+                bmax = glm::max(bmax, glm::max(p0, glm::max(p1, p2)));
+                normals[i] = length > 0.0f ? normal / length : PK_FLOAT3_ZERO;
+                corners[i] = p0;
+                axis += normals[i];
+            }
+
+            meshlet.center = (bmin + bmax) * 0.5f;
+            meshlet.radius = 0.0f;
+
+            for (uint i = 0; i < icount; ++i)
+            {
+                auto position = *reinterpret_cast<const float3*>(vertices + (size_t)indices[i] * stride + vertexOffset);
+                meshlet.radius = glm::max(meshlet.radius, glm::length(position - meshlet.center));
+            }
+
+            meshlet.coneApex = meshlet.center;
+            meshlet.coneAxis = PK_FLOAT3_ZERO;
+            meshlet.coneCutoff = 2.0f;
+
+            auto axisLength = glm::length(axis);
+
+            if (axisLength <= 0.0f)
+            {
+                return;
+            }
+
+            axis /= axisLength;
+            auto minDot = 1.0f;
+
+            for (uint i = 0; i < tcount; ++i)
+            {
+                // Degenerate triangles are never rasterized.
+                if (normals[i] != PK_FLOAT3_ZERO)
+                {
+                    minDot = glm::min(minDot, glm::dot(normals[i], axis));
+                }
+            }
+
+            if (minDot <= minConeDot)
+            {
+                return;
+            }
+
+            // Move the apex back along the axis until it is behind every triangle plane.
+            auto maxT = 0.0f;
+
+            for (uint i = 0; i < tcount; ++i)
+            {
+                if (normals[i] != PK_FLOAT3_ZERO)
+                {
+                    maxT = glm::max(maxT, glm::dot(meshlet.center - corners[i], normals[i]) / glm::dot(axis, normals[i]));
+                }
+            }
+
+            meshlet.coneApex = meshlet.center - axis * maxT;
+            meshlet.coneAxis = axis;
+            meshlet.coneCutoff = sqrt(1.0f - minDot * minDot);
+        }
+    }
+
+
+    void CalculateNormals(const float3* vertices, const uint* indices, float3* normals, uint vcount, uint icount, float sign)
+    {
+        for (uint i = 0, j = 0; i < icount; i += 3)
+        {
+            auto i0 = indices[i + 0];
+            auto i1 = indices[i + 1];
+            auto i2 = indices[i + 2];
+            auto v0 = vertices[i0];
+            auto v1 = vertices[i1];
+            auto v2 = vertices[i2];
+
+            auto tangent = glm::normalize(v1 - v0);
+            auto binormal = glm::normalize(v2 - v0);
+            auto normal = glm::normalize(glm::cross(tangent, binormal));
+            normals[i0] += normal;
+            normals[i1] += normal;
+            normals[i2] += normal;
+        }
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            normals[i] = glm::normalize(normals[i]) * sign;
+        }
+
+    }
+
+    void CalculateTangents(const float3* vertices, const float3* normals, const float2* texcoords, const uint* indices, float4* tangents, uint vcount, uint icount)
+    {
+        MikktsInterface0::PKMeshData data;
+        data.vertices = reinterpret_cast<const float*>(vertices);
+        data.normals = reinterpret_cast<const float*>(normals);
+        data.tangents = reinterpret_cast<float*>(tangents);
+        data.texcoords = reinterpret_cast<const float*>(texcoords);
+        data.indices = indices;
+        data.vcount = vcount;
+        data.icount = icount;
+
+        SMikkTSpaceInterface mikttInterface;
+        mikttInterface.m_getNumFaces = MikktsInterface0::GetNumFaces;
+        mikttInterface.m_getNumVerticesOfFace = MikktsInterface0::GetNumVerticesOfFace;
+        mikttInterface.m_getPosition = MikktsInterface0::GetPosition;
+        mikttInterface.m_getNormal = MikktsInterface0::GetNormal;
+        mikttInterface.m_getTexCoord = MikktsInterface0::GetTexCoord;
+        mikttInterface.m_setTSpaceBasic = MikktsInterface0::SetTSpaceBasic;
+        mikttInterface.m_setTSpace = nullptr;
+
+        SMikkTSpaceContext context;
+        context.m_pInterface = &mikttInterface;
+        context.m_pUserData = &data;
+
+        PK_CORE_ASSERT(genTangSpaceDefault(&context), "Failed to calculate tangents");
+    }
+
+    void CalculateTangents(void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint tangentOffset, uint texcoordOffset, const uint* indices, uint vcount, uint icount)
+    {
+        MikktsInterface1::PKMeshData data;
+        data.vertices = reinterpret_cast<float*>(vertices);
+        data.stride = stride;
+        data.vertexOffset = vertexOffset;
+        data.normalOffset = normalOffset;
+        data.tangentOffset = tangentOffset;
+        data.texcoordOffset = texcoordOffset;
+        data.indices = indices;
+        data.vcount = vcount;
+        data.icount = icount;
+
+        SMikkTSpaceInterface mikttInterface;
+        mikttInterface.m_getNumFaces = MikktsInterface1::GetNumFaces;
+        mikttInterface.m_getNumVerticesOfFace = MikktsInterface1::GetNumVerticesOfFace;
+        mikttInterface.m_getPosition = MikktsInterface1::GetPosition;
+        mikttInterface.m_getNormal = MikktsInterface1::GetNormal;
+        mikttInterface.m_getTexCoord = MikktsInterface1::GetTexCoord;
+        mikttInterface.m_setTSpaceBasic = MikktsInterface1::SetTSpaceBasic;
+        mikttInterface.m_setTSpace = nullptr;
+
+        SMikkTSpaceContext context;
+        context.m_pInterface = &mikttInterface;
+        context.m_pUserData = &data;
+
+        PK_CORE_ASSERT(genTangSpaceDefault(&context), "Failed to calculate tangents");
+    }
+
+    void CalculateTangents(const void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint texcoordOffset, const uint* indices, float4* cornerTangents, uint vcount, uint icount)
+    {
+        MikktsInterface1::PKMeshData data;
+        data.vertices = const_cast<float*>(reinterpret_cast<const float*>(vertices));
+        data.stride = stride;
+        data.vertexOffset = vertexOffset;
+        data.normalOffset = normalOffset;
+        data.texcoordOffset = texcoordOffset;
+        data.indices = indices;
+        data.cornerTangents = reinterpret_cast<float*>(cornerTangents);
+        data.vcount = vcount;
+        data.icount = icount;
+
+        SMikkTSpaceInterface mikttInterface;
+        mikttInterface.m_getNumFaces = MikktsInterface1::GetNumFaces;
+        mikttInterface.m_getNumVerticesOfFace = MikktsInterface1::GetNumVerticesOfFace;
+        mikttInterface.m_getPosition = MikktsInterface1::GetPosition;
+        mikttInterface.m_getNormal = MikktsInterface1::GetNormal;
+        mikttInterface.m_getTexCoord = MikktsInterface1::GetTexCoord;
+        mikttInterface.m_setTSpaceBasic = MikktsInterface1::SetTSpaceCorner;
+        mikttInterface.m_setTSpace = nullptr;
+
+        SMikkTSpaceContext context;
+        context.m_pInterface = &mikttInterface;
+        context.m_pUserData = &data;
+
+        PK_CORE_ASSERT(genTangSpaceDefault(&context), "Failed to calculate tangents");
+    }
+
+    void CalculateTangents(Core::JobSystem* jobSystem, const void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint texcoordOffset, const uint* indices, float4* cornerTangents, uint vcount, uint icount)
+    {
+        PK_PROFILE_FUNCTION();
+
+        // Smaller groups are dominated by mikktspace setup costs.
+        const uint minGroupTriangles = 2048u;
+        auto tcount = icount / 3;
+        auto groupCount = jobSystem != nullptr ? glm::min(jobSystem->GetThreadCount() * 4u, tcount / minGroupTriangles) : 0u;
+
+        if (groupCount < 2)
+        {
+            CalculateTangents(vertices, stride, vertexOffset, normalOffset, texcoordOffset, indices, cornerTangents, vcount, icount);
+            return;
+        }
+
+        // Triangles that don't share vertices don't affect each other's tangents. Connected triangles are kept in the same group & in their original order.
+        std::vector<uint> roots(vcount);
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            roots[i] = i;
+        }
+
+        auto find = [&roots](uint i)
+        {
+            while (roots[i] != i)
+            {
+                i = roots[i] = roots[roots[i]];
+            }
+
+            return i;
+        };
+
+        for (uint i = 0; i < icount; i += 3)
+        {
+            auto r0 = find(indices[i + 0]);
+            auto r1 = find(indices[i + 1]);
+            auto r2 = find(indices[i + 2]);
+            roots[r1] = r0;
+            roots[find(r2)] = r0;
+        }
+
+        std::vector<uint> componentSizes(vcount, 0u);
+        std::vector<uint> triangleGroups(tcount);
+
+        for (uint i = 0; i < tcount; ++i)
+        {
+            triangleGroups[i] = find(indices[i * 3]);
+            componentSizes[triangleGroups[i]]++;
+        }
+
+        // Components are assigned to groups in first use order until each group has its share of the triangles.
+        std::vector<uint> componentGroups(vcount, ~0u);
+        std::vector<uint> groupOffsets(groupCount + 1, 0u);
+        auto groupSize = (tcount + groupCount - 1) / groupCount;
+        auto assigned = 0u;
+
+        for (uint i = 0; i < tcount; ++i)
+        {
+            auto root = triangleGroups[i];
+
+            if (componentGroups[root] == ~0u)
+            {
+                componentGroups[root] = glm::min(assigned / groupSize, groupCount - 1);
+                assigned += componentSizes[root];
+            }
+
+            triangleGroups[i] = componentGroups[root];
+            groupOffsets[triangleGroups[i] + 1]++;
+        }
+
+        for (uint i = 0; i < groupCount; ++i)
+        {
+            groupOffsets[i + 1] += groupOffsets[i];
+        }
+
+        std::vector<uint> groupTriangles(tcount);
+        std::vector<uint> groupIndices(tcount * 3);
+        std::vector<uint> heads(groupOffsets.begin(), groupOffsets.end() - 1);
+
+        for (uint i = 0; i < tcount; ++i)
+        {
+            auto head = heads[triangleGroups[i]]++;
+            groupTriangles[head] = i;
+            memcpy(groupIndices.data() + head * 3, indices + i * 3, sizeof(uint) * 3);
+        }
+
+        std::vector<float4> groupTangents(tcount * 3);
+
+        jobSystem->ParallelFor(groupCount, 1u, [&](uint32_t begin, uint32_t end)
+        {
+            for (auto group = begin; group < end; ++group)
+            {
+                auto offset = groupOffsets[group];
+                auto count = groupOffsets[group + 1] - offset;
+
+                if (count == 0)
+                {
+                    continue;
+                }
+
+                CalculateTangents(vertices, stride, vertexOffset, normalOffset, texcoordOffset, groupIndices.data() + offset * 3, groupTangents.data() + offset * 3, vcount, count * 3);
+
+                for (auto i = offset; i < offset + count; ++i)
+                {
+                    memcpy(cornerTangents + groupTriangles[i] * 3, groupTangents.data() + i * 3, sizeof(float4) * 3);
+                }
+            }
+        });
+    }
+
+    void CalculateTangentsFast(void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint tangentOffset, uint texcoordOffset, const uint* indices, uint vcount, uint icount)
+    {
+        PK_PROFILE_FUNCTION();
+
+        auto data = reinterpret_cast<float*>(vertices);
+
+        // Tangent & bitangent sums, uv derivatives are weighted by the triangle's uv area.
+        std::vector<float4> sums(vcount * 2, PK_FLOAT4_ZERO);
+
+        for (uint i = 0; i < icount; i += 3)
+        {
+            const float* corners[3] = { data + indices[i + 0] * stride, data + indices[i + 1] * stride, data + indices[i + 2] * stride };
+            auto uv0 = corners[0] + texcoordOffset;
+            auto uv1 = corners[1] + texcoordOffset;
+            auto uv2 = corners[2] + texcoordOffset;
+            auto du1 = uv1[0] - uv0[0];
+            auto dv1 = uv1[1] - uv0[1];
+            auto du2 = uv2[0] - uv0[0];
+            auto dv2 = uv2[1] - uv0[1];
+            auto determinant = du1 * dv2 - du2 * dv1;
+
+            if (determinant == 0.0f)
+            {
+                continue;
+            }
+
+            auto p0 = _mm_setr_ps(corners[0][vertexOffset], corners[0][vertexOffset + 1], corners[0][vertexOffset + 2], 0.0f);
+            auto e1 = _mm_sub_ps(_mm_setr_ps(corners[1][vertexOffset], corners[1][vertexOffset + 1], corners[1][vertexOffset + 2], 0.0f), p0);
+            auto e2 = _mm_sub_ps(_mm_setr_ps(corners[2][vertexOffset], corners[2][vertexOffset + 1], corners[2][vertexOffset + 2], 0.0f), p0);
+            auto r = _mm_set1_ps(1.0f / determinant);
+            auto tangent = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1, _mm_set1_ps(dv2)), _mm_mul_ps(e2, _mm_set1_ps(dv1))), r);
+            auto bitangent = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e2, _mm_set1_ps(du1)), _mm_mul_ps(e1, _mm_set1_ps(du2))), r);
+
+            for (uint j = 0; j < 3; ++j)
+            {
+                auto sum = &sums[indices[i + j] * 2].x;
+                _mm_storeu_ps(sum + 0, _mm_add_ps(_mm_loadu_ps(sum + 0), tangent));
+                _mm_storeu_ps(sum + 4, _mm_add_ps(_mm_loadu_ps(sum + 4), bitangent));
+            }
+        }
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            auto vertex = data + i * stride;
+            auto normal = *reinterpret_cast<const float3*>(vertex + normalOffset);
+            auto tangentSum = float3(sums[i * 2 + 0]);
+            auto tangent = tangentSum - normal * glm::dot(normal, tangentSum);
+            auto length = glm::length(tangent);
+
+            // Unmapped or fully cancelled out tangents fall back to any direction orthogonal to the normal.
+            if (length < 1e-6f)
+            {
+                tangent = glm::cross(normal, glm::abs(normal.x) < 0.9f ? PK_FLOAT3_RIGHT : PK_FLOAT3_UP);
+                length = glm::length(tangent);
+            }
+
+            tangent /= length;
+            auto sign = glm::dot(glm::cross(normal, tangent), float3(sums[i * 2 + 1])) < 0.0f ? -1.0f : 1.0f;
+            *reinterpret_cast<float4*>(vertex + tangentOffset) = float4(tangent, sign);
+        }
+    }
+
+    uint WeldVertices(float* vertices, uint stride, uint* indices, uint vcount, uint icount)
+    {
+        PK_PROFILE_FUNCTION();
+
+        auto words = reinterpret_cast<const uint32_t*>(vertices);
+        std::unordered_map<uint, uint, WeldUtility::VertexHash, WeldUtility::VertexEquals> unique(vcount, { words, stride }, { words, stride });
+        std::vector<uint> remap(vcount);
+        uint count = 0;
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            auto element = unique.emplace(i, count);
+            remap[i] = element.first->second;
+
+            if (element.second)
+            {
+                ++count;
+            }
+        }
+
+        // Unique vertices keep their relative order & only move backwards, a forward pass can compact in place.
+        for (uint i = 0, next = 0; i < vcount; ++i)
+        {
+            if (remap[i] != next)
+            {
+                continue;
+            }
+
+            if (i != next)
+            {
+                memmove(vertices + (size_t)next * stride, vertices + (size_t)i * stride, stride * sizeof(float));
+            }
+
+            ++next;
+        }
+
+        for (uint i = 0; i < icount; ++i)
+        {
+            indices[i] = remap[indices[i]];
+        }
+
+        return count;
+    }
+
+    uint WeldTangents(float* vertices, uint stride, uint tangentOffset, const float4* cornerTangents, uint* indices, uint vcount, uint icount)
+    {
+        PK_PROFILE_FUNCTION();
+
+        // Vertices that have received a tangent & a chain of the copies split from each vertex.
+        std::vector<bool> assigned(vcount, false);
+        std::vector<uint> splits(icount, ~0u);
+        auto count = vcount;
+
+        for (uint i = 0; i < icount; ++i)
+        {
+            auto index = indices[i];
+            auto tangent = reinterpret_cast<const float*>(cornerTangents + i);
+
+            if (!assigned[index])
+            {
+                memcpy(vertices + (size_t)index * stride + tangentOffset, tangent, sizeof(float4));
+                assigned[index] = true;
+                continue;
+            }
+
+            auto current = index;
+
+            while (current != ~0u && memcmp(vertices + (size_t)current * stride + tangentOffset, tangent, sizeof(float4)) != 0)
+            {
+                current = splits[current];
+            }
+
+            if (current == ~0u)
+            {
+                current = count++;
+                memcpy(vertices + (size_t)current * stride, vertices + (size_t)index * stride, stride * sizeof(float));
+                memcpy(vertices + (size_t)current * stride + tangentOffset, tangent, sizeof(float4));
+                splits[current] = splits[index];
+                splits[index] = current;
+            }
+
+            indices[i] = current;
+        }
+
+        return count;
+    }
+
+    void OptimizeVertexCache(uint* indices, uint icount, uint vcount, uint cacheSize)
+    {
+        PK_PROFILE_FUNCTION();
+
+        TipsifyUtility::Adjacency adjacency;
+        TipsifyUtility::BuildAdjacency(adjacency, indices, icount, vcount);
+
+        auto liveCounts = adjacency.counts;
+        std::vector<uint> timestamps(vcount, 0u);
+        std::vector<bool> emitted(icount / 3, false);
+        std::vector<uint> deadEnds;
+        std::vector<uint> candidates;
+        std::vector<uint> output;
+        output.reserve(icount);
+
+        uint time = cacheSize + 1;
+        uint cursor = 0;
+        auto fanning = TipsifyUtility::SkipDeadEnd(deadEnds, liveCounts, cursor, vcount);
+
+        while (fanning != ~0u)
+        {
+            candidates.clear();
+
+            auto begin = adjacency.triangles.data() + adjacency.offsets[fanning];
+            auto end = begin + adjacency.counts[fanning];
+
+            for (auto triangle = begin; triangle != end; ++triangle)
+            {
+                if (emitted[*triangle])
+                {
+                    continue;
+                }
+
+                for (uint i = 0; i < 3; ++i)
+                {
+                    auto vertex = indices[*triangle * 3 + i];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveCounts[vertex]--;
+
+                    if (time - timestamps[vertex] > cacheSize)
+                    {
+                        timestamps[vertex] = time++;
+                    }
+                }
+
+                emitted[*triangle] = true;
+            }
+
+            // Prefer the oldest candidate that will still be in the cache after its remaining triangles are emitted.
+            auto next = ~0u;
+            auto bestPriority = -1;
+
+            for (auto vertex : candidates)
+            {
+                if (liveCounts[vertex] == 0)
+                {
+                    continue;
+                }
+
+                auto priority = 0;
+
+                if (time - timestamps[vertex] + 2 * liveCounts[vertex] <= cacheSize)
+                {
+                    priority = (int)(time - timestamps[vertex]);
+                }
+
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+
+            fanning = next != ~0u ? next : TipsifyUtility::SkipDeadEnd(deadEnds, liveCounts, cursor, vcount);
+        }
+
+        memcpy(indices, output.data(), icount * sizeof(uint));
+    }
+
+    void OptimizeOverdraw(const float* vertices, uint stride, uint vertexOffset, uint* indices, uint icount, uint vcount, uint cacheSize, float threshold)
+    {
+        PK_PROFILE_FUNCTION();
+
+        auto tcount = icount / 3;
+
+        if (tcount < 2)
+        {
+            return;
+        }
+
+        std::vector<uint> timestamps(vcount, 0u);
+        uint time = cacheSize + 1;
+
+        auto countMisses = [&](uint triangle)
+        {
+            uint misses = 0;
+
+            for (uint i = 0; i < 3; ++i)
+            {
+                auto vertex = indices[triangle * 3 + i];
+
+                if (time - timestamps[vertex] > cacheSize)
+                {
+                    timestamps[vertex] = time++;
+                    ++misses;
+                }
+            }
+
+            return misses;
+        };
+
+        // Hard boundaries are where the cache optimized order already restarts (all three vertices miss).
+        std::vector<uint> hardBoundaries;
+
+        for (uint i = 0; i < tcount; ++i)
+        {
+            if (countMisses(i) == 3)
+            {
+                hardBoundaries.push_back(i);
+            }
+        }
+
+        hardBoundaries.push_back(tcount);
+
+        // Soft boundaries split hard clusters further where it costs less than threshold in acmr.
+        std::vector<uint> clusters;
+
+        for (uint i = 0; i + 1 < hardBoundaries.size(); ++i)
+        {
+            auto start = hardBoundaries[i];
+            auto end = hardBoundaries[i + 1];
+            uint clusterMisses = 0;
+
+            time += cacheSize + 1;
+
+            for (auto j = start; j < end; ++j)
+            {
+                clusterMisses += countMisses(j);
+            }
+
+            auto clusterThreshold = threshold * (float)clusterMisses / (float)(end - start);
+
+            time += cacheSize + 1;
+            clusters.push_back(start);
+            uint misses = 0;
+            uint first = start;
+
+            for (auto j = start; j < end; ++j)
+            {
+                misses += countMisses(j);
+
+                if (j + 1 < end && (float)misses / (float)(j - first + 1) <= clusterThreshold)
+                {
+                    clusters.push_back(j + 1);
+                    time += cacheSize + 1;
+                    misses = 0;
+                    first = j + 1;
+                }
+            }
+        }
+
+        clusters.push_back(tcount);
+
+        auto getPosition = [&](uint vertex) { return *reinterpret_cast<const float3*>(vertices + (size_t)vertex * stride + vertexOffset); };
+
+        float3 meshCentroid = PK_FLOAT3_ZERO;
+
+        for (uint i = 0; i < icount; ++i)
+        {
+            meshCentroid += getPosition(indices[i]);
+        }
+
+        meshCentroid /= (float)icount;
+
+        // Clusters facing away from the mesh center are drawn first so that they occlude the inner ones.
+        std::vector<std::pair<float, uint>> sortKeys;
+        sortKeys.reserve(clusters.size() - 1);
+
+        for (uint i = 0; i + 1 < clusters.size(); ++i)
+        {
+            float3 centroid = PK_FLOAT3_ZERO;
+            float3 normal = PK_FLOAT3_ZERO;
+            auto area = 0.0f;
+
+            for (auto j = clusters[i]; j < clusters[i + 1]; ++j)
+            {
+                auto p0 = getPosition(indices[j * 3 + 0]);
+                auto p1 = getPosition(indices[j * 3 + 1]);
+                auto p2 = getPosition(indices[j * 3 + 2]);
+                auto areaNormal = glm::cross(p1 - p0, p2 - p0);
+                auto triangleArea = glm::length(areaNormal);
+                centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+                normal += areaNormal;
+                area += triangleArea;
+            }
+
+            centroid = area > 0.0f ? centroid / area : centroid;
+            auto normalLength = glm::length(normal);
+            normal = normalLength > 0.0f ? normal / normalLength : normal;
+            sortKeys.push_back({ glm::dot(centroid - meshCentroid, normal), i });
+        }
+
+        std::stable_sort(sortKeys.begin(), sortKeys.end(), [](const std::pair<float, uint>& a, const std::pair<float, uint>& b) { return a.first > b.first; });
+
+        std::vector<uint> output;
+        output.reserve(icount);
+
+        for (auto& key : sortKeys)
+        {
+            output.insert(output.end(), indices + clusters[key.second] * 3, indices + clusters[key.second + 1] * 3);
+        }
+
+        memcpy(indices, output.data(), icount * sizeof(uint));
+    }
+
+    uint OptimizeVertexFetch(float* vertices, uint stride, uint* indices, uint vcount, uint icount)
+    {
+        PK_PROFILE_FUNCTION();
+
+        std::vector<uint> remap(vcount, ~0u);
+        std::vector<float> output;
+        output.reserve((size_t)vcount * stride);
+        uint count = 0;
+
+        for (uint i = 0; i < icount; ++i)
+        {
+            auto& target = remap[indices[i]];
+
+            if (target == ~0u)
+            {
+                target = count++;
+                output.insert(output.end(), vertices + (size_t)indices[i] * stride, vertices + (size_t)(indices[i] + 1) * stride);
+            }
+
+            indices[i] = target;
+        }
+
+        memcpy(vertices, output.data(), output.size() * sizeof(float));
+        return count;
+    }
+
+    VertexCacheStatistics AnalyzeVertexCache(const uint* indices, uint icount, uint vcount, uint cacheSize)
+    {
+        VertexCacheStatistics statistics;
+
+        if (icount == 0)
+        {
+            return statistics;
+        }
+
+        // Fifo cache, a vertex is cached if it was inserted less than cacheSize misses ago.
+        std::vector<uint> insertions(vcount, 0u);
+        std::vector<bool> used(vcount, false);
+        uint time = cacheSize + 1;
+        uint usedCount = 0;
+
+        for (uint i = 0; i < icount; ++i)
+        {
+            auto vertex = indices[i];
+
+            if (!used[vertex])
+            {
+                used[vertex] = true;
+                ++usedCount;
+            }
+
+            if (time - insertions[vertex] > cacheSize)
+            {
+                insertions[vertex] = time++;
+                statistics.vertexTransforms++;
+            }
+        }
+
+        statistics.acmr = (float)statistics.vertexTransforms / (float)(icount / 3);
+        statistics.atvr = (float)statistics.vertexTransforms / (float)usedCount;
+        return statistics;
+    }
+
+    uint SimplifyMesh(const float* vertices, uint stride, uint vertexOffset, const uint* indices, uint icount, uint vcount, uint targetIndexCount, float targetError, uint* output, float* resultError)
+    {
+        PK_PROFILE_FUNCTION();
+
+        using namespace SimplifyUtility;
+
+        memmove(output, indices, icount * sizeof(uint));
+        *resultError = 0.0f;
+
+        std::vector<bool> used(vcount, false);
+        auto bmin = PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+        auto bmax = -PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+
+        for (uint i = 0; i < icount; ++i)
+        {
+            auto& position = *reinterpret_cast<const float3*>(vertices + (size_t)output[i] * stride + vertexOffset);
+            bmin = glm::min(bmin, position);
+            bmax = glm::max(bmax, position);
+            used[output[i]] = true;
+        }
+
+        auto extent = icount > 0 ? glm::max(bmax.x - bmin.x, glm::max(bmax.y - bmin.y, bmax.z - bmin.z)) : 0.0f;
+
+        if (extent <= 0.0f || icount <= targetIndexCount)
+        {
+            return icount;
+        }
+
+        // Errors are measured in a unit cube so that the weights are scale independent.
+        std::vector<float3> positions(vcount);
+        auto words = reinterpret_cast<const uint32_t*>(vertices + vertexOffset);
+        std::unordered_map<uint, uint, PositionHash, PositionEquals> unique(vcount, { words, stride }, { words, stride });
+        // First attribute vertex with the same position & a circular list of all of them.
+        std::vector<uint> remap(vcount);
+        std::vector<uint> wedges(vcount);
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            remap[i] = i;
+            wedges[i] = i;
+
+            if (!used[i])
+            {
+                continue;
+            }
+
+            positions[i] = (*reinterpret_cast<const float3*>(vertices + (size_t)i * stride + vertexOffset) - bmin) / extent;
+            remap[i] = unique.emplace(i, i).first->second;
+
+            if (remap[i] != i)
+            {
+                wedges[i] = wedges[remap[i]];
+                wedges[remap[i]] = i;
+            }
+        }
+
+        // Directed edges between positions & between attribute vertices. A seam is open in the latter only.
+        std::unordered_map<ulong, uint> edges;
+        std::unordered_set<ulong> attributeEdges;
+
+        auto buildEdges = [&](uint count)
+        {
+            edges.clear();
+            attributeEdges.clear();
+
+            for (uint i = 0; i < count; ++i)
+            {
+                auto a = output[i];
+                auto b = output[i - i % 3 + (i + 1) % 3];
+                edges[EdgeKey(remap[a], remap[b])]++;
+                attributeEdges.insert(EdgeKey(a, b));
+            }
+        };
+
+        buildEdges(icount);
+
+        std::vector<uint8_t> openOut(vcount, 0u);
+        std::vector<uint8_t> openIn(vcount, 0u);
+        std::vector<uint8_t> seamOut(vcount, 0u);
+        std::vector<uint8_t> seamIn(vcount, 0u);
+        std::vector<bool> nonManifold(vcount, false);
+        std::vector<Quadric> quadrics(vcount);
+
+        for (uint i = 0; i < icount; i += 3)
+        {
+            auto& p0 = positions[output[i + 0]];
+            auto& p1 = positions[output[i + 1]];
+            auto& p2 = positions[output[i + 2]];
+            auto normal = glm::cross(p1 - p0, p2 - p0);
+            auto area = glm::length(normal);
+
+            if (area > 0.0f)
+            {
+                normal /= area;
+
+                for (uint j = 0; j < 3; ++j)
+                {
+                    quadrics[remap[output[i + j]]].AddPlane(normal, -glm::dot(normal, p0), area * 0.5f);
+                }
+            }
+
+            for (uint j = 0; j < 3; ++j)
+            {
+                auto va = output[i + j];
+                auto vb = output[i + (j + 1) % 3];
+                auto a = remap[va];
+                auto b = remap[vb];
+
+                if (edges.at(EdgeKey(a, b)) > 1)
+                {
+                    nonManifold[a] = true;
+                    nonManifold[b] = true;
+                }
+
+                if (attributeEdges.count(EdgeKey(vb, va)) == 0)
+                {
+                    seamOut[va] = (uint8_t)glm::min(seamOut[va] + 1, 255);
+                    seamIn[vb] = (uint8_t)glm::min(seamIn[vb] + 1, 255);
+                }
+
+                if (edges.count(EdgeKey(b, a)) > 0)
+                {
+                    continue;
+                }
+
+                openOut[a] = (uint8_t)glm::min(openOut[a] + 1, 255);
+                openIn[b] = (uint8_t)glm::min(openIn[b] + 1, 255);
+
+                // Keeps border vertices on a plane perpendicular to the triangle through the edge.
+                auto edge = positions[b] - positions[a];
+                auto edgeNormal = glm::cross(edge, normal);
+                auto edgeNormalLength = glm::length(edgeNormal);
+
+                if (area > 0.0f && edgeNormalLength > 0.0f)
+                {
+                    edgeNormal /= edgeNormalLength;
+                    quadrics[a].AddPlane(edgeNormal, -glm::dot(edgeNormal, positions[a]), glm::length(edge) * BorderWeight);
+                    quadrics[b].AddPlane(edgeNormal, -glm::dot(edgeNormal, positions[a]), glm::length(edge) * BorderWeight);
+                }
+            }
+        }
+
+        std::vector<VertexKind> kinds(vcount, VertexKind::Locked);
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            auto p = remap[i];
+            auto pair = wedges[i];
+
+            if (!used[i] || nonManifold[p])
+            {
+                continue;
+            }
+
+            if (pair == i && openOut[p] == 0 && openIn[p] == 0)
+            {
+                kinds[i] = VertexKind::Manifold;
+            }
+            else if (pair == i && openOut[p] == 1 && openIn[p] == 1)
+            {
+                kinds[i] = VertexKind::Border;
+            }
+            else if (wedges[pair] == i && openOut[p] == 0 && openIn[p] == 0 && seamOut[i] == 1 && seamIn[i] == 1 && seamOut[pair] == 1 && seamIn[pair] == 1)
+            {
+                kinds[i] = VertexKind::Seam;
+            }
+        }
+
+        // Wedge of the target that the other wedge of a seam source shares an edge with.
+        auto getSeamTarget = [&](uint source, uint target)
+        {
+            auto pair = wedges[source];
+            auto wedge = target;
+
+            do
+            {
+                if (attributeEdges.count(EdgeKey(pair, wedge)) > 0 || attributeEdges.count(EdgeKey(wedge, pair)) > 0)
+                {
+                    return wedge;
+                }
+
+                wedge = wedges[wedge];
+            }
+            while (wedge != target);
+
+            return ~0u;
+        };
+
+        auto canCollapse = [&](uint source, uint target)
+        {
+            switch (kinds[source])
+            {
+                case VertexKind::Manifold: 
+                    return true;
+                case VertexKind::Border: 
+                    return kinds[target] != VertexKind::Manifold && (edges.count(EdgeKey(remap[source], remap[target])) == 0 || edges.count(EdgeKey(remap[target], remap[source])) == 0);
+                case VertexKind::Seam: 
+                    return (kinds[target] == VertexKind::Seam || kinds[target] == VertexKind::Locked) &&
+                           (attributeEdges.count(EdgeKey(source, target)) == 0 || attributeEdges.count(EdgeKey(target, source)) == 0) &&
+                           getSeamTarget(source, target) != ~0u;
+                default: 
+                    return false;
+            }
+        };
+
+        std::vector<uint> collapseRemap(vcount);
+        std::vector<bool> collapseLocked(vcount, false);
+        std::vector<Collapse> collapses;
+        std::vector<uint> sourceRing;
+        std::vector<uint> targetRing;
+        TipsifyUtility::Adjacency adjacency;
+        auto errorLimit = (targetError / extent) * (targetError / extent);
+        auto maxError = 0.0f;
+        auto count = icount;
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            collapseRemap[i] = i;
+        }
+
+        while (count > targetIndexCount)
+        {
+            TipsifyUtility::BuildAdjacency(adjacency, output, count, vcount);
+            collapses.clear();
+
+            for (uint i = 0; i < count; ++i)
+            {
+                auto i0 = output[i];
+                auto i1 = output[i - i % 3 + (i + 1) % 3];
+
+                if (remap[i0] == remap[i1])
+                {
+                    continue;
+                }
+
+                auto forward = canCollapse(i0, i1) ? quadrics[remap[i0]].Evaluate(positions[i1]) : std::numeric_limits<float>().max();
+                auto backward = canCollapse(i1, i0) ? quadrics[remap[i1]].Evaluate(positions[i0]) : std::numeric_limits<float>().max();
+
+                if (forward <= backward && forward <= errorLimit)
+                {
+                    collapses.push_back({ i0, i1, forward });
+                }
+                else if (backward < forward && backward <= errorLimit)
+                {
+                    collapses.push_back({ i1, i0, backward });
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+            // Border & seam collapses remove one triangle per side, interior collapses two.
+            auto removeCount = (count - targetIndexCount) / 3;
+            auto removed = 0u;
+            auto applied = 0u;
+
+            for (auto& collapse : collapses)
+            {
+                if (removed >= removeCount)
+                {
+                    break;
+                }
+
+                if (collapseLocked[remap[collapse.source]] || collapseLocked[remap[collapse.target]])
+                {
+                    continue;
+                }
+
+                // Seams move both of their wedges, each onto the target wedge on its side of the seam.
+                uint sources[2] = { collapse.source, wedges[collapse.source] };
+                uint targets[2] = { collapse.target, kinds[collapse.source] == VertexKind::Seam ? getSeamTarget(collapse.source, collapse.target) : collapse.target };
+                auto wedgeCount = kinds[collapse.source] == VertexKind::Seam ? 2u : 1u;
+                auto source = remap[collapse.source];
+                auto target = remap[collapse.target];
+                auto& targetPosition = positions[collapse.target];
+                auto sharedCount = 0u;
+                auto isFlipped = false;
+                sourceRing.clear();
+                targetRing.clear();
+
+                for (uint w = 0; w < wedgeCount && !isFlipped; ++w)
+                {
+                    for (uint j = 0; j < adjacency.counts[sources[w]]; ++j)
+                    {
+                        auto triangle = output + adjacency.triangles[adjacency.offsets[sources[w]] + j] * 3;
+                        auto hasTarget = false;
+
+                        for (uint k = 0; k < 3; ++k)
+                        {
+                            hasTarget |= remap[triangle[k]] == target;
+                            sourceRing.push_back(remap[triangle[k]]);
+                        }
+
+                        if (hasTarget)
+                        {
+                            ++sharedCount;
+                            continue;
+                        }
+
+                        float3 corners[3];
+
+                        for (uint k = 0; k < 3; ++k)
+                        {
+                            corners[k] = triangle[k] == sources[w] ? targetPosition : positions[triangle[k]];
+                        }
+
+                        auto before = glm::cross(positions[triangle[1]] - positions[triangle[0]], positions[triangle[2]] - positions[triangle[0]]);
+                        auto after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+                        if (glm::dot(before, after) < FlipThreshold * glm::length(before) * glm::length(after))
+                        {
+                            isFlipped = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (isFlipped)
+                {
+                    continue;
+                }
+
+                // Link condition, sharing more neighbours than there are triangles on the edge would pinch the surface into a non manifold edge.
+                auto wedge = collapse.target;
+
+                do
+                {
+                    for (uint j = 0; j < adjacency.counts[wedge]; ++j)
+                    {
+                        auto triangle = output + adjacency.triangles[adjacency.offsets[wedge] + j] * 3;
+
+                        for (uint k = 0; k < 3; ++k)
+                        {
+                            targetRing.push_back(remap[triangle[k]]);
+                        }
+                    }
+
+                    wedge = wedges[wedge];
+                }
+                while (wedge != collapse.target);
+
+                std::sort(sourceRing.begin(), sourceRing.end());
+                std::sort(targetRing.begin(), targetRing.end());
+                sourceRing.erase(std::unique(sourceRing.begin(), sourceRing.end()), sourceRing.end());
+                targetRing.erase(std::unique(targetRing.begin(), targetRing.end()), targetRing.end());
+
+                auto commonCount = 0u;
+
+                for (auto s = sourceRing.begin(), t = targetRing.begin(); s != sourceRing.end() && t != targetRing.end();)
+                {
+                    if (*s < *t)
+                    {
+                        ++s;
+                    }
+                    else if (*t < *s)
+                    {
+                        ++t;
+                    }
+                    else
+                    {
+                        commonCount += *s != source && *s != target;
+                        ++s;
+                        ++t;
+                    }
+                }
+
+                if (commonCount > sharedCount)
+                {
+                    continue;
+                }
+
+                for (uint w = 0; w < wedgeCount; ++w)
+                {
+                    collapseRemap[sources[w]] = targets[w];
+                }
+
+                quadrics[target].Add(quadrics[source]);
+                maxError = glm::max(maxError, collapse.error);
+                removed += sharedCount;
+                ++applied;
+
+                // The checks above read triangles of the neighbours, these must stay unchanged until the next pass.
+                for (auto neighbour : sourceRing)
+                {
+                    collapseLocked[neighbour] = true;
+                }
+            }
+
+            if (applied == 0)
+            {
+                break;
+            }
+
+            auto write = 0u;
+
+            for (uint i = 0; i < count; i += 3)
+            {
+                auto a = collapseRemap[output[i + 0]];
+                auto b = collapseRemap[output[i + 1]];
+                auto c = collapseRemap[output[i + 2]];
+
+                if (remap[a] != remap[b] && remap[b] != remap[c] && remap[c] != remap[a])
+                {
+                    output[write++] = a;
+                    output[write++] = b;
+                    output[write++] = c;
+                }
+            }
+
+            count = write;
+            buildEdges(count);
+
+            for (uint i = 0; i < vcount; ++i)
+            {
+                collapseRemap[i] = i;
+                collapseLocked[i] = false;
+            }
+        }
+
+        *resultError = glm::sqrt(maxError) * extent;
+        return count;
     }
 
+    TopologyStatistics AnalyzeTopology(const float* vertices, uint stride, uint vertexOffset, const uint* indices, uint icount, uint vcount)
+    {
+        using namespace SimplifyUtility;
+
+        TopologyStatistics statistics;
+        auto words = reinterpret_cast<const uint32_t*>(vertices + vertexOffset);
+        std::unordered_map<uint, uint, PositionHash, PositionEquals> unique(vcount, { words, stride }, { words, stride });
+        std::unordered_map<ulong, uint> edges;
+        std::vector<uint> remap(icount);
 
-    void CalculateNormals(const float3* vertices, const uint* indices, float3* normals, uint vcount, uint icount, float sign)
+        for (uint i = 0; i < icount; ++i)
+        {
+            remap[i] = unique.emplace(indices[i], indices[i]).first->second;
+        }
+
+        for (uint i = 0; i < icount; i += 3)
+        {
+            if (remap[i] == remap[i + 1] || remap[i + 1] == remap[i + 2] || remap[i + 2] == remap[i])
+            {
+                statistics.degenerateTriangles++;
+                continue;
+            }
+
+            for (uint j = 0; j < 3; ++j)
+            {
+                edges[EdgeKey(remap[i + j], remap[i + (j + 1) % 3])]++;
+            }
+        }
+
+        for (auto& edge : edges)
+        {
+            auto a = (uint)(edge.first >> 32ull);
+            auto b = (uint)(edge.first & 0xFFFFFFFFull);
+            auto reverse = edges.find(EdgeKey(b, a));
+            auto reverseCount = reverse != edges.end() ? reverse->second : 0u;
+
+            if (edge.second > 1 || (a < b && edge.second + reverseCount > 2))
+            {
+                statistics.nonManifoldEdges++;
+            }
+            else if (reverseCount == 0)
+            {
+                statistics.openEdges++;
+            }
+        }
+
+        return statistics;
+    }
+
+    uint BuildMeshlets(const float* vertices, uint stride, uint vertexOffset, uint* indices, uint icount, uint vcount, std::vector<Structs::Meshlet>& output)
     {
-        for (uint i = 0, j = 0; i < icount; i += 3)
+        PK_PROFILE_FUNCTION();
+
+        using namespace SimplifyUtility;
+
+        // Preference for triangles that keep the normal cone narrow over ones that add fewer vertices.
+        const float coneWeight = 2.0f;
+
+        auto tcount = icount / 3;
+        auto firstMeshlet = (uint)output.size();
+        auto words = reinterpret_cast<const uint32_t*>(vertices + vertexOffset);
+
+        // Meshlets grow across attribute seams, adjacency is by position.
+        std::unordered_map<uint, uint, PositionHash, PositionEquals> unique(vcount, { words, stride }, { words, stride });
+        std::vector<uint> positions(tcount * 3);
+
+        for (uint i = 0; i < tcount * 3; ++i)
         {
-            auto i0 = indices[i + 0];
-            auto i1 = indices[i + 1];
-            auto i2 = indices[i + 2];
-            auto v0 = vertices[i0];
-            auto v1 = vertices[i1];
-            auto v2 = vertices[i2];
+            positions[i] = unique.emplace(indices[i], indices[i]).first->second;
+        }
 
-            auto tangent = glm::normalize(v1 - v0);
-            auto binormal = glm::normalize(v2 - v0);
-            auto normal = glm::normalize(glm::cross(tangent, binormal));
-            normals[i0] += normal;
-            normals[i1] += normal;
-            normals[i2] += normal;
+        TipsifyUtility::Adjacency adjacency;
+        TipsifyUtility::BuildAdjacency(adjacency, positions.data(), tcount * 3, vcount);
+
+        std::vector<float3> normals(tcount);
+
+        for (uint i = 0; i < tcount; ++i)
+        {
+            auto p0 = *reinterpret_cast<const float3*>(vertices + (size_t)indices[i * 3 + 0] * stride + vertexOffset);
+            auto p1 = *reinterpret_cast<const float3*>(vertices + (size_t)indices[i * 3 + 1] * stride + vertexOffset);
+            auto p2 = *reinterpret_cast<const float3*>(vertices + (size_t)indices[i * 3 + 2] * stride + vertexOffset);
+            auto normal = glm::cross(p1 - p0, p2 - p0);
+            auto length = glm::length(normal);
+            normals[i] = length > 0.0f ? normal / length : PK_FLOAT3_ZERO;
         }
 
-        for (uint i = 0; i < vcount; ++i)
+        // Meshlet that last referenced a vertex or listed a triangle as a candidate.
+        std::vector<uint> vertexStamps(vcount, ~0u);
+        std::vector<uint> candidateStamps(tcount, ~0u);
+        std::vector<bool> emitted(tcount, false);
+        std::vector<uint> candidates;
+        std::vector<uint> ordered;
+        ordered.reserve(tcount * 3);
+
+        uint cursor = 0;
+        uint vertexCount = 0;
+        uint meshletOffset = 0;
+        auto axis = PK_FLOAT3_ZERO;
+
+        auto getNewVertices = [&](uint triangle, uint stamp)
         {
-            normals[i] = glm::normalize(normals[i]) * sign;
+            auto a = indices[triangle * 3 + 0];
+            auto b = indices[triangle * 3 + 1];
+            auto c = indices[triangle * 3 + 2];
+            return (uint)(vertexStamps[a] != stamp) + (uint)(vertexStamps[b] != stamp && b != a) + (uint)(vertexStamps[c] != stamp && c != a && c != b);
+        };
+
+        auto addTriangle = [&](uint triangle, uint stamp)
+        {
+            vertexCount += getNewVertices(triangle, stamp);
+            emitted[triangle] = true;
+            axis += normals[triangle];
+
+            for (uint i = 0; i < 3; ++i)
+            {
+                auto vertex = indices[triangle * 3 + i];
+                auto position = positions[triangle * 3 + i];
+                vertexStamps[vertex] = stamp;
+                ordered.push_back(vertex);
+
+                for (uint j = 0; j < adjacency.counts[position]; ++j)
+                {
+                    auto neighbour = adjacency.triangles[adjacency.offsets[position] + j];
+
+                    if (!emitted[neighbour] && candidateStamps[neighbour] != stamp)
+                    {
+                        candidateStamps[neighbour] = stamp;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            }
+        };
+
+        while (ordered.size() < tcount * 3)
+        {
+            auto stamp = (uint)output.size();
+            auto seed = ~0u;
+
+            // Continue next to the previous meshlet, otherwise from the next triangle in input order.
+            for (auto candidate : candidates)
+            {
+                if (!emitted[candidate])
+                {
+                    seed = candidate;
+                    break;
+                }
+            }
+
+            for (; seed == ~0u && cursor < tcount; ++cursor)
+            {
+                if (!emitted[cursor])
+                {
+                    seed = cursor;
+                }
+            }
+
+            candidates.clear();
+            vertexCount = 0;
+            axis = PK_FLOAT3_ZERO;
+            addTriangle(seed, stamp);
+
+            while ((ordered.size() - meshletOffset) / 3 < MeshletMaxTriangles)
+            {
+                auto best = ~0u;
+                auto bestScore = std::numeric_limits<float>().max();
+                auto axisLength = glm::length(axis);
+                auto coneAxis = axisLength > 0.0f ? axis / axisLength : PK_FLOAT3_ZERO;
+
+                for (auto candidate : candidates)
+                {
+                    if (emitted[candidate])
+                    {
+                        continue;
+                    }
+
+                    auto newVertices = getNewVertices(candidate, stamp);
+
+                    if (vertexCount + newVertices > MeshletMaxVertices)
+                    {
+                        continue;
+                    }
+
+                    auto score = newVertices + coneWeight * (1.0f - glm::dot(normals[candidate], coneAxis));
+
+                    if (score < bestScore)
+                    {
+                        best = candidate;
+                        bestScore = score;
+                    }
+                }
+
+                if (best == ~0u)
+                {
+                    break;
+                }
+
+                addTriangle(best, stamp);
+            }
+
+            Structs::Meshlet meshlet;
+            meshlet.indexOffset = meshletOffset;
+            meshlet.indexCount = (uint)ordered.size() - meshletOffset;
+            MeshletUtility::ComputeBounds(vertices, stride, vertexOffset, ordered.data() + meshletOffset, meshlet.indexCount, meshlet);
+            output.push_back(meshlet);
+            meshletOffset = (uint)ordered.size();
+        }
+
+        memcpy(indices, ordered.data(), ordered.size() * sizeof(uint));
+
+        // Growth order is not cache friendly, reorder within each meshlet.
+        for (auto i = firstMeshlet; i < output.size(); ++i)
+        {
+            OptimizeVertexCache(indices + output.at(i).indexOffset, output.at(i).indexCount, vcount);
         }
 
+        return (uint)output.size() - firstMeshlet;
     }
 
-    void CalculateTangents(const float3* vertices, const float3* normals, const float2* texcoords, const uint* indices, float4* tangents, uint vcount, uint icount)
+    void CalculateSubmeshBounds(const float* vertices, uint stride, uint vertexOffset, const uint* indices, const Structs::IndexRange* submeshes, uint submeshCount, BoundingBox* bounds)
     {
-        MikktsInterface0::PKMeshData data;
-        data.vertices = reinterpret_cast<const float*>(vertices);
-        data.normals = reinterpret_cast<const float*>(normals);
-        data.tangents = reinterpret_cast<float*>(tangents);
-        data.texcoords = reinterpret_cast<const float*>(texcoords);
-        data.indices = indices;
-        data.vcount = vcount;
-        data.icount = icount;
+        for (uint i = 0; i < submeshCount; ++i)
+        {
+            float3 minpos = PK_FLOAT3_ONE * std::numeric_limits<float>().max();
+            float3 maxpos = -PK_FLOAT3_ONE * std::numeric_limits<float>().max();
 
-        SMikkTSpaceInterface mikttInterface;
-        mikttInterface.m_getNumFaces = MikktsInterface0::GetNumFaces;
-        mikttInterface.m_getNumVerticesOfFace = MikktsInterface0::GetNumVerticesOfFace;
-        mikttInterface.m_getPosition = MikktsInterface0::GetPosition;
-        mikttInterface.m_getNormal = MikktsInterface0::GetNormal;
-        mikttInterface.m_getTexCoord = MikktsInterface0::GetTexCoord;
-        mikttInterface.m_setTSpaceBasic = MikktsInterface0::SetTSpaceBasic;
-        mikttInterface.m_setTSpace = nullptr;
+            for (uint j = submeshes[i].offset; j < submeshes[i].offset + submeshes[i].count; ++j)
+            {
+                auto position = reinterpret_cast<const float3*>(vertices + indices[j] * stride + vertexOffset);
+                minpos = glm::min(minpos, *position);
+                maxpos = glm::max(maxpos, *position);
+            }
 
-        SMikkTSpaceContext context;
-        context.m_pInterface = &mikttInterface;
-        context.m_pUserData = &data;
+            bounds[i] = submeshes[i].count > 0 ? PK::Math::Functions::CreateBoundsMinMax(minpos, maxpos) : PK::Math::Functions::CreateBoundsMinMax(PK_FLOAT3_ZERO, PK_FLOAT3_ZERO);
+        }
+    }
 
-        PK_CORE_ASSERT(genTangSpaceDefault(&context), "Failed to calculate tangents");
+    void CompressVertices(const Structs::Vertex_Full* vertices, Structs::Vertex_Compressed* output, uint vcount, const BoundingBox& bounds)
+    {
+        using namespace CompressionUtility;
+
+        auto extents = bounds.max - bounds.min;
+        auto inverseExtents = float3(extents.x > 0.0f ? 1.0f / extents.x : 0.0f, extents.y > 0.0f ? 1.0f / extents.y : 0.0f, extents.z > 0.0f ? 1.0f / extents.z : 0.0f);
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            auto& vertex = vertices[i];
+            auto& packed = output[i];
+            auto position = (vertex.position - bounds.min) * inverseExtents;
+            auto normal = OctaEncode(vertex.normal);
+            auto tangent = OctaEncode(float3(vertex.tangent));
+
+            packed.position[0] = (ushort)QuantizeUnorm(position.x, 16);
+            packed.position[1] = (ushort)QuantizeUnorm(position.y, 16);
+            packed.position[2] = (ushort)QuantizeUnorm(position.z, 16);
+            packed.position[3] = 0;
+            packed.normal[0] = QuantizeSnorm16(normal.x);
+            packed.normal[1] = QuantizeSnorm16(normal.y);
+            packed.tangent = QuantizeUnorm(tangent.x * 0.5f + 0.5f, 16) | (QuantizeUnorm(tangent.y * 0.5f + 0.5f, 15) << 16) | (vertex.tangent.w < 0.0f ? 1u << 31 : 0u);
+            packed.texcoord[0] = glm::packHalf1x16(vertex.texcoord.x);
+            packed.texcoord[1] = glm::packHalf1x16(vertex.texcoord.y);
+        }
     }
 
-    void CalculateTangents(void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint tangentOffset, uint texcoordOffset, const uint* indices, uint vcount, uint icount)
+    void DecompressVertices(const Structs::Vertex_Compressed* vertices, Structs::Vertex_Full* output, uint vcount, const BoundingBox& bounds)
     {
-        MikktsInterface1::PKMeshData data;
-        data.vertices = reinterpret_cast<float*>(vertices);
-        data.stride = stride;
-        data.vertexOffset = vertexOffset;
-        data.normalOffset = normalOffset;
-        data.tangentOffset = tangentOffset;
-        data.texcoordOffset = texcoordOffset;
-        data.indices = indices;
-        data.vcount = vcount;
-        data.icount = icount;
+        using namespace CompressionUtility;
 
-        SMikkTSpaceInterface mikttInterface;
-        mikttInterface.m_getNumFaces = MikktsInterface1::GetNumFaces;
-        mikttInterface.m_getNumVerticesOfFace = MikktsInterface1::GetNumVerticesOfFace;
-        mikttInterface.m_getPosition = MikktsInterface1::GetPosition;
-        mikttInterface.m_getNormal = MikktsInterface1::GetNormal;
-        mikttInterface.m_getTexCoord = MikktsInterface1::GetTexCoord;
-        mikttInterface.m_setTSpaceBasic = MikktsInterface1::SetTSpaceBasic;
-        mikttInterface.m_setTSpace = nullptr;
+        auto extents = bounds.max - bounds.min;
 
-        SMikkTSpaceContext context;
-        context.m_pInterface = &mikttInterface;
-        context.m_pUserData = &data;
+        for (uint i = 0; i < vcount; ++i)
+        {
+            auto& packed = vertices[i];
+            auto& vertex = output[i];
+            auto tangentX = DequantizeUnorm(packed.tangent & 0xFFFFu, 16) * 2.0f - 1.0f;
+            auto tangentY = DequantizeUnorm((packed.tangent >> 16) & 0x7FFFu, 15) * 2.0f - 1.0f;
 
-        PK_CORE_ASSERT(genTangSpaceDefault(&context), "Failed to calculate tangents");
+            vertex.position = bounds.min + float3(DequantizeUnorm(packed.position[0], 16), DequantizeUnorm(packed.position[1], 16), DequantizeUnorm(packed.position[2], 16)) * extents;
+            vertex.normal = OctaDecode(float2(DequantizeSnorm16(packed.normal[0]), DequantizeSnorm16(packed.normal[1])));
+            vertex.tangent = float4(OctaDecode(float2(tangentX, tangentY)), (packed.tangent >> 31) != 0 ? -1.0f : 1.0f);
+            vertex.texcoord = float2(glm::unpackHalf1x16(packed.texcoord[0]), glm::unpackHalf1x16(packed.texcoord[1]));
+        }
+    }
+
+    VertexCompressionError GetCompressionError(const Structs::Vertex_Full* vertices, uint vcount, const BoundingBox& bounds)
+    {
+        PK_PROFILE_FUNCTION();
+
+        using namespace CompressionUtility;
+
+        std::vector<Structs::Vertex_Compressed> compressed(vcount);
+        std::vector<Structs::Vertex_Full> decompressed(vcount);
+        CompressVertices(vertices, compressed.data(), vcount, bounds);
+        DecompressVertices(compressed.data(), decompressed.data(), vcount, bounds);
+
+        VertexCompressionError error;
+
+        for (uint i = 0; i < vcount; ++i)
+        {
+            auto& a = vertices[i];
+            auto& b = decompressed[i];
+            auto tangentError = (a.tangent.w < 0.0f) != (b.tangent.w < 0.0f) ? 180.0f : AngleDegrees(float3(a.tangent), float3(b.tangent));
+            error.position = glm::max(error.position, glm::length(a.position - b.position));
+            error.normal = glm::max(error.normal, AngleDegrees(a.normal, b.normal));
+            error.tangent = glm::max(error.tangent, tangentError);
+            error.texcoord = glm::max(error.texcoord, glm::compMax(glm::abs(a.texcoord - b.texcoord)));
+        }
+
+        return error;
     }
 
 
@@ -463,11 +2101,11 @@ namespace PK::Rendering::MeshUtility
             indices[baseIndex + 5] = baseVertex + 0;
         }
 
-        BufferLayout layout = { {PK_TYPE::FLOAT3, "POSITION"}, {PK_TYPE::FLOAT3, "NORMAL"}, {PK_TYPE::FLOAT4, "TANGENT"}, {PK_TYPE::FLOAT2, "TEXCOORD0"} };
+        auto& layout = Mesh::GetVertexLayout(false);
 
-        CalculateTangents(reinterpret_cast<float*>(vertices), layout.GetStride() / 4, 0, 3, 6, 10, indices, vcount, icount);
+        CalculateTangentsFast(reinterpret_cast<float*>(vertices), layout.GetStride() / 4, 0, 3, 6, 10, indices, vcount, icount);
 
-        auto mesh = CreateRef<Mesh>(CreateRef<VertexBuffer>(vertices, vcount, layout, true), CreateRef<IndexBuffer>(indices, icount, true));
+        auto mesh = CreateRef<Mesh>(layout, vertices, vcount, indices, icount);
         mesh->SetLocalBounds(PK::Math::Functions::CreateBoundsCenterExtents({ center.x, center.y, 0.0f }, { extents.x, extents.y, 0.0f }));
 
         free(vertices);
@@ -476,14 +2114,17 @@ namespace PK::Rendering::MeshUtility
         return mesh;
     }
 
-    Ref<Mesh> GetSphere(const float3& offset, const float radius)
+    static const int SphereLongitudes = 24;
+    static const int SphereLatitudes = 16;
+    static const int SphereVertexCount = (SphereLongitudes + 1) * SphereLatitudes + 2;
+    static const int SphereIndexCount = (SphereLongitudes * 2 + (SphereLatitudes - 1) * SphereLongitudes * 2) * 3;
+
+    // Uv sphere of SphereVertexCount vertices & SphereIndexCount indices. Indices start at baseVertex.
+    static void GetSphereGeometry(const float3& offset, const float radius, Structs::Vertex_Full* vertices, uint* indices, uint baseVertex)
     {
-        const int longc = 24;
-        const int lattc = 16;
-        const int vcount = (longc + 1) * lattc + 2;
-        
-        //Vertex_Full
-        auto vertices = PK_CONTIGUOUS_ALLOC(Structs::Vertex_Full, vcount);
+        const int longc = SphereLongitudes;
+        const int lattc = SphereLatitudes;
+        const int vcount = SphereVertexCount;
 
         vertices[0].position = PK_FLOAT3_UP * radius;
        
@@ -507,6 +2148,7 @@ namespace PK::Rendering::MeshUtility
         for (int n = 0; n < vcount; ++n)
         {
             vertices[n].normal = glm::normalize(vertices[n].position);
+            vertices[n].position += offset;
         }
 
         vertices[0].texcoord = PK_FLOAT2_UP;
@@ -519,20 +2161,15 @@ namespace PK::Rendering::MeshUtility
                 vertices[lon + lat * (longc + 1) + 1].texcoord = float2((float)lon / longc, 1.0f - (float)(lat + 1) / (lattc + 1));
             }
         }
-        
-        const int facec = vcount;
-        const int triscount = facec * 2;
-        const int icount = triscount * 3;
-        auto indices = PK_CONTIGUOUS_ALLOC(unsigned int, icount);
 
         //Top Cap
         int i = 0;
 
         for (int lon = 0; lon < longc; lon++)
         {
-            indices[i++] = lon + 2;
-            indices[i++] = lon + 1;
-            indices[i++] = 0;
+            indices[i++] = baseVertex + lon + 2;
+            indices[i++] = baseVertex + lon + 1;
+            indices[i++] = baseVertex;
         }
 
         //Middle
@@ -543,29 +2180,41 @@ namespace PK::Rendering::MeshUtility
                 int current = lon + lat * (longc + 1) + 1;
                 int next = current + longc + 1;
 
-                indices[i++] = current;
-                indices[i++] = current + 1;
-                indices[i++] = next + 1;
+                indices[i++] = baseVertex + current;
+                indices[i++] = baseVertex + current + 1;
+                indices[i++] = baseVertex + next + 1;
 
-                indices[i++] = current;
-                indices[i++] = next + 1;
-                indices[i++] = next;
+                indices[i++] = baseVertex + current;
+                indices[i++] = baseVertex + next + 1;
+                indices[i++] = baseVertex + next;
             }
         }
 
         //Bottom Cap
         for (int lon = 0; lon < longc; lon++)
         {
-            indices[i++] = vcount - 1;
-            indices[i++] = vcount - (lon + 2) - 1;
-            indices[i++] = vcount - (lon + 1) - 1;
+            indices[i++] = baseVertex + vcount - 1;
+            indices[i++] = baseVertex + vcount - (lon + 2) - 1;
+            indices[i++] = baseVertex + vcount - (lon + 1) - 1;
         }
+    }
+
+    Ref<Mesh> GetSphere(const float3& offset, const float radius)
+    {
+        const int vcount = SphereVertexCount;
+        const int icount = SphereIndexCount;
+        
+        //Vertex_Full
+        auto vertices = PK_CONTIGUOUS_ALLOC(Structs::Vertex_Full, vcount);
+        auto indices = PK_CONTIGUOUS_ALLOC(unsigned int, icount);
+
+        GetSphereGeometry(PK_FLOAT3_ZERO, radius, vertices, indices, 0);
 
-        BufferLayout layout = { {PK_TYPE::FLOAT3, "POSITION"}, {PK_TYPE::FLOAT3, "NORMAL"}, {PK_TYPE::FLOAT4, "TANGENT"}, {PK_TYPE::FLOAT2, "TEXCOORD0"} };
+        auto& layout = Mesh::GetVertexLayout(false);
 
-        CalculateTangents(reinterpret_cast<float*>(vertices), layout.GetStride() / 4, 0, 3, 6, 10, indices, vcount, icount);
+        CalculateTangentsFast(reinterpret_cast<float*>(vertices), layout.GetStride() / 4, 0, 3, 6, 10, indices, vcount, icount);
 
-        auto mesh = CreateRef<Mesh>(CreateRef<VertexBuffer>(reinterpret_cast<float*>(vertices), vcount, layout, true), CreateRef<IndexBuffer>(indices, icount, true));
+        auto mesh = CreateRef<Mesh>(layout, vertices, vcount, indices, icount);
         mesh->SetLocalBounds(PK::Math::Functions::CreateBoundsCenterExtents(offset, PK_FLOAT3_ONE * radius));
 
         free(vertices);
@@ -573,4 +2222,40 @@ namespace PK::Rendering::MeshUtility
 
         return mesh;
     }
+
+    Ref<Mesh> GetSphereGrid(const float3& offset, const float radius, const float spacing, uint2 resolution)
+    {
+        const uint count = resolution.x * resolution.y;
+        const uint vcount = SphereVertexCount * count;
+        const uint icount = SphereIndexCount * count;
+        auto vertices = PK_CONTIGUOUS_ALLOC(Structs::Vertex_Full, vcount);
+        auto indices = PK_CONTIGUOUS_ALLOC(unsigned int, icount);
+        auto size = float2(resolution - 1u) * spacing;
+        std::vector<IndexRange> submeshes;
+        std::vector<BoundingBox> submeshBounds;
+
+        for (auto y = 0u; y < resolution.y; ++y)
+        for (auto x = 0u; x < resolution.x; ++x)
+        {
+            auto index = x + y * resolution.x;
+            auto center = offset + float3(x * spacing - size.x * 0.5f, 0.0f, y * spacing - size.y * 0.5f);
+            GetSphereGeometry(center, radius, vertices + index * SphereVertexCount, indices + index * SphereIndexCount, index * SphereVertexCount);
+            submeshes.push_back({ index * SphereIndexCount, (uint)SphereIndexCount });
+            submeshBounds.push_back(PK::Math::Functions::CreateBoundsCenterExtents(center, PK_FLOAT3_ONE * radius));
+        }
+
+        auto& layout = Mesh::GetVertexLayout(false);
+
+        CalculateTangentsFast(reinterpret_cast<float*>(vertices), layout.GetStride() / 4, 0, 3, 6, 10, indices, vcount, icount);
+
+        auto mesh = CreateRef<Mesh>(layout, vertices, vcount, indices, icount);
+        mesh->SetSubMeshes(submeshes);
+        mesh->SetSubmeshBounds(submeshBounds);
+        mesh->SetLocalBounds(PK::Math::Functions::CreateBoundsCenterExtents(offset, float3(size.x * 0.5f + radius, radius, size.y * 0.5f + radius)));
+
+        free(vertices);
+        free(indices);
+
+        return mesh;
+    }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "Rendering/Objects/Mesh.h"
+#include "Core/JobSystem.h"
 #include <hlslmath.h>
 
 namespace PK::Rendering::MeshUtility
@@ -7,13 +8,93 @@ namespace PK::Rendering::MeshUtility
     using namespace Utilities;
     using namespace Objects;
 
+    struct VertexCacheStatistics
+    {
+        uint vertexTransforms = 0;
+        // Average cache miss ratio, transformed vertices per triangle.
+        float acmr = 0.0f;
+        // Average transform to vertex ratio, 1.0 is optimal.
+        float atvr = 0.0f;
+    };
+
+    struct TopologyStatistics
+    {
+        // Edges with a triangle on one side only.
+        uint openEdges = 0;
+        // Edges shared by more than two triangles or twice in the same direction.
+        uint nonManifoldEdges = 0;
+        // Triangles with two corners at the same position.
+        uint degenerateTriangles = 0;
+    };
+
+    // Largest round trip error of a compressed vertex layout. Also used as the precision budget when choosing one.
+    struct VertexCompressionError
+    {
+        // Object space distance.
+        float position = 0.0f;
+        // Degrees.
+        float normal = 0.0f;
+        float tangent = 0.0f;
+        float texcoord = 0.0f;
+
+        inline bool IsWithin(const VertexCompressionError& budget) const { return position <= budget.position && normal <= budget.normal && tangent <= budget.tangent && texcoord <= budget.texcoord; }
+    };
+
     void CalculateNormals(const float3* vertices, const uint* indices, float3* normals, uint vcount, uint icount, float sign = 1.0f);
     void CalculateTangents(const float3* vertices, const float3* normals, const float2* texcoords, const uint* indices, float4* tangents, uint vcount, uint icount);
     void CalculateTangents(void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint tangentOffset, uint texcoordOffset, const uint* indices, uint vcount, uint icount);
+    // Writes one tangent per index instead of per vertex. Use WeldTangents to merge them back into an indexed vertex list.
+    void CalculateTangents(const void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint texcoordOffset, const uint* indices, float4* cornerTangents, uint vcount, uint icount);
+    // Splits the triangles into groups that share no vertices & runs the above on each group in parallel.
+    // Bitwise identical to the single threaded version when vertices with equal position, normal & texcoord are welded.
+    void CalculateTangents(Core::JobSystem* jobSystem, const void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint texcoordOffset, const uint* indices, float4* cornerTangents, uint vcount, uint icount);
+    // Accumulates triangle tangents per vertex & orthogonalizes them against the normal. Not mikktspace compatible, meant for procedural meshes.
+    void CalculateTangentsFast(void* vertices, uint stride, uint vertexOffset, uint normalOffset, uint tangentOffset, uint texcoordOffset, const uint* indices, uint vcount, uint icount);
+    // Merges bitwise identical vertices & remaps the indices. Strides are in floats. Returns the new vertex count.
+    uint WeldVertices(float* vertices, uint stride, uint* indices, uint vcount, uint icount);
+    // Writes per index tangents into the vertices, corners with a different tangent are split into new vertices.
+    // The vertex array must have room for icount vertices. Returns the new vertex count.
+    uint WeldTangents(float* vertices, uint stride, uint tangentOffset, const float4* cornerTangents, uint* indices, uint vcount, uint icount);
+    // Meshes with a larger round trip error are imported with full precision vertices.
+    const VertexCompressionError VertexCompressionBudget = { 1e-3f, 0.5f, 1.0f, 1.0f / 1024.0f };
+    // Imported lod chain, triangle budgets relative to the full detail submesh & error bounds relative to the largest mesh dimension.
+    const uint MaxLodCount = 4;
+    const float LodTriangleRatios[MaxLodCount - 1] = { 0.5f, 0.25f, 0.125f };
+    const float LodErrorRatios[MaxLodCount - 1] = { 0.005f, 0.01f, 0.02f };
+    // Meshlet limits, sized for a 64 thread cluster culling & mesh shader workgroup.
+    const uint MeshletMaxVertices = 64;
+    const uint MeshletMaxTriangles = 124;
+
+    // Tipsify (Sander et al. 2007) triangle reordering for a post transform vertex cache of cacheSize entries.
+    void OptimizeVertexCache(uint* indices, uint icount, uint vcount, uint cacheSize = 16);
+    // Splits cache optimized triangles into clusters & sorts them outward facing first. threshold is the allowed acmr increase.
+    void OptimizeOverdraw(const float* vertices, uint stride, uint vertexOffset, uint* indices, uint icount, uint vcount, uint cacheSize = 16, float threshold = 1.05f);
+    // Reorders vertices in first use order. Unreferenced vertices are removed, returns the new vertex count.
+    uint OptimizeVertexFetch(float* vertices, uint stride, uint* indices, uint vcount, uint icount);
+    // Simulates a fifo post transform vertex cache.
+    VertexCacheStatistics AnalyzeVertexCache(const uint* indices, uint icount, uint vcount, uint cacheSize = 16);
+    // Quadric error metric edge collapse (Garland & Heckbert 1997). Writes at most icount indices, returns the simplified index count.
+    // Stops at targetIndexCount or when the next collapse would exceed targetError, both errors are object space distances.
+    // Attribute seams & non manifold vertices are kept in place, open borders only collapse along themselves.
+    uint SimplifyMesh(const float* vertices, uint stride, uint vertexOffset, const uint* indices, uint icount, uint vcount, uint targetIndexCount, float targetError, uint* output, float* resultError);
+    // Edges are compared by position, vertices split by attribute seams count as connected.
+    TopologyStatistics AnalyzeTopology(const float* vertices, uint stride, uint vertexOffset, const uint* indices, uint icount, uint vcount);
+    // Greedily grows meshlets over connected triangles, preferring ones that share vertices & keep the normal cone narrow.
+    // Triangles are reordered so that each meshlet is a contiguous, vertex cache optimized index range. Appends the meshlets to output with index offsets
+    // relative to indices & returns the number of meshlets appended.
+    uint BuildMeshlets(const float* vertices, uint stride, uint vertexOffset, uint* indices, uint icount, uint vcount, std::vector<Structs::Meshlet>& output);
+    // Bounds of the vertices referenced by each index range. Strides & offsets are in floats.
+    void CalculateSubmeshBounds(const float* vertices, uint stride, uint vertexOffset, const uint* indices, const Structs::IndexRange* submeshes, uint submeshCount, BoundingBox* bounds);
+    // Positions are quantized relative to bounds, which must contain all of the vertices.
+    void CompressVertices(const Structs::Vertex_Full* vertices, Structs::Vertex_Compressed* output, uint vcount, const BoundingBox& bounds);
+    void DecompressVertices(const Structs::Vertex_Compressed* vertices, Structs::Vertex_Full* output, uint vcount, const BoundingBox& bounds);
+    VertexCompressionError GetCompressionError(const Structs::Vertex_Full* vertices, uint vcount, const BoundingBox& bounds);
     Ref<Mesh> GetBoxSimple(const float3& offset, const float3& extents);
     Ref<Mesh> GetBox(const float3& offset, const float3& extents);
     Ref<Mesh> GetQuad2D(const float2& min, const float2& max);
     Ref<Mesh> GetQuad3D(const float2& min, const float2& max);
     Ref<Mesh> GetPlane(const float2& center, const float2& extents, uint2 resolution);
     Ref<Mesh> GetSphere(const float3& offset, const float radius);
+    // Grid of spheres on the xz plane centered at offset, each sphere is a submesh with its own bounds.
+    Ref<Mesh> GetSphereGrid(const float3& offset, const float radius, const float spacing, uint2 resolution);
 }
@@ -0,0 +1,497 @@
+#include "PrecompiledHeader.h"
+#include "Rendering/ObjReader.h"
+#include "Core/Profiler.h"
+#include <charconv>
+
+namespace PK::Rendering::ObjReader
+{
+    enum class Statement
+    {
+        Unknown,
+        Position,
+        Texcoord,
+        Normal,
+        Face,
+        Group
+    };
+
+    // A range of whole lines. Attributes are written directly to their final location, faces are stitched together in chunk order.
+    struct Chunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        uint lineCount = 0;
+        uint counts[3] = { 0, 0, 0 };
+        // Lines & attributes in the preceding chunks.
+        uint lineBase = 0;
+        uint bases[3] = { 0, 0, 0 };
+        // Position, texcoord & normal index of each triangle corner, ~0u when missing.
+        std::vector<uint3> corners;
+        // Corner offsets at which a group or object statement starts a new submesh.
+        std::vector<uint> groupStarts;
+        std::string error;
+    };
+
+    // Chunks below this size are not worth a job.
+    const size_t MinChunkSize = 64ull * 1024ull;
+    const float PowersOfTen[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+    static inline bool IsSpace(char c) { return c == ' ' || c == '\t'; }
+    static inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+    static inline bool IsTokenEnd(const char* c, const char* end) { return c == end || IsSpace(*c) || *c == '\r'; }
+
+    static inline const char* SkipSpaces(const char* c, const char* end)
+    {
+        while (c < end && IsSpace(*c))
+        {
+            ++c;
+        }
+
+        return c;
+    }
+
+    static inline const char* FindLineEnd(const char* c, const char* end)
+    {
+        auto newline = reinterpret_cast<const char*>(memchr(c, '\n', end - c));
+        return newline != nullptr ? newline : end;
+    }
+
+    // Statements need to be followed by a space, others like usemtl, mtllib or s are ignored.
+    static Statement ReadStatement(const char*& c, const char* end)
+    {
+        c = SkipSpaces(c, end);
+        auto length = 0;
+
+        while (c + length < end && !IsTokenEnd(c + length, end))
+        {
+            ++length;
+        }
+
+        if (c + length == end || !IsSpace(c[length]))
+        {
+            return Statement::Unknown;
+        }
+
+        auto statement = Statement::Unknown;
+
+        switch (length)
+        {
+            case 1:
+                statement = c[0] == 'v' ? Statement::Position :
+                            c[0] == 'f' ? Statement::Face :
+                            c[0] == 'g' || c[0] == 'o' ? Statement::Group : Statement::Unknown;
+                break;
+            case 2:
+                statement = c[0] != 'v' ? Statement::Unknown :
+                            c[1] == 't' ? Statement::Texcoord :
+                            c[1] == 'n' ? Statement::Normal : Statement::Unknown;
+                break;
+        }
+
+        c += length;
+        return statement;
+    }
+
+    // Exact for up to 24 bits of mantissa & exponents up to 10, which covers typical exporter output. Anything else goes through from_chars.
+    static const char* ParseFloat(const char* c, const char* end, float* value)
+    {
+        auto begin = c;
+        auto isNegative = c < end && *c == '-';
+        c += c < end && (*c == '-' || *c == '+') ? 1 : 0;
+
+        auto digits = c;
+        uint64_t mantissa = 0;
+        auto significantDigits = 0;
+        auto exponent = 0;
+
+        for (; c < end && IsDigit(*c); ++c)
+        {
+            mantissa = mantissa * 10 + (*c - '0');
+            significantDigits += mantissa != 0 ? 1 : 0;
+        }
+
+        auto hasDigits = c != digits;
+
+        if (c < end && *c == '.')
+        {
+            auto fraction = ++c;
+
+            for (; c < end && IsDigit(*c); ++c)
+            {
+                mantissa = mantissa * 10 + (*c - '0');
+                significantDigits += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+
+            hasDigits |= c != fraction;
+        }
+
+        if (hasDigits && c < end && (*c == 'e' || *c == 'E'))
+        {
+            auto exponentSign = c + 1 < end && c[1] == '-' ? -1 : 1;
+            auto exponentDigits = c + 1 + (c + 1 < end && (c[1] == '-' || c[1] == '+') ? 1 : 0);
+            auto explicitExponent = 0;
+
+            for (c = exponentDigits; c < end && IsDigit(*c) && explicitExponent < 10000; ++c)
+            {
+                explicitExponent = explicitExponent * 10 + (*c - '0');
+            }
+
+            hasDigits &= c != exponentDigits;
+            exponent += exponentSign * explicitExponent;
+        }
+
+        if (hasDigits && significantDigits <= 18 && mantissa <= (1ull << 24) && exponent >= -10 && exponent <= 10 && IsTokenEnd(c, end))
+        {
+            auto magnitude = exponent < 0 ? (float)mantissa / PowersOfTen[-exponent] : (float)mantissa * PowersOfTen[exponent];
+            *value = isNegative ? -magnitude : magnitude;
+            return c;
+        }
+
+        // from_chars doesn't accept a leading plus.
+        begin += begin < end && *begin == '+' ? 1 : 0;
+        auto result = std::from_chars(begin, end, *value);
+        return result.ec == std::errc() && IsTokenEnd(result.ptr, end) ? result.ptr : nullptr;
+    }
+
+    static const char* ParseInt(const char* c, const char* end, int* value)
+    {
+        auto isNegative = c < end && *c == '-';
+        c += c < end && (*c == '-' || *c == '+') ? 1 : 0;
+
+        auto digits = c;
+        int64_t magnitude = 0;
+
+        for (; c < end && IsDigit(*c) && magnitude <= INT32_MAX; ++c)
+        {
+            magnitude = magnitude * 10 + (*c - '0');
+        }
+
+        if (c == digits || magnitude > INT32_MAX)
+        {
+            return nullptr;
+        }
+
+        *value = (int)(isNegative ? -magnitude : magnitude);
+        return c;
+    }
+
+    // Indices are one based, negative ones are relative to the end of the attributes read so far.
+    static bool ResolveIndex(int index, uint countSoFar, uint totalCount, uint* output)
+    {
+        auto resolved = index > 0 ? (int64_t)index - 1 : (int64_t)countSoFar + index;
+        *output = (uint)resolved;
+        return index != 0 && resolved >= 0 && resolved < totalCount;
+    }
+
+    static void CountStatements(Chunk& chunk)
+    {
+        for (auto c = chunk.begin; c < chunk.end; ++chunk.lineCount)
+        {
+            auto lineEnd = FindLineEnd(c, chunk.end);
+
+            switch (ReadStatement(c, lineEnd))
+            {
+                case Statement::Position: chunk.counts[0]++; break;
+                case Statement::Texcoord: chunk.counts[1]++; break;
+                case Statement::Normal: chunk.counts[2]++; break;
+                default: break;
+            }
+
+            c = lineEnd + 1;
+        }
+    }
+
+    static void ParseStatements(Chunk& chunk, float3* positions, float2* texcoords, float3* normals, const uint* totalCounts)
+    {
+        uint counts[3] = { chunk.bases[0], chunk.bases[1], chunk.bases[2] };
+        std::vector<uint3> polygon;
+        auto line = chunk.lineBase;
+
+        for (auto lineBegin = chunk.begin; lineBegin < chunk.end; ++line)
+        {
+            auto lineEnd = FindLineEnd(lineBegin, chunk.end);
+            auto c = lineBegin;
+            auto statement = ReadStatement(c, lineEnd);
+            auto isValid = true;
+
+            switch (statement)
+            {
+                case Statement::Position:
+                case Statement::Normal:
+                {
+                    auto output = statement == Statement::Position ? &positions[counts[0]++].x : &normals[counts[2]++].x;
+
+                    for (auto i = 0; i < 3 && isValid; ++i)
+                    {
+                        c = ParseFloat(SkipSpaces(c, lineEnd), lineEnd, output + i);
+                        isValid = c != nullptr;
+                    }
+                }
+                break;
+
+                case Statement::Texcoord:
+                {
+                    auto output = &texcoords[counts[1]++].x;
+
+                    for (auto i = 0; i < 2 && isValid; ++i)
+                    {
+                        c = ParseFloat(SkipSpaces(c, lineEnd), lineEnd, output + i);
+                        isValid = c != nullptr;
+                    }
+                }
+                break;
+
+                case Statement::Face:
+                {
+                    polygon.clear();
+
+                    c = SkipSpaces(c, lineEnd);
+
+                    while (isValid && c < lineEnd && *c != '\r')
+                    {
+                        int indices[3] = { 0, 0, 0 };
+                        uint3 corner = { ~0u, ~0u, ~0u };
+
+                        c = ParseInt(c, lineEnd, indices);
+                        isValid = c != nullptr && ResolveIndex(indices[0], counts[0], totalCounts[0], &corner.x);
+
+                        // p, p/t, p//n or p/t/n.
+                        for (auto i = 1; i < 3 && isValid && c < lineEnd && *c == '/'; ++i)
+                        {
+                            if (i == 1 && c + 1 < lineEnd && c[1] == '/')
+                            {
+                                ++c;
+                                continue;
+                            }
+
+                            c = ParseInt(c + 1, lineEnd, indices + i);
+                            isValid = c != nullptr && ResolveIndex(indices[i], counts[i], totalCounts[i], &corner[i]);
+                        }
+
+                        isValid = isValid && IsTokenEnd(c, lineEnd);
+                        c = isValid ? SkipSpaces(c, lineEnd) : c;
+                        polygon.push_back(corner);
+                    }
+
+                    // Points & lines have no triangles.
+                    for (auto i = 2u; isValid && i < polygon.size(); ++i)
+                    {
+                        chunk.corners.push_back(polygon.at(0));
+                        chunk.corners.push_back(polygon.at(i - 1));
+                        chunk.corners.push_back(polygon.at(i));
+                    }
+                }
+                break;
+
+                case Statement::Group: chunk.groupStarts.push_back((uint)chunk.corners.size()); break;
+                default: break;
+            }
+
+            if (!isValid)
+            {
+                chunk.error = "Malformed statement or index out of range at line " + std::to_string(line + 1);
+                return;
+            }
+
+            lineBegin = lineEnd + 1;
+        }
+    }
+
+    bool Parse(const char* text, size_t size, Core::JobSystem* jobSystem, ObjData& data, std::string& error)
+    {
+        PK_PROFILE_FUNCTION();
+
+        size_t chunkCount = jobSystem != nullptr ? glm::clamp(size / MinChunkSize, (size_t)1u, (size_t)jobSystem->GetThreadCount() * 4u) : 1u;
+        std::vector<Chunk> chunks(chunkCount);
+        auto textEnd = text + size;
+
+        // Chunks end after the first line break past their share of the text.
+        for (auto i = 0u; i < chunkCount; ++i)
+        {
+            auto& chunk = chunks.at(i);
+            chunk.begin = i == 0 ? text : chunks.at(i - 1).end;
+            auto lineEnd = FindLineEnd(std::max(chunk.begin, text + size * (i + 1) / chunkCount), textEnd);
+            chunk.end = lineEnd < textEnd ? lineEnd + 1 : textEnd;
+        }
+
+        auto forEachChunk = [&](const std::function<void(Chunk&)>& function)
+        {
+            if (jobSystem == nullptr || chunkCount == 1)
+            {
+                for (auto& chunk : chunks)
+                {
+                    function(chunk);
+                }
+
+                return;
+            }
+
+            jobSystem->ParallelFor((uint32_t)chunkCount, 1u, [&](uint32_t begin, uint32_t end)
+            {
+                for (auto i = begin; i < end; ++i)
+                {
+                    function(chunks.at(i));
+                }
+            });
+        };
+
+        // Relative indices & attribute locations need the number of attributes before each chunk.
+        forEachChunk(CountStatements);
+
+        uint totalCounts[3] = { 0, 0, 0 };
+        uint lineCount = 0;
+
+        for (auto& chunk : chunks)
+        {
+            chunk.lineBase = lineCount;
+            lineCount += chunk.lineCount;
+
+            for (auto i = 0; i < 3; ++i)
+            {
+                chunk.bases[i] = totalCounts[i];
+                totalCounts[i] += chunk.counts[i];
+            }
+        }
+
+        std::vector<float3> positions(totalCounts[0]);
+        std::vector<float2> texcoords(totalCounts[1]);
+        std::vector<float3> normals(totalCounts[2]);
+
+        forEachChunk([&](Chunk& chunk) { ParseStatements(chunk, positions.data(), texcoords.data(), normals.data(), totalCounts); });
+
+        for (auto& chunk : chunks)
+        {
+            if (!chunk.error.empty())
+            {
+                error = chunk.error;
+                return false;
+            }
+        }
+
+        data.vertices.clear();
+        data.indices.clear();
+        data.submeshes.clear();
+        data.positionCount = totalCounts[0];
+        data.texcoordCount = totalCounts[1];
+        data.normalCount = totalCounts[2];
+
+        // Vertices that share a position are linked into a list, most positions only have a few texcoord & normal combinations.
+        std::vector<uint> firstVertices(totalCounts[0], ~0u);
+        std::vector<uint3> vertexCorners;
+        std::vector<uint> nextVertices;
+        uint submeshOffset = 0;
+
+        for (auto& chunk : chunks)
+        {
+            auto groupIndex = 0u;
+
+            for (auto i = 0u; i <= chunk.corners.size(); ++i)
+            {
+                for (; groupIndex < chunk.groupStarts.size() && chunk.groupStarts.at(groupIndex) == i; ++groupIndex)
+                {
+                    if (data.indices.size() > submeshOffset)
+                    {
+                        data.submeshes.push_back({ submeshOffset, (uint)data.indices.size() - submeshOffset });
+                        submeshOffset = (uint)data.indices.size();
+                    }
+                }
+
+                if (i == chunk.corners.size())
+                {
+                    break;
+                }
+
+                auto& corner = chunk.corners.at(i);
+                auto vertex = firstVertices.at(corner.x);
+                auto previous = ~0u;
+
+                while (vertex != ~0u && vertexCorners.at(vertex) != corner)
+                {
+                    previous = vertex;
+                    vertex = nextVertices.at(vertex);
+                }
+
+                if (vertex == ~0u)
+                {
+                    vertex = (uint)vertexCorners.size();
+                    vertexCorners.push_back(corner);
+                    nextVertices.push_back(~0u);
+                    (previous == ~0u ? firstVertices.at(corner.x) : nextVertices.at(previous)) = vertex;
+                }
+
+                data.indices.push_back(vertex);
+            }
+        }
+
+        if (data.indices.size() > submeshOffset)
+        {
+            data.submeshes.push_back({ submeshOffset, (uint)data.indices.size() - submeshOffset });
+        }
+
+        data.vertices.resize(vertexCorners.size());
+
+        for (auto i = 0u; i < vertexCorners.size(); ++i)
+        {
+            auto& corner = vertexCorners.at(i);
+            auto& vertex = data.vertices.at(i);
+            vertex.position = positions.at(corner.x);
+            vertex.texcoord = corner.y != ~0u ? texcoords.at(corner.y) : PK_FLOAT2_ZERO;
+            vertex.normal = corner.z != ~0u ? normals.at(corner.z) : PK_FLOAT3_ZERO;
+            vertex.tangent = PK_FLOAT4_ZERO;
+        }
+
+        return true;
+    }
+
+    bool Read(const std::string& filepath, Core::JobSystem* jobSystem, ObjData& data, std::string& error)
+    {
+        auto file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            error = "Failed to open file: " + filepath;
+            return false;
+        }
+
+        LARGE_INTEGER fileSize = {};
+        HANDLE mapping = nullptr;
+        const char* view = nullptr;
+        auto hasSize = GetFileSizeEx(file, &fileSize) != 0;
+
+        // Empty files can't be mapped.
+        if (hasSize && fileSize.QuadPart > 0)
+        {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+
+        if (mapping != nullptr)
+        {
+            view = reinterpret_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+
+        auto isValid = hasSize && (view != nullptr || fileSize.QuadPart == 0);
+
+        if (isValid)
+        {
+            isValid = Parse(view, view != nullptr ? (size_t)fileSize.QuadPart : 0ull, jobSystem, data, error);
+        }
+        else
+        {
+            error = "Failed to map file: " + filepath;
+        }
+
+        if (view != nullptr)
+        {
+            UnmapViewOfFile(view);
+        }
+
+        if (mapping != nullptr)
+        {
+            CloseHandle(mapping);
+        }
+
+        CloseHandle(file);
+        return isValid;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Core/JobSystem.h"
+#include <hlslmath.h>
+#include "Rendering/Structs/StructsCommon.h"
+
+namespace PK::Rendering::ObjReader
+{
+    using namespace Structs;
+
+    // Triangulated contents of an .obj file. Vertices are the unique position, texcoord & normal index triplets in first use order.
+    struct ObjData
+    {
+        std::vector<Vertex_Full> vertices;
+        std::vector<uint> indices;
+        // One range per group or object that has faces, in file order.
+        std::vector<IndexRange> submeshes;
+        uint positionCount = 0;
+        uint texcoordCount = 0;
+        uint normalCount = 0;
+    };
+
+    // Parses v, vt, vn, f, g & o statements, everything else is skipped. Polygons are fan triangulated & corners without a texcoord or normal get zeroes.
+    // Chunks of whole lines are parsed on the job system when one is given, the result doesn't depend on the number of threads.
+    // Returns false & describes the first error when a statement is malformed or an index is out of range.
+    bool Parse(const char* text, size_t size, Core::JobSystem* jobSystem, ObjData& data, std::string& error);
+    // Memory maps the file & parses it in place.
+    bool Read(const std::string& filepath, Core::JobSystem* jobSystem, ObjData& data, std::string& error);
+}
@@ -34,6 +34,7 @@ namespace PK::Rendering::Objects
 		glCreateBuffers(1, &m_graphicsId);
 		glBindBuffer(GL_ARRAY_BUFFER, m_graphicsId);
 		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		m_memory.Set(0, size);
 	}
 	
 	VertexBuffer::VertexBuffer(const void* vertices, size_t size, bool immutable) : m_immutable(immutable)
@@ -49,6 +50,8 @@ namespace PK::Rendering::Objects
 		{
 			glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
 		}
+
+		m_memory.Set(0, size);
 	}
 	
 	VertexBuffer::VertexBuffer(size_t elementCount, const BufferLayout& layout) : VertexBuffer(layout.GetStride() * elementCount)
@@ -72,7 +75,7 @@ namespace PK::Rendering::Objects
 		glNamedBufferSubData(m_graphicsId, 0, size, data);
 	}
 	
-	IndexBuffer::IndexBuffer(uint* indices, uint count, bool immutable) : m_count(count), m_immutable(immutable)
+	IndexBuffer::IndexBuffer(const uint* indices, uint count, bool immutable) : m_count(count), m_immutable(immutable)
 	{
 		glCreateBuffers(1, &m_graphicsId);
 		glBindBuffer(GL_ARRAY_BUFFER, m_graphicsId);
@@ -85,6 +88,8 @@ namespace PK::Rendering::Objects
 		{
 			glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint), indices, GL_STATIC_DRAW);
 		}
+
+		m_memory.Set(0, count * sizeof(uint));
 	}
 	
 	IndexBuffer::~IndexBuffer()
@@ -98,6 +103,9 @@ namespace PK::Rendering::Objects
 		glBindBuffer(GL_UNIFORM_BUFFER, m_graphicsId);
 		glBufferStorage(GL_UNIFORM_BUFFER, layout.GetStride(), nullptr, GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT);
 		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		// Properties are mirrored in a cpu side block that is flushed to the buffer.
+		m_memory.Set(m_data.size(), layout.GetStride());
 	}
 	
 	ConstantBuffer::~ConstantBuffer()
@@ -128,6 +136,7 @@ namespace PK::Rendering::Objects
 		}
 
 		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		m_memory.Set(0, size);
 	}
 	
 	ComputeBuffer::~ComputeBuffer()
@@ -149,6 +158,7 @@ namespace PK::Rendering::Objects
 		
 		glInvalidateBufferData(m_graphicsId);
 		glNamedBufferData(m_graphicsId, size, nullptr, m_usage);
+		m_memory.Set(0, size);
 	}
 	
 	void ComputeBuffer::ValidateSize(uint newCount)
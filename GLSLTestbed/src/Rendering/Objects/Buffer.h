@@ -1,5 +1,6 @@
 #pragma once
 #include "Core/BufferView.h"
+#include "Core/MemoryTracker.h"
 #include "Rendering/Objects/GraphicsObject.h"
 #include "Rendering/Structs/BufferLayout.h"
 #include "Rendering/Structs/PropertyBlock.h"
@@ -27,12 +28,13 @@ namespace PK::Rendering::Objects
 		private:
 			BufferLayout m_layout;
 			bool m_immutable;
+			Core::MemoryAllocation m_memory { Core::MemoryResource::VertexBuffer };
 	};
 	
 	class IndexBuffer : public GraphicsObject
 	{
 		public:
-			IndexBuffer(uint* indices, uint count, bool immutable);
+			IndexBuffer(const uint* indices, uint count, bool immutable);
 			~IndexBuffer();
 		
 			inline uint GetCount() const { return m_count; }
@@ -40,6 +42,7 @@ namespace PK::Rendering::Objects
 		private:
 			uint m_count;
 			bool m_immutable;
+			Core::MemoryAllocation m_memory { Core::MemoryResource::IndexBuffer };
 	};
 	
 	class ConstantBuffer : public GraphicsObject, public PropertyBlock
@@ -49,6 +52,7 @@ namespace PK::Rendering::Objects
 			~ConstantBuffer();
 			void FlushBuffer();
 		private:
+			Core::MemoryAllocation m_memory { Core::MemoryResource::ConstantBuffer };
 	};
 	
 	class ComputeBuffer : public GraphicsObject
@@ -95,5 +99,6 @@ namespace PK::Rendering::Objects
 			size_t m_count;
 			GLenum m_usage;
 			bool m_immutable;
+			Core::MemoryAllocation m_memory { Core::MemoryResource::ComputeBuffer };
 	};
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "PrecompiledHeader.h"
+#include "Rendering/Objects/GeometryPool.h"
+#include <glad/glad.h>
+
+namespace PK::Rendering::Objects
+{
+	// Copies the live ranges compacted into a new buffer of the given capacity. Contiguous ranges are copied together.
+	static GraphicsID ReallocateBuffer(GraphicsID buffer, RangeAllocator& ranges, size_t stride, uint capacity)
+	{
+		std::vector<RangeAllocator::Move> moves;
+		ranges.Compact(moves);
+		ranges.Grow(capacity);
+
+		GraphicsID newBuffer = 0;
+		glCreateBuffers(1, &newBuffer);
+		glNamedBufferStorage(newBuffer, stride * ranges.GetCapacity(), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+		for (auto i = 0u; i < moves.size();)
+		{
+			auto move = moves.at(i++);
+
+			for (; i < moves.size() && moves.at(i).source == move.source + move.count; ++i)
+			{
+				move.count += moves.at(i).count;
+			}
+
+			glCopyNamedBufferSubData(buffer, newBuffer, move.source * stride, move.destination * stride, move.count * stride);
+		}
+
+		if (buffer != 0)
+		{
+			glDeleteBuffers(1, &buffer);
+		}
+
+		return newBuffer;
+	}
+
+	// Compacting is enough when the free ranges are only fragmented, otherwise the capacity is at least doubled.
+	static uint AllocateRange(RangeAllocator& ranges, GraphicsID& buffer, size_t stride, uint count, uint minCapacity)
+	{
+		auto handle = ranges.Allocate(count);
+
+		if (handle != RangeAllocator::InvalidHandle || count == 0)
+		{
+			return handle;
+		}
+
+		auto capacity = ranges.GetCapacity();
+
+		if (ranges.GetFreeCount() < count)
+		{
+			capacity = glm::max(glm::max(minCapacity, capacity * 2u), ranges.GetUsedCount() + count);
+		}
+
+		buffer = ReallocateBuffer(buffer, ranges, stride, capacity);
+		return ranges.Allocate(count);
+	}
+
+	GeometryPool::GeometryPool(const BufferLayout& layout) : m_layout(layout)
+	{
+		glCreateVertexArrays(1, &m_graphicsId);
+
+		auto index = 0u;
+
+		for (const auto& element : m_layout)
+		{
+			switch (element.Type)
+			{
+				case PK_TYPE::FLOAT:
+				case PK_TYPE::FLOAT2:
+				case PK_TYPE::FLOAT3:
+				case PK_TYPE::FLOAT4:
+				case PK_TYPE::HALF2:
+				case PK_TYPE::HALF4:
+				case PK_TYPE::SHORT2:
+				case PK_TYPE::USHORT4:
+				case PK_TYPE::INT:
+				case PK_TYPE::INT2:
+				case PK_TYPE::INT3:
+				case PK_TYPE::INT4:
+					glVertexArrayAttribFormat(m_graphicsId, index, Convert::Components(element.Type), Convert::BaseType(element.Type), element.Normalized ? GL_TRUE : GL_FALSE, (GLuint)element.Offset);
+					break;
+				// Read as integers by the shader, packed data is decoded there.
+				case PK_TYPE::UINT:
+				case PK_TYPE::UINT2:
+				case PK_TYPE::UINT3:
+				case PK_TYPE::UINT4:
+					glVertexArrayAttribIFormat(m_graphicsId, index, Convert::Components(element.Type), Convert::BaseType(element.Type), (GLuint)element.Offset);
+					break;
+				default:
+					PK_CORE_ASSERT(false, "Unsupported geometry pool vertex element type!");
+			}
+
+			glEnableVertexArrayAttrib(m_graphicsId, index);
+			glVertexArrayAttribBinding(m_graphicsId, index, 0);
+			++index;
+		}
+	}
+
+	GeometryPool::~GeometryPool()
+	{
+		glDeleteVertexArrays(1, &m_graphicsId);
+		glDeleteBuffers(1, &m_vertexBuffer);
+		glDeleteBuffers(1, &m_indexBuffer);
+	}
+
+	Ref<GeometryPool> GeometryPool::Get(const BufferLayout& layout)
+	{
+		static std::vector<std::pair<BufferLayout, Weak<GeometryPool>>> pools;
+
+		for (auto& pool : pools)
+		{
+			if (pool.first == layout && !pool.second.expired())
+			{
+				return pool.second.lock();
+			}
+		}
+
+		Core::MemoryScope memoryScope("GeometryPool");
+		auto pool = CreateRef<GeometryPool>(layout);
+		pools.erase(std::remove_if(pools.begin(), pools.end(), [](const std::pair<BufferLayout, Weak<GeometryPool>>& p) { return p.second.expired(); }), pools.end());
+		pools.push_back({ layout, pool });
+		return pool;
+	}
+
+	GeometryPool::Allocation GeometryPool::Allocate(const void* vertices, uint vertexCount, const uint* indices, uint indexCount)
+	{
+		auto stride = (size_t)m_layout.GetStride();
+		auto vertexBuffer = m_vertexBuffer;
+		auto indexBuffer = m_indexBuffer;
+
+		Allocation allocation;
+		allocation.vertices = AllocateRange(m_vertexRanges, m_vertexBuffer, stride, vertexCount, MinVertexCapacity);
+		allocation.indices = AllocateRange(m_indexRanges, m_indexBuffer, sizeof(uint), indexCount, MinIndexCapacity);
+
+		if (vertexBuffer != m_vertexBuffer)
+		{
+			glVertexArrayVertexBuffer(m_graphicsId, 0, m_vertexBuffer, 0, (GLsizei)stride);
+		}
+
+		if (indexBuffer != m_indexBuffer)
+		{
+			glVertexArrayElementBuffer(m_graphicsId, m_indexBuffer);
+		}
+
+		UpdateMemory();
+
+		if (allocation.vertices != RangeAllocator::InvalidHandle)
+		{
+			glNamedBufferSubData(m_vertexBuffer, GetVertexRange(allocation).offset * stride, vertexCount * stride, vertices);
+		}
+
+		if (allocation.indices != RangeAllocator::InvalidHandle)
+		{
+			glNamedBufferSubData(m_indexBuffer, GetIndexRange(allocation).offset * sizeof(uint), indexCount * sizeof(uint), indices);
+		}
+
+		return allocation;
+	}
+
+	void GeometryPool::Free(const Allocation& allocation)
+	{
+		m_vertexRanges.Free(allocation.vertices);
+		m_indexRanges.Free(allocation.indices);
+		UpdateMemory();
+	}
+
+	void GeometryPool::Compact()
+	{
+		if (m_vertexBuffer == 0 || m_indexBuffer == 0)
+		{
+			return;
+		}
+
+		auto stride = (size_t)m_layout.GetStride();
+		m_vertexBuffer = ReallocateBuffer(m_vertexBuffer, m_vertexRanges, stride, m_vertexRanges.GetCapacity());
+		m_indexBuffer = ReallocateBuffer(m_indexBuffer, m_indexRanges, sizeof(uint), m_indexRanges.GetCapacity());
+		glVertexArrayVertexBuffer(m_graphicsId, 0, m_vertexBuffer, 0, (GLsizei)stride);
+		glVertexArrayElementBuffer(m_graphicsId, m_indexBuffer);
+	}
+
+	void GeometryPool::ReadVertices(const Allocation& allocation, void* vertices) const
+	{
+		auto stride = (size_t)m_layout.GetStride();
+		auto& range = GetVertexRange(allocation);
+		glGetNamedBufferSubData(m_vertexBuffer, range.offset * stride, range.count * stride, vertices);
+	}
+
+	void GeometryPool::ReadIndices(const Allocation& allocation, uint* indices) const
+	{
+		auto& range = GetIndexRange(allocation);
+		glGetNamedBufferSubData(m_indexBuffer, range.offset * sizeof(uint), range.count * sizeof(uint), indices);
+	}
+
+	void GeometryPool::UpdateMemory()
+	{
+		auto stride = (size_t)m_layout.GetStride();
+		m_vertexMemory.Set(0, (size_t)m_vertexRanges.GetFreeCount() * stride);
+		m_indexMemory.Set(0, (size_t)m_indexRanges.GetFreeCount() * sizeof(uint));
+	}
+}
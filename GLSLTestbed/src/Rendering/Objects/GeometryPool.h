@@ -0,0 +1,59 @@
+#pragma once
+#include "Utilities/Ref.h"
+#include "Core/MemoryTracker.h"
+#include "Rendering/Objects/GraphicsObject.h"
+#include "Rendering/Structs/BufferLayout.h"
+#include "Rendering/Structs/RangeAllocator.h"
+
+namespace PK::Rendering::Objects
+{
+	using namespace Utilities;
+	using namespace Structs;
+
+	// Vertex & index storage shared by the meshes of a vertex layout. Meshes sub allocate ranges & are drawn with a base vertex, so they share one vertex array.
+	// Indices are stored relative to the first vertex of their allocation.
+	// Allocated ranges are charged to the memory owner of the mesh that holds them, the pool is only charged for its free capacity.
+	class GeometryPool : public GraphicsObject
+	{
+		public:
+			struct Allocation
+			{
+				uint vertices = RangeAllocator::InvalidHandle;
+				uint indices = RangeAllocator::InvalidHandle;
+			};
+
+			GeometryPool(const BufferLayout& layout);
+			~GeometryPool();
+
+			// Pool of the meshes with the layout, lives as long as it is referenced.
+			static Ref<GeometryPool> Get(const BufferLayout& layout);
+
+			// Grows the buffers when the free ranges are too small, which moves the existing allocations.
+			Allocation Allocate(const void* vertices, uint vertexCount, const uint* indices, uint indexCount);
+			void Free(const Allocation& allocation);
+			// Moves the allocations to the start of the buffers, ranges queried earlier are invalidated.
+			void Compact();
+			void ReadVertices(const Allocation& allocation, void* vertices) const;
+			void ReadIndices(const Allocation& allocation, uint* indices) const;
+
+			inline const IndexRange& GetVertexRange(const Allocation& allocation) const { return m_vertexRanges.GetRange(allocation.vertices); }
+			inline const IndexRange& GetIndexRange(const Allocation& allocation) const { return m_indexRanges.GetRange(allocation.indices); }
+			inline const RangeAllocator& GetVertexRanges() const { return m_vertexRanges; }
+			inline const RangeAllocator& GetIndexRanges() const { return m_indexRanges; }
+			inline const BufferLayout& GetLayout() const { return m_layout; }
+
+		private:
+			void UpdateMemory();
+
+			static constexpr uint MinVertexCapacity = 1u << 16u;
+			static constexpr uint MinIndexCapacity = 1u << 18u;
+
+			BufferLayout m_layout;
+			RangeAllocator m_vertexRanges;
+			RangeAllocator m_indexRanges;
+			GraphicsID m_vertexBuffer = 0;
+			GraphicsID m_indexBuffer = 0;
+			Core::MemoryAllocation m_vertexMemory { Core::MemoryResource::VertexBuffer };
+			Core::MemoryAllocation m_indexMemory { Core::MemoryResource::IndexBuffer };
+	};
+}
@@ -3,9 +3,12 @@
 #include "Rendering/Objects/Mesh.h"
 #include "Rendering/GraphicsAPI.h"
 #include "Rendering/MeshUtility.h"
+#include "Rendering/ObjReader.h"
+#include "Core/Profiler.h"
+#include "Core/Application.h"
 #include <glad/glad.h>
 #include <hlslmath.h>
-#include <tinyobjloader/tiny_obj_loader.h>
+#include <atomic>
 
 namespace PK::Rendering::Objects
 {
@@ -13,9 +16,10 @@ namespace PK::Rendering::Objects
 	using namespace PK::Rendering::Structs;
 	using namespace PK::Math;
 
-	Mesh::Mesh()
+	static std::atomic<uint> s_nextMeshId = 1u;
+
+	Mesh::Mesh() : m_meshId(s_nextMeshId++)
 	{
-		glCreateVertexArrays(1, &m_graphicsId);
 	}
 	
 	Mesh::Mesh(const Ref<VertexBuffer>& vertexBuffer, const Ref<IndexBuffer>& indexBuffer) : Mesh()
@@ -23,17 +27,67 @@ namespace PK::Rendering::Objects
 		AddVertexBuffer(vertexBuffer);
 		SetIndexBuffer(indexBuffer);
 	}
+
+	Mesh::Mesh(const BufferLayout& layout, const void* vertices, uint vertexCount, const uint* indices, uint indexCount) : Mesh()
+	{
+		SetPooledGeometry(layout, vertices, vertexCount, indices, indexCount);
+	}
 	
 	Mesh::~Mesh()
 	{
-		glDeleteVertexArrays(1, &m_graphicsId);
+		ReleaseGeometry();
+	}
+
+	const BufferLayout& Mesh::GetVertexLayout(bool compressed)
+	{
+		static const BufferLayout layoutFull = { {PK_TYPE::FLOAT3, "POSITION"}, {PK_TYPE::FLOAT3, "NORMAL"}, {PK_TYPE::FLOAT4, "TANGENT"}, {PK_TYPE::FLOAT2, "TEXCOORD0"} };
+		static const BufferLayout layoutCompressed = { {PK_TYPE::USHORT4, "POSITION", 1, true}, {PK_TYPE::SHORT2, "NORMAL", 1, true}, {PK_TYPE::UINT, "TANGENT"}, {PK_TYPE::HALF2, "TEXCOORD0"} };
+		return compressed ? layoutCompressed : layoutFull;
+	}
+
+	void Mesh::SetPooledGeometry(const BufferLayout& layout, const void* vertices, uint vertexCount, const uint* indices, uint indexCount)
+	{
+		PK_CORE_ASSERT(vertexCount > 0 && indexCount > 0, "Pooled meshes need vertices & indices!");
+
+		ReleaseGeometry();
+		m_geometryPool = GeometryPool::Get(layout);
+		m_geometryAllocation = m_geometryPool->Allocate(vertices, vertexCount, indices, indexCount);
+		m_geometryVertexMemory.Set(0, (size_t)vertexCount * layout.GetStride());
+		m_geometryIndexMemory.Set(0, (size_t)indexCount * sizeof(uint));
+	}
+
+	void Mesh::ReleaseGeometry()
+	{
+		if (m_geometryPool != nullptr)
+		{
+			m_geometryPool->Free(m_geometryAllocation);
+			m_geometryPool = nullptr;
+			m_geometryAllocation = {};
+			m_geometryVertexMemory.Set(0, 0);
+			m_geometryIndexMemory.Set(0, 0);
+		}
+
+		if (m_graphicsId != 0)
+		{
+			glDeleteVertexArrays(1, &m_graphicsId);
+			m_graphicsId = 0;
+		}
+
+		m_vertexBufferIndex = 0;
+		m_vertexBuffers.clear();
+		m_indexBuffer = nullptr;
 	}
 	
 	void Mesh::AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer)
 	{
 		PK_CORE_ASSERT(vertexBuffer->GetLayout().GetElements().size(), "Vertex Buffer has no layout!");
-	
-		// @TODO Refactor to use shared vertex array objects for buffer layouts
+		PK_CORE_ASSERT(m_geometryPool == nullptr, "Cannot add vertex buffers to a pooled mesh!");
+
+		if (m_graphicsId == 0)
+		{
+			glCreateVertexArrays(1, &m_graphicsId);
+		}
+
 		glBindVertexArray(m_graphicsId);
 		GraphicsAPI::SetVertexBuffer(vertexBuffer.get());
 	
@@ -47,6 +101,10 @@ namespace PK::Rendering::Objects
 				case PK_TYPE::FLOAT2:
 				case PK_TYPE::FLOAT3:
 				case PK_TYPE::FLOAT4:
+				case PK_TYPE::HALF2:
+				case PK_TYPE::HALF4:
+				case PK_TYPE::SHORT2:
+				case PK_TYPE::USHORT4:
 				case PK_TYPE::INT:
 				case PK_TYPE::INT2:
 				case PK_TYPE::INT3:
@@ -62,6 +120,21 @@ namespace PK::Rendering::Objects
 					++m_vertexBufferIndex;
 					break;
 				}
+				// Read as integers by the shader, packed data is decoded there.
+				case PK_TYPE::UINT:
+				case PK_TYPE::UINT2:
+				case PK_TYPE::UINT3:
+				case PK_TYPE::UINT4:
+				{
+					glEnableVertexAttribArray(m_vertexBufferIndex);
+					glVertexAttribIPointer(m_vertexBufferIndex,
+						Convert::Components(element.Type),
+						Convert::BaseType(element.Type),
+						layout.GetStride(),
+						(const void*)element.Offset);
+					++m_vertexBufferIndex;
+					break;
+				}
 				case PK_TYPE::FLOAT3X3:
 				case PK_TYPE::FLOAT4X4:
 				{
@@ -91,105 +164,403 @@ namespace PK::Rendering::Objects
 	
 	void Mesh::SetIndexBuffer(const Ref<IndexBuffer>& indexBuffer)
 	{
+		PK_CORE_ASSERT(m_geometryPool == nullptr, "Cannot set the index buffer of a pooled mesh!");
+
+		if (m_graphicsId == 0)
+		{
+			glCreateVertexArrays(1, &m_graphicsId);
+		}
+
 		glBindVertexArray(m_graphicsId);
 		GraphicsAPI::SetIndexBuffer(indexBuffer.get());
 		m_indexBuffer = indexBuffer;
 	}
+
+	uint Mesh::GetIndexCount() const
+	{
+		if (m_geometryPool != nullptr)
+		{
+			return m_geometryPool->GetIndexRange(m_geometryAllocation).count;
+		}
+
+		return m_indexBuffer != nullptr ? m_indexBuffer->GetCount() : 0u;
+	}
+
+	bool Mesh::ReadGeometry(std::vector<Vertex_Full>& vertices, std::vector<uint>& indices) const
+	{
+		if (m_geometryPool == nullptr || !(m_geometryPool->GetLayout() == GetVertexLayout(m_hasCompressedVertices)))
+		{
+			return false;
+		}
+
+		auto vertexCount = m_geometryPool->GetVertexRange(m_geometryAllocation).count;
+		vertices.resize(vertexCount);
+		indices.resize(GetIndexCount());
+		m_geometryPool->ReadIndices(m_geometryAllocation, indices.data());
+
+		if (m_hasCompressedVertices)
+		{
+			std::vector<Vertex_Compressed> compressed(vertexCount);
+			m_geometryPool->ReadVertices(m_geometryAllocation, compressed.data());
+			MeshUtility::DecompressVertices(compressed.data(), vertices.data(), vertexCount, m_quantizationBounds);
+		}
+		else
+		{
+			m_geometryPool->ReadVertices(m_geometryAllocation, vertices.data());
+		}
+
+		return true;
+	}
 	
 	const Structs::IndexRange Mesh::GetSubmeshIndexRange(int submesh) const
 	{
-		if (submesh < 0 || m_indexRanges.empty())
+		if (m_indexRanges.empty() || (submesh < 0 && m_lodCount == 1))
+		{
+			return { 0, GetIndexCount() };
+		}
+	
+		// The ranges of a lod are contiguous, lods are appended after the full detail indices.
+		if (submesh < 0)
 		{
-			return { 0, m_indexBuffer->GetCount() };
+			auto submeshCount = GetSubmeshCount();
+			auto lod = glm::min((uint)(-1 - submesh), m_lodCount - 1);
+			auto& first = m_indexRanges.at(lod * submeshCount);
+			auto& last = m_indexRanges.at(lod * submeshCount + submeshCount - 1);
+			return { first.offset, last.offset + last.count - first.offset };
 		}
 	
-		auto idx = glm::min((uint)submesh, (uint)m_indexRanges.size());
+		auto idx = glm::min((uint)submesh, (uint)m_indexRanges.size() - 1);
 		return m_indexRanges.at(idx);
 	}
 	
+	int Mesh::GetLodSubmesh(int submesh, uint lod) const
+	{
+		lod = glm::min(lod, m_lodCount - 1);
+		return submesh < 0 ? -1 - (int)lod : (int)(lod * GetSubmeshCount()) + submesh;
+	}
+	
+	float Mesh::GetLodError(int submesh, uint lod) const
+	{
+		if (m_lodErrors.empty())
+		{
+			return 0.0f;
+		}
+	
+		auto submeshCount = GetSubmeshCount();
+		lod = glm::min(lod, m_lodCount - 1);
+	
+		if (submesh >= 0)
+		{
+			return m_lodErrors.at(lod * submeshCount + glm::min((uint)submesh, submeshCount - 1));
+		}
+	
+		auto error = 0.0f;
+	
+		for (auto i = 0u; i < submeshCount; ++i)
+		{
+			error = glm::max(error, m_lodErrors.at(lod * submeshCount + i));
+		}
+	
+		return error;
+	}
+	
+	uint Mesh::SelectLod(int submesh, float pixelsPerUnit, float maxPixelError) const
+	{
+		for (auto lod = m_lodCount - 1; lod > 0; --lod)
+		{
+			if (GetLodError(submesh, lod) * pixelsPerUnit <= maxPixelError)
+			{
+				return lod;
+			}
+		}
+	
+		return 0;
+	}
+	
+	const BoundingBox& Mesh::GetSubmeshBounds(int submesh) const
+	{
+		if (m_submeshBounds.empty() || submesh < 0)
+		{
+			return m_localBounds;
+		}
+
+		return m_submeshBounds.at((uint)submesh % (uint)m_submeshBounds.size());
+	}
+
+	const Structs::IndexRange Mesh::GetMeshletRange(int submesh) const
+	{
+		if (m_meshletRanges.empty())
+		{
+			return { 0, 0 };
+		}
+	
+		// Meshlets are built in the same order as the index ranges, the meshlets of a lod are contiguous as well.
+		if (submesh < 0)
+		{
+			auto submeshCount = GetSubmeshCount();
+			auto lod = glm::min((uint)(-1 - submesh), m_lodCount - 1);
+			auto& first = m_meshletRanges.at(lod * submeshCount);
+			auto& last = m_meshletRanges.at(lod * submeshCount + submeshCount - 1);
+			return { first.offset, last.offset + last.count - first.offset };
+		}
+	
+		return m_meshletRanges.at(glm::min((uint)submesh, (uint)m_meshletRanges.size() - 1));
+	}
 }
 
 template<>
 bool PK::Core::AssetImporters::IsValidExtension<PK::Rendering::Objects::Mesh>(const std::filesystem::path& extension) { return extension.compare(".mdl") == 0; }
 
+// Full precision vertices are cached, the compressed layout is chosen against the current budget.
+static void SelectVertexLayout(PK::Core::AssetImporters::ImportData<PK::Rendering::Objects::Mesh>& data)
+{
+	using namespace PK::Rendering;
+
+	auto error = MeshUtility::GetCompressionError(data.vertexData, (uint)data.vertexCount, data.localBounds);
+
+	if (!error.IsWithin(MeshUtility::VertexCompressionBudget))
+	{
+		return;
+	}
+
+	data.compressedVertices.resize(data.vertexCount);
+	MeshUtility::CompressVertices(data.vertexData, data.compressedVertices.data(), (uint)data.vertexCount, data.localBounds);
+	data.isCompressed = true;
+}
+
+// Lods are simplified from the full detail triangles of each submesh & appended level by level, which keeps the ranges of a level contiguous.
+static void GenerateLods(PK::Core::AssetImporters::ImportData<PK::Rendering::Objects::Mesh>& data, uint stride, uint vcount)
+{
+	using namespace PK::Rendering;
+
+	// A level that removes less of the previous level's triangles ends the chain.
+	const float minLodReduction = 0.1f;
+
+	auto& indices = data.indices;
+	auto submeshCount = (uint)data.submeshes.size();
+	auto size = data.localBounds.GetExtents() * 2.0f;
+	auto maxSize = glm::max(size.x, glm::max(size.y, size.z));
+	auto previousCount = (uint)indices.size();
+	std::vector<uint> lod;
+
+	data.lodErrors.assign(submeshCount, 0.0f);
+	data.lodCount = 1;
+
+	for (auto level = 0u; level < MeshUtility::MaxLodCount - 1; ++level)
+	{
+		auto levelOffset = (uint)indices.size();
+
+		for (auto i = 0u; i < submeshCount; ++i)
+		{
+			auto submesh = data.submeshes.at(i);
+			auto targetCount = (uint)((submesh.count / 3) * MeshUtility::LodTriangleRatios[level]) * 3;
+			auto error = 0.0f;
+			lod.resize(submesh.count);
+
+			auto count = MeshUtility::SimplifyMesh(reinterpret_cast<const float*>(data.vertices.data()), stride, 0, indices.data() + submesh.offset, submesh.count, vcount, targetCount, maxSize * MeshUtility::LodErrorRatios[level], lod.data(), &error);
+			MeshUtility::OptimizeVertexCache(lod.data(), count, vcount);
+
+			data.submeshes.push_back({ (uint)indices.size(), count });
+			data.lodErrors.push_back(glm::max(error, data.lodErrors.at(level * submeshCount + i)));
+			indices.insert(indices.end(), lod.begin(), lod.begin() + count);
+		}
+
+		auto levelCount = (uint)indices.size() - levelOffset;
+
+		if (levelCount > previousCount * (1.0f - minLodReduction))
+		{
+			indices.resize(levelOffset);
+			data.submeshes.resize(submeshCount * data.lodCount);
+			data.lodErrors.resize(submeshCount * data.lodCount);
+			break;
+		}
+
+		previousCount = levelCount;
+		data.lodCount++;
+	}
+}
+
+// Meshlets are built for every range, lods included. Triangles are reordered within their range.
+static void GenerateMeshlets(PK::Core::AssetImporters::ImportData<PK::Rendering::Objects::Mesh>& data, uint stride, uint vcount)
+{
+	using namespace PK::Rendering;
+
+	data.meshlets.clear();
+	data.meshletRanges.clear();
+
+	for (auto& submesh : data.submeshes)
+	{
+		auto first = (uint)data.meshlets.size();
+		auto count = MeshUtility::BuildMeshlets(reinterpret_cast<const float*>(data.vertices.data()), stride, 0, data.indices.data() + submesh.offset, submesh.count, vcount, data.meshlets);
+
+		for (auto i = first; i < first + count; ++i)
+		{
+			data.meshlets.at(i).indexOffset += submesh.offset;
+		}
+
+		data.meshletRanges.push_back({ first, count });
+	}
+}
+
 template<>
-void PK::Core::AssetImporters::Import(const std::string& filepath, Ref<PK::Rendering::Objects::Mesh>& mesh)
+void PK::Core::AssetImporters::Decode(const std::string& filepath, ImportData<PK::Rendering::Objects::Mesh>& data)
 {
-	using namespace PK::Rendering::Objects;
 	using namespace PK::Rendering::Structs;
 
-	if (mesh->m_graphicsId)
+	PK_PROFILE_SCOPE("AssetImporters::Decode<Mesh>");
+
+	// Increment when the decoded output changes.
+	const uint32_t importerVersion = 6;
+	auto cache = AssetCache::Get();
+
+	if (cache != nullptr)
 	{
-		glDeleteVertexArrays(1, &mesh->m_graphicsId);
-	}
+		auto cooked = cache->Open(filepath, importerVersion, 0ull);
 
-	glCreateVertexArrays(1, &mesh->m_graphicsId);
+		if (cooked != nullptr)
+		{
+			size_t submeshCount = 0;
+			size_t lodErrorCount = 0;
+			size_t meshletCount = 0;
+			size_t meshletRangeCount = 0;
+			auto submeshes = cooked->Read<IndexRange>(submeshCount);
+			auto lodErrors = cooked->Read<float>(lodErrorCount);
+			auto lodCount = cooked->ReadValue<uint>();
+			auto meshlets = cooked->Read<Meshlet>(meshletCount);
+			auto meshletRanges = cooked->Read<IndexRange>(meshletRangeCount);
+			auto localBounds = cooked->ReadValue<BoundingBox>();
+			size_t submeshBoundsCount = 0;
+			auto submeshBounds = cooked->Read<BoundingBox>(submeshBoundsCount);
+			data.vertexData = cooked->Read<Vertex_Full>(data.vertexCount);
+			data.indexData = cooked->Read<uint>(data.indexCount);
 
-	mesh->m_vertexBufferIndex = 0;
-	mesh->m_vertexBuffers.clear();
-	mesh->m_indexBuffer = nullptr;
-	mesh->m_indexRanges.clear();
+			if (cooked->IsValid())
+			{
+				data.submeshes.assign(submeshes, submeshes + submeshCount);
+				data.lodErrors.assign(lodErrors, lodErrors + lodErrorCount);
+				data.lodCount = lodCount;
+				data.meshlets.assign(meshlets, meshlets + meshletCount);
+				data.meshletRanges.assign(meshletRanges, meshletRanges + meshletRangeCount);
+				data.localBounds = localBounds;
+				data.submeshBounds.assign(submeshBounds, submeshBounds + submeshBoundsCount);
+				data.cookedData = std::move(cooked);
+				SelectVertexLayout(data);
+				return;
+			}
+		}
+	}
+
+	// Captured before reading so that the stored blob never describes newer contents than it was decoded from.
+	AssetCacheSource cacheSource;
+	auto isCacheable = cache != nullptr && cache->Capture(filepath, importerVersion, 0ull, {}, cacheSource);
 
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
+	PK::Rendering::ObjReader::ObjData obj;
 	std::string err;
-	
-	bool success = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filepath.c_str(), Utilities::String::ReadDirectory(filepath).c_str(), true);
 
-	PK_CORE_ASSERT(err.empty(), err.c_str());
-	PK_CORE_ASSERT(!attrib.vertices.empty(), "Mesh doesn't contain vertices");
-	PK_CORE_ASSERT(!attrib.normals.empty(), "Mesh doesn't contain normals");
-	PK_CORE_ASSERT(!attrib.texcoords.empty(), "Mesh doesn't contain uvs");
-	PK_CORE_ASSERT(success, "Failed to load .obj");
+	bool success = PK::Rendering::ObjReader::Read(filepath, PK::Core::Application::GetService<PK::Core::JobSystem>(), obj, err);
 
-	uint indexCount = 0;
-	std::vector<uint> indices;
-	std::vector<PK::Rendering::Structs::IndexRange> submeshes;
-	std::vector<PK::Rendering::Structs::Vertex_Full> vertices;
+	PK_CORE_ASSERT(success, "Failed to load .obj: %s", err.c_str());
+	PK_CORE_ASSERT(obj.positionCount > 0, "Mesh doesn't contain vertices");
+	PK_CORE_ASSERT(obj.normalCount > 0, "Mesh doesn't contain normals");
+	PK_CORE_ASSERT(obj.texcoordCount > 0, "Mesh doesn't contain uvs");
+
+	auto& indices = data.indices;
+	auto& submeshes = data.submeshes;
+	auto& vertices = data.vertices;
 	float3 minpos =  PK_FLOAT3_ONE * std::numeric_limits<float>().max();
 	float3 maxpos = -PK_FLOAT3_ONE * std::numeric_limits<float>().max();
 
-	auto invertices = attrib.vertices.data();
-	auto innormals = attrib.normals.data();
-	auto inuvs = attrib.texcoords.data();
-
-	auto index = 0;
+	indices = std::move(obj.indices);
+	vertices = std::move(obj.vertices);
+	submeshes = std::move(obj.submeshes);
 
-	for (size_t i = 0; i < shapes.size(); ++i) 
+	for (auto& vertex : vertices)
 	{
-		auto& tris = shapes.at(i).mesh.indices;
-		auto tcount = (uint)tris.size();
+		maxpos = glm::max(vertex.position, maxpos);
+		minpos = glm::min(vertex.position, minpos);
+	}
 
-		submeshes.push_back({ indexCount, tcount });
+	// The reader only merges corners with identical attribute indices, weld identical corners into shared vertices before & after tangent generation.
+	const uint stride = sizeof(Vertex_Full) / 4;
+	auto icount = (uint)indices.size();
+	auto vcount = PK::Rendering::MeshUtility::WeldVertices(reinterpret_cast<float*>(vertices.data()), stride, indices.data(), (uint)vertices.size(), icount);
 
-		for (uint j = 0; j < tcount; ++j)
-		{
-			auto& tri = tris.at(j);
+	std::vector<float4> tangents(icount);
+	PK::Rendering::MeshUtility::CalculateTangents(PK::Core::Application::GetService<PK::Core::JobSystem>(), vertices.data(), stride, 0, 3, 10, indices.data(), tangents.data(), vcount, icount);
+
+	vertices.resize(icount);
+	vcount = PK::Rendering::MeshUtility::WeldTangents(reinterpret_cast<float*>(vertices.data()), stride, 6, tangents.data(), indices.data(), vcount, icount);
 
-			indices.push_back(index++);
+	// Triangles are only reordered within their submesh, vertices are shared by all of them.
+	for (auto& submesh : submeshes)
+	{
+		PK::Rendering::MeshUtility::OptimizeVertexCache(indices.data() + submesh.offset, submesh.count, vcount);
+		PK::Rendering::MeshUtility::OptimizeOverdraw(reinterpret_cast<float*>(vertices.data()), stride, 0, indices.data() + submesh.offset, submesh.count, vcount);
+	}
 
-			PK::Rendering::Structs::Vertex_Full v;
-			v.position = *reinterpret_cast<float3*>(invertices + tri.vertex_index * 3);
-			v.normal = *reinterpret_cast<float3*>(innormals + tri.normal_index * 3);
-			v.tangent = PK_FLOAT4_ZERO;
-			v.texcoord = *reinterpret_cast<float2*>(inuvs + tri.texcoord_index * 2);
-			vertices.push_back(v);
+	data.localBounds = PK::Math::Functions::CreateBoundsMinMax(minpos, maxpos);
+	GenerateLods(data, stride, vcount);
+	GenerateMeshlets(data, stride, vcount);
+	icount = (uint)indices.size();
 
-			maxpos = glm::max(v.position, maxpos);
-			minpos = glm::min(v.position, minpos);
-		}
+	vcount = PK::Rendering::MeshUtility::OptimizeVertexFetch(reinterpret_cast<float*>(vertices.data()), stride, indices.data(), vcount, icount);
+	vertices.resize(vcount);
+	vertices.shrink_to_fit();
 
-		indexCount += tcount;
+	data.submeshBounds.resize(submeshes.size() / data.lodCount);
+	PK::Rendering::MeshUtility::CalculateSubmeshBounds(reinterpret_cast<const float*>(vertices.data()), stride, 0, indices.data(), submeshes.data(), (uint)data.submeshBounds.size(), data.submeshBounds.data());
+
+	data.vertexData = vertices.data();
+	data.vertexCount = vertices.size();
+	data.indexData = indices.data();
+	data.indexCount = indices.size();
+
+	if (isCacheable)
+	{
+		AssetCacheWriter writer;
+		writer.Write(submeshes.data(), submeshes.size());
+		writer.Write(data.lodErrors.data(), data.lodErrors.size());
+		writer.WriteValue(data.lodCount);
+		writer.Write(data.meshlets.data(), data.meshlets.size());
+		writer.Write(data.meshletRanges.data(), data.meshletRanges.size());
+		writer.WriteValue(data.localBounds);
+		writer.Write(data.submeshBounds.data(), data.submeshBounds.size());
+		writer.Write(vertices.data(), vertices.size());
+		writer.Write(indices.data(), indices.size());
+		cache->Store(filepath, cacheSource, writer);
 	}
 
+	SelectVertexLayout(data);
+}
 
-	BufferLayout layout = { {PK_TYPE::FLOAT3, "POSITION"}, {PK_TYPE::FLOAT3, "NORMAL"}, {PK_TYPE::FLOAT4, "TANGENT"}, {PK_TYPE::FLOAT2, "TEXCOORD0"} };
+template<>
+void PK::Core::AssetImporters::Commit(ImportData<PK::Rendering::Objects::Mesh>& data, Ref<PK::Rendering::Objects::Mesh>& mesh)
+{
+	using namespace PK::Rendering::Objects;
+	using namespace PK::Rendering::Structs;
+
+	PK_PROFILE_SCOPE("AssetImporters::Commit<Mesh>");
+
+	mesh->m_indexRanges.clear();
+	mesh->SetLocalBounds(data.localBounds);
+	mesh->m_quantizationBounds = data.localBounds;
+	mesh->m_hasCompressedVertices = data.isCompressed;
 
-	PK::Rendering::MeshUtility::CalculateTangents(reinterpret_cast<float*>(vertices.data()), layout.GetStride() / 4, 0, 3, 6, 10, indices.data(), (uint)vertices.size(), (uint)indices.size());
+	// Reloads release the previous range before allocating, the pool reuses it when the mesh didn't grow.
+	const void* vertices = data.isCompressed ? (const void*)data.compressedVertices.data() : (const void*)data.vertexData;
+	mesh->SetPooledGeometry(Mesh::GetVertexLayout(data.isCompressed), vertices, (uint)data.vertexCount, data.indexData, (uint)data.indexCount);
+	mesh->SetSubMeshes(data.submeshes);
+	mesh->m_lodErrors = data.lodErrors;
+	mesh->m_lodCount = data.lodCount;
+	mesh->m_meshlets = data.meshlets;
+	mesh->m_meshletRanges = data.meshletRanges;
+	mesh->m_submeshBounds = data.submeshBounds;
+}
 
-	mesh->SetLocalBounds(PK::Math::Functions::CreateBoundsMinMax(minpos, maxpos));
-	mesh->AddVertexBuffer(CreateRef<VertexBuffer>(vertices.data(), vertices.size(), layout, true));
-	mesh->SetIndexBuffer(CreateRef<IndexBuffer>(indices.data(), (uint)indices.size(), true));
-	mesh->SetSubMeshes(submeshes);
+template<>
+void PK::Core::AssetImporters::Import(const std::string& filepath, Ref<PK::Rendering::Objects::Mesh>& mesh)
+{
+	ImportData<PK::Rendering::Objects::Mesh> data;
+	Decode(filepath, data);
+	Commit(data, mesh);
 }
\ No newline at end of file
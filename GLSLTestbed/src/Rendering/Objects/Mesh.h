@@ -2,9 +2,49 @@
 #include "PreCompiledHeader.h"
 #include "Utilities/Ref.h"
 #include "Core/AssetDataBase.h"
+#include "Core/AssetCache.h"
 #include "Rendering/Objects/Buffer.h"
+#include "Rendering/Objects/GeometryPool.h"
 #include "Rendering/Structs/StructsCommon.h"
 
+namespace PK::Rendering::Objects
+{
+	class Mesh;
+}
+
+namespace PK::Core::AssetImporters
+{
+	template<>
+	struct ImportData<Rendering::Objects::Mesh>
+	{
+		static constexpr bool IsDecodable = true;
+		std::vector<Rendering::Structs::Vertex_Full> vertices;
+		// Filled when the mesh fits the compression precision budget. Positions are quantized relative to localBounds.
+		std::vector<Rendering::Structs::Vertex_Compressed> compressedVertices;
+		bool isCompressed = false;
+		std::vector<uint> indices;
+		// Level major, the ranges of all submeshes for lod 0 are followed by those for lod 1 etc.
+		std::vector<Rendering::Structs::IndexRange> submeshes;
+		// Object space simplification error of each range in submeshes.
+		std::vector<float> lodErrors;
+		uint lodCount = 1;
+		std::vector<Rendering::Structs::Meshlet> meshlets;
+		// Range in meshlets for each range in submeshes.
+		std::vector<Rendering::Structs::IndexRange> meshletRanges;
+		Math::BoundingBox localBounds;
+		// Object space bounds of each full detail submesh, the lods of a submesh share them.
+		std::vector<Math::BoundingBox> submeshBounds;
+		// Point either to the vectors above or into the mapped cache blob, which is then uploaded from directly.
+		Scope<AssetCacheReader> cookedData;
+		const Rendering::Structs::Vertex_Full* vertexData = nullptr;
+		const uint* indexData = nullptr;
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+
+		inline size_t GetSize() const { return vertexCount * (isCompressed ? sizeof(Rendering::Structs::Vertex_Compressed) : sizeof(Rendering::Structs::Vertex_Full)) + indexCount * sizeof(uint); }
+	};
+}
+
 namespace PK::Rendering::Objects
 {
 	using namespace Utilities;
@@ -12,30 +52,83 @@ namespace PK::Rendering::Objects
 
 	class Mesh : public GraphicsObject, public Asset
 	{
-		friend void AssetImporters::Import(const std::string& filepath, Ref<Mesh>& mesh);
+		friend void AssetImporters::Commit(AssetImporters::ImportData<Mesh>& data, Ref<Mesh>& mesh);
 	
 		public:
 			Mesh();
 			Mesh(const Ref<VertexBuffer>& vertexBuffer, const Ref<IndexBuffer>& indexBuffer);
+			// Allocates the geometry from the pool of the layout.
+			Mesh(const BufferLayout& layout, const void* vertices, uint vertexCount, const uint* indices, uint indexCount);
 			~Mesh();
 		
 			void AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer);
 			void SetIndexBuffer(const Ref<IndexBuffer>& indexBuffer);
-			inline void SetSubMeshes(const std::initializer_list<IndexRange>& indexRanges) { m_indexRanges = indexRanges; }
-			inline void SetSubMeshes(const std::vector<IndexRange>& indexRanges) { m_indexRanges = indexRanges; }
+			inline void SetSubMeshes(const std::initializer_list<IndexRange>& indexRanges) { m_indexRanges = indexRanges; m_lodErrors.clear(); m_lodCount = 1; m_meshlets.clear(); m_meshletRanges.clear(); m_submeshBounds.clear(); }
+			inline void SetSubMeshes(const std::vector<IndexRange>& indexRanges) { m_indexRanges = indexRanges; m_lodErrors.clear(); m_lodCount = 1; m_meshlets.clear(); m_meshletRanges.clear(); m_submeshBounds.clear(); }
 		
 			inline const std::vector<Ref<VertexBuffer>>& GetVertexBuffers() const { return m_vertexBuffers; }
 			inline const Ref<IndexBuffer>& GetIndexBuffer() const { return m_indexBuffer; }
+			inline const Ref<GeometryPool>& GetGeometryPool() const { return m_geometryPool; }
+			// Vertex array to draw with, pooled meshes share the one of their pool.
+			inline GraphicsID GetVertexArrayID() const { return m_geometryPool != nullptr ? m_geometryPool->GetGraphicsID() : m_graphicsId; }
+			// Unique for every mesh, unlike the vertex array id.
+			inline uint GetMeshID() const { return m_meshId; }
+			// Position of the mesh in its pool, added to the submesh ranges when drawing. Zero for meshes with their own buffers.
+			inline int GetBaseVertex() const { return m_geometryPool != nullptr ? (int)m_geometryPool->GetVertexRange(m_geometryAllocation).offset : 0; }
+			inline uint GetBaseIndex() const { return m_geometryPool != nullptr ? m_geometryPool->GetIndexRange(m_geometryAllocation).offset : 0u; }
+			uint GetIndexCount() const;
+			// Copies the geometry of a pooled mesh that uses one of the layouts from GetVertexLayout, compressed vertices are decoded. Returns false for other meshes.
+			bool ReadGeometry(std::vector<Vertex_Full>& vertices, std::vector<uint>& indices) const;
+			// Submeshes past GetSubmeshCount address lods & negative ones the whole mesh at a lod, see GetLodSubmesh.
 			const IndexRange GetSubmeshIndexRange(int submesh) const;
-			inline const uint GetSubmeshCount() const { return glm::max(1, (int)m_indexRanges.size()); }
+			inline const IndexRange GetSubmeshIndexRange(int submesh, uint lod) const { return GetSubmeshIndexRange(GetLodSubmesh(submesh, lod)); }
+			inline const uint GetSubmeshCount() const { return glm::max(1, (int)(m_indexRanges.size() / m_lodCount)); }
+			inline const uint GetLodCount() const { return m_lodCount; }
+			// Submesh index to draw a lod of a submesh with, -1 for the whole mesh.
+			int GetLodSubmesh(int submesh, uint lod) const;
+			// Object space distance of a lod from the full detail surface, -1 for the largest error of all submeshes.
+			float GetLodError(int submesh, uint lod) const;
+			// Coarsest lod whose error covers at most maxPixelError pixels when one object space unit covers pixelsPerUnit pixels.
+			uint SelectLod(int submesh, float pixelsPerUnit, float maxPixelError) const;
+			// Range in GetMeshlets for a submesh index as accepted by GetSubmeshIndexRange. Empty for meshes without meshlets.
+			const IndexRange GetMeshletRange(int submesh) const;
+			inline const Meshlet* GetMeshlets() const { return m_meshlets.data(); }
 			inline const BoundingBox& GetLocalBounds() const { return m_localBounds; }
 			inline void SetLocalBounds(const BoundingBox& bounds) { m_localBounds = bounds; }
+			// Local bounds of a submesh index as accepted by GetSubmeshIndexRange. Meshes without submesh bounds return the local bounds.
+			const BoundingBox& GetSubmeshBounds(int submesh) const;
+			// One per submesh, empty when the local bounds are used for all of them.
+			inline const std::vector<BoundingBox>& GetSubmeshBounds() const { return m_submeshBounds; }
+			inline void SetSubmeshBounds(const std::vector<BoundingBox>& bounds) { m_submeshBounds = bounds; }
+			inline bool HasCompressedVertices() const { return m_hasCompressedVertices; }
+			inline const BoundingBox& GetQuantizationBounds() const { return m_quantizationBounds; }
+			// Ranges are given per submesh index as accepted by GetSubmeshIndexRange.
+			inline void SetMeshlets(const std::vector<Meshlet>& meshlets, const std::vector<IndexRange>& meshletRanges) { m_meshlets = meshlets; m_meshletRanges = meshletRanges; }
+
+			// Layout of Vertex_Compressed or Vertex_Full, meshes that use them share a pool with the imported meshes.
+			static const BufferLayout& GetVertexLayout(bool compressed);
 	
 		private:
+			void SetPooledGeometry(const BufferLayout& layout, const void* vertices, uint vertexCount, const uint* indices, uint indexCount);
+			void ReleaseGeometry();
+
 			uint32_t m_vertexBufferIndex = 0;
 			std::vector<Ref<VertexBuffer>> m_vertexBuffers;
 			Ref<IndexBuffer> m_indexBuffer;
+			Ref<GeometryPool> m_geometryPool;
+			GeometryPool::Allocation m_geometryAllocation;
+			// Pooled ranges are charged to the owner of the mesh instead of the pool.
+			Core::MemoryAllocation m_geometryVertexMemory { Core::MemoryResource::VertexBuffer };
+			Core::MemoryAllocation m_geometryIndexMemory { Core::MemoryResource::IndexBuffer };
+			uint m_meshId = 0;
 			std::vector<IndexRange> m_indexRanges;
+			std::vector<float> m_lodErrors;
+			uint m_lodCount = 1;
+			std::vector<Meshlet> m_meshlets;
+			std::vector<IndexRange> m_meshletRanges;
 			BoundingBox m_localBounds;
+			std::vector<BoundingBox> m_submeshBounds;
+			BoundingBox m_quantizationBounds;
+			bool m_hasCompressedVertices = false;
 	};
 }
\ No newline at end of file
@@ -170,5 +170,6 @@ namespace PK::Rendering::Objects
 	
 		SetDescriptor(descriptor);
 		CreateTextureStorage(m_graphicsId, descriptor);
+		m_memory.Set(0, GetStorageSize(descriptor));
 	}
 }
\ No newline at end of file
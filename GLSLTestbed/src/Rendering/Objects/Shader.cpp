@@ -1,9 +1,16 @@
 ﻿#include "PrecompiledHeader.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Rendering/ShaderDirectives.h"
+#include "Rendering/ShaderVariantManifest.h"
 #include "Rendering/Objects/Shader.h"
 #include "Utilities/StringHashID.h"
 #include "Utilities/StringUtilities.h"
 #include "Utilities/Log.h"
+#include "Core/Profiler.h"
+#include "Core/AssetCache.h"
+#include "Core/Application.h"
+#include "Core/JobSystem.h"
+#include "Core/Time.h"
 #include <hlslmath.h>
 
 namespace PK::Rendering::Objects
@@ -34,54 +41,32 @@ namespace PK::Rendering::Objects
 		}
 	}
 
-	void ShaderVariantMap::ListVariants()
+	std::string ShaderVariantMap::GetVariantKeywords(uint32_t index) const
 	{
-		std::vector<std::vector<std::string>> keywordlist;
+		std::vector<std::pair<uint8_t, std::string>> selected;
 
 		for (auto& kv : keywords)
 		{
-			auto keyword = StringHashID::IDToString(kv.first);
-			auto index0 = (kv.second >> 4) & 0xF;
-			auto index1 = kv.second & 0xF;
+			auto directive = (kv.second >> 4) & 0xF;
+			auto stride = directives[directive] & 0xFFFFFF;
+			auto size = (directive + 1u < directivecount ? directives[directive + 1] & 0xFFFFFF : variantcount) / stride;
 
-			if (keywordlist.size() <= index0)
+			if ((index / stride) % size == (kv.second & 0xFu))
 			{
-				keywordlist.resize(index0 + 1);
+				selected.push_back({ kv.second, StringHashID::IDToString(kv.first) });
 			}
-
-			if (keywordlist.at(index0).size() <= index1)
-			{
-				keywordlist.at(index0).resize(index1 + 1);
-			}
-
-			keywordlist.at(index0)[index1] = keyword;
 		}
 
-		PK::Utilities::Debug::InsertNewLine();
+		std::sort(selected.begin(), selected.end());
+		std::string defines = "";
 
-		for (auto j = 0u; j < variantcount; ++j)
+		for (auto& keyword : selected)
 		{
-			std::string defines = "";
-			auto index = j;
-
-			for (auto i = 0; i < keywordlist.size(); ++i)
-			{
-				auto& declares = keywordlist.at(i);
-				auto& keyword = declares.at(index % declares.size());
-
-				if (!keyword.empty())
-				{
-					defines.append(keyword);
-					defines.append(" ");
-				}
-
-				index /= (uint32_t)declares.size();
-			}
-
-			PK_CORE_LOG(defines.c_str());
+			defines.append(keyword.second);
+			defines.append(" ");
 		}
 
-		PK::Utilities::Debug::InsertNewLine();
+		return defines;
 	}
 	
 	bool ShaderVariantMap::SupportsKeywords(const uint32_t* hashIds, const uint32_t count) const
@@ -108,76 +93,220 @@ namespace PK::Rendering::Objects
 	
 		return idx;
 	}
+
+	uint32_t ShaderVariantMap::GetFixedDirectiveMask() const
+	{
+		uint32_t mask = 0u;
+
+		for (auto& kv : keywords)
+		{
+			if ((kv.second & 0xFu) == 0u)
+			{
+				mask |= 1u << (kv.second >> 4);
+			}
+		}
+
+		for (auto keyword : EngineKeywords)
+		{
+			auto kv = keywords.find(StringHashID::StringToID(keyword));
+
+			if (kv != keywords.end())
+			{
+				mask |= 1u << (kv->second >> 4);
+			}
+		}
+
+		return mask;
+	}
+
+	uint32_t ShaderVariantMap::GetFallbackIndex(uint32_t index, uint32_t fixedDirectiveMask) const
+	{
+		uint32_t idx = 0;
+
+		for (uint32_t i = 0; i < directivecount; ++i)
+		{
+			if (fixedDirectiveMask & (1u << i))
+			{
+				auto stride = directives[i] & 0xFFFFFF;
+				auto size = (i + 1u < directivecount ? directives[i + 1] & 0xFFFFFF : variantcount) / stride;
+				idx += stride * ((index / stride) % size);
+			}
+		}
+
+		return idx;
+	}
 	
 	
 	ShaderVariant::ShaderVariant(GraphicsID graphicsId, const std::map<uint32_t, ShaderPropertyInfo>& properties)
 	{
 		m_graphicsId = graphicsId;
-		m_properties = properties;
+		m_propertyHashes.reserve(properties.size());
+		m_propertyInfos.reserve(properties.size());
+
+		// Map iteration is ordered by hash.
+		for (auto& kv : properties)
+		{
+			m_propertyHashes.push_back(kv.first);
+			m_propertyInfos.push_back(kv.second);
+		}
+
+		// The driver doesn't expose program memory, the binary size is the closest estimate.
+		GLint binaryLength = 0;
+		glGetProgramiv(m_graphicsId, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		m_memory.Set(m_propertyHashes.size() * (sizeof(uint32_t) + sizeof(ShaderPropertyInfo)), (size_t)binaryLength);
 	}
 	
 	ShaderVariant::~ShaderVariant() { glDeleteProgram(m_graphicsId); }
 	
 	void ShaderVariant::ListProperties()
 	{
-		for (auto& i : m_properties)
+		for (auto i = 0u; i < m_propertyHashes.size(); ++i)
 		{
-			PK_CORE_LOG("%s : %s : %i", Convert::ToString(i.second.type).c_str(), StringHashID::IDToString(i.first).c_str(), i.second.location);
+			auto& info = m_propertyInfos.at(i);
+			PK_CORE_LOG("%s : %s : %i", Convert::ToString(info.type).c_str(), StringHashID::IDToString(m_propertyHashes.at(i)).c_str(), info.location);
 		}
 	}
 	
 	void ShaderVariant::SetPropertyBlock(const ShaderPropertyBlock& propertyBlock)
 	{
+		auto& plan = GetBindingPlan(propertyBlock);
+		auto values = propertyBlock.GetData();
+
+		for (auto& binding : plan.bindings)
+		{
+			binding.upload(binding.location, binding.count, values + binding.offset);
+		}
+	}
+
+	const ShaderPropertyInfo* ShaderVariant::FindProperty(uint32_t hashId) const
+	{
+		auto iterator = std::lower_bound(m_propertyHashes.begin(), m_propertyHashes.end(), hashId);
+
+		if (iterator == m_propertyHashes.end() || *iterator != hashId)
+		{
+			return nullptr;
+		}
+
+		return &m_propertyInfos.at(iterator - m_propertyHashes.begin());
+	}
+
+	const ShaderVariant::BindingPlan& ShaderVariant::GetBindingPlan(const ShaderPropertyBlock& propertyBlock)
+	{
+		auto layoutVersion = propertyBlock.GetLayoutVersion();
+		auto cached = m_bindingPlans.find(layoutVersion);
+
+		if (cached != m_bindingPlans.end())
+		{
+			cached->second.lastUse = ++m_bindingPlanUseCount;
+			return cached->second;
+		}
+
+		if (m_bindingPlans.size() >= MaxBindingPlans)
+		{
+			m_bindingPlans.erase(std::min_element(m_bindingPlans.begin(), m_bindingPlans.end(), [](const std::pair<const uint, BindingPlan>& a, const std::pair<const uint, BindingPlan>& b)
+			{
+				return a.second.lastUse < b.second.lastUse;
+			}));
+		}
+
+		auto& plan = m_bindingPlans[layoutVersion];
+		plan.lastUse = ++m_bindingPlanUseCount;
+
 		for (auto& i : propertyBlock)
 		{
-			auto& hashId = i.first;
-	
-			if (m_properties.count(hashId) < 1)
+			auto prop = FindProperty(i.first);
+
+			if (prop == nullptr)
 			{
 				continue;
 			}
-	
-			const auto& prop = m_properties.at(hashId);
 
 			auto& info = i.second;
-			uint count = info.size / Convert::Size(info.type);
-			auto components = Convert::Components(info.type);
-	
-			switch (info.type)
-			{
-				case PK_TYPE::FLOAT: glUniform1fv(prop.location, count, propertyBlock.GetElementPtr<float>(info)); break;
-				case PK_TYPE::FLOAT2: glUniform2fv(prop.location, count, propertyBlock.GetElementPtr<float>(info)); break;
-				case PK_TYPE::FLOAT3: glUniform3fv(prop.location, count, propertyBlock.GetElementPtr<float>(info)); break;
-				case PK_TYPE::FLOAT4: glUniform4fv(prop.location, count, propertyBlock.GetElementPtr<float>(info)); break;
-				case PK_TYPE::FLOAT2X2: glUniformMatrix2fv(prop.location, count, GL_FALSE, propertyBlock.GetElementPtr<float>(info)); break;
-				case PK_TYPE::FLOAT3X3: glUniformMatrix3fv(prop.location, count, GL_FALSE, propertyBlock.GetElementPtr<float>(info)); break;
-				case PK_TYPE::FLOAT4X4: glUniformMatrix4fv(prop.location, count, GL_FALSE, propertyBlock.GetElementPtr<float>(info)); break;
-				case PK_TYPE::INT:  glUniform1iv(prop.location, count, propertyBlock.GetElementPtr<int>(info)); break;
-				case PK_TYPE::INT2: glUniform2iv(prop.location, count, propertyBlock.GetElementPtr<int>(info)); break;
-				case PK_TYPE::INT3: glUniform3iv(prop.location, count, propertyBlock.GetElementPtr<int>(info)); break;
-				case PK_TYPE::INT4: glUniform4iv(prop.location, count, propertyBlock.GetElementPtr<int>(info)); break;
-				case PK_TYPE::UINT:  glUniform1uiv(prop.location, count, propertyBlock.GetElementPtr<uint>(info)); break;
-				case PK_TYPE::UINT2: glUniform2uiv(prop.location, count, propertyBlock.GetElementPtr<uint>(info)); break;
-				case PK_TYPE::UINT3: glUniform3uiv(prop.location, count, propertyBlock.GetElementPtr<uint>(info)); break;
-				case PK_TYPE::UINT4: glUniform4uiv(prop.location, count, propertyBlock.GetElementPtr<uint>(info)); break;
-				case PK_TYPE::HANDLE: glUniformHandleui64vARB(prop.location, count, propertyBlock.GetElementPtr<ulong>(info)); break;
-				case PK_TYPE::TEXTURE: GraphicsAPI::BindTextures(prop.location, propertyBlock.GetElementPtr<GraphicsID>(info), count); break;
-				case PK_TYPE::IMAGE_PARAMS: GraphicsAPI::BindImages(prop.location, propertyBlock.GetElementPtr<ImageBindDescriptor>(info), count); break;
-				case PK_TYPE::CONSTANT_BUFFER: GraphicsAPI::BindBuffers(PK_TYPE::CONSTANT_BUFFER, prop.location, propertyBlock.GetElementPtr<GraphicsID>(info), count); break;
-				case PK_TYPE::COMPUTE_BUFFER: GraphicsAPI::BindBuffers(PK_TYPE::COMPUTE_BUFFER, prop.location, propertyBlock.GetElementPtr<GraphicsID>(info), count); break;
-				default: PK_CORE_ERROR("Invalid Shader Property Type");
-			}
+			// Validates the offset once per layout instead of on every upload.
+			propertyBlock.GetElementPtr<char>(info);
+			plan.bindings.push_back({ info.offset, prop->location, (ushort)(info.size / Convert::Size(info.type)), GetUploadFunction(info.type) });
 		}
+
+		return plan;
+	}
+
+	ShaderVariant::UploadFunction ShaderVariant::GetUploadFunction(PK_TYPE type)
+	{
+		switch (type)
+		{
+			case PK_TYPE::FLOAT: return [](ushort location, uint count, const char* values) { glUniform1fv(location, count, reinterpret_cast<const float*>(values)); };
+			case PK_TYPE::FLOAT2: return [](ushort location, uint count, const char* values) { glUniform2fv(location, count, reinterpret_cast<const float*>(values)); };
+			case PK_TYPE::FLOAT3: return [](ushort location, uint count, const char* values) { glUniform3fv(location, count, reinterpret_cast<const float*>(values)); };
+			case PK_TYPE::FLOAT4: return [](ushort location, uint count, const char* values) { glUniform4fv(location, count, reinterpret_cast<const float*>(values)); };
+			case PK_TYPE::FLOAT2X2: return [](ushort location, uint count, const char* values) { glUniformMatrix2fv(location, count, GL_FALSE, reinterpret_cast<const float*>(values)); };
+			case PK_TYPE::FLOAT3X3: return [](ushort location, uint count, const char* values) { glUniformMatrix3fv(location, count, GL_FALSE, reinterpret_cast<const float*>(values)); };
+			case PK_TYPE::FLOAT4X4: return [](ushort location, uint count, const char* values) { glUniformMatrix4fv(location, count, GL_FALSE, reinterpret_cast<const float*>(values)); };
+			case PK_TYPE::INT: return [](ushort location, uint count, const char* values) { glUniform1iv(location, count, reinterpret_cast<const int*>(values)); };
+			case PK_TYPE::INT2: return [](ushort location, uint count, const char* values) { glUniform2iv(location, count, reinterpret_cast<const int*>(values)); };
+			case PK_TYPE::INT3: return [](ushort location, uint count, const char* values) { glUniform3iv(location, count, reinterpret_cast<const int*>(values)); };
+			case PK_TYPE::INT4: return [](ushort location, uint count, const char* values) { glUniform4iv(location, count, reinterpret_cast<const int*>(values)); };
+			case PK_TYPE::UINT: return [](ushort location, uint count, const char* values) { glUniform1uiv(location, count, reinterpret_cast<const uint*>(values)); };
+			case PK_TYPE::UINT2: return [](ushort location, uint count, const char* values) { glUniform2uiv(location, count, reinterpret_cast<const uint*>(values)); };
+			case PK_TYPE::UINT3: return [](ushort location, uint count, const char* values) { glUniform3uiv(location, count, reinterpret_cast<const uint*>(values)); };
+			case PK_TYPE::UINT4: return [](ushort location, uint count, const char* values) { glUniform4uiv(location, count, reinterpret_cast<const uint*>(values)); };
+			case PK_TYPE::HANDLE: return [](ushort location, uint count, const char* values) { glUniformHandleui64vARB(location, count, reinterpret_cast<const ulong*>(values)); };
+			case PK_TYPE::TEXTURE: return [](ushort location, uint count, const char* values) { GraphicsAPI::BindTextures(location, reinterpret_cast<const GraphicsID*>(values), count); };
+			case PK_TYPE::IMAGE_PARAMS: return [](ushort location, uint count, const char* values) { GraphicsAPI::BindImages(location, reinterpret_cast<const ImageBindDescriptor*>(values), count); };
+			case PK_TYPE::CONSTANT_BUFFER: return [](ushort location, uint count, const char* values) { GraphicsAPI::BindBuffers(PK_TYPE::CONSTANT_BUFFER, location, reinterpret_cast<const GraphicsID*>(values), count); };
+			case PK_TYPE::COMPUTE_BUFFER: return [](ushort location, uint count, const char* values) { GraphicsAPI::BindBuffers(PK_TYPE::COMPUTE_BUFFER, location, reinterpret_cast<const GraphicsID*>(values), count); };
+			default: PK_CORE_ERROR("Invalid Shader Property Type");
+		}
+
+		return nullptr;
 	}
 	
 	
-	Shader::~Shader() { m_variants.clear(); }
+	Shader::~Shader() { ReleaseVariants(); }
 	
 	const Ref<ShaderVariant>& Shader::GetActiveVariant()
 	{
-		m_activeIndex = m_variantMap.GetActiveIndex();
+		auto index = m_variantMap.GetActiveIndex();
+		auto isMiss = m_isStripped && m_variants.at(index) == nullptr && m_pendingVariants.at(index) == nullptr;
+
+		if (!m_requestedVariants.at(index))
+		{
+			m_requestedVariants.at(index) = true;
+			auto manifest = ShaderVariantManifest::Get();
+
+			if (manifest != nullptr)
+			{
+				manifest->RecordVariant(GetFileName(), m_variantMap, index, isMiss);
+			}
+		}
+
+		// Dispatching a different kernel would write wrong results, compute shaders wait for their variant even when it was stripped.
+		if (m_variants.at(index) == nullptr && (!isMiss || m_isCompute))
+		{
+			RequestVariant(index, m_isCompute);
+		}
+
+		if (m_variants.at(index) == nullptr)
+		{
+			// Variants that differ in vertex input, instancing or pass would draw wrong results. The fallback serves every shading variant of it, so it is waited on once.
+			// Stripped misses only differ from a compiled fallback in shading keywords, otherwise the missed variant is compiled instead of an unlisted fallback.
+			auto fallback = m_variantMap.GetFallbackIndex(index, m_fixedDirectiveMask);
+
+			if (m_variants.at(fallback) == nullptr)
+			{
+				RequestVariant(isMiss ? index : fallback, true);
+			}
+
+			index = m_variants.at(index) != nullptr ? index : fallback;
+		}
+
+		m_activeIndex = index;
 		return m_variants.at(m_activeIndex);
 	}
+
+	uint32_t Shader::GetCompiledVariantCount() const
+	{
+		return (uint32_t)std::count_if(m_variants.begin(), m_variants.end(), [](const Ref<ShaderVariant>& variant) { return variant != nullptr; });
+	}
 	
 	void Shader::ListProperties()
 	{
@@ -190,7 +319,20 @@ namespace PK::Rendering::Objects
 	void Shader::ListVariants()
 	{
 		PK_CORE_LOG_HEADER("Listing variants for shader: %s", GetFileName().c_str());
-		m_variantMap.ListVariants();
+		PK::Utilities::Debug::InsertNewLine();
+
+		auto pendingCount = 0u;
+
+		for (auto i = 0u; i < m_variants.size(); ++i)
+		{
+			auto isPending = m_pendingVariants.at(i) != nullptr;
+			auto state = m_variants.at(i) != nullptr ? "compiled" : isPending ? "queued  " : "        ";
+			pendingCount += isPending ? 1u : 0u;
+			PK_CORE_LOG("%s %s%s", state, m_variantMap.GetVariantKeywords(i).c_str(), i == FallbackIndex ? "(fallback)" : "");
+		}
+
+		PK::Utilities::Debug::InsertNewLine();
+		PK_CORE_LOG("Compiled %i of %i declared variants with %i programs & %i unique stages, %i queued.", GetCompiledVariantCount(), GetDeclaredVariantCount(), (uint32_t)m_programIndices.size(), (uint32_t)m_stageCache.size(), pendingCount);
 	}
 	
 	void Shader::ResetKeywords() { m_variantMap.Reset(); }
@@ -493,59 +635,32 @@ namespace PK::Rendering::Objects
 			PK_CORE_ASSERT(false, "Invalid Argument type for Cull value");
 		}
 		
-		static void GetSharedInclude(const std::string& source, std::string& sharedInclude)
+		// Whole word search, keywords are only referenced as identifiers.
+		static bool ContainsKeyword(const std::string& text, const std::string& keyword)
 		{
-			auto typeToken = "#pragma PROGRAM_";
-			auto typeTokenLength = strlen(typeToken);
-			auto pos = source.find(typeToken, 0); //Start of shader type declaration line
-		
-			// Treat code in the beginning of the source as shared include
-			if (pos != std::string::npos && pos != 0)
-			{
-				sharedInclude = source.substr(0, pos);
-			}
-		}
-	
-		static void GetVariantDefines(const std::vector<std::vector<std::string>>& keywords, uint32_t index, std::string& defines)
-		{
-			defines.clear();
-	
-			for (auto i = 0; i < keywords.size(); ++i)
+			auto isIdentifier = [](char c) { return isalnum((unsigned char)c) || c == '_'; };
+
+			for (auto pos = text.find(keyword); pos != std::string::npos; pos = text.find(keyword, pos + 1))
 			{
-				auto& declares = keywords.at(i);
-				auto& keyword = declares.at(index % declares.size());
-	
-				if (keyword != "_")
+				auto end = pos + keyword.size();
+
+				if ((pos == 0 || !isIdentifier(text[pos - 1])) && (end >= text.size() || !isIdentifier(text[end])))
 				{
-					defines.append("#define ");
-					defines.append(keyword);
-					defines.append("\n");
+					return true;
 				}
-	
-				index /= (uint32_t)declares.size();
 			}
+
+			return false;
 		}
 		
-		static void ExtractMulticompiles(std::string& source, std::vector<std::vector<std::string>>& keywords, ShaderVariantMap& multicompilemap)
+		static void ExtractMulticompiles(const ShaderDirectives::Header& header, ShaderVariantMap& multicompilemap)
 		{
-			std::string output;
-			size_t pos = 0;
-
 			multicompilemap.variantcount = 1;
 			multicompilemap.directivecount = 0;
 			multicompilemap.keywords.clear();
 
-			while (true)
+			for (auto& directive : header.multiCompiles)
 			{
-				pos = Utilities::String::ExtractToken(pos, "#multi_compile ", source, output, false);
-	
-				if (pos == std::string::npos)
-				{
-					break;
-				}
-
-				auto directive = Utilities::String::Split(output, " ");
-
 				for (auto j = 0; j < directive.size(); ++j)
 				{
 					auto& keyword = directive.at(j);
@@ -556,14 +671,13 @@ namespace PK::Rendering::Objects
 					}
 				}
 	
-				keywords.push_back(directive);
 				multicompilemap.directives[multicompilemap.directivecount] = multicompilemap.variantcount & 0xFFFFFF;
 				multicompilemap.variantcount *= (uint32_t)directive.size();
 				multicompilemap.directivecount++;
 			}
 		}
 	
-		static void ExtractInstancingInfo(const std::string& source, const ShaderVariantMap& variants, ShaderInstancingInfo& instancingInfo)
+		static void ExtractInstancingInfo(const ShaderDirectives::Header& header, const ShaderVariantMap& variants, ShaderInstancingInfo& instancingInfo)
 		{
 			auto instancingKeyword = StringHashID::StringToID("PK_ENABLE_INSTANCING");
 			instancingInfo.supportsInstancing = variants.keywords.count(instancingKeyword) > 0;
@@ -575,22 +689,10 @@ namespace PK::Rendering::Objects
 			}
 
 			std::vector<BufferElement> elements;
-			std::vector<std::string> instancedProperties;
-			Utilities::String::FindTokens("PK_INSTANCED_PROPERTY", source, instancedProperties, true);
 
-			for (auto& propRaw : instancedProperties)
+			for (auto& property : header.instancedProperties)
 			{
-				auto values = Utilities::String::Split(propRaw, " ;\n\r");
-
-				if (values.size() != 3)
-				{
-					continue;
-				}
-			
-				auto type = Math::Convert::FromUniformString(values.at(1).c_str());
-				auto name = values.at(2);
-
-				elements.push_back(BufferElement(type, name));
+				elements.push_back(BufferElement(Math::Convert::FromUniformString(property.first.c_str()), property.second));
 			}
 
 			instancingInfo.hasInstancedProperties = !elements.empty();
@@ -601,13 +703,13 @@ namespace PK::Rendering::Objects
 			}
 		}
 
-		static void ExtractStateAttributes(std::string& source, FixedStateAttributes& parameters)
+		static void ExtractStateAttributes(const ShaderDirectives::Header& header, FixedStateAttributes& parameters)
 		{
-			auto valueZWrite = Utilities::String::ExtractToken("#ZWrite ", source, false);
-			auto valueZTest = Utilities::String::ExtractToken("#ZTest ", source, false);
-			auto valueBlend = Utilities::String::ExtractToken("#Blend ", source, false);
-			auto valueColorMask = Utilities::String::ExtractToken("#ColorMask ", source, false);
-			auto valueCull = Utilities::String::ExtractToken("#Cull ", source, false);
+			auto valueZWrite = header.zwrite;
+			auto& valueZTest = header.ztest;
+			auto& valueBlend = header.blend;
+			auto& valueColorMask = header.colorMask;
+			auto& valueCull = header.cull;
 		
 			if (!valueZWrite.empty())
 			{
@@ -636,98 +738,239 @@ namespace PK::Rendering::Objects
 			GetCullModeFromString(Utilities::String::Trim(valueCull), parameters.CullMode, parameters.CullEnabled);
 		}
 		
-		static void ProcessShaderVersion(std::string& source)
+		static void ProcessShaderVersion(const std::string& source, const ShaderDirectives::Program& program, std::string& version)
 		{
-			auto versionToken = Utilities::String::ExtractToken("#version ", source, true);
+			version = source.substr(program.version.offset, program.version.count);
 			
-			if (versionToken.empty())
+			if (version.empty())
 			{
-				source.insert(0, "#version 460\n");
+				version = "#version 460\n";
 				PK_CORE_LOG("Shader didn't declare language version. Declaring 460 as default.");
 			}
-			else
-			{
-				source.insert(0, versionToken);
-			}
 		}
 		
-		static void ProcessShaderTypeDefine(GLenum type, std::string& source)
+		static const char* GetShaderTypeDefine(GLenum type)
 		{
 			switch (type)
 			{
-				case GL_VERTEX_SHADER: source.insert(0, "#define SHADER_STAGE_VERTEX\n"); return;
-				case GL_FRAGMENT_SHADER: source.insert(0, "#define SHADER_STAGE_FRAGMENT\n"); return;
-				case GL_GEOMETRY_SHADER: source.insert(0, "#define SHADER_STAGE_GEOMETRY\n"); return;
-				case GL_TESS_CONTROL_SHADER: source.insert(0, "#define SHADER_STAGE_TESSELATION_CONTROL\n"); return;
-				case GL_TESS_EVALUATION_SHADER: source.insert(0, "#define SHADER_STAGE_TESSELATION_EVALUATE\n"); return;
-				case GL_COMPUTE_SHADER: source.insert(0, "#define SHADER_STAGE_COMPUTE\n"); return;
-				default: PK_CORE_ASSERT(false, "Unknown shader type!"); return;
+				case GL_VERTEX_SHADER: return "#define SHADER_STAGE_VERTEX\n";
+				case GL_FRAGMENT_SHADER: return "#define SHADER_STAGE_FRAGMENT\n";
+				case GL_GEOMETRY_SHADER: return "#define SHADER_STAGE_GEOMETRY\n";
+				case GL_TESS_CONTROL_SHADER: return "#define SHADER_STAGE_TESSELATION_CONTROL\n";
+				case GL_TESS_EVALUATION_SHADER: return "#define SHADER_STAGE_TESSELATION_EVALUATE\n";
+				case GL_COMPUTE_SHADER: return "#define SHADER_STAGE_COMPUTE\n";
+				default: PK_CORE_ASSERT(false, "Unknown shader type!"); return "";
 			}
 		}
 		
-		static void ReadFile(const std::string& filepath, std::string& ouput)
+		static void ReadFile(const std::string& filepath, std::string& ouput, std::vector<std::string>& includes)
 		{
-			ouput = Utilities::String::ReadFileRecursiveInclude(filepath);
+			ouput = Utilities::String::ReadFileRecursiveInclude(filepath, includes);
+
+			// Edits to includes should reload the shader.
+			for (auto& include : includes)
+			{
+				PK::Core::AssetDatabase::RecordDependency(include);
+			}
 		}
-		
-		static void ProcessTypeSources(const std::string& source, const std::string& sharedInclude, const std::string& variantDefines, std::unordered_map<GLenum, std::string>& shaderSources)
+
+		// Keyword & property names are cooked as strings as their hash ids are assigned at runtime.
+		static void WriteCooked(const Core::AssetImporters::ImportData<Shader>& data, Core::AssetCacheWriter& writer)
 		{
-			shaderSources.clear();
-	
-			auto typeToken = "#pragma PROGRAM_";
-			auto typeTokenLength = strlen(typeToken);
-			auto pos = source.find(typeToken, 0); //Start of shader type declaration line
-	
-			while (pos != std::string::npos)
+			writer.WriteValue(data.variantMap.variantcount);
+			writer.WriteValue(data.variantMap.directivecount);
+			writer.Write(data.variantMap.directives, 16);
+			writer.WriteValue((uint32_t)data.variantMap.keywords.size());
+
+			for (auto& kv : data.variantMap.keywords)
 			{
-				auto eol = source.find_first_of("\r\n", pos); //End of shader type declaration line
-				auto nextLinePos = source.find_first_not_of("\r\n", eol); //Start of shader code after shader type declaration line
-				PK_CORE_ASSERT(eol != std::string::npos, "Syntax error");
-				PK_CORE_ASSERT(nextLinePos != std::string::npos, "Syntax error");
-	
-				auto begin = pos + typeTokenLength; //Start of shader type name (after "#pragma PROGRAM_" keyword)
-				auto type = source.substr(begin, eol - begin);
-	
-				PK_CORE_ASSERT(GetShaderTypeFromString(type), "Invalid shader type specified");
-	
-				pos = source.find(typeToken, nextLinePos); //Start of next shader type declaration line
-	
-				shaderSources[GetShaderTypeFromString(type)] = pos == std::string::npos ? source.substr(nextLinePos) : source.substr(nextLinePos, pos - nextLinePos);
+				writer.WriteString(StringHashID::IDToString(kv.first));
+				writer.WriteValue(kv.second);
 			}
-		
-			for (auto& kv : shaderSources)
+
+			writer.WriteValue(data.stateAttributes);
+			writer.WriteValue(data.instancingInfo.supportsInstancing);
+			writer.WriteValue(data.instancingInfo.hasInstancedProperties);
+			writer.WriteValue((uint32_t)data.instancingInfo.propertyLayout.GetElements().size());
+
+			for (auto& element : data.instancingInfo.propertyLayout)
+			{
+				writer.WriteValue(element.Type);
+				writer.WriteValue(element.Size);
+				writer.WriteValue(element.Normalized);
+				writer.WriteString(StringHashID::IDToString(element.NameHashId));
+			}
+
+			writer.WriteValue((uint32_t)data.source->stages.size());
+
+			for (auto& stage : data.source->stages)
+			{
+				writer.WriteValue(stage.type);
+				writer.WriteString(stage.version);
+				writer.WriteString(stage.text);
+			}
+
+			writer.WriteValue((uint32_t)data.source->keywords.size());
+
+			for (auto& directive : data.source->keywords)
+			{
+				writer.WriteValue((uint32_t)directive.size());
+
+				for (auto& keyword : directive)
+				{
+					writer.WriteString(keyword);
+				}
+			}
+		}
+
+		static bool ReadCooked(Core::AssetCacheReader* reader, Core::AssetImporters::ImportData<Shader>& data)
+		{
+			size_t directiveCount = 0;
+			data.variantMap.variantcount = reader->ReadValue<uint32_t>();
+			data.variantMap.directivecount = reader->ReadValue<uint32_t>();
+			auto directives = reader->Read<uint32_t>(directiveCount);
+
+			if (directiveCount != 16)
+			{
+				return false;
+			}
+
+			memcpy(data.variantMap.directives, directives, sizeof(data.variantMap.directives));
+			auto keywordCount = reader->ReadValue<uint32_t>();
+
+			for (auto i = 0u; i < keywordCount && reader->IsValid(); ++i)
+			{
+				auto keyword = reader->ReadString();
+				data.variantMap.keywords[StringHashID::StringToID(keyword)] = reader->ReadValue<uint8_t>();
+			}
+
+			data.stateAttributes = reader->ReadValue<FixedStateAttributes>();
+			data.instancingInfo.supportsInstancing = reader->ReadValue<bool>();
+			data.instancingInfo.hasInstancedProperties = reader->ReadValue<bool>();
+			auto elementCount = reader->ReadValue<uint32_t>();
+			std::vector<BufferElement> elements;
+
+			for (auto i = 0u; i < elementCount && reader->IsValid(); ++i)
+			{
+				auto type = reader->ReadValue<PK_TYPE>();
+				auto size = reader->ReadValue<ushort>();
+				auto normalized = reader->ReadValue<bool>();
+				auto name = reader->ReadString();
+				auto typeSize = Convert::Size(type);
+				elements.push_back(BufferElement(type, name, typeSize > 0 ? size / typeSize : 1, normalized));
+			}
+
+			if (!elements.empty())
+			{
+				data.instancingInfo.propertyLayout = BufferLayout(elements);
+			}
+
+			auto source = CreateRef<ShaderSource>();
+			auto stageCount = reader->ReadValue<uint32_t>();
+
+			for (auto i = 0u; i < stageCount && reader->IsValid(); ++i)
+			{
+				auto& stage = source->stages.emplace_back();
+				stage.type = reader->ReadValue<GLenum>();
+				stage.version = reader->ReadString();
+				stage.text = reader->ReadString();
+			}
+
+			auto sourceDirectiveCount = reader->ReadValue<uint32_t>();
+
+			for (auto i = 0u; i < sourceDirectiveCount && reader->IsValid(); ++i)
 			{
-				kv.second.insert(0, sharedInclude);
-				ProcessShaderTypeDefine(kv.first, kv.second);
-				kv.second.insert(0, variantDefines);
-				ProcessShaderVersion(kv.second);
+				auto& directive = source->keywords.emplace_back();
+				auto directiveKeywordCount = reader->ReadValue<uint32_t>();
+
+				for (auto j = 0u; j < directiveKeywordCount && reader->IsValid(); ++j)
+				{
+					directive.push_back(reader->ReadString());
+				}
 			}
+
+			if (!reader->IsValid() || source->keywords.size() != data.variantMap.directivecount)
+			{
+				return false;
+			}
+
+			source->FindReferencedKeywords();
+			data.source = source;
+			return true;
 		}
 		
-		static void Compile(const std::string& filename, const std::unordered_map<GLenum, std::string>& shaderSources, std::map<uint32_t, ShaderPropertyInfo>& variablemap, GraphicsID& program)
+		static void ProcessTypeSources(const std::string& source, const ShaderDirectives::Header& header, std::vector<ShaderSource::Stage>& stages)
 		{
-			program = glCreateProgram();
-			variablemap.clear();
+			stages.clear();
+
+			for (auto& program : header.programs)
+			{
+				auto stageType = GetShaderTypeFromString(program.type);
+				PK_CORE_ASSERT(stageType, "Invalid shader type specified");
+
+				// A stage declared twice replaces the earlier declaration.
+				auto stage = std::find_if(stages.begin(), stages.end(), [stageType](const ShaderSource::Stage& s) { return s.type == stageType; });
+				stage = stage != stages.end() ? stage : stages.insert(stages.end(), ShaderSource::Stage());
+				stage->type = stageType;
+				ShaderDirectives::GetProgramText(source, header, program, stage->text);
+				ProcessShaderVersion(source, program, stage->version);
+			}
+		}
 		
+		// Returns without waiting for the driver when it compiles in parallel. The stages stay attached for error reporting until the program is finished.
+		// Stages are compiled once per unique source & owned by the stage cache.
+		static GraphicsID BeginCompile(const std::string& filename, const std::unordered_map<GLenum, std::string>& shaderSources, std::unordered_map<size_t, GraphicsID>& stageCache, std::vector<GraphicsID>& stages)
+		{
+			PK_PROFILE_FUNCTION();
+
 			PK_CORE_ASSERT(shaderSources.size() > 0, "No shader sources supplied for %s", filename.c_str());
-		
-			auto stageCount = shaderSources.size();
-	
-			GLenum* glShaderIDs = PK_STACK_ALLOC(GLenum, stageCount);
-			int glShaderIDIndex = 0;
+
+			auto program = glCreateProgram();
+			stages.clear();
 		
 			for (auto& kv : shaderSources)
 			{
-				auto type = kv.first;
-				const auto& source = kv.second;
-		
-				auto glShader = glCreateShader(type);
-				
-				const auto* sourceCStr = source.c_str();
+				auto& glShader = stageCache[ShaderSource::GetStageHash(kv.first, kv.second)];
+
+				if (glShader == 0)
+				{
+					glShader = glCreateShader(kv.first);
+					const auto* sourceCStr = kv.second.c_str();
+					glShaderSource(glShader, 1, &sourceCStr, 0);
+					glCompileShader(glShader);
+				}
+
+				glAttachShader(program, glShader);
+				stages.push_back(glShader);
+			}
 		
-				glShaderSource(glShader, 1, &sourceCStr, 0);
-				glCompileShader(glShader);
+			glLinkProgram(program);
+			return program;
+		}
+
+		static bool IsCompileComplete(GraphicsID program)
+		{
+			#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+			if (!GraphicsAPI::SupportsParallelShaderCompile())
+			{
+				return true;
+			}
+
+			GLint isComplete = GL_FALSE;
+			glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &isComplete);
+			return isComplete == GL_TRUE;
+		}
 		
+		// Waits for the program if it is still compiling, reports errors & maps the properties of the linked program.
+		static void EndCompile(const std::string& filename, GraphicsID program, const std::vector<GraphicsID>& stages, std::map<uint32_t, ShaderPropertyInfo>& variablemap)
+		{
+			PK_PROFILE_FUNCTION();
+
+			variablemap.clear();
+
+			for (auto glShader : stages)
+			{
 				GLint isCompiled = 0;
 				glGetShaderiv(glShader, GL_COMPILE_STATUS, &isCompiled);
 	
@@ -739,18 +982,11 @@ namespace PK::Rendering::Objects
 					std::vector<GLchar> infoLog(maxLength);
 					glGetShaderInfoLog(glShader, maxLength, &maxLength, &infoLog[0]);
 		
-					glDeleteShader(glShader);
-		
 					PK_CORE_LOG_HEADER("Shader (%s) Compilation Failure!", filename.c_str());
 					PK_CORE_ERROR(infoLog.data());
 				}
-		
-				glAttachShader(program, glShader);
-				glShaderIDs[glShaderIDIndex++] = glShader;
 			}
 		
-			glLinkProgram(program);
-		
 			GLint isLinked = 0;
 			glGetProgramiv(program, GL_LINK_STATUS, (int*)&isLinked);
 	
@@ -761,21 +997,12 @@ namespace PK::Rendering::Objects
 	
 				std::vector<GLchar> infoLog(maxLength);
 				glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
-		
-				glDeleteProgram(program);
-		
-				for (auto i = 0; i < stageCount; ++i)
-				{
-					glDeleteShader(glShaderIDs[i]);
-				}
-		
 				PK_CORE_ERROR("Shader link failure! \n%s \n%s", filename.c_str(), infoLog.data());
 			}
 		
-			for (auto i = 0; i < stageCount; ++i)
+			for (auto glShader : stages)
 			{
-				glDetachShader(program, glShaderIDs[i]);
-				glDeleteShader(glShaderIDs[i]);
+				glDetachShader(program, glShader);
 			}
 		
 			// Set as active so that texture slots can be bound
@@ -915,38 +1142,297 @@ namespace PK::Rendering::Objects
 			glUseProgram(currentProgram);
 		}
 	}
+
+	void ShaderSource::FindReferencedKeywords()
+	{
+		for (auto& stage : stages)
+		{
+			stage.referencedKeywords.resize(keywords.size());
+
+			for (auto i = 0u; i < keywords.size(); ++i)
+			{
+				for (auto& keyword : keywords.at(i))
+				{
+					stage.referencedKeywords.at(i).push_back(keyword != "_" && ShaderCompiler::ContainsKeyword(stage.text, keyword));
+				}
+			}
+		}
+	}
+
+	void ShaderSource::GetVariantSources(uint32_t index, std::unordered_map<GLenum, std::string>& stageSources) const
+	{
+		stageSources.clear();
+
+		for (auto& stage : stages)
+		{
+			const char* defineToken = "#define ";
+			const char* typeDefine = ShaderCompiler::GetShaderTypeDefine(stage.type);
+			std::vector<const std::string*> defines;
+			auto size = stage.version.size() + strlen(typeDefine) + stage.text.size();
+			auto directiveIndex = index;
+
+			for (auto i = 0u; i < keywords.size(); ++i)
+			{
+				auto& declares = keywords.at(i);
+				auto keywordIndex = directiveIndex % (uint32_t)declares.size();
+				directiveIndex /= (uint32_t)declares.size();
+
+				if (stage.referencedKeywords.at(i).at(keywordIndex))
+				{
+					defines.push_back(&declares.at(keywordIndex));
+					size += strlen(defineToken) + declares.at(keywordIndex).size() + 1;
+				}
+			}
+
+			// Assembled in order into a single allocation.
+			auto& output = stageSources[stage.type];
+			output.reserve(size);
+			output.append(stage.version);
+
+			for (auto define : defines)
+			{
+				output.append(defineToken);
+				output.append(*define);
+				output.append("\n");
+			}
+
+			output.append(typeDefine);
+			output.append(stage.text);
+		}
+	}
+
+	size_t ShaderSource::GetStageHash(GLenum type, const std::string& stageSource)
+	{
+		auto hash = std::hash<std::string>()(stageSource);
+		return hash ^ (std::hash<GLenum>()(type) + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+	}
+
+	size_t ShaderSource::GetProgramHash(const std::unordered_map<GLenum, std::string>& stageSources)
+	{
+		// Order independent as the map isn't ordered.
+		size_t hash = 0ull;
+
+		for (auto& kv : stageSources)
+		{
+			hash += GetStageHash(kv.first, kv.second) * 0x100000001b3ull;
+		}
+
+		return hash;
+	}
+
+	struct Shader::PendingVariant
+	{
+		// Written by the preprocess job, read once the counter is done.
+		std::unordered_map<GLenum, std::string> sources;
+		size_t programHash = 0ull;
+		Core::JobCounter counter;
+		GraphicsID program = 0;
+		// Owned by the stage cache of the shader.
+		std::vector<GraphicsID> stages;
+
+		~PendingVariant()
+		{
+			if (program != 0)
+			{
+				glDeleteProgram(program);
+			}
+		}
+	};
+
+	void Shader::RequestVariant(uint32_t index, bool wait)
+	{
+		static uint64_t compileFrame = 0ull;
+		static uint32_t compileCount = 0u;
+
+		auto jobSystem = Core::Application::GetService<Core::JobSystem>();
+		auto& pending = m_pendingVariants.at(index);
+
+		if (pending == nullptr)
+		{
+			pending = CreateRef<PendingVariant>();
+			auto source = m_source;
+			auto target = pending;
+			jobSystem->Dispatch([source, target, index]()
+			{
+				source->GetVariantSources(index, target->sources);
+				target->programHash = ShaderSource::GetProgramHash(target->sources);
+			}, &pending->counter);
+		}
+
+		if (wait)
+		{
+			jobSystem->Wait(&pending->counter);
+		}
+
+		if (!pending->counter.IsDone())
+		{
+			return;
+		}
+
+		if (pending->program == 0)
+		{
+			auto compiled = m_programIndices.find(pending->programHash);
+
+			if (compiled != m_programIndices.end())
+			{
+				m_variants.at(index) = m_variants.at(compiled->second);
+				pending = nullptr;
+				return;
+			}
+
+			auto frameIndex = Core::Application::GetService<Core::Time>()->GetFrameIndex();
+
+			if (compileFrame != frameIndex)
+			{
+				compileFrame = frameIndex;
+				compileCount = 0u;
+			}
+
+			// Without parallel compile support the driver compiles synchronously, limit the number of variants that stall a frame.
+			if (!wait && !GraphicsAPI::SupportsParallelShaderCompile() && compileCount >= MaxBlockingCompilesPerFrame)
+			{
+				return;
+			}
+
+			compileCount++;
+			pending->program = ShaderCompiler::BeginCompile(GetFileName(), pending->sources, m_stageCache, pending->stages);
+		}
+
+		if (!wait && !ShaderCompiler::IsCompileComplete(pending->program))
+		{
+			return;
+		}
+
+		// Released first so that a failed compile isn't retried, the pending variant deletes the program in that case.
+		auto finished = std::move(pending);
+		std::map<uint32_t, ShaderPropertyInfo> properties;
+		ShaderCompiler::EndCompile(GetFileName(), finished->program, finished->stages, properties);
+		m_variants.at(index) = CreateRef<ShaderVariant>(finished->program, properties);
+		m_programIndices[finished->programHash] = index;
+		finished->program = 0;
+	}
+
+	void Shader::ReleaseVariants()
+	{
+		m_pendingVariants.clear();
+		m_variants.clear();
+		m_programIndices.clear();
+
+		for (auto& kv : m_stageCache)
+		{
+			glDeleteShader(kv.second);
+		}
+
+		m_stageCache.clear();
+	}
 }
 
 template<>
 bool PK::Core::AssetImporters::IsValidExtension<PK::Rendering::Objects::Shader>(const std::filesystem::path& extension) { return extension.compare(".shader") == 0; }
 
-template<> 
-void PK::Core::AssetImporters::Import(const std::string& filepath, PK::Utilities::Ref<PK::Rendering::Objects::Shader>& shader)
+template<>
+void PK::Core::AssetImporters::Decode(const std::string& filepath, ImportData<PK::Rendering::Objects::Shader>& data)
 {
-	shader->m_variants.clear();
-
-	// A lot of hacky stuff in this parser at the moment.
-	// @TODO Consider clean up once priorities allow it.
-	std::string source;
-	std::string sharedInclude;
-	std::string variantDefines;
-	std::vector<std::vector<std::string>> mckeywords;
-	std::unordered_map<GLenum, std::string> shaderSources;
+	PK_PROFILE_SCOPE("AssetImporters::Decode<Shader>");
+
+	// Increment when the decoded output changes.
+	const uint32_t importerVersion = 3;
+	auto cache = AssetCache::Get();
+	auto cooked = cache != nullptr ? cache->Open(filepath, importerVersion, 0ull) : nullptr;
+
+	if (cooked == nullptr || !PK::Rendering::Objects::ShaderCompiler::ReadCooked(cooked.get(), data))
+	{
+		data = ImportData<PK::Rendering::Objects::Shader>();
+
+		auto source = PK::Utilities::CreateRef<PK::Rendering::Objects::ShaderSource>();
+		std::vector<std::string> includes;
+		std::string text;
+		PK::Rendering::ShaderDirectives::Header header;
+
+		PK::Rendering::Objects::ShaderCompiler::ReadFile(filepath, text, includes);
+
+		// Includes are only known after a read. Capture them & decode a second read so that the blob never describes newer contents than it was decoded from.
+		AssetCacheSource cacheSource;
+		auto isCacheable = cache != nullptr && cache->Capture(filepath, importerVersion, 0ull, includes, cacheSource);
+
+		if (isCacheable)
+		{
+			includes.clear();
+			PK::Rendering::Objects::ShaderCompiler::ReadFile(filepath, text, includes);
+			isCacheable = includes == cacheSource.dependencies;
+		}
+
+		PK::Rendering::ShaderDirectives::Lex(text, header);
+		PK::Rendering::Objects::ShaderCompiler::ExtractMulticompiles(header, data.variantMap);
+		PK::Rendering::Objects::ShaderCompiler::ExtractStateAttributes(header, data.stateAttributes);
+		PK::Rendering::Objects::ShaderCompiler::ExtractInstancingInfo(header, data.variantMap, data.instancingInfo);
+		PK::Rendering::Objects::ShaderCompiler::ProcessTypeSources(text, header, source->stages);
+		source->keywords = header.multiCompiles;
+		source->FindReferencedKeywords();
+		data.source = source;
+
+		if (isCacheable)
+		{
+			AssetCacheWriter writer;
+			PK::Rendering::Objects::ShaderCompiler::WriteCooked(data, writer);
+			cache->Store(filepath, cacheSource, writer);
+		}
+	}
+
+	// Only the fallback variant is preprocessed up front, the others are processed when first requested.
+	data.source->GetVariantSources(PK::Rendering::Objects::Shader::FallbackIndex, data.fallbackSources);
+}
+
+template<>
+void PK::Core::AssetImporters::Commit(ImportData<PK::Rendering::Objects::Shader>& data, PK::Utilities::Ref<PK::Rendering::Objects::Shader>& shader)
+{
+	PK_PROFILE_SCOPE("AssetImporters::Commit<Shader>");
+
 	std::map<uint32_t, PK::Rendering::Structs::ShaderPropertyInfo> properties;
-	PK::Rendering::Objects::GraphicsID programId;
+	std::vector<PK::Rendering::Objects::GraphicsID> stages;
 
-	PK::Rendering::Objects::ShaderCompiler::ReadFile(filepath, source);
-	PK::Rendering::Objects::ShaderCompiler::ExtractMulticompiles(source, mckeywords, shader->m_variantMap);
-	PK::Rendering::Objects::ShaderCompiler::ExtractStateAttributes(source, shader->m_stateAttributes);
-	PK::Rendering::Objects::ShaderCompiler::ExtractInstancingInfo(source, shader->m_variantMap, shader->m_instancingInfo);
+	// Pending compiles of the previous source are discarded.
+	shader->ReleaseVariants();
+	shader->m_variantMap = data.variantMap;
+	shader->m_stateAttributes = data.stateAttributes;
+	shader->m_instancingInfo = data.instancingInfo;
+	shader->m_source = data.source;
+	shader->m_isCompute = data.fallbackSources.count(GL_COMPUTE_SHADER) > 0;
+	shader->m_fixedDirectiveMask = data.variantMap.GetFixedDirectiveMask();
+	shader->m_activeIndex = PK::Rendering::Objects::Shader::FallbackIndex;
+	shader->m_variants.resize(data.variantMap.variantcount);
+	shader->m_pendingVariants.resize(data.variantMap.variantcount);
+	shader->m_requestedVariants.assign(data.variantMap.variantcount, false);
 
-	PK::Rendering::Objects::ShaderCompiler::GetSharedInclude(source, sharedInclude);
+	auto programId = PK::Rendering::Objects::ShaderCompiler::BeginCompile(shader->GetFileName(), data.fallbackSources, shader->m_stageCache, stages);
+	PK::Rendering::Objects::ShaderCompiler::EndCompile(shader->GetFileName(), programId, stages, properties);
+	shader->m_variants.at(PK::Rendering::Objects::Shader::FallbackIndex) = PK::Utilities::CreateRef<PK::Rendering::Objects::ShaderVariant>(programId, properties);
+	shader->m_programIndices[PK::Rendering::Objects::ShaderSource::GetProgramHash(data.fallbackSources)] = PK::Rendering::Objects::Shader::FallbackIndex;
 
-	for (uint32_t i = 0; i < shader->m_variantMap.variantcount; ++i)
+	// Shaders that the manifest doesn't list aren't stripped, their variants are compiled on demand.
+	auto manifest = PK::Rendering::ShaderVariantManifest::Get();
+	std::vector<uint32_t> listedVariants;
+	shader->m_isStripped = manifest != nullptr && manifest->IsStripping() && manifest->GetVariantIndices(shader->GetFileName(), data.variantMap, listedVariants);
+
+	// Preprocessing of every listed variant is dispatched before the first one is waited on.
+	for (auto wait : { false, true })
 	{
-		PK::Rendering::Objects::ShaderCompiler::GetVariantDefines(mckeywords, i, variantDefines);
-		PK::Rendering::Objects::ShaderCompiler::ProcessTypeSources(source, sharedInclude, variantDefines, shaderSources);
-		PK::Rendering::Objects::ShaderCompiler::Compile(shader->GetFileName(), shaderSources, properties, programId);
-		shader->m_variants.push_back(CreateRef<PK::Rendering::Objects::ShaderVariant>(programId, properties));
+		for (auto index : listedVariants)
+		{
+			if (shader->m_variants.at(index) == nullptr)
+			{
+				shader->RequestVariant(index, wait);
+			}
+		}
 	}
+}
+
+template<> 
+void PK::Core::AssetImporters::Import(const std::string& filepath, PK::Utilities::Ref<PK::Rendering::Objects::Shader>& shader)
+{
+	PK_PROFILE_SCOPE("AssetImporters::Import<Shader>");
+
+	ImportData<PK::Rendering::Objects::Shader> data;
+	Decode(filepath, data);
+	Commit(data, shader);
 }
\ No newline at end of file
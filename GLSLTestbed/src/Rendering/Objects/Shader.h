@@ -1,5 +1,6 @@
 #pragma once
 #include "Core/AssetDataBase.h"
+#include "Core/MemoryTracker.h"
 #include "Rendering/Objects/GraphicsObject.h"
 #include "Rendering/Structs/ShaderPropertyBlock.h"
 #include "Rendering/Structs/FixedStateAttributes.h"
@@ -28,10 +29,24 @@ namespace PK::Rendering::Objects
 		public:
 			void Reset();
 			void SetKeywords(const uint32_t* hashIds, size_t count);
-			void ListVariants();
+			// Space separated keywords that select a variant.
+			std::string GetVariantKeywords(uint32_t index) const;
 			inline bool SupportsKeyword(const uint32_t hashId) const { return keywords.count(hashId) > 0; }
 			bool SupportsKeywords(const uint32_t* hashIds, const uint32_t count) const;
 			uint32_t GetActiveIndex() const;
+			// Directives that a fallback variant has to match, see EngineKeywords. Directives without a "_" keyword select a pass & are included as well.
+			uint32_t GetFixedDirectiveMask() const;
+			// The variant with the same keywords in the fixed directives & the first keyword of every other directive.
+			uint32_t GetFallbackIndex(uint32_t index, uint32_t fixedDirectiveMask) const;
+
+			// Set by the engine instead of materials. They change the vertex input, instancing or pass of a variant.
+			static constexpr const char* EngineKeywords[] =
+			{
+				"PK_ENABLE_INSTANCING",
+				"PK_VERTEX_COMPRESSED",
+				"PK_META_DEPTH_NORMALS",
+				"PK_META_GI_VOXELIZE",
+			};
 	
 			uint32_t variantcount = 0;
 			uint32_t directivecount = 0;
@@ -44,22 +59,131 @@ namespace PK::Rendering::Objects
 		public:
 			ShaderVariant(GraphicsID graphicsId, const std::map<uint32_t, ShaderPropertyInfo>& properties);
 			~ShaderVariant();
+			// Uploads the properties that the variant declares using the binding plan of the block layout.
 			void SetPropertyBlock(const ShaderPropertyBlock& propertyBlock);
 			void ListProperties();
 		private:
-			std::map<uint32_t, ShaderPropertyInfo> m_properties;
+			typedef void (*UploadFunction)(ushort location, uint count, const char* values);
+
+			struct PropertyBinding
+			{
+				uint offset = 0;
+				ushort location = 0xFFFF;
+				ushort count = 0;
+				UploadFunction upload = nullptr;
+			};
+
+			// Properties of a block layout that the variant declares, in block iteration order.
+			struct BindingPlan
+			{
+				uint64_t lastUse = 0ull;
+				std::vector<PropertyBinding> bindings;
+			};
+
+			const ShaderPropertyInfo* FindProperty(uint32_t hashId) const;
+			const BindingPlan& GetBindingPlan(const ShaderPropertyBlock& propertyBlock);
+			static UploadFunction GetUploadFunction(PK_TYPE type);
+
+			// A draw binds a global, a material & a per draw block. Every material has a layout of its own, the least recently used plan is evicted once the limit is reached.
+			static constexpr uint32_t MaxBindingPlans = 64;
+
+			// Sorted by hash, searched when a binding plan is built.
+			std::vector<uint32_t> m_propertyHashes;
+			std::vector<ShaderPropertyInfo> m_propertyInfos;
+			// By block layout version.
+			std::unordered_map<uint, BindingPlan> m_bindingPlans;
+			uint64_t m_bindingPlanUseCount = 0ull;
+			Core::MemoryAllocation m_memory { Core::MemoryResource::ShaderVariant };
+	};
+	
+	// Stages the variants of a shader are assembled from, state & multi compile directives are already extracted.
+	// Shared with the jobs that preprocess variants, it is replaced instead of modified on reload.
+	struct ShaderSource
+	{
+		// Keywords of each multi compile directive, "_" for none.
+		std::vector<std::vector<std::string>> keywords;
+
+		struct Stage
+		{
+			GLenum type = 0;
+			std::string version;
+			// Shared include & stage code without the version directive.
+			std::string text;
+			// Keywords that the stage doesn't reference aren't defined, variants that only differ by them get identical stage sources.
+			std::vector<std::vector<bool>> referencedKeywords;
+		};
+
+		// Split once so that variants are assembled without searching or prepending to the source.
+		std::vector<Stage> stages;
+
+		void FindReferencedKeywords();
+		void GetVariantSources(uint32_t index, std::unordered_map<GLenum, std::string>& stageSources) const;
+		static size_t GetStageHash(GLenum type, const std::string& stageSource);
+		static size_t GetProgramHash(const std::unordered_map<GLenum, std::string>& stageSources);
+
+		inline size_t GetSize() const
+		{
+			size_t size = 0;
+
+			for (auto& stage : stages)
+			{
+				size += stage.text.size();
+			}
+
+			return size;
+		}
 	};
 	
+	class Shader;
+}
+
+namespace PK::Core::AssetImporters
+{
+	template<>
+	struct ImportData<Rendering::Objects::Shader>
+	{
+		static constexpr bool IsDecodable = true;
+		Rendering::Objects::ShaderVariantMap variantMap;
+		Rendering::Structs::FixedStateAttributes stateAttributes;
+		Rendering::Objects::ShaderInstancingInfo instancingInfo;
+		Utilities::Ref<const Rendering::Objects::ShaderSource> source;
+		// Preprocessed stage sources of the fallback variant, only compilation is left to the main thread.
+		std::unordered_map<GLenum, std::string> fallbackSources;
+
+		// Program binaries are roughly proportional to the source size.
+		size_t GetSize() const
+		{
+			size_t size = source != nullptr ? source->GetSize() : 0;
+
+			for (auto& kv : fallbackSources)
+			{
+				size += kv.second.size();
+			}
+
+			return size;
+		}
+	};
+}
+
+namespace PK::Rendering::Objects
+{
 	class Shader: public Asset
 	{
-		friend void AssetImporters::Import(const std::string& filepath, Ref<Shader>& shader);
+		friend void AssetImporters::Commit(AssetImporters::ImportData<Shader>& data, Ref<Shader>& shader);
 	
 		public:
+			// Selects the first keyword of every multi compile directive. Compiled on import so that there always is a variant to draw with.
+			static constexpr uint32_t FallbackIndex = 0;
+
 			~Shader();
 			inline const FixedStateAttributes& GetFixedStateAttributes() const { return m_stateAttributes; }
 			inline const ShaderInstancingInfo& GetInstancingInfo() const { return m_instancingInfo; }
 			inline bool SupportsKeyword(const uint32_t hashId) const { return m_variantMap.SupportsKeyword(hashId); }
 			inline bool SupportsKeywords(const uint32_t* hashIds, const uint32_t count) const { return m_variantMap.SupportsKeywords(hashIds, count); }
+			inline const ShaderVariantMap& GetVariantMap() const { return m_variantMap; }
+			// Variants are compiled when they are first requested. Until then a variant that only differs in shading keywords is returned, compute shaders wait for theirs.
+			// The fallback of a requested variant is compiled synchronously when it isn't available yet.
+			// Stripped shaders only compile the variants listed in the variant manifest & misses that no compiled fallback can stand in for.
 			const Ref<ShaderVariant>& GetActiveVariant();
 	
 			inline void SetPropertyBlock(const ShaderPropertyBlock& propertyBlock) { m_variants.at(m_activeIndex)->SetPropertyBlock(propertyBlock); }
@@ -67,10 +191,33 @@ namespace PK::Rendering::Objects
 			void SetKeywords(const std::vector<uint32_t>& keywords);
 			void ListProperties();
 			void ListVariants();
+			inline uint32_t GetDeclaredVariantCount() const { return (uint32_t)m_variants.size(); }
+			uint32_t GetCompiledVariantCount() const;
 	
 		private:
+			struct PendingVariant;
+
+			// Preprocesses the sources on a job & compiles them once they are ready. Returns once the variant is compiled if wait is set.
+			void RequestVariant(uint32_t index, bool wait);
+			void ReleaseVariants();
+
+			// Without parallel shader compile support finishing a variant blocks, spreads the compiles over frames.
+			static constexpr uint32_t MaxBlockingCompilesPerFrame = 1;
+
 			uint32_t m_activeIndex = 0;
+			uint32_t m_fixedDirectiveMask = 0u;
+			bool m_isCompute = false;
+			bool m_isStripped = false;
+			// Variants resolved since import, each is reported to the variant manifest once.
+			std::vector<bool> m_requestedVariants;
+			// Empty until compiled.
 			std::vector<Ref<ShaderVariant>> m_variants;
+			std::vector<Ref<PendingVariant>> m_pendingVariants;
+			// Compiled stages by source hash, attached to every program that uses an identical stage source.
+			std::unordered_map<size_t, GraphicsID> m_stageCache;
+			// Variants with identical stage sources share a program.
+			std::unordered_map<size_t, uint32_t> m_programIndices;
+			Ref<const ShaderSource> m_source;
 			ShaderVariantMap m_variantMap = ShaderVariantMap();
 			FixedStateAttributes m_stateAttributes = FixedStateAttributes();
 			ShaderInstancingInfo m_instancingInfo = ShaderInstancingInfo();
@@ -130,6 +130,31 @@ namespace PK::Rendering::Objects
         m_channels = GetFormatChannels(descriptor.colorFormat);
     }
     
+    size_t Texture::GetStorageSize(const TextureDescriptor& descriptor)
+    {
+        auto resolution = glm::max(descriptor.resolution, PK_UINT3_ONE);
+        auto levels = descriptor.miplevels > 0 ? descriptor.miplevels : 1u;
+        auto layers = 1u;
+
+        switch (descriptor.dimension)
+        {
+            case GL_TEXTURE_CUBE_MAP: layers = 6u; break;
+            case GL_TEXTURE_CUBE_MAP_ARRAY: layers = resolution.z * 6u; break;
+            case GL_TEXTURE_2D_ARRAY:
+            case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: layers = resolution.z; break;
+        }
+
+        size_t texels = 0;
+
+        for (auto level = 0u; level < levels; ++level)
+        {
+            auto depth = descriptor.dimension == GL_TEXTURE_3D ? glm::max(resolution.z >> level, 1u) : layers;
+            texels += (size_t)glm::max(resolution.x >> level, 1u) * glm::max(resolution.y >> level, 1u) * depth;
+        }
+
+        return texels * (GetTexelSizeBits(descriptor.colorFormat) / 8u) * glm::max(descriptor.msaaSamples, 1u);
+    }
+
     void Texture::CreateTextureStorage(GraphicsID& graphicsId, const TextureDescriptor& descriptor)
     {
         glCreateTextures(descriptor.dimension, 1, &graphicsId);
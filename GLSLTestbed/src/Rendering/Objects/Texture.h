@@ -1,5 +1,6 @@
 #pragma once
 #include "Rendering/Objects/GraphicsObject.h"
+#include "Core/MemoryTracker.h"
 #include <hlslmath.h>
 #include <KTX/ktx.h>
 
@@ -81,8 +82,11 @@ namespace PK::Rendering::Objects
             static uint8_t GetTexelSizeBits(GLenum format);
             static uint8_t GetChannelCount(GLenum channels);
             static void GetDescirptorFromKTX(ktxTexture* tex, TextureDescriptor* desc, GLenum* channels);
+            // Bytes of the storage allocated for the descriptor, including mips, layers & samples.
+            static size_t GetStorageSize(const TextureDescriptor& descriptor);
     
             TextureDescriptor m_descriptor;
             GLenum m_channels;
+            Core::MemoryAllocation m_memory { Core::MemoryResource::Texture };
     };
 }
\ No newline at end of file
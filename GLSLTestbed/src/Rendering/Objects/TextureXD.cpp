@@ -1,6 +1,7 @@
 #include "PrecompiledHeader.h"
 #include "Utilities/Log.h"
 #include "Rendering/Objects/TextureXD.h"
+#include "Core/Profiler.h"
 #include <KTX/ktx.h>
 
 namespace PK::Rendering::Objects
@@ -15,6 +16,7 @@ namespace PK::Rendering::Objects
 	TextureXD::TextureXD(const TextureDescriptor& descriptor) : Texture(descriptor)
 	{
 		CreateTextureStorage(m_graphicsId, descriptor);
+		m_memory.Set(0, GetStorageSize(descriptor));
 	}
 	
 	TextureXD::~TextureXD()
@@ -36,35 +38,55 @@ template<>
 bool PK::Core::AssetImporters::IsValidExtension<PK::Rendering::Objects::TextureXD>(const std::filesystem::path& extension) { return extension.compare(".ktx") == 0; }
 
 template<>
-void PK::Core::AssetImporters::Import(const std::string& filepath, Utilities::Ref<PK::Rendering::Objects::TextureXD>& texture)
+void PK::Core::AssetImporters::Decode(const std::string& filepath, ImportData<PK::Rendering::Objects::TextureXD>& data)
+{
+	PK_PROFILE_SCOPE("AssetImporters::Decode<TextureXD>");
+
+	data.wrapmode = PK::Rendering::Objects::Texture::GetWrapmodeFromString(filepath.c_str());
+
+	auto result = ktxTexture_CreateFromNamedFile(filepath.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &data.texture);
+
+	PK_CORE_ASSERT(result == KTX_SUCCESS, "Failed to load ktx!");
+
+	PK::Rendering::Objects::Texture::GetDescirptorFromKTX(data.texture, &data.descriptor, &data.channels);
+}
+
+template<>
+void PK::Core::AssetImporters::Commit(ImportData<PK::Rendering::Objects::TextureXD>& data, Utilities::Ref<PK::Rendering::Objects::TextureXD>& texture)
 {
+	PK_PROFILE_SCOPE("AssetImporters::Commit<TextureXD>");
+
 	if (texture->m_graphicsId != 0)
 	{
 		glDeleteTextures(1, &texture->m_graphicsId);
 	}
 
-	auto wrapmode = PK::Rendering::Objects::Texture::GetWrapmodeFromString(filepath.c_str());
-
-	ktxTexture* kTexture;
 	KTX_error_code result;
 	GLenum target, glerror;
 
-	result = ktxTexture_CreateFromNamedFile(filepath.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture);
-
-	PK_CORE_ASSERT(result == KTX_SUCCESS, "Failed to load ktx!");
-
-	PK::Rendering::Objects::Texture::GetDescirptorFromKTX(kTexture, &texture->m_descriptor, &texture->m_channels);
+	texture->m_descriptor = data.descriptor;
+	texture->m_channels = data.channels;
 
 	glGenTextures(1, &texture->m_graphicsId);
 
-	result = ktxTexture_GLUpload(kTexture, &texture->m_graphicsId, &target, &glerror);
+	result = ktxTexture_GLUpload(data.texture, &texture->m_graphicsId, &target, &glerror);
 	
 	PK_CORE_ASSERT(result == KTX_SUCCESS, "Failed to upload ktx!");
 
 	glTextureParameteri(texture->m_graphicsId, GL_TEXTURE_MIN_FILTER, texture->m_descriptor.filtermin);
 	glTextureParameteri(texture->m_graphicsId, GL_TEXTURE_MAG_FILTER, texture->m_descriptor.filtermag);
-	texture->SetWrapMode(wrapmode, wrapmode, wrapmode);
+	texture->SetWrapMode(data.wrapmode, data.wrapmode, data.wrapmode);
 	texture->SetAnistropy(texture->m_descriptor.anistropy);
+	texture->m_memory.Set(0, data.texture->dataSize);
 
-	ktxTexture_Destroy(kTexture);
+	ktxTexture_Destroy(data.texture);
+	data.texture = nullptr;
+}
+
+template<>
+void PK::Core::AssetImporters::Import(const std::string& filepath, Utilities::Ref<PK::Rendering::Objects::TextureXD>& texture)
+{
+	ImportData<PK::Rendering::Objects::TextureXD> data;
+	Decode(filepath, data);
+	Commit(data, texture);
 }
\ No newline at end of file
@@ -2,13 +2,37 @@
 #include "Core/AssetDataBase.h"
 #include "Rendering/Objects/Texture.h"
 
+namespace PK::Rendering::Objects
+{
+	class TextureXD;
+}
+
+namespace PK::Core::AssetImporters
+{
+	template<>
+	struct ImportData<Rendering::Objects::TextureXD> : public NoCopy
+	{
+		static constexpr bool IsDecodable = true;
+		~ImportData() { if (texture != nullptr) { ktxTexture_Destroy(texture); } }
+
+		// Image data is read in the decode phase, the upload only copies it to the graphics context.
+		ktxTexture* texture = nullptr;
+		Rendering::Objects::TextureDescriptor descriptor;
+		GLenum channels = 0;
+		GLenum wrapmode = GL_CLAMP_TO_EDGE;
+
+		inline size_t GetSize() const { return texture != nullptr ? texture->dataSize : 0; }
+	};
+}
+
 namespace PK::Rendering::Objects
 {
 	using namespace Utilities;
 
 	class TextureXD : public Texture, public Asset
 	{
-		friend void AssetImporters::Import(const std::string& filepath, Ref<TextureXD>& texture);
+		friend void AssetImporters::Decode(const std::string& filepath, AssetImporters::ImportData<TextureXD>& data);
+		friend void AssetImporters::Commit(AssetImporters::ImportData<TextureXD>& data, Ref<TextureXD>& texture);
 	
 		public:
 			TextureXD();
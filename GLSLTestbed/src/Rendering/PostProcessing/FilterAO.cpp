@@ -2,6 +2,7 @@
 #include "FilterAO.h"
 #include "Rendering/GraphicsAPI.h"
 #include "Utilities/HashCache.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering::PostProcessing
 {
@@ -14,6 +15,8 @@ namespace PK::Rendering::PostProcessing
 
     FilterAO::FilterAO(AssetDatabase* assetDatabase, const ApplicationConfig* config) : FilterBase(assetDatabase->Find<Shader>("SH_VS_FilterAO"))
     {
+        Core::MemoryScope memoryScope("FilterAO");
+
         OnUpdateParameters(config);
         m_passKeywords[0] = StringHashID::StringToID("AO_PASS0");
         m_passKeywords[1] = StringHashID::StringToID("AO_PASS1");
@@ -2,6 +2,7 @@
 #include "FilterBloom.h"
 #include "Utilities/HashCache.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering::PostProcessing
 {
@@ -21,6 +22,8 @@ namespace PK::Rendering::PostProcessing
 
     FilterBloom::FilterBloom(AssetDatabase* assetDatabase, const ApplicationConfig* config) : FilterBase(assetDatabase->Find<Shader>("SH_VS_FilterBloom"))
     {
+        Core::MemoryScope memoryScope("FilterBloom");
+
         auto lensDirtTexture = assetDatabase->Load<TextureXD>(config->FileBloomDirt.value.c_str());
         m_computeHistogram = assetDatabase->Find<Shader>("CS_LuminanceHistogram");
         m_computeFilmgrain = assetDatabase->Find<Shader>("SH_VS_FilmGrain");
@@ -2,11 +2,14 @@
 #include "FilterDof.h"
 #include "Utilities/HashCache.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering::PostProcessing
 {
     FilterDof::FilterDof(AssetDatabase* assetDatabase, const ApplicationConfig* config) : FilterBase(assetDatabase->Find<Shader>("SH_VS_DOFBlur"))
     {
+        Core::MemoryScope memoryScope("FilterDof");
+
         m_passKeywords[0] = StringHashID::StringToID("PASS_PREFILTER");
         m_passKeywords[1] = StringHashID::StringToID("PASS_DISKBLUR");
 
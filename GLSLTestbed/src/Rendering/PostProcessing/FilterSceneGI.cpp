@@ -2,11 +2,14 @@
 #include "FilterSceneGI.h"
 #include "Rendering/GraphicsAPI.h"
 #include "ECS/Contextual/EntityViews/EntityViews.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering::PostProcessing
 {
     FilterSceneGI::FilterSceneGI(AssetDatabase* assetDatabase, ECS::EntityDatabase* entityDb, const ApplicationConfig* config) : FilterBase(assetDatabase->Find<Shader>("CS_SceneGI_Bake_Checkerboard"))
     {
+        Core::MemoryScope memoryScope("FilterSceneGI");
+
         m_shaderVoxelize = assetDatabase->Find<Shader>("SH_WS_SceneGI_Meta_White");
         m_computeMipmap = assetDatabase->Find<Shader>("CS_SceneGIMipmap");
 
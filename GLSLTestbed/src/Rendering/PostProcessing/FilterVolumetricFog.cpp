@@ -2,6 +2,7 @@
 #include "FilterVolumetricFog.h"
 #include "Utilities/HashCache.h"
 #include "Rendering/GraphicsAPI.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering::PostProcessing
 {
@@ -11,6 +12,8 @@ namespace PK::Rendering::PostProcessing
 
     FilterVolumetricFog::FilterVolumetricFog(AssetDatabase* assetDatabase, const ApplicationConfig* config) : FilterBase(assetDatabase->Find<Shader>("SH_VS_VolumeFogComposite"))
     {
+        Core::MemoryScope memoryScope("FilterVolumetricFog");
+
         TextureDescriptor descriptor;
         descriptor.dimension = GL_TEXTURE_3D;
         descriptor.colorFormat = GL_RGBA16F;
@@ -3,10 +3,11 @@
 #include "Core/Application.h"
 #include "Utilities/HashCache.h"
 #include "Utilities/Utilities.h"
+#include "Core/Profiler.h"
 #include "Rendering/RenderPipeline.h"
 #include "Rendering/GraphicsAPI.h"
 #include "Rendering/MeshUtility.h"
-#include "ECS/Contextual/EntityViews/EntityViews.h"
+#include "Core/MemoryTracker.h"
 
 namespace PK::Rendering
 {
@@ -26,21 +27,60 @@ namespace PK::Rendering
 		properties->SetFloat(hashCache->pk_SceneOEM_Exposure, exposure);
 	}
 	
-	static void UpdateDynamicBatches(ECS::EntityDatabase* entityDb, Culling::VisibilityCache& viscache, Batching::DynamicBatchCollection& batches)
+	static void UpdateDynamicBatches(const RenderSnapshot* snapshot, Culling::VisibilityCache& viscache, const Batching::StaticBatchCollection& staticBatches, const std::unordered_set<uint>& staticEntities, Batching::DynamicBatchCollection& batches, bool cullSubmeshes, Culling::SubmeshCullingStatistics& statistics)
 	{
 		Batching::ResetCollection(&batches);
+		statistics = {};
 	
+		FrustumPlanes frustum;
+		Functions::ExtractFrustrumPlanes(snapshot->viewProjection, &frustum, true);
+
 		auto cullingResults = viscache.GetList(Culling::CullingGroup::CameraFrustum, (int)ECS::Components::RenderHandleFlags::Renderer);
 	
 		for (uint i = 0; i < cullingResults.count; ++i)
 		{
-			auto* view = entityDb->Query<ECS::EntityViews::MeshRenderable>(ECS::EGID(cullingResults[i], (uint)ECS::ENTITY_GROUPS::ACTIVE));
-			auto* materials = &view->materials->sharedMaterials;
-			auto mesh = view->mesh->sharedMesh;
+			auto& renderable = snapshot->renderables.at(cullingResults[i]);
+
+			if (staticEntities.count(renderable.GID.entityID()) > 0)
+			{
+				continue;
+			}
+
+			auto materials = snapshot->materials.data() + renderable.materialFirst;
+			auto pixelsPerUnit = snapshot->GetPixelsPerUnit(renderable);
+			// Submeshes of renderables that are entirely inside the frustum are visible as well.
+			auto testSubmeshes = cullSubmeshes && renderable.isCullable && renderable.submeshBoundsCount > 1 && !Functions::ContainsPlanesAABB(frustum.planes, 6, renderable.worldAABB);
+			statistics.visibleRenderables++;
+			statistics.submeshes += renderable.materialCount;
+			statistics.partialRenderables += testSubmeshes ? 1 : 0;
 	
-			for (auto i = 0; i < materials->size(); ++i)
+			for (auto i = 0u; i < renderable.materialCount; ++i)
+			{
+				if (testSubmeshes && i < renderable.submeshBoundsCount)
+				{
+					statistics.testedSubmeshes++;
+
+					if (!Functions::IntersectPlanesAABB(frustum.planes, 6, snapshot->submeshBounds.at(renderable.submeshBoundsFirst + i)))
+					{
+						statistics.culledSubmeshes++;
+						continue;
+					}
+				}
+
+				auto lod = renderable.mesh->SelectLod(i, pixelsPerUnit, snapshot->lodPixelError);
+				auto& attributes = materials[i]->GetShader()->GetFixedStateAttributes();
+				auto cullBackfaces = attributes.CullEnabled && attributes.CullMode == GL_BACK;
+				Batching::QueueDraw(&batches, renderable.mesh, renderable.mesh->GetLodSubmesh(i, lod), materials[i], { &renderable.localToWorld, 0.0f }, snapshot->viewProjection, cullBackfaces);
+			}
+		}
+
+		for (auto& batch : staticBatches.Batches)
+		{
+			if (Functions::IntersectPlanesAABB(frustum.planes, 6, batch.bounds))
 			{
-				Batching::QueueDraw(&batches, mesh, i, materials->at(i), { &view->transform->localToWorld, 0.0f });
+				auto& attributes = batch.material->GetShader()->GetFixedStateAttributes();
+				auto cullBackfaces = attributes.CullEnabled && attributes.CullMode == GL_BACK;
+				Batching::QueueDraw(&batches, batch.mesh.get(), 0, batch.material, { &staticBatches.LocalToWorld, 0.0f }, snapshot->viewProjection, cullBackfaces);
 			}
 		}
 	
@@ -55,6 +95,8 @@ namespace PK::Rendering
 		m_filterSceneGi(assetDatabase, entityDb, config),
 		m_lightsManager(assetDatabase, config)
 	{
+		Core::MemoryScope memoryScope("RenderPipeline");
+
 		m_entityDb = entityDb;
 		m_context.BlitQuad = MeshUtility::GetQuad2D({ -1.0f,-1.0f }, { 1.0f, 1.0f });
 		m_context.BlitShader = assetDatabase->Find<Shader>("SH_VS_Internal_Blit");
@@ -66,6 +108,9 @@ namespace PK::Rendering
 	
 		m_enableLightingDebug = config->EnableLightingDebug;
 		m_logframerate = config->EnableFrameRateLog;
+		m_enablePipelining = config->EnablePipelinedRendering;
+		m_lodPixelError = config->MeshLodPixelError;
+		m_enableStaticBatching = config->EnableStaticBatching;
 
 		auto renderTargetDescriptor = RenderTextureDescriptor();
 		renderTargetDescriptor.colorFormats = { GL_RGBA16F };
@@ -135,6 +180,10 @@ namespace PK::Rendering
 		m_constantsPerFrame->SetFloat4(hashCache->pk_CosTime, { cosf(time / 8), cosf(time / 4), cosf(time / 2), cosf(time) });
 		m_constantsPerFrame->SetFloat4(hashCache->pk_DeltaTime, { deltatime, 1.0f / deltatime, smoothdeltatime, 1.0f / smoothdeltatime });
 
+		auto& frameTime = m_submeshCullingFrameTimes[m_enableSubmeshCulling ? 1 : 0];
+		frameTime.seconds += timeRef->GetUnscaledDeltaTime();
+		frameTime.frames++;
+
 		if (m_logframerate)
 		{
 			timeRef->LogFrameRate();
@@ -153,10 +202,25 @@ namespace PK::Rendering
 		switch (step)
 		{
 			case UpdateStep::OpenFrame: GraphicsAPI::OpenContext(&m_context); break;
+			case UpdateStep::UpdateEngines: if (m_enablePipelining) { OnExtractSnapshot(); } break;
 			case UpdateStep::PreRender: OnPreRender(); break;
 			case UpdateStep::Render: OnRender(); break;
 			case UpdateStep::PostRender: GraphicsAPI::EndWindow(); break;
-			case UpdateStep::CloseFrame: GraphicsAPI::CloseContext(); break;
+			case UpdateStep::CloseFrame: GraphicsAPI::CloseContext(); m_isSnapshotExtracted = false; break;
+		}
+	}
+
+	void RenderPipeline::GetStepAccess(int condition, PK::ECS::StepAccess* access) const
+	{
+		// Snapshot extraction reads the scene, the remaining steps only access the snapshot & the graphics context.
+		if (condition == (int)UpdateStep::UpdateEngines || condition == (int)UpdateStep::PreRender)
+		{
+			access->Read<ECS::Components::Transform>()
+				.Read<ECS::Components::Bounds>()
+				.Read<ECS::Components::RenderableHandle>()
+				.Read<ECS::Components::MeshReference>()
+				.Read<ECS::Components::Materials>()
+				.Read<ECS::Components::Light>();
 		}
 	}
 
@@ -164,6 +228,14 @@ namespace PK::Rendering
 	{
 		m_enableLightingDebug = token->asset->EnableLightingDebug;
 		m_logframerate = token->asset->EnableFrameRateLog;
+		m_lodPixelError = token->asset->MeshLodPixelError;
+		m_enableStaticBatching = token->asset->EnableStaticBatching;
+
+		if (!m_enableStaticBatching)
+		{
+			m_staticBatches = {};
+			m_staticEntities.clear();
+		}
 
 		m_OEMTexture = token->assetDatabase->Load<TextureXD>(token->asset->FileBackgroundTexture.value.c_str());
 		m_OEMExposure = token->asset->BackgroundExposure.value;
@@ -172,13 +244,71 @@ namespace PK::Rendering
 		m_filterDof.OnUpdateParameters(token->asset);
 	}
 	
+	// In pipelined mode this runs at the start of the engine update, before its worker steps are dispatched.
+	// The scene is then rendered from the state before the update while the update runs on workers.
+	void RenderPipeline::OnExtractSnapshot()
+	{
+		PK_PROFILE_FUNCTION();
+
+		m_snapshot.Clear();
+		ExtractRenderSnapshot(m_entityDb, m_context.ShaderProperties, &m_snapshot);
+		m_snapshot.lodPixelError = m_lodPixelError;
+		m_isSnapshotExtracted = true;
+	}
+
+	// Static renderables are baked once their meshes are resident. Only the camera passes use the batches, shadows are drawn per renderable.
+	void RenderPipeline::BakeStaticBatches(const RenderSnapshot* snapshot)
+	{
+		PK_PROFILE_FUNCTION();
+
+		const auto staticMask = (ushort)(ECS::Components::RenderHandleFlags::Renderer | ECS::Components::RenderHandleFlags::Static);
+		std::vector<Batching::StaticDrawcall> drawcalls;
+		std::vector<uint> entities;
+
+		for (auto& renderable : snapshot->renderables)
+		{
+			if (((ushort)renderable.flags & staticMask) != staticMask)
+			{
+				continue;
+			}
+
+			for (auto i = 0u; i < renderable.materialCount; ++i)
+			{
+				drawcalls.push_back({ renderable.mesh, renderable.mesh->GetLodSubmesh(i, 0), snapshot->materials.at(renderable.materialFirst + i), renderable.localToWorld });
+				entities.push_back(renderable.GID.entityID());
+			}
+		}
+
+		auto isBaked = std::make_unique<bool[]>(drawcalls.size());
+		Batching::BakeStaticBatches(&m_staticBatches, drawcalls.data(), (uint)drawcalls.size(), isBaked.get());
+		m_staticEntities.clear();
+
+		// Drawcalls of an entity share a mesh, they are either all baked or none of them is.
+		for (auto i = 0u; i < drawcalls.size(); ++i)
+		{
+			if (isBaked[i])
+			{
+				m_staticEntities.insert(entities.at(i));
+			}
+		}
+
+		PK_CORE_LOG("Baked %i static renderables into %i batches.", (uint)m_staticEntities.size(), (uint)m_staticBatches.Batches.size());
+	}
+	
 	void RenderPipeline::OnPreRender()
 	{
+		PK_PROFILE_FUNCTION();
+
+		if (!m_isSnapshotExtracted)
+		{
+			OnExtractSnapshot();
+		}
+
+		auto* snapshot = &m_snapshot;
+
 		GraphicsAPI::StartWindow();
 		GraphicsAPI::ResetResourceBindings();
 		auto resolution = GraphicsAPI::GetActiveWindowResolution();
-		const float4x4& inverseViewProjection = *m_context.ShaderProperties.GetPropertyPtr<float4x4>(HashCache::Get()->pk_MATRIX_I_VP);
-		const float4 projParams = *m_context.ShaderProperties.GetPropertyPtr<float4>(HashCache::Get()->pk_ProjectionParams);
 
 		SetOEMTextures(m_OEMTexture, m_constantsPerFrame, 1, m_OEMExposure);
 
@@ -190,7 +320,7 @@ namespace PK::Rendering
 			m_constantsPerFrame->SetResourceHandle(HashCache::Get()->pk_ScreenNormals, m_GeometryBufferTarget->GetColorBuffer(0)->GetBindlessHandleResident());
 		}
 
-		auto cascadeZSplits = m_lightsManager.GetCascadeZSplits(projParams.x, projParams.y);
+		auto cascadeZSplits = m_lightsManager.GetCascadeZSplits(snapshot->zNear, snapshot->zFar);
 		m_constantsPerFrame->SetFloat4(HashCache::Get()->pk_ShadowCascadeZSplits, reinterpret_cast<float4*>(cascadeZSplits.planes));
 
 		m_filterAO.OnPreRender(m_GeometryBufferTarget.get());
@@ -202,28 +332,34 @@ namespace PK::Rendering
 		m_constantsPerFrame->FlushBuffer();
 		GraphicsAPI::SetGlobalConstantBuffer(HashCache::Get()->pk_PerFrameConstants, m_constantsPerFrame->GetGraphicsID());
 	
-		Culling::ResetEntityVisibilities(m_entityDb);
 		m_visibilityCache.Reset();
 		
-		Culling::BuildVisibilityCacheFrustum(m_entityDb, 
+		Culling::BuildVisibilityCacheFrustum(snapshot, 
 			&m_visibilityCache, 
-			GraphicsAPI::GetActiveViewProjectionMatrix(), 
+			snapshot->viewProjection, 
 			Culling::CullingGroup::CameraFrustum, 
 			(ushort)(ECS::Components::RenderHandleFlags::Renderer | ECS::Components::RenderHandleFlags::Light));
 	
-		UpdateDynamicBatches(m_entityDb, m_visibilityCache, m_dynamicBatches);
+		if (m_enableStaticBatching && !m_staticBatches.IsBaked && snapshot->pendingStaticCount == 0)
+		{
+			BakeStaticBatches(snapshot);
+		}
+
+		UpdateDynamicBatches(snapshot, m_visibilityCache, m_staticBatches, m_staticEntities, m_dynamicBatches, m_enableSubmeshCulling, m_submeshCulling);
 
 		m_lightsManager.Preprocess(
-			m_entityDb, 
+			snapshot, 
 			m_visibilityCache.GetList(Culling::CullingGroup::CameraFrustum, (int)ECS::Components::RenderHandleFlags::Light), 
 			resolution, 
-			inverseViewProjection, 
-			projParams.x, 
-			projParams.y);
+			snapshot->inverseViewProjection, 
+			snapshot->zNear, 
+			snapshot->zFar);
 	}
 	
 	void RenderPipeline::OnRender()
 	{
+		PK_PROFILE_FUNCTION();
+
 		GraphicsAPI::SetRenderTarget(m_GeometryBufferTarget.get());
 		GraphicsAPI::Clear(PK_COLOR_CLEAR, 1.0f, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -17,11 +17,13 @@
 #include "Rendering/PostProcessing/FilterDof.h"
 #include "Rendering/PostProcessing/FilterSceneGI.h"
 #include "Rendering/LightsManager.h"
+#include "Rendering/RenderSnapshot.h"
 
 namespace PK::Rendering
 {
     class RenderPipeline : public IService, 
                            public PK::ECS::ISimpleStep, 
+                           public PK::ECS::IStepAccess, 
                            public PK::ECS::IStep<Time>, 
                            public PK::ECS::IStep<Input>, 
                            public PK::ECS::IStep<AssetImportToken<ApplicationConfig>>
@@ -33,18 +35,39 @@ namespace PK::Rendering
             void Step(Input* token) override;
             void Step(int condition) override;
             void Step(AssetImportToken<ApplicationConfig>* token) override;
+            void GetStepAccess(int condition, PK::ECS::StepAccess* access) const override;
+
+            inline const Culling::SubmeshCullingStatistics& GetSubmeshCullingStatistics() const { return m_submeshCulling; }
+            inline bool IsSubmeshCulling() const { return m_enableSubmeshCulling; }
+            // Frame times are averaged per mode from the last switch to it, so that both can be compared in the same scene.
+            inline void SetSubmeshCulling(bool value) { m_submeshCullingFrameTimes[value ? 1 : 0] = {}; m_enableSubmeshCulling = value; }
+            inline const Culling::SubmeshCullingFrameTime& GetSubmeshCullingFrameTime(bool enabled) const { return m_submeshCullingFrameTimes[enabled ? 1 : 0]; }
     
         private:
+            void OnExtractSnapshot();
             void OnPreRender();
             void OnRender();
+            void BakeStaticBatches(const RenderSnapshot* snapshot);
     
             bool m_enableLightingDebug;
             bool m_logframerate;
+            bool m_enablePipelining;
+            float m_lodPixelError;
+            bool m_enableStaticBatching;
 
             GraphicsContext m_context;  
             PK::ECS::EntityDatabase* m_entityDb;
+            // Only one frame is extracted & rendered at a time, the storage is reused between frames.
+            RenderSnapshot m_snapshot;
+            bool m_isSnapshotExtracted = false;
             Culling::VisibilityCache m_visibilityCache;
+            Culling::SubmeshCullingStatistics m_submeshCulling;
+            bool m_enableSubmeshCulling = true;
+            Culling::SubmeshCullingFrameTime m_submeshCullingFrameTimes[2];
             Batching::DynamicBatchCollection m_dynamicBatches;
+            Batching::StaticBatchCollection m_staticBatches;
+            // Entity ids of the renderables drawn by the static batches.
+            std::unordered_set<uint> m_staticEntities;
             LightsManager m_lightsManager;
             PostProcessing::FilterBloom m_filterBloom;
             PostProcessing::FilterAO m_filterAO;
@@ -0,0 +1,93 @@
+#include "PrecompiledHeader.h"
+#include "Utilities/HashCache.h"
+#include "Core/Application.h"
+#include "Rendering/RenderSnapshot.h"
+#include "ECS/Contextual/EntityViews/EntityViews.h"
+
+namespace PK::Rendering
+{
+	using namespace PK::ECS::Components;
+
+	void RenderSnapshot::Clear()
+	{
+		renderables.clear();
+		lights.clear();
+		materials.clear();
+		submeshBounds.clear();
+		pendingStaticCount = 0;
+	}
+
+	float RenderSnapshot::GetPixelsPerUnit(const SnapshotRenderable& renderable) const
+	{
+		auto& matrix = renderable.localToWorld;
+		auto scale = glm::max(glm::length(float3(matrix[0])), glm::max(glm::length(float3(matrix[1])), glm::length(float3(matrix[2]))));
+		auto depth = (viewProjection * float4(renderable.worldAABB.GetCenter(), 1.0f)).w;
+		return lodScale * scale / glm::max(depth, zNear);
+	}
+
+	void ExtractRenderSnapshot(ECS::EntityDatabase* entityDb, const ShaderPropertyBlock& globals, RenderSnapshot* snapshot)
+	{
+		auto* hashCache = HashCache::Get();
+		auto projectionParams = *globals.GetPropertyPtr<float4>(hashCache->pk_ProjectionParams);
+		snapshot->viewProjection = *globals.GetPropertyPtr<float4x4>(hashCache->pk_MATRIX_VP);
+		snapshot->inverseViewProjection = *globals.GetPropertyPtr<float4x4>(hashCache->pk_MATRIX_I_VP);
+		snapshot->zNear = projectionParams.x;
+		snapshot->zFar = projectionParams.y;
+		snapshot->lodScale = (*globals.GetPropertyPtr<float4x4>(hashCache->pk_MATRIX_P))[1][1] * Application::GetWindow()->GetHeight() * 0.5f;
+
+		auto cullables = entityDb->Query<ECS::EntityViews::BaseRenderable>((int)ECS::ENTITY_GROUPS::ACTIVE);
+		snapshot->renderables.reserve(cullables.count);
+
+		for (auto i = 0; i < cullables.count; ++i)
+		{
+			auto cullable = &cullables[i];
+
+			SnapshotRenderable renderable;
+			renderable.GID = cullable->GID;
+			renderable.worldAABB = cullable->bounds->worldAABB;
+			renderable.flags = cullable->handle->flags;
+			renderable.isCullable = cullable->handle->isCullable;
+
+			if ((ushort)renderable.flags & (ushort)RenderHandleFlags::Renderer)
+			{
+				auto* view = entityDb->Query<ECS::EntityViews::MeshRenderable>(cullable->GID);
+				renderable.localToWorld = view->transform->localToWorld;
+				renderable.mesh = view->mesh->sharedMesh.Get();
+				renderable.materialFirst = (uint)snapshot->materials.size();
+				renderable.materialCount = (uint)view->materials->sharedMaterials.size();
+				snapshot->materials.insert(snapshot->materials.end(), view->materials->sharedMaterials.begin(), view->materials->sharedMaterials.end());
+				renderable.submeshBoundsFirst = (uint)snapshot->submeshBounds.size();
+				renderable.submeshBoundsCount = (uint)cullable->bounds->submeshWorldAABBs.size();
+				snapshot->submeshBounds.insert(snapshot->submeshBounds.end(), cullable->bounds->submeshWorldAABBs.begin(), cullable->bounds->submeshWorldAABBs.end());
+
+				if (((ushort)renderable.flags & (ushort)RenderHandleFlags::Static) && !view->mesh->sharedMesh.IsResident())
+				{
+					snapshot->pendingStaticCount++;
+				}
+			}
+
+			if ((ushort)renderable.flags & (ushort)RenderHandleFlags::Light)
+			{
+				auto* view = entityDb->Query<ECS::EntityViews::LightRenderable>(cullable->GID);
+
+				SnapshotLight light;
+				light.GID = cullable->GID;
+				light.worldAABB = cullable->bounds->worldAABB;
+				light.color = view->light->color;
+				light.radius = view->light->radius;
+				light.angle = view->light->angle;
+				light.castShadows = view->light->castShadows;
+				light.cookie = view->light->cookie;
+				light.lightType = view->light->lightType;
+				light.position = view->transform->position;
+				light.rotation = view->transform->rotation;
+				light.worldToLocal = view->transform->worldToLocal;
+
+				renderable.light = (uint)snapshot->lights.size();
+				snapshot->lights.push_back(light);
+			}
+
+			snapshot->renderables.push_back(renderable);
+		}
+	}
+}
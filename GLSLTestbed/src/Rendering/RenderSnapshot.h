@@ -0,0 +1,71 @@
+#pragma once
+#include "ECS/EntityDatabase.h"
+#include "ECS/Contextual/Components/Components.h"
+#include "Rendering/Structs/ShaderPropertyBlock.h"
+#include <hlslmath.h>
+
+namespace PK::Rendering
+{
+    using namespace PK::Math;
+    using namespace PK::Rendering::Objects;
+    using namespace PK::Rendering::Structs;
+
+    struct SnapshotRenderable
+    {
+        ECS::EGID GID;
+        BoundingBox worldAABB;
+        ECS::Components::RenderHandleFlags flags = ECS::Components::RenderHandleFlags::Renderer;
+        bool isCullable = true;
+        float4x4 localToWorld = PK_FLOAT4X4_IDENTITY;
+        Mesh* mesh = nullptr;
+        uint materialFirst = 0;
+        uint materialCount = 0;
+        // Range in the snapshot submesh bounds, empty for meshes without per submesh bounds.
+        uint submeshBoundsFirst = 0;
+        uint submeshBoundsCount = 0;
+        // Index into the snapshot lights, 0xFFFFFFFF for non light renderables.
+        uint light = 0xFFFFFFFF;
+    };
+
+    struct SnapshotLight
+    {
+        ECS::EGID GID;
+        BoundingBox worldAABB;
+        color color = PK_COLOR_WHITE;
+        float radius = 1.0f;
+        float angle = 45.0f;
+        bool castShadows = true;
+        LightCookie cookie = LightCookie::NoCookie;
+        LightType lightType = LightType::Point;
+        float3 position = PK_FLOAT3_ZERO;
+        quaternion rotation = PK_QUATERNION_IDENTITY;
+        float4x4 worldToLocal = PK_FLOAT4X4_IDENTITY;
+    };
+
+    // Copy of the scene state a frame is rendered from, extracted before the engines update the scene.
+    // The render steps only read the snapshot, so they can run while the engine update of the same frame executes on workers.
+    struct RenderSnapshot
+    {
+        float4x4 viewProjection = PK_FLOAT4X4_IDENTITY;
+        float4x4 inverseViewProjection = PK_FLOAT4X4_IDENTITY;
+        float zNear = 0.0f;
+        float zFar = 0.0f;
+        // Screen pixels covered by one world space unit at a view depth of one.
+        float lodScale = 0.0f;
+        // Largest screen space error of a selected mesh lod in pixels.
+        float lodPixelError = 1.0f;
+        std::vector<SnapshotRenderable> renderables;
+        std::vector<SnapshotLight> lights;
+        std::vector<Material*> materials;
+        std::vector<BoundingBox> submeshBounds;
+        // Static renderables that still use a placeholder mesh.
+        uint pendingStaticCount = 0;
+
+        void Clear();
+        // Screen pixels covered by one object space unit at the center of a renderable, used to select mesh lods.
+        float GetPixelsPerUnit(const SnapshotRenderable& renderable) const;
+    };
+
+    // Copies renderables, lights & the camera set in the global properties. Reads the entity database, call only while the simulation is idle.
+    void ExtractRenderSnapshot(ECS::EntityDatabase* entityDb, const ShaderPropertyBlock& globals, RenderSnapshot* snapshot);
+}
@@ -0,0 +1,188 @@
+#include "PrecompiledHeader.h"
+#include "Rendering/ShaderDirectives.h"
+#include "Utilities/StringUtilities.h"
+
+namespace PK::Rendering::ShaderDirectives
+{
+    enum class Directive
+    {
+        None,
+        MultiCompile,
+        ZWrite,
+        ZTest,
+        Blend,
+        ColorMask,
+        Cull,
+        Version,
+        Program
+    };
+
+    struct Token
+    {
+        const char* text;
+        size_t length;
+        Directive directive;
+    };
+
+    // The value of a directive is the rest of the line after its token.
+    const Token Tokens[] =
+    {
+        { "#multi_compile ", 15, Directive::MultiCompile },
+        { "#ZWrite ", 8, Directive::ZWrite },
+        { "#ZTest ", 7, Directive::ZTest },
+        { "#Blend ", 7, Directive::Blend },
+        { "#ColorMask ", 11, Directive::ColorMask },
+        { "#Cull ", 6, Directive::Cull },
+        { "#version ", 9, Directive::Version },
+        { "#pragma PROGRAM_", 16, Directive::Program },
+    };
+
+    const std::string InstancedPropertyToken = "PK_INSTANCED_PROPERTY";
+
+    // Directives can appear anywhere on a line, only the first one of a line is collected.
+    static Directive FindDirective(const std::string& source, size_t begin, size_t end, size_t& position, size_t& valueOffset)
+    {
+        auto data = source.data();
+
+        for (auto c = reinterpret_cast<const char*>(memchr(data + begin, '#', end - begin)); c != nullptr; c = reinterpret_cast<const char*>(memchr(c + 1, '#', data + end - c - 1)))
+        {
+            position = c - data;
+
+            for (auto& token : Tokens)
+            {
+                if (end - position >= token.length && source.compare(position, token.length, token.text) == 0)
+                {
+                    valueOffset = position + token.length;
+                    return token.directive;
+                }
+            }
+        }
+
+        return Directive::None;
+    }
+
+    static void ReadInstancedProperty(const std::string& source, size_t begin, size_t end, Header& header)
+    {
+        auto position = std::string_view(source.data() + begin, end - begin).find(InstancedPropertyToken);
+
+        if (position == std::string_view::npos)
+        {
+            return;
+        }
+
+        auto values = Utilities::String::Split(source.substr(begin + position, end - begin - position), " ;\n\r");
+
+        if (values.size() == 3)
+        {
+            header.instancedProperties.push_back({ values.at(1), values.at(2) });
+        }
+    }
+
+    static void AppendSegment(std::vector<Segment>& segments, size_t begin, size_t end)
+    {
+        if (end > begin)
+        {
+            segments.push_back({ begin, end - begin });
+        }
+    }
+
+    static void SetFirstValue(std::string& target, const std::string& value)
+    {
+        if (target.empty())
+        {
+            target = value;
+        }
+    }
+
+    void Lex(const std::string& source, Header& header)
+    {
+        header = Header();
+
+        auto segments = &header.sharedSegments;
+        auto version = Segment();
+        size_t segmentBegin = 0;
+        size_t lineBegin = 0;
+
+        while (lineBegin < source.size())
+        {
+            auto newline = reinterpret_cast<const char*>(memchr(source.data() + lineBegin, '\n', source.size() - lineBegin));
+            auto lineEnd = newline != nullptr ? (size_t)(newline - source.data()) : source.size();
+            size_t position = 0;
+            size_t valueOffset = 0;
+            auto directive = FindDirective(source, lineBegin, lineEnd, position, valueOffset);
+
+            if (directive == Directive::None)
+            {
+                ReadInstancedProperty(source, lineBegin, lineEnd, header);
+                lineBegin = lineEnd + 1;
+                continue;
+            }
+
+            // The directive & the empty lines after it are skipped.
+            auto valueEnd = std::min(source.find_first_of("\r\n", valueOffset), source.size());
+            auto nextLine = std::min(source.find_first_not_of("\r\n", valueEnd), source.size());
+            auto value = source.substr(valueOffset, valueEnd - valueOffset);
+            AppendSegment(*segments, segmentBegin, position);
+            segmentBegin = nextLine;
+            lineBegin = nextLine;
+
+            switch (directive)
+            {
+                case Directive::MultiCompile: header.multiCompiles.push_back(Utilities::String::Split(value, " ")); break;
+                case Directive::ZWrite: SetFirstValue(header.zwrite, value); break;
+                case Directive::ZTest: SetFirstValue(header.ztest, value); break;
+                case Directive::Blend: SetFirstValue(header.blend, value); break;
+                case Directive::ColorMask: SetFirstValue(header.colorMask, value); break;
+                case Directive::Cull: SetFirstValue(header.cull, value); break;
+                case Directive::Version:
+                {
+                    auto& target = header.programs.empty() ? version : header.programs.back().version;
+
+                    if (target.count == 0)
+                    {
+                        target = { position, nextLine - position };
+                    }
+                }
+                break;
+                case Directive::Program:
+                {
+                    // Programs start with the version of the shared code.
+                    header.programs.push_back({ value, version });
+                    segments = &header.programs.back().segments;
+                }
+                break;
+                default: break;
+            }
+        }
+
+        AppendSegment(*segments, segmentBegin, source.size());
+    }
+
+    void GetProgramText(const std::string& source, const Header& header, const Program& program, std::string& text)
+    {
+        size_t size = 0;
+
+        for (auto& segment : header.sharedSegments)
+        {
+            size += segment.count;
+        }
+
+        for (auto& segment : program.segments)
+        {
+            size += segment.count;
+        }
+
+        text.clear();
+        text.reserve(size);
+
+        for (auto& segment : header.sharedSegments)
+        {
+            text.append(source, segment.offset, segment.count);
+        }
+
+        for (auto& segment : program.segments)
+        {
+            text.append(source, segment.offset, segment.count);
+        }
+    }
+}
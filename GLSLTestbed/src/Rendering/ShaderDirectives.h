@@ -0,0 +1,44 @@
+#pragma once
+#include "PrecompiledHeader.h"
+
+namespace PK::Rendering::ShaderDirectives
+{
+    // A range of the source that isn't part of a directive.
+    struct Segment
+    {
+        size_t offset = 0;
+        size_t count = 0;
+    };
+
+    struct Program
+    {
+        // Name following "#pragma PROGRAM_", for example VERTEX.
+        std::string type;
+        // Version directive of the shared code, or the first one of the program when the shared code doesn't declare one. Empty when neither does.
+        Segment version;
+        std::vector<Segment> segments;
+    };
+
+    struct Header
+    {
+        // Keywords of each #multi_compile directive in declaration order, "_" for none.
+        std::vector<std::vector<std::string>> multiCompiles;
+        // Values of the first declaration of each state directive, empty when not declared.
+        std::string zwrite;
+        std::string ztest;
+        std::string blend;
+        std::string colorMask;
+        std::string cull;
+        // Type & name of the PK_INSTANCED_PROPERTY declarations.
+        std::vector<std::pair<std::string, std::string>> instancedProperties;
+        // Code before the first program, shared by all programs.
+        std::vector<Segment> sharedSegments;
+        std::vector<Program> programs;
+    };
+
+    // Collects the directives in one pass over the source lines. Directive lines & the empty lines that follow them are excluded from the segments.
+    // Doesn't depend on a graphics context, validating the values is left to the caller.
+    void Lex(const std::string& source, Header& header);
+    // Shared code followed by the code of the program, without version directives.
+    void GetProgramText(const std::string& source, const Header& header, const Program& program, std::string& text);
+}
@@ -0,0 +1,243 @@
+#include "PrecompiledHeader.h"
+#include "Rendering/ShaderVariantManifest.h"
+#include "Utilities/StringHashID.h"
+#include "Utilities/StringUtilities.h"
+#include "Utilities/Log.h"
+#include <yaml-cpp/yaml.h>
+#include <filesystem>
+#include <fstream>
+
+namespace PK::Rendering
+{
+    using namespace PK::Utilities;
+
+    static uint32_t GetDirectiveStride(const ShaderVariantMap& variantMap, uint32_t directive)
+    {
+        return variantMap.directives[directive] & 0xFFFFFF;
+    }
+
+    static uint32_t GetDirectiveSize(const ShaderVariantMap& variantMap, uint32_t directive)
+    {
+        auto next = directive + 1u < variantMap.directivecount ? GetDirectiveStride(variantMap, directive + 1u) : variantMap.variantcount;
+        return next / GetDirectiveStride(variantMap, directive);
+    }
+
+    ShaderVariantManifest::ShaderVariantManifest(AssetDatabase* assetDatabase, const std::string& filepath, bool strip) :
+        m_assetDatabase(assetDatabase),
+        m_filepath(filepath),
+        m_strip(strip)
+    {
+        if (!std::filesystem::exists(m_filepath))
+        {
+            if (m_strip)
+            {
+                PK_CORE_LOG_WARNING("Shader variant manifest not found at: %s, all variants are compiled on demand.", m_filepath.c_str());
+            }
+
+            return;
+        }
+
+        YAML::Node root = YAML::LoadFile(m_filepath);
+        auto shaders = root["ShaderVariantManifest"];
+
+        if (!shaders)
+        {
+            return;
+        }
+
+        for (auto shader : shaders)
+        {
+            auto& variants = m_variants[shader.first.as<std::string>()];
+
+            for (auto variant : shader.second)
+            {
+                variants.insert(variant.as<std::string>());
+            }
+        }
+    }
+
+    bool ShaderVariantManifest::GetVariantIndices(const std::string& shaderpath, const ShaderVariantMap& variantMap, std::vector<uint32_t>& indices) const
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        auto shader = m_variants.find(shaderpath);
+
+        if (shader == m_variants.end())
+        {
+            return false;
+        }
+
+        for (auto& variant : shader->second)
+        {
+            auto keywords = String::Split(variant, " ");
+            uint32_t index = 0u;
+            auto isValid = true;
+
+            for (auto& keyword : keywords)
+            {
+                if (keyword == "_")
+                {
+                    continue;
+                }
+
+                auto kv = variantMap.keywords.find(StringHashID::StringToID(keyword));
+
+                if (kv == variantMap.keywords.end())
+                {
+                    isValid = false;
+                    break;
+                }
+
+                index += GetDirectiveStride(variantMap, kv->second >> 4) * (kv->second & 0xFu);
+            }
+
+            if (isValid)
+            {
+                indices.push_back(index);
+            }
+        }
+
+        return true;
+    }
+
+    void ShaderVariantManifest::RecordVariant(const std::string& shaderpath, const ShaderVariantMap& variantMap, uint32_t index, bool isMiss)
+    {
+        auto name = GetVariantName(variantMap, index);
+
+        if (isMiss)
+        {
+            PK_CORE_LOG_WARNING("Shader variant not in manifest: %s [%s]", shaderpath.c_str(), name.c_str());
+        }
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_variants[shaderpath].insert(name);
+        m_recordedCount++;
+        m_missCount += isMiss ? 1u : 0u;
+    }
+
+    void ShaderVariantManifest::Save(const std::string& materialDirectory)
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(materialDirectory))
+        {
+            if (entry.path().extension().compare(".material") == 0)
+            {
+                AddMaterialVariants(entry.path().string());
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        std::ofstream file(m_filepath);
+
+        if (!file.is_open())
+        {
+            PK_CORE_LOG_WARNING("Failed to write shader variant manifest: %s", m_filepath.c_str());
+            return;
+        }
+
+        auto variantCount = 0u;
+        file << "ShaderVariantManifest:\n";
+
+        for (auto& shader : m_variants)
+        {
+            file << "    " << shader.first << ":\n";
+
+            for (auto& variant : shader.second)
+            {
+                file << "        - " << variant << "\n";
+            }
+
+            variantCount += (uint32_t)shader.second.size();
+        }
+
+        PK_CORE_LOG("Wrote %i variants of %i shaders to: %s", variantCount, (uint32_t)m_variants.size(), m_filepath.c_str());
+    }
+
+    // The material keywords fix the directives they belong to, directives of engine keywords can take any value.
+    void ShaderVariantManifest::AddMaterialVariants(const std::string& filepath)
+    {
+        YAML::Node root = YAML::LoadFile(filepath);
+        auto data = root["Material"];
+
+        if (!data || !data["Shader"])
+        {
+            return;
+        }
+
+        auto shaderpath = data["Shader"].as<std::string>();
+        auto& variantMap = m_assetDatabase->Load<Shader>(shaderpath)->GetVariantMap();
+        uint32_t values[16] = {};
+        bool isEngineDirective[16] = {};
+
+        // Set independently of materials: globally by the batcher & vertex layout, or by the meta passes that redraw the scene batches.
+        for (auto keyword : ShaderVariantMap::EngineKeywords)
+        {
+            auto kv = variantMap.keywords.find(StringHashID::StringToID(keyword));
+
+            if (kv != variantMap.keywords.end())
+            {
+                isEngineDirective[kv->second >> 4] = true;
+            }
+        }
+
+        auto keywords = data["Keywords"];
+
+        if (keywords)
+        {
+            for (auto keyword : keywords)
+            {
+                auto kv = variantMap.keywords.find(StringHashID::StringToID(keyword.as<std::string>()));
+
+                if (kv != variantMap.keywords.end())
+                {
+                    values[kv->second >> 4] = kv->second & 0xFu;
+                }
+            }
+        }
+
+        uint32_t combinations = 1u;
+
+        for (auto i = 0u; i < variantMap.directivecount; ++i)
+        {
+            combinations *= isEngineDirective[i] ? GetDirectiveSize(variantMap, i) : 1u;
+        }
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        auto& variants = m_variants[shaderpath];
+
+        for (auto combination = 0u; combination < combinations; ++combination)
+        {
+            auto remainder = combination;
+            uint32_t index = 0u;
+
+            for (auto i = 0u; i < variantMap.directivecount; ++i)
+            {
+                auto value = values[i];
+
+                if (isEngineDirective[i])
+                {
+                    auto size = GetDirectiveSize(variantMap, i);
+                    value = remainder % size;
+                    remainder /= size;
+                }
+
+                index += GetDirectiveStride(variantMap, i) * value;
+            }
+
+            variants.insert(GetVariantName(variantMap, index));
+        }
+    }
+
+    std::string ShaderVariantManifest::GetVariantName(const ShaderVariantMap& variantMap, uint32_t index)
+    {
+        auto keywords = variantMap.GetVariantKeywords(index);
+
+        // Variants that only select "_" are listed by it so that every entry is a readable value.
+        if (keywords.empty())
+        {
+            return "_";
+        }
+
+        keywords.pop_back();
+        return keywords;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Core/IService.h"
+#include "Core/ISingleton.h"
+#include "Core/AssetDataBase.h"
+#include "Rendering/Objects/Shader.h"
+#include <mutex>
+#include <set>
+
+namespace PK::Rendering
+{
+    using namespace PK::Core;
+    using namespace PK::Rendering::Objects;
+
+    // Variants of each shader that are in use, stored as the keywords that select them so that entries stay valid when directives are reordered.
+    // Built from the variants that shaders resolve at runtime & a static analysis of the material keyword lists combined with the keywords the engine sets per pass.
+    // When stripping, listed variants are compiled on import & requests for other variants are logged as misses.
+    class ShaderVariantManifest : public IService, public ISingleton<ShaderVariantManifest>
+    {
+        public:
+            ShaderVariantManifest(AssetDatabase* assetDatabase, const std::string& filepath, bool strip);
+
+            inline bool IsStripping() const { return m_strip; }
+            inline uint32_t GetMissCount() const { return m_missCount; }
+            inline uint32_t GetRecordedCount() const { return m_recordedCount; }
+
+            // Returns false when the shader isn't listed. Entries with keywords that the shader no longer declares are skipped.
+            bool GetVariantIndices(const std::string& shaderpath, const ShaderVariantMap& variantMap, std::vector<uint32_t>& indices) const;
+            // Called once per variant that a shader resolves, from the thread that draws.
+            void RecordVariant(const std::string& shaderpath, const ShaderVariantMap& variantMap, uint32_t index, bool isMiss);
+            // Writes the listed, recorded & statically reachable variants of the materials in the directory.
+            void Save(const std::string& materialDirectory);
+
+        private:
+            void AddMaterialVariants(const std::string& filepath);
+            static std::string GetVariantName(const ShaderVariantMap& variantMap, uint32_t index);
+
+            AssetDatabase* m_assetDatabase = nullptr;
+            std::string m_filepath;
+            bool m_strip = false;
+            uint32_t m_missCount = 0u;
+            uint32_t m_recordedCount = 0u;
+            mutable std::mutex m_lock;
+            // Ordered so that the written manifest is stable between saves.
+            std::map<std::string, std::set<std::string>> m_variants;
+    };
+}
@@ -46,6 +46,14 @@ namespace PK::Rendering::Structs
 			std::vector<BufferElement>::iterator end() { return m_elements.end(); }
 			std::vector<BufferElement>::const_iterator begin() const { return m_elements.begin(); }
 			std::vector<BufferElement>::const_iterator end() const { return m_elements.end(); }
+
+			bool operator==(const BufferLayout& other) const
+			{
+				return m_elements.size() == other.m_elements.size() && std::equal(m_elements.begin(), m_elements.end(), other.m_elements.begin(), [](const BufferElement& a, const BufferElement& b)
+				{
+					return a.NameHashId == b.NameHashId && a.Type == b.Type && a.Size == b.Size && a.Normalized == b.Normalized;
+				});
+			}
 	
 		private:
 			void CalculateOffsetsAndStride();
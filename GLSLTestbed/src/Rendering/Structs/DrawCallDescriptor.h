@@ -14,6 +14,7 @@ namespace PK::Rendering::Structs
         Procedural = 2,
         Compute = 3,
         ComputeIndirect = 4,
+        MeshIndirect = 5,
     };
 
     struct DrawCallDescriptor
@@ -1,12 +1,19 @@
 #include "PrecompiledHeader.h"
 #include "Utilities/StringHashID.h"
 #include "Rendering/Structs/PropertyBlock.h"
+#include <atomic>
 
 namespace PK::Rendering::Structs
 {
 	using namespace PK::Utilities;
 	using namespace PK::Math;
 
+	static uint GetNextLayoutVersion()
+	{
+		static std::atomic<uint> layoutVersion = 0u;
+		return ++layoutVersion;
+	}
+
 	PropertyBlock::PropertyBlock() : m_explicitLayout(false), m_currentByteOffset(0)
 	{
 	}
@@ -23,6 +30,8 @@ namespace PK::Rendering::Structs
 			m_properties[element.NameHashId] = { element.Type, element.Size, m_currentByteOffset };
 			m_currentByteOffset += element.Size;
 		}
+
+		m_layoutVersion = GetNextLayoutVersion();
 	}
 	
 	PropertyBlock::PropertyBlock(const BufferLayout& layout) : PropertyBlock(layout, 16)
@@ -50,6 +59,7 @@ namespace PK::Rendering::Structs
 	
 			info = { type, size, m_currentByteOffset };
 			m_currentByteOffset += size;
+			m_layoutVersion = GetNextLayoutVersion();
 		}
 		else if (info.size < size || info.type != type)
 		{
@@ -90,6 +100,7 @@ namespace PK::Rendering::Structs
 	void PropertyBlock::Clear()
 	{
 		m_currentByteOffset = 0;
+		m_layoutVersion = 0;
 		m_properties.clear();
 	}
 }
\ No newline at end of file
@@ -60,6 +60,10 @@ namespace PK::Rendering::Structs
 			inline void SetResourceHandle(uint hashId, const ulong& value) { SetValue(hashId, PK_TYPE::HANDLE, &value); }
 	
 			void CopyFrom(PropertyBlock& from);
+
+			// Unique for every set of property offsets & types, changes when a property is added or the block is cleared. Empty blocks share 0.
+			inline uint GetLayoutVersion() const { return m_layoutVersion; }
+			inline const char* GetData() const { return m_data.data(); }
 	
 			virtual void Clear();
 		
@@ -108,6 +112,7 @@ namespace PK::Rendering::Structs
 	
 			bool m_explicitLayout = false;
 			uint m_currentByteOffset = 0;
+			uint m_layoutVersion = 0;
 			std::vector<char> m_data;
 			std::unordered_map<uint, PropertyInfo> m_properties;
 	};
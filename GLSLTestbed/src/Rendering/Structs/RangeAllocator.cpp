@@ -0,0 +1,197 @@
+#include "PrecompiledHeader.h"
+#include "Rendering/Structs/RangeAllocator.h"
+
+namespace PK::Rendering::Structs
+{
+	RangeAllocator::RangeAllocator(uint capacity)
+	{
+		Grow(capacity);
+	}
+
+	uint RangeAllocator::Allocate(uint count)
+	{
+		if (count == 0)
+		{
+			return InvalidHandle;
+		}
+
+		auto best = m_freeRanges.size();
+
+		for (auto i = 0u; i < m_freeRanges.size(); ++i)
+		{
+			auto freeCount = m_freeRanges.at(i).count;
+
+			if (freeCount >= count && (best == m_freeRanges.size() || freeCount < m_freeRanges.at(best).count))
+			{
+				best = i;
+			}
+		}
+
+		if (best == m_freeRanges.size())
+		{
+			return InvalidHandle;
+		}
+
+		auto& range = m_freeRanges.at(best);
+		IndexRange allocation = { range.offset, count };
+		range.offset += count;
+		range.count -= count;
+
+		if (range.count == 0)
+		{
+			m_freeRanges.erase(m_freeRanges.begin() + best);
+		}
+
+		auto handle = (uint)m_allocations.size();
+
+		if (!m_freeHandles.empty())
+		{
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+			m_allocations.at(handle) = allocation;
+		}
+		else
+		{
+			m_allocations.push_back(allocation);
+		}
+
+		m_usedCount += count;
+		return handle;
+	}
+
+	void RangeAllocator::Free(uint handle)
+	{
+		if (handle == InvalidHandle)
+		{
+			return;
+		}
+
+		auto range = m_allocations.at(handle);
+		PK_CORE_ASSERT(range.count > 0, "Range allocation %i is already released!", handle);
+
+		m_allocations.at(handle) = { 0, 0 };
+		m_freeHandles.push_back(handle);
+		m_usedCount -= range.count;
+
+		auto next = std::lower_bound(m_freeRanges.begin(), m_freeRanges.end(), range.offset, [](const IndexRange& a, uint offset) { return a.offset < offset; });
+
+		if (next != m_freeRanges.begin())
+		{
+			auto previous = next - 1;
+
+			if (previous->offset + previous->count == range.offset)
+			{
+				range = { previous->offset, previous->count + range.count };
+				next = m_freeRanges.erase(previous);
+			}
+		}
+
+		if (next != m_freeRanges.end() && range.offset + range.count == next->offset)
+		{
+			range.count += next->count;
+			next = m_freeRanges.erase(next);
+		}
+
+		m_freeRanges.insert(next, range);
+	}
+
+	void RangeAllocator::Compact(std::vector<Move>& moves)
+	{
+		std::vector<uint> handles;
+		handles.reserve(m_allocations.size());
+
+		for (auto i = 0u; i < m_allocations.size(); ++i)
+		{
+			if (m_allocations.at(i).count > 0)
+			{
+				handles.push_back(i);
+			}
+		}
+
+		std::sort(handles.begin(), handles.end(), [this](uint a, uint b) { return m_allocations.at(a).offset < m_allocations.at(b).offset; });
+
+		auto offset = 0u;
+		moves.clear();
+		moves.reserve(handles.size());
+
+		for (auto handle : handles)
+		{
+			auto& range = m_allocations.at(handle);
+			moves.push_back({ range.offset, offset, range.count });
+			range.offset = offset;
+			offset += range.count;
+		}
+
+		m_freeRanges.clear();
+
+		if (offset < m_capacity)
+		{
+			m_freeRanges.push_back({ offset, m_capacity - offset });
+		}
+	}
+
+	void RangeAllocator::Grow(uint capacity)
+	{
+		if (capacity <= m_capacity)
+		{
+			return;
+		}
+
+		if (!m_freeRanges.empty() && m_freeRanges.back().offset + m_freeRanges.back().count == m_capacity)
+		{
+			m_freeRanges.back().count += capacity - m_capacity;
+		}
+		else
+		{
+			m_freeRanges.push_back({ m_capacity, capacity - m_capacity });
+		}
+
+		m_capacity = capacity;
+	}
+
+	bool RangeAllocator::Validate() const
+	{
+		if (!std::is_sorted(m_freeRanges.begin(), m_freeRanges.end(), [](const IndexRange& a, const IndexRange& b) { return a.offset < b.offset; }))
+		{
+			return false;
+		}
+
+		std::vector<std::pair<IndexRange, bool>> ranges;
+		auto usedCount = 0u;
+
+		for (auto& range : m_allocations)
+		{
+			if (range.count > 0)
+			{
+				ranges.push_back({ range, false });
+				usedCount += range.count;
+			}
+		}
+
+		for (auto& range : m_freeRanges)
+		{
+			if (range.count == 0)
+			{
+				return false;
+			}
+
+			ranges.push_back({ range, true });
+		}
+
+		std::sort(ranges.begin(), ranges.end(), [](const std::pair<IndexRange, bool>& a, const std::pair<IndexRange, bool>& b) { return a.first.offset < b.first.offset; });
+
+		auto offset = 0u;
+
+		for (auto i = 0u; i < ranges.size(); ++i)
+		{
+			if (ranges.at(i).first.offset != offset || (i > 0 && ranges.at(i).second && ranges.at(i - 1).second))
+			{
+				return false;
+			}
+
+			offset += ranges.at(i).first.count;
+		}
+
+		return offset == m_capacity && usedCount == m_usedCount && GetAllocationCount() == ranges.size() - m_freeRanges.size();
+	}
+}
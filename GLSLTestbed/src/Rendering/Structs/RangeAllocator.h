@@ -0,0 +1,48 @@
+#pragma once
+#include "Rendering/Structs/StructsCommon.h"
+
+namespace PK::Rendering::Structs
+{
+	// Sub allocates element ranges from a capacity. Only does the bookkeeping, the owner of the storage applies the moves returned by Compact.
+	class RangeAllocator
+	{
+		public:
+			struct Move
+			{
+				uint source = 0;
+				uint destination = 0;
+				uint count = 0;
+			};
+
+			static constexpr uint InvalidHandle = ~0u;
+
+			RangeAllocator(uint capacity = 0);
+
+			// Best fit from the free ranges. Returns InvalidHandle for empty ranges & when no free range is large enough.
+			uint Allocate(uint count);
+			// Adjacent free ranges are merged. Freeing InvalidHandle does nothing.
+			void Free(uint handle);
+			// Moves the live ranges to the start in offset order & leaves one free range at the end. Outputs a move for every live range, unmoved ones included.
+			void Compact(std::vector<Move>& moves);
+			// Appends the added capacity to the free range at the end.
+			void Grow(uint capacity);
+			// Checks that the live & free ranges tile the capacity without overlaps or adjacent free ranges.
+			bool Validate() const;
+
+			inline const IndexRange& GetRange(uint handle) const { return m_allocations.at(handle); }
+			inline uint GetCapacity() const { return m_capacity; }
+			inline uint GetUsedCount() const { return m_usedCount; }
+			inline uint GetFreeCount() const { return m_capacity - m_usedCount; }
+			inline uint GetFreeRangeCount() const { return (uint)m_freeRanges.size(); }
+			inline uint GetAllocationCount() const { return (uint)(m_allocations.size() - m_freeHandles.size()); }
+
+		private:
+			uint m_capacity = 0;
+			uint m_usedCount = 0;
+			// Sorted by offset.
+			std::vector<IndexRange> m_freeRanges;
+			// Indexed by handle, released handles are reused & have an empty range.
+			std::vector<IndexRange> m_allocations;
+			std::vector<uint> m_freeHandles;
+	};
+}
@@ -48,6 +48,19 @@ namespace PK::Rendering::Structs
         float4 tangent;
         float2 texcoord;
     };
+
+    // Decoded by VertexCompression.glsl.
+    struct Vertex_Compressed
+    {
+        // Unorm16 relative to the mesh bounds, w is padding.
+        ushort position[4];
+        // Octahedral snorm16.
+        short normal[2];
+        // Octahedral unorm 16 + 15 bits, bitangent sign in the highest bit.
+        uint tangent;
+        // Half floats.
+        ushort texcoord[2];
+    };
     
     struct PKRawLight
     {
@@ -64,4 +77,27 @@ namespace PK::Rendering::Structs
         uint offset = 0;
         uint count = 0;
     };
+
+    // Cluster of consecutive triangles in an index range, bounds are in object space.
+    struct Meshlet
+    {
+        float3 center;
+        float radius = 0.0f;
+        // Every triangle faces away from views where dot(normalize(coneApex - view), coneAxis) >= coneCutoff.
+        float3 coneApex;
+        float coneCutoff = 2.0f;
+        float3 coneAxis;
+        uint indexOffset = 0;
+        uint indexCount = 0;
+    };
+
+    // Layout of glMultiDrawElementsIndirect commands.
+    struct DrawIndirectArguments
+    {
+        uint count = 0;
+        uint instanceCount = 0;
+        uint firstIndex = 0;
+        int baseVertex = 0;
+        uint baseInstance = 0;
+    };
 }
\ No newline at end of file
@@ -43,6 +43,10 @@ namespace PK::Utilities
         DEFINE_HASH_CACHE(pk_InstancedProperties)
         DEFINE_HASH_CACHE(PK_ENABLE_INSTANCING)
 
+        DEFINE_HASH_CACHE(PK_VERTEX_COMPRESSED)
+        DEFINE_HASH_CACHE(pk_MeshQuantizationMin)
+        DEFINE_HASH_CACHE(pk_MeshQuantizationExtents)
+
         DEFINE_HASH_CACHE(pk_PerFrameConstants)
         DEFINE_HASH_CACHE(pk_GizmoVertices)
         DEFINE_HASH_CACHE(pk_DebugDrawIndex)
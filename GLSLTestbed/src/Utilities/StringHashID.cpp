@@ -5,6 +5,19 @@ namespace PK::Utilities
 {
     uint32_t StringHashID::LocalStringToID(const std::string& str)
     {
+        {
+            std::shared_lock<std::shared_mutex> lock(m_lock);
+            auto element = m_stringIdMap.find(str);
+
+            if (element != m_stringIdMap.end())
+            {
+                return element->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_lock);
+
+        // Another thread might have registered the string in between.
         if (m_stringIdMap.count(str) > 0)
         {
             return m_stringIdMap.at(str);
@@ -22,6 +35,8 @@ namespace PK::Utilities
     
     const std::string& StringHashID::LocalIDToString(uint32_t id)
     {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+
         if (id > m_idCounter)
         {
             throw std::invalid_argument("Trying to get a string using an invalid id: " + std::to_string(id));
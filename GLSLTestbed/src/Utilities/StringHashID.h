@@ -1,11 +1,14 @@
 #pragma once
 #include "Core/ISingleton.h"
 #include "Core/IService.h"
+#include <mutex>
+#include <shared_mutex>
 
 namespace PK::Utilities
 {
     using namespace Core;
 
+    // Thread safe, asset decoding registers names from job threads.
     class StringHashID : public IService, public ISingleton<StringHashID>
     {
         public:
@@ -20,6 +23,7 @@ namespace PK::Utilities
         private:
             std::unordered_map<std::string, uint32_t> m_stringIdMap;
             std::unordered_map<uint32_t, std::string> m_idStringMap;
+            std::shared_mutex m_lock;
             uint32_t m_idCounter = 0;
     };
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "PrecompiledHeader.h"
 #include "Utilities/StringUtilities.h"
 #include "Utilities/Log.h"
+#include "Utilities/Ref.h"
+#include <filesystem>
+#include <mutex>
 
 namespace PK::Utilities::String
 {
@@ -70,64 +73,138 @@ namespace PK::Utilities::String
 		return filepath.substr(0, lastSlash);
     }
 
-	std::string ReadFileRecursiveInclude(const std::string& filepath, std::vector<std::string>& includes, bool isRecursive)
+	// A file split at its include lines. Shaders include the same files, so they are read from disk once & again only when modified.
+	struct IncludeFile
+	{
+		struct Segment
+		{
+			std::string text;
+			// Path of the include that follows the text, empty for the last segment.
+			std::string include;
+		};
+
+		std::filesystem::file_time_type timestamp;
+		std::vector<Segment> segments;
+		bool hasPragmaOnce = false;
+	};
+
+	static std::mutex s_includeCacheLock;
+	static std::unordered_map<std::string, Ref<const IncludeFile>> s_includeCache;
+
+	static Ref<const IncludeFile> GetIncludeFile(const std::string& filepath)
 	{
 		auto includeOnceToken = "#pragma once";
 		auto includeToken = "#include ";
 		auto includeTokenLength = strlen(includeToken);
-		auto foundPragmaOnce = false;
 
-		std::ifstream file(filepath, std::ios::in);
+		std::error_code error;
+		auto timestamp = std::filesystem::last_write_time(filepath, error);
+
+		{
+			std::unique_lock<std::mutex> lock(s_includeCacheLock);
+			auto iter = s_includeCache.find(filepath);
+
+			if (iter != s_includeCache.end() && !error && iter->second->timestamp == timestamp)
+			{
+				return iter->second;
+			}
+		}
+
+		std::ifstream file(filepath, std::ios::in | std::ios::binary);
 
 		PK_CORE_ASSERT(file, "Could not open file at: %s", filepath.c_str());
 
-		std::string result;
-		std::string lineBuffer;
+		std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		file.close();
 
-		while (std::getline(file, lineBuffer))
+		auto directory = filepath.substr(0, filepath.find_last_of("/\\") + 1);
+		auto includeFile = CreateRef<IncludeFile>();
+		includeFile->timestamp = timestamp;
+		includeFile->segments.emplace_back();
+
+		for (size_t start = 0; start < content.size();)
 		{
-			if (!foundPragmaOnce && lineBuffer.find(includeOnceToken) != lineBuffer.npos)
+			auto end = content.find('\n', start);
+			auto next = end == std::string::npos ? content.size() : end + 1;
+			end = end == std::string::npos ? content.size() : end;
+			auto length = end > start && content[end - 1] == '\r' ? end - start - 1 : end - start;
+			auto line = std::string_view(content.data() + start, length);
+			start = next;
+
+			if (!includeFile->hasPragmaOnce && line.find(includeOnceToken) != line.npos)
 			{
-				foundPragmaOnce = true;
-
-				if (std::find(includes.begin(), includes.end(), filepath) != includes.end())
-				{
-					file.close();
-					return "";
-				}
-
-				includes.push_back(filepath);
+				includeFile->hasPragmaOnce = true;
 				continue;
 			}
 
-			auto includepos = lineBuffer.find(includeToken);
+			auto includepos = line.find(includeToken);
 
-			if (includepos != lineBuffer.npos)
+			if (includepos != line.npos)
 			{
-				lineBuffer.erase(0, includepos + includeTokenLength);
-				lineBuffer.insert(0, filepath.substr(0, filepath.find_last_of("/\\") + 1));
-				result += ReadFileRecursiveInclude(lineBuffer, includes, true);
+				includeFile->segments.back().include = directory;
+				includeFile->segments.back().include.append(line.substr(includepos + includeTokenLength));
+				includeFile->segments.emplace_back();
 				continue;
 			}
 
-			result += lineBuffer + '\n';
+			includeFile->segments.back().text.append(line);
+			includeFile->segments.back().text.append(1, '\n');
 		}
 
-		if (!isRecursive)
+		std::unique_lock<std::mutex> lock(s_includeCacheLock);
+		s_includeCache[filepath] = includeFile;
+		return includeFile;
+	}
+
+	static void ReadFileRecursiveInclude(const std::string& filepath, std::vector<std::string>& includes, std::vector<std::string>* dependencies, std::string& result)
+	{
+		auto includeFile = GetIncludeFile(filepath);
+
+		if (includeFile->hasPragmaOnce)
 		{
-			result += '\0';
+			if (std::find(includes.begin(), includes.end(), filepath) != includes.end())
+			{
+				return;
+			}
+
+			includes.push_back(filepath);
 		}
 
-		file.close();
+		for (auto& segment : includeFile->segments)
+		{
+			result.append(segment.text);
 
-		return result;
+			if (segment.include.empty())
+			{
+				continue;
+			}
+
+			if (dependencies != nullptr && std::find(dependencies->begin(), dependencies->end(), segment.include) == dependencies->end())
+			{
+				dependencies->push_back(segment.include);
+			}
+
+			ReadFileRecursiveInclude(segment.include, includes, dependencies, result);
+		}
 	}
 
-	std::string ReadFileRecursiveInclude(const std::string& filepath)
+	static std::string ReadFileRecursiveInclude(const std::string& filepath, std::vector<std::string>* dependencies)
 	{
 		std::vector<std::string> includes;
-		return ReadFileRecursiveInclude(filepath, includes, false);
+		std::string result;
+		ReadFileRecursiveInclude(filepath, includes, dependencies, result);
+		result += '\0';
+		return result;
 	}
+
+	void ClearIncludeCache()
+	{
+		std::unique_lock<std::mutex> lock(s_includeCacheLock);
+		s_includeCache.clear();
+	}
+
+	std::string ReadFileRecursiveInclude(const std::string& filepath) { return ReadFileRecursiveInclude(filepath, nullptr); }
+	std::string ReadFileRecursiveInclude(const std::string& filepath, std::vector<std::string>& dependencies) { return ReadFileRecursiveInclude(filepath, &dependencies); }
 	
 	std::string ExtractToken(const char* token, std::string& source, bool includeToken)
 	{
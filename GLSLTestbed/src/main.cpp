@@ -16,7 +16,7 @@ int main(int argc, char** argv)
 
 	//_CrtSetBreakAlloc(69727);
 
-	auto app = new PK::Core::Application("PK Renderer");
+	auto app = new PK::Core::Application("PK Renderer", std::vector<std::string>(argv, argv + argc));
 	app->Run();
 	delete app;
 }
\ No newline at end of file